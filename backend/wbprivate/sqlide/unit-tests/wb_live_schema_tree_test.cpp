@@ -4328,11 +4328,9 @@ void set_patterns(GPatternSpec** schema_pattern, GPatternSpec** object_pattern,
     *object_pattern = g_pattern_spec_new(base::toupper(filters[1]).c_str());
 }
 
-// Test filter_children and filter_children_collection without filters stablished to make
-// Sure effectively all the data is copied from one tree to the other
-TEST_FUNCTION(33) {
-  mforms::TreeNodeRef root_node = pmodel_view->root_node();
-  mforms::TreeNodeRef root_node_f = pmodel_view_filtered->root_node();
+// Verifies the filtered tree is a full copy of the base one, except for the content of tables and views which is
+// only copied for the ones expanded on the base tree
+void verify_filtered_copy(const std::string& check, mforms::TreeNodeRef root_node, mforms::TreeNodeRef root_node_f) {
   mforms::TreeNodeRef schema_node;
   mforms::TreeNodeRef schema_node_f;
   mforms::TreeNodeRef object_node;
@@ -4340,34 +4338,27 @@ TEST_FUNCTION(33) {
   mforms::TreeNodeRef sub_node;
   mforms::TreeNodeRef sub_node_f;
 
-  fill_complex_schema("TF033CHK001");
-
-  // Ensure no matter the type, all the children are copied if no filter is specified
-  // This test indeed includes the testing of
-  ensure_equals("TF033CHK002: Unexpected number of schema nodes before filtering", root_node_f->count(), 0);
-  _tester.filter_children(LiveSchemaTree::Schema, root_node, root_node_f);
-  ensure_equals("TF033CHK002: Unexpected number of schema nodes after filtering", root_node_f->count(),
+  ensure_equals(check + ": Unexpected number of schema nodes after filtering", root_node_f->count(),
                 root_node->count());
 
   for (int schema_index = 0; schema_index < root_node->count(); schema_index++) {
     schema_node = root_node->get_child(schema_index);
     schema_node_f = root_node_f->get_child(schema_index);
 
-    ensure("TF033CHK002: Unexpected schema data in filtered schema",
-           schema_node_f->get_data() == schema_node->get_data());
+    ensure(check + ": Unexpected schema data in filtered schema", schema_node_f->get_data() == schema_node->get_data());
 
-    ensure_equals("TF033CHK002: Unexpected number of schema collection nodes after filtering", schema_node_f->count(),
+    ensure_equals(check + ": Unexpected number of schema collection nodes after filtering", schema_node_f->count(),
                   schema_node->count());
-    ensure_equals("TF033CHK002: Unexpected number of table nodes after filtering",
+    ensure_equals(check + ": Unexpected number of table nodes after filtering",
                   schema_node_f->get_child(LiveSchemaTree::TABLES_NODE_INDEX)->count(),
                   schema_node->get_child(LiveSchemaTree::TABLES_NODE_INDEX)->count());
-    ensure_equals("TF033CHK002: Unexpected number of view nodes after filtering",
+    ensure_equals(check + ": Unexpected number of view nodes after filtering",
                   schema_node_f->get_child(LiveSchemaTree::VIEWS_NODE_INDEX)->count(),
                   schema_node->get_child(LiveSchemaTree::VIEWS_NODE_INDEX)->count());
-    ensure_equals("TF033CHK002: Unexpected number of procedure nodes after filtering",
+    ensure_equals(check + ": Unexpected number of procedure nodes after filtering",
                   schema_node_f->get_child(LiveSchemaTree::PROCEDURES_NODE_INDEX)->count(),
                   schema_node->get_child(LiveSchemaTree::PROCEDURES_NODE_INDEX)->count());
-    ensure_equals("TF033CHK002: Unexpected number of function nodes after filtering",
+    ensure_equals(check + ": Unexpected number of function nodes after filtering",
                   schema_node_f->get_child(LiveSchemaTree::FUNCTIONS_NODE_INDEX)->count(),
                   schema_node->get_child(LiveSchemaTree::FUNCTIONS_NODE_INDEX)->count());
 
@@ -4376,20 +4367,34 @@ TEST_FUNCTION(33) {
       object_node = schema_node->get_child(LiveSchemaTree::TABLES_NODE_INDEX)->get_child(table_index);
       object_node_f = schema_node_f->get_child(LiveSchemaTree::TABLES_NODE_INDEX)->get_child(table_index);
 
-      ensure("TF033CHK002: Unexpected table data in filtered table",
-             object_node->get_data() == object_node_f->get_data());
-      ensure_equals("TF033CHK002: Unexpected number of table collection nodes after filtering", object_node_f->count(),
+      ensure(check + ": Unexpected table data in filtered table", object_node->get_data() == object_node_f->get_data());
+
+      // The collection nodes are always there, they are created along with the table node
+      ensure_equals(check + ": Unexpected number of table collection nodes after filtering", object_node_f->count(),
                     object_node->count());
-      ensure_equals("TF033CHK002: Unexpected number of column nodes after filtering",
+
+      if (!object_node->is_expanded()) {
+        ensure_equals(check + ": Unexpected number of column nodes in collapsed table",
+                      object_node_f->get_child(LiveSchemaTree::TABLE_COLUMNS_NODE_INDEX)->count(), 0);
+        ensure_equals(check + ": Unexpected number of index nodes in collapsed table",
+                      object_node_f->get_child(LiveSchemaTree::TABLE_INDEXES_NODE_INDEX)->count(), 0);
+        ensure_equals(check + ": Unexpected number of trigger nodes in collapsed table",
+                      object_node_f->get_child(LiveSchemaTree::TABLE_TRIGGERS_NODE_INDEX)->count(), 0);
+        ensure_equals(check + ": Unexpected number of foreign key nodes in collapsed table",
+                      object_node_f->get_child(LiveSchemaTree::TABLE_FOREIGN_KEYS_NODE_INDEX)->count(), 0);
+        continue;
+      }
+
+      ensure_equals(check + ": Unexpected number of column nodes after filtering",
                     object_node_f->get_child(LiveSchemaTree::TABLE_COLUMNS_NODE_INDEX)->count(),
                     object_node->get_child(LiveSchemaTree::TABLE_COLUMNS_NODE_INDEX)->count());
-      ensure_equals("TF033CHK002: Unexpected number of index nodes after filtering",
+      ensure_equals(check + ": Unexpected number of index nodes after filtering",
                     object_node_f->get_child(LiveSchemaTree::TABLE_INDEXES_NODE_INDEX)->count(),
                     object_node->get_child(LiveSchemaTree::TABLE_INDEXES_NODE_INDEX)->count());
-      ensure_equals("TF033CHK002: Unexpected number of trigger nodes after filtering",
+      ensure_equals(check + ": Unexpected number of trigger nodes after filtering",
                     object_node_f->get_child(LiveSchemaTree::TABLE_TRIGGERS_NODE_INDEX)->count(),
                     object_node->get_child(LiveSchemaTree::TABLE_TRIGGERS_NODE_INDEX)->count());
-      ensure_equals("TF033CHK002: Unexpected number of foreign key nodes after filtering",
+      ensure_equals(check + ": Unexpected number of foreign key nodes after filtering",
                     object_node_f->get_child(LiveSchemaTree::TABLE_FOREIGN_KEYS_NODE_INDEX)->count(),
                     object_node->get_child(LiveSchemaTree::TABLE_FOREIGN_KEYS_NODE_INDEX)->count());
 
@@ -4398,7 +4403,7 @@ TEST_FUNCTION(33) {
         sub_node = object_node->get_child(LiveSchemaTree::TABLE_COLUMNS_NODE_INDEX)->get_child(column_index);
         sub_node_f = object_node_f->get_child(LiveSchemaTree::TABLE_COLUMNS_NODE_INDEX)->get_child(column_index);
 
-        ensure("TF033CHK002: Unexpected column data in filtered table column",
+        ensure(check + ": Unexpected column data in filtered table column",
                sub_node->get_data() == sub_node_f->get_data());
       }
 
@@ -4407,7 +4412,7 @@ TEST_FUNCTION(33) {
         sub_node = object_node->get_child(LiveSchemaTree::TABLE_INDEXES_NODE_INDEX)->get_child(index_index);
         sub_node_f = object_node_f->get_child(LiveSchemaTree::TABLE_INDEXES_NODE_INDEX)->get_child(index_index);
 
-        ensure("TF033CHK002: Unexpected index data in filtered index", sub_node->get_data() == sub_node_f->get_data());
+        ensure(check + ": Unexpected index data in filtered index", sub_node->get_data() == sub_node_f->get_data());
       }
 
       for (int trigger_index = 0;
@@ -4416,8 +4421,7 @@ TEST_FUNCTION(33) {
         sub_node = object_node->get_child(LiveSchemaTree::TABLE_TRIGGERS_NODE_INDEX)->get_child(trigger_index);
         sub_node_f = object_node_f->get_child(LiveSchemaTree::TABLE_TRIGGERS_NODE_INDEX)->get_child(trigger_index);
 
-        ensure("TF033CHK002: Unexpected trigger data in filtered trigger",
-               sub_node->get_data() == sub_node_f->get_data());
+        ensure(check + ": Unexpected trigger data in filtered trigger", sub_node->get_data() == sub_node_f->get_data());
       }
 
       for (int fk_index = 0; fk_index < object_node->get_child(LiveSchemaTree::TABLE_FOREIGN_KEYS_NODE_INDEX)->count();
@@ -4425,26 +4429,31 @@ TEST_FUNCTION(33) {
         sub_node = object_node->get_child(LiveSchemaTree::TABLE_FOREIGN_KEYS_NODE_INDEX)->get_child(fk_index);
         sub_node_f = object_node_f->get_child(LiveSchemaTree::TABLE_FOREIGN_KEYS_NODE_INDEX)->get_child(fk_index);
 
-        ensure("TF033CHK002: Unexpected foreign key data in filtered foreign key",
+        ensure(check + ": Unexpected foreign key data in filtered foreign key",
                sub_node->get_data() == sub_node_f->get_data());
       }
     }
 
-    for (int view_index = 0; view_index < schema_node_f->get_child(LiveSchemaTree::TABLES_NODE_INDEX)->count();
+    for (int view_index = 0; view_index < schema_node_f->get_child(LiveSchemaTree::VIEWS_NODE_INDEX)->count();
          view_index++) {
       object_node = schema_node->get_child(LiveSchemaTree::VIEWS_NODE_INDEX)->get_child(view_index);
       object_node_f = schema_node_f->get_child(LiveSchemaTree::VIEWS_NODE_INDEX)->get_child(view_index);
 
-      ensure("TF033CHK002: Unexpected table data in filtered view",
-             object_node_f->get_data() == object_node->get_data());
-      ensure_equals("TF033CHK002: Unexpected number of view column nodes after filtering", object_node_f->count(),
+      ensure(check + ": Unexpected table data in filtered view", object_node_f->get_data() == object_node->get_data());
+
+      if (!object_node->is_expanded()) {
+        ensure_equals(check + ": Unexpected number of column nodes in collapsed view", object_node_f->count(), 0);
+        continue;
+      }
+
+      ensure_equals(check + ": Unexpected number of view column nodes after filtering", object_node_f->count(),
                     object_node->count());
 
       for (int column_index = 0; column_index < object_node->count(); column_index++) {
         sub_node = object_node->get_child(column_index);
         sub_node_f = object_node_f->get_child(column_index);
 
-        ensure("TF033CHK002: Unexpected column data in filtered view column",
+        ensure(check + ": Unexpected column data in filtered view column",
                sub_node->get_data() == sub_node_f->get_data());
       }
     }
@@ -4455,7 +4464,7 @@ TEST_FUNCTION(33) {
       object_node = schema_node->get_child(LiveSchemaTree::PROCEDURES_NODE_INDEX)->get_child(procedure_index);
       object_node_f = schema_node_f->get_child(LiveSchemaTree::PROCEDURES_NODE_INDEX)->get_child(procedure_index);
 
-      ensure("TF033CHK002: Unexpected procedure data in filtered routine",
+      ensure(check + ": Unexpected procedure data in filtered routine",
              object_node_f->get_data() == object_node->get_data());
     }
 
@@ -4464,11 +4473,85 @@ TEST_FUNCTION(33) {
       object_node = schema_node->get_child(LiveSchemaTree::FUNCTIONS_NODE_INDEX)->get_child(function_index);
       object_node_f = schema_node_f->get_child(LiveSchemaTree::FUNCTIONS_NODE_INDEX)->get_child(function_index);
 
-      ensure("TF033CHK002: Unexpected function data in filtered routine",
+      ensure(check + ": Unexpected function data in filtered routine",
              object_node_f->get_data() == object_node->get_data());
     }
   }
+}
+
+// Expands or collapses all the tables and views of the given tree
+void set_objects_expanded(mforms::TreeNodeRef root_node, bool expanded) {
+  for (int schema_index = 0; schema_index < root_node->count(); schema_index++) {
+    mforms::TreeNodeRef schema_node = root_node->get_child(schema_index);
+    int collections[] = {LiveSchemaTree::TABLES_NODE_INDEX, LiveSchemaTree::VIEWS_NODE_INDEX};
+
+    for (size_t collection_index = 0; collection_index < 2; collection_index++) {
+      mforms::TreeNodeRef collection = schema_node->get_child(collections[collection_index]);
+      for (int object_index = 0; object_index < collection->count(); object_index++) {
+        if (expanded)
+          collection->get_child(object_index)->expand();
+        else
+          collection->get_child(object_index)->collapse();
+      }
+    }
+  }
+}
 
+// Test filter_children and filter_children_collection without filters stablished to make
+// Sure effectively all the data is copied from one tree to the other
+TEST_FUNCTION(33) {
+  mforms::TreeNodeRef root_node = pmodel_view->root_node();
+  mforms::TreeNodeRef root_node_f = pmodel_view_filtered->root_node();
+
+  fill_complex_schema("TF033CHK001");
+
+  // Ensure no matter the type, all the children are copied if no filter is specified
+  // The content of tables and views is left empty as they are collapsed on the base tree
+  ensure_equals("TF033CHK002: Unexpected number of schema nodes before filtering", root_node_f->count(), 0);
+  _tester.filter_children(LiveSchemaTree::Schema, root_node, root_node_f);
+  verify_filtered_copy("TF033CHK002", root_node, root_node_f);
+
+  // With the tables and views expanded on the base tree their content is fully copied
+  set_objects_expanded(root_node, true);
+  _tester.filter_children(LiveSchemaTree::Schema, root_node, root_node_f);
+  verify_filtered_copy("TF033CHK003", root_node, root_node_f);
+
+  mforms::TreeNodeRef table_node_f =
+    _lst_filtered.get_node_for_object("test_schema", LiveSchemaTree::Table, "customer");
+  ensure("TF033CHK003: Table content not copied",
+         table_node_f->get_child(LiveSchemaTree::TABLE_COLUMNS_NODE_INDEX)->count() > 0);
+
+  // A table or view filtered while collapsed gets its content copied once it is expanded on the filtered tree
+  set_objects_expanded(root_node, false);
+  _lst_filtered.set_base(&_lst);
+  _lst_filtered.set_filter("");
+  _lst_filtered.filter_data();
+  verify_filtered_copy("TF033CHK004", root_node, root_node_f);
+
+  table_node_f = _lst_filtered.get_node_for_object("test_schema", LiveSchemaTree::Table, "customer");
+  mforms::TreeNodeRef view_node_f =
+    _lst_filtered.get_node_for_object("test_schema", LiveSchemaTree::View, "first_view");
+  ensure("TF033CHK005: Table node not found in the filtered tree", table_node_f.is_valid());
+  ensure("TF033CHK005: View node not found in the filtered tree", view_node_f.is_valid());
+
+  // The details are already loaded on the base tree, so expanding must not fetch them again
+  deleg_filtered->_check_id = "TF033CHK005";
+  _tester_filtered.expand_toggled(table_node_f, true);
+  _tester_filtered.expand_toggled(view_node_f, true);
+  deleg_filtered->check_and_reset("TF033CHK005");
+
+  // The expand state gets propagated so the base nodes are now expanded and the copies must be complete
+  ensure("TF033CHK006: Expand state not propagated to the base table",
+         _lst.get_node_for_object("test_schema", LiveSchemaTree::Table, "customer")->is_expanded());
+  ensure("TF033CHK006: Expand state not propagated to the base view",
+         _lst.get_node_for_object("test_schema", LiveSchemaTree::View, "first_view")->is_expanded());
+  ensure_equals("TF033CHK006: Unexpected number of column nodes after expanding",
+                table_node_f->get_child(LiveSchemaTree::TABLE_COLUMNS_NODE_INDEX)->count(), 3);
+  ensure_equals("TF033CHK006: Unexpected number of view column nodes after expanding", view_node_f->count(), 4);
+  verify_filtered_copy("TF033CHK006", root_node, root_node_f);
+
+  _tester_filtered.enable_events(false);
+  _lst_filtered.set_base(NULL);
   root_node->remove_children();
   root_node_f->remove_children();
 }
@@ -4660,4 +4743,200 @@ TEST_FUNCTION(36) {
   deleg_filtered->check_and_reset("TF036CHK001");
 }
 
+void collect_node_names(mforms::TreeNodeRef node, const std::string& prefix, std::vector<std::string>& names) {
+  for (int index = 0; index < node->count(); index++) {
+    mforms::TreeNodeRef child = node->get_child(index);
+    std::string path = prefix + "/" + child->get_string(0);
+
+    names.push_back(path);
+    collect_node_names(child, path, names);
+  }
+}
+
+void ensure_same_names(const std::string& check, const std::vector<std::string>& names,
+                       const std::vector<std::string>& expected) {
+  ensure_equals(check + ": Unexpected number of nodes", names.size(), expected.size());
+
+  for (size_t index = 0; index < names.size(); index++)
+    ensure_equals(check + ": Unexpected node", names[index], expected[index]);
+}
+
+// Tests a filter getting more specific refines the filtered tree in place with the same result as filtering from scratch
+TEST_FUNCTION(37) {
+  mforms::TreeNodeRef root_node_f = pmodel_view_filtered->root_node();
+  std::vector<std::string> refined;
+  std::vector<std::string> filtered;
+
+  fill_complex_schema("TF037CHK001");
+
+  _lst_filtered.set_base(&_lst);
+  _lst_filtered.set_filter("b");
+  _lst_filtered.filter_data();
+  ensure_equals("TF037CHK002: Unexpected number of schema nodes after filtering", root_node_f->count(), 2);
+
+  mforms::TreeNodeRef schema_node_f = root_node_f->get_child(0);
+
+  // Filters as if typing the filter one character after the other
+  const char* filters[] = {"basic_", "basic_s", "basic_schema.", "basic_schema.s", "basic_schema.se"};
+  for (size_t index = 0; index < sizeof(filters) / sizeof(filters[0]); index++) {
+    std::string check = base::strfmt("TF037CHK%03d", (int)index + 3);
+
+    _lst_filtered.set_filter(filters[index]);
+    _lst_filtered.filter_data();
+
+    ensure(check + ": Matching schema node not kept", root_node_f->get_child(0).ptr() == schema_node_f.ptr());
+
+    refined.clear();
+    collect_node_names(root_node_f, "", refined);
+
+    // Disabling the events makes the tree forget the applied filter, so the next filtering starts from the base tree
+    _tester_filtered.enable_events(false);
+    _lst_filtered.filter_data();
+
+    filtered.clear();
+    collect_node_names(root_node_f, "", filtered);
+
+    ensure_same_names(check, refined, filtered);
+
+    schema_node_f = root_node_f->get_child(0);
+  }
+
+  std::vector<std::string> schemas(1, "basic_schema");
+  std::vector<std::string> views;
+  views.push_back("second_view");
+  views.push_back("secure_view");
+  verify_filter_result("TF037CHK008", root_node_f, schemas, std::vector<std::string>(), views,
+                       std::vector<std::string>(), std::vector<std::string>());
+
+  // A filter not extending the applied one also gives the same result as filtering from scratch
+  _lst_filtered.set_filter("basic_schema.sec");
+  _lst_filtered.filter_data();
+  _lst_filtered.set_filter("basic_*.s");
+  _lst_filtered.filter_data();
+
+  refined.clear();
+  collect_node_names(root_node_f, "", refined);
+
+  _tester_filtered.enable_events(false);
+  _lst_filtered.filter_data();
+
+  filtered.clear();
+  collect_node_names(root_node_f, "", filtered);
+
+  ensure_same_names("TF037CHK009", refined, filtered);
+  ensure_equals("TF037CHK009: Unexpected number of schema nodes after filtering", root_node_f->count(), 2);
+
+  pmodel_view->root_node()->remove_children();
+  root_node_f->remove_children();
+}
+
+// Tests clearing the filter brings back all the objects of the base tree
+TEST_FUNCTION(38) {
+  mforms::TreeNodeRef root_node_f = pmodel_view_filtered->root_node();
+  std::vector<std::string> schemas;
+  std::vector<std::string> tables;
+  std::vector<std::string> views;
+  std::vector<std::string> procedures;
+  std::vector<std::string> functions;
+
+  fill_complex_schema("TF038CHK001");
+
+  _lst_filtered.set_base(&_lst);
+  _lst_filtered.set_filter("dev");
+  _lst_filtered.filter_data();
+  ensure_equals("TF038CHK002: Unexpected number of schema nodes after filtering", root_node_f->count(), 1);
+
+  schemas.push_back("basic_schema");
+  schemas.push_back("basic_training");
+  schemas.push_back("dev_schema");
+  schemas.push_back("test_schema");
+  tables.push_back("client");
+  tables.push_back("customer");
+  tables.push_back("product");
+  tables.push_back("store");
+  views.push_back("first_view");
+  views.push_back("second_view");
+  views.push_back("secure_view");
+  views.push_back("third");
+  procedures.push_back("get_debths");
+  procedures.push_back("get_lazy");
+  procedures.push_back("get_payments");
+  functions.push_back("calc_debth_list");
+  functions.push_back("calc_income");
+  functions.push_back("dummy");
+
+  _lst_filtered.set_filter("");
+  _lst_filtered.filter_data();
+  ensure_equals("TF038CHK003: Unexpected text filter", _tester_filtered.string_filter(), "");
+  verify_filter_result("TF038CHK003", root_node_f, schemas, tables, views, procedures, functions);
+
+  // Filtering again after clearing starts from the base tree
+  schemas.clear();
+  schemas.push_back("test_schema");
+  _lst_filtered.set_filter("t");
+  _lst_filtered.filter_data();
+  verify_filter_result("TF038CHK004", root_node_f, schemas, tables, views, procedures, functions);
+
+  pmodel_view->root_node()->remove_children();
+  root_node_f->remove_children();
+}
+
+// Tests the content of a filtered table is copied from the base tree when the table gets expanded
+TEST_FUNCTION(39) {
+  mforms::TreeNodeRef root_node_f = pmodel_view_filtered->root_node();
+
+  fill_complex_schema("TF039CHK001");
+
+  mforms::TreeNodeRef table_node = _lst.get_node_for_object("test_schema", LiveSchemaTree::Table, "customer");
+  ensure("TF039CHK002: Table node not found in the base tree", table_node.is_valid());
+
+  _lst_filtered.set_base(&_lst);
+  _lst_filtered.set_filter("test_schema.cust");
+  _lst_filtered.filter_data();
+
+  ensure_equals("TF039CHK003: Unexpected number of schema nodes after filtering", root_node_f->count(), 1);
+  ensure_equals("TF039CHK003: Unexpected number of table nodes after filtering",
+                root_node_f->get_child(0)->get_child(LiveSchemaTree::TABLES_NODE_INDEX)->count(), 1);
+
+  mforms::TreeNodeRef table_node_f =
+    root_node_f->get_child(0)->get_child(LiveSchemaTree::TABLES_NODE_INDEX)->get_child(0);
+  ensure_equals("TF039CHK003: Unexpected table node after filtering", table_node_f->get_string(0), "customer");
+  ensure("TF039CHK003: Unexpected table data in filtered table", table_node_f->get_data() == table_node->get_data());
+
+  // The table is collapsed on the base tree so its content is not copied yet
+  ensure_equals("TF039CHK004: Unexpected number of column nodes before expanding",
+                table_node_f->get_child(LiveSchemaTree::TABLE_COLUMNS_NODE_INDEX)->count(), 0);
+  ensure_equals("TF039CHK004: Unexpected number of index nodes before expanding",
+                table_node_f->get_child(LiveSchemaTree::TABLE_INDEXES_NODE_INDEX)->count(), 0);
+
+  // The details are already loaded on the base tree, so expanding must not fetch them again
+  deleg_filtered->_check_id = "TF039CHK005";
+  _tester_filtered.expand_toggled(table_node_f, true);
+  deleg_filtered->check_and_reset("TF039CHK005");
+
+  std::vector<std::string> names;
+  std::vector<std::string> expected;
+  collect_node_names(table_node_f, "", names);
+  collect_node_names(table_node, "", expected);
+  ensure_same_names("TF039CHK006", names, expected);
+  ensure_equals("TF039CHK006: Unexpected number of column nodes after expanding",
+                table_node_f->get_child(LiveSchemaTree::TABLE_COLUMNS_NODE_INDEX)->count(), 3);
+  ensure_equals("TF039CHK006: Unexpected number of index nodes after expanding",
+                table_node_f->get_child(LiveSchemaTree::TABLE_INDEXES_NODE_INDEX)->count(),
+                table_node->get_child(LiveSchemaTree::TABLE_INDEXES_NODE_INDEX)->count());
+  ensure("TF039CHK006: Expand state not propagated to the base tree", table_node->is_expanded());
+
+  // Once expanded on the base tree the content is copied right away when filtering
+  _tester_filtered.enable_events(false);
+  _lst_filtered.filter_data();
+
+  table_node_f = root_node_f->get_child(0)->get_child(LiveSchemaTree::TABLES_NODE_INDEX)->get_child(0);
+  names.clear();
+  collect_node_names(table_node_f, "", names);
+  ensure_same_names("TF039CHK007", names, expected);
+
+  pmodel_view->root_node()->remove_children();
+  root_node_f->remove_children();
+}
+
 END_TESTS
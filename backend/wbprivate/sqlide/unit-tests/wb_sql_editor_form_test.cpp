@@ -31,6 +31,7 @@
 #include "cppconn/sqlstring.h"
 
 #include "sqlide/wb_sql_editor_form.h"
+#include "grtsqlparser/sql_facade.h"
 
 using namespace grt;
 using namespace wb;
@@ -109,6 +110,44 @@ public:
     perform_idle_tasks();
   }
 
+  // Access to the table details cache of the schema tree.
+  void fetch_table_details(const std::string &schema_name) {
+    _form->get_live_tree()->fetch_table_details_for_schema(schema_name);
+  }
+
+  void forget_table_details(const std::string &schema_name) {
+    _form->get_live_tree()->forget_table_details(schema_name);
+  }
+
+  bool has_cached_table_details(const std::string &schema_name, const std::string &table_name) {
+    return _form->get_live_tree()->cached_table_details(schema_name, table_name) != NULL;
+  }
+
+  // Marks the details of the schema as being fetched, as done when its contents arrived.
+  void begin_table_details_fetch(const std::string &schema_name) {
+    std::shared_ptr<SqlEditorTreeController> tree = _form->get_live_tree();
+    base::MutexLock lock(tree->_table_details_mutex);
+    tree->_pending_table_details[schema_name].fetch_count++;
+  }
+
+  bool has_pending_table_details(const std::string &schema_name) {
+    std::shared_ptr<SqlEditorTreeController> tree = _form->get_live_tree();
+    base::MutexLock lock(tree->_table_details_mutex);
+    return tree->_pending_table_details.find(schema_name) != tree->_pending_table_details.end();
+  }
+
+  void table_details_fetched(const std::string &schema_name) {
+    _form->get_live_tree()->table_details_fetched(schema_name);
+  }
+
+  void fetch_object_details(const std::string &schema_name, const std::string &obj_name, short flags) {
+    _form->get_live_tree()->fetch_object_details(schema_name, obj_name, wb::LiveSchemaTree::Table, flags, updater_slot);
+  }
+
+  base::RecMutexLock lock_aux_connection() {
+    return _form->ensure_valid_aux_connection();
+  }
+
   void exec_sql(std::string &sql) {
     _form->exec_sql_returning_results(sql, false);
   }
@@ -224,6 +263,17 @@ private:
   SqlEditorForm::Ref _form;
 };
 
+struct TableDetailsFetch {
+  EditorFormTester *tester;
+  std::string schema_name;
+
+  static gpointer run(gpointer data) {
+    TableDetailsFetch *fetch = static_cast<TableDetailsFetch *>(data);
+    fetch->tester->fetch_table_details(fetch->schema_name);
+    return NULL;
+  }
+};
+
 BEGIN_TEST_DATA_CLASS(wb_sql_editor_form_test)
 public:
 WBTester *tester;
@@ -687,6 +737,120 @@ TEST_FUNCTION(6) {
   ensure_equals("TF006CHK005 : Unexpected foreign key delete rule", pchild_data->referenced_table, "language");
 }
 
+// Testing SqlEditorForm::split_script_in_chunks with chunks much smaller than the script.
+TEST_FUNCTION(7) {
+  SqlFacade::Ref sql_facade = SqlFacade::instance_for_rdbms(form->rdbms());
+
+  // Long enough for many chunks, with DELIMITER commands and delimiters in strings and comments all over.
+  std::string script;
+  std::vector<std::string> expected;
+  for (int i = 0; i < 40; ++i) {
+    std::string n = std::to_string(i);
+    script += "select " + n + ";\n";
+    script += "DELIMITER $$\ncreate procedure p" + n + "() begin select 1; select 2; end$$\n";
+    script += "select 'a;b' " + n + "$$\nDELIMITER ;\n";
+    script += "insert into t values (" + n + ", '$$;');\n";
+    script += "-- comment; here\n/* block; */ select " + n + ";\n";
+
+    expected.push_back("select " + n);
+    expected.push_back("create procedure p" + n + "() begin select 1; select 2; end");
+    expected.push_back("select 'a;b' " + n);
+    expected.push_back("insert into t values (" + n + ", '$$;')");
+    expected.push_back("select " + n);
+  }
+
+  const size_t chunk_sizes[] = {1, 7, 64, 333, 1000, script.size()};
+  for (size_t chunk_size : chunk_sizes) {
+    std::string check_id = "TF007CHK001 (chunk size " + std::to_string(chunk_size) + ")";
+    std::vector<std::string> statements;
+    size_t last_end_offset = 0;
+    bool completed = SqlEditorForm::split_script_in_chunks(
+      sql_facade, script.c_str(), script.size(), chunk_size, [&](const char *text, size_t length, size_t end_offset) {
+        ensure(check_id + " : Statements out of order", end_offset > last_end_offset);
+        last_end_offset = end_offset;
+        statements.push_back(std::string(text, length));
+        return true;
+      });
+
+    ensure(check_id + " : Splitting not completed", completed);
+    ensure_equals(check_id + " : Unexpected number of statements", statements.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+      ensure_equals(check_id + " : Unexpected statement", statements[i], expected[i]);
+  }
+
+  // Splitting stops as soon as a statement is rejected.
+  size_t count = 0;
+  bool completed = SqlEditorForm::split_script_in_chunks(sql_facade, script.c_str(), script.size(), 64,
+                                                         [&](const char *, size_t, size_t) { return ++count < 3; });
+  ensure("TF007CHK002 : Splitting not stopped", !completed);
+  ensure_equals("TF007CHK002 : Unexpected number of statements", count, 3U);
+}
+
+// Testing the bulk fetch of table details, which is discarded when the details were dropped meanwhile.
+TEST_FUNCTION(8) {
+  form_tester->tree_refresh();
+  form_tester->load_schema_data("wb_sql_editor_form_test");
+
+  form_tester->forget_table_details("wb_sql_editor_form_test");
+  ensure("TF008CHK001 : Table details not dropped",
+         !form_tester->has_cached_table_details("wb_sql_editor_form_test", "film"));
+
+  form_tester->fetch_table_details("wb_sql_editor_form_test");
+  ensure("TF008CHK002 : Table details not cached",
+         form_tester->has_cached_table_details("wb_sql_editor_form_test", "film"));
+
+  form_tester->forget_table_details("wb_sql_editor_form_test");
+
+  // The fetch takes the current generation of the schema details and then waits for the aux connection, which is
+  // held here until the details were dropped again.
+  TableDetailsFetch fetch = {form_tester, "wb_sql_editor_form_test"};
+  GThread *thread;
+  {
+    base::RecMutexLock aux_lock(form_tester->lock_aux_connection());
+    thread = base::create_thread(&TableDetailsFetch::run, &fetch);
+    g_usleep(500000);
+    form_tester->forget_table_details("wb_sql_editor_form_test");
+  }
+  g_thread_join(thread);
+
+  ensure("TF008CHK003 : Stale table details cached",
+         !form_tester->has_cached_table_details("wb_sql_editor_form_test", "film"));
+}
+
+// Testing table details requested while the details of the schema are being fetched.
+TEST_FUNCTION(9) {
+  form_tester->tree_refresh();
+  form_tester->load_schema_data("wb_sql_editor_form_test");
+
+  form_tester->forget_table_details("wb_sql_editor_form_test");
+  form_tester->begin_table_details_fetch("wb_sql_editor_form_test");
+
+  // Deferred until the fetch finished, the updater must not be called yet.
+  form_tester->_expect_update_node_children = false;
+  form_tester->_check_id = "TF009CHK001";
+  form_tester->fetch_object_details("wb_sql_editor_form_test", "film_text", wb::LiveSchemaTree::COLUMN_DATA);
+  ensure("TF009CHK001 : Request not kept", form_tester->has_pending_table_details("wb_sql_editor_form_test"));
+
+  form_tester->fetch_table_details("wb_sql_editor_form_test");
+
+  // The kept request is served from the fetched details.
+  form_tester->_expect_update_node_children = true;
+  form_tester->_mock_propagate_update_node_children = true;
+  form_tester->_check_id = "TF009CHK002";
+  form_tester->table_details_fetched("wb_sql_editor_form_test");
+  form_tester->clean_and_reset();
+
+  ensure("TF009CHK003 : Pending fetch not finished",
+         !form_tester->has_pending_table_details("wb_sql_editor_form_test"));
+  ensure("TF009CHK003 : Table details not cached",
+         form_tester->has_cached_table_details("wb_sql_editor_form_test", "film_text"));
+
+  mforms::TreeNodeRef table_node = form->get_live_tree()->get_schema_tree()->get_node_for_object(
+    "wb_sql_editor_form_test", wb::LiveSchemaTree::Table, "film_text");
+  wb::LiveSchemaTree::TableData *pdata = dynamic_cast<wb::LiveSchemaTree::TableData *>(table_node->get_data());
+  ensure("TF009CHK004 : Columns were not loaded", pdata->is_data_loaded(wb::LiveSchemaTree::COLUMN_DATA));
+}
+
 // Due to the tut nature, this must be executed as a last test always,
 // we can't have this inside of the d-tor.
 TEST_FUNCTION(99) {
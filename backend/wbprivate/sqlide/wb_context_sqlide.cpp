@@ -173,6 +173,14 @@ public:
     return grt::IntegerRef(0);
   }
 
+  virtual grt::IntegerRef executeScriptFile(const std::string &path) {
+    std::shared_ptr<SqlEditorForm> ref(_editor);
+    if (ref)
+      ref->exec_sql_script_file(path);
+
+    return grt::IntegerRef(0);
+  }
+
   virtual db_query_ResultsetRef executeManagementQuery(const std::string &sql, bool log) {
     std::shared_ptr<SqlEditorForm> ref(_editor);
     if (ref) {
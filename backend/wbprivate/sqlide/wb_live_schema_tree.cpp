@@ -1696,12 +1696,22 @@ std::string LiveSchemaTree::get_filter_wildcard(const std::string& filter, Filte
 void LiveSchemaTree::filter_data() {
   _enabled_events = false;
 
-  // Removes all the objects on the target tree
-  _model_view->clear();
-
-  mforms::TreeNodeRef base_root = _base->_model_view->root_node();
   mforms::TreeNodeRef this_root = _model_view->root_node();
-  filter_children(Schema, base_root, this_root, _schema_pattern);
+
+  // If the new filter just extends the one already applied (i.e. another character was typed) the objects matching
+  // it are a subset of the ones already in the tree, so they are filtered in place instead of copying again the
+  // whole base tree (which may hold many thousands of objects).
+  if (!_applied_filter.empty() && _filter.length() > _applied_filter.length() &&
+      base::hasPrefix(_filter, _applied_filter))
+    refine_children(Schema, this_root, _schema_pattern);
+  else {
+    // Removes all the objects on the target tree
+    _model_view->clear();
+
+    mforms::TreeNodeRef base_root = _base->_model_view->root_node();
+    filter_children(Schema, base_root, this_root, _schema_pattern);
+  }
+  _applied_filter = _filter;
 
   // To keep the active schema on the filtered tree
   set_active_schema(_base->_active_schema);
@@ -1791,7 +1801,9 @@ bool LiveSchemaTree::filter_children(ObjectType type, mforms::TreeNodeRef& sourc
       setup_node(group_added_nodes[0], type, source_node->get_data(), true);
 
       // For each found node, continues with their children...
-      if (type == Schema || type == Table || type == View)
+      // The content of tables and views is only copied for expanded nodes, the rest is copied when they get
+      // expanded (see expand_toggled) so a filter matching many tables doesn't create nodes for all their columns.
+      if (type == Schema || ((type == Table || type == View) && source_node->is_expanded()))
         filter_children_collection(source_node, group_added_nodes[0]);
 
       if (source_node->is_expanded())
@@ -1811,6 +1823,41 @@ bool LiveSchemaTree::filter_children(ObjectType type, mforms::TreeNodeRef& sourc
   return target->count() > 0;
 }
 
+/*
+*  refine_children: removes from target the children not matching the given pattern, used when the filter gets more
+*                   specific as the nodes already in the tree are then a superset of the new result
+*/
+bool LiveSchemaTree::refine_children(ObjectType type, mforms::TreeNodeRef& target, GPatternSpec* pattern) {
+  // Validation to occur only on schema child objects if a pattern is set
+  bool validate = is_object_type(DatabaseObject, type) && pattern;
+
+  // Goes backwards so removing a node doesn't change the position of the ones still to be checked
+  for (int index = target->count() - 1; index >= 0; index--) {
+    mforms::TreeNodeRef node = target->get_child(index);
+
+    if (validate && !g_pattern_match_string(pattern, base::toupper(node->get_string(0)).c_str()))
+      node->remove_from_parent();
+    else if (type == Schema && _object_pattern) {
+      mforms::TreeNodeRef collection = node->get_child(TABLES_NODE_INDEX);
+      bool found_tables = refine_children(Table, collection, _object_pattern);
+
+      collection = node->get_child(VIEWS_NODE_INDEX);
+      bool found_views = refine_children(View, collection, _object_pattern);
+
+      collection = node->get_child(PROCEDURES_NODE_INDEX);
+      bool found_procedures = refine_children(Procedure, collection, _object_pattern);
+
+      collection = node->get_child(FUNCTIONS_NODE_INDEX);
+      bool found_functions = refine_children(Function, collection, _object_pattern);
+
+      if (!(found_tables || found_views || found_procedures || found_functions))
+        node->remove_from_parent();
+    }
+  }
+
+  return target->count() > 0;
+}
+
 //--------------------------------------------------------------------------------------------------
 
 void LiveSchemaTree::clean_filter() {
@@ -1997,6 +2044,13 @@ void LiveSchemaTree::expand_toggled(mforms::TreeNodeRef node, bool value) {
 
     if (value) {
       if (node_data) {
+        // The content of tables and views is copied from the base tree on demand, see filter_children
+        if (_base && (node_data->get_type() == Table || node_data->get_type() == View)) {
+          mforms::TreeNodeRef base_node = _base->get_node_from_path(get_node_path(node));
+          if (base_node)
+            filter_children_collection(base_node, node);
+        }
+
         switch (node_data->get_type()) {
           case Schema:
             load_schema_content(node);
@@ -387,6 +387,7 @@ namespace wb {
     void filter_children_collection(mforms::TreeNodeRef& source, mforms::TreeNodeRef& target);
     bool filter_children(ObjectType type, mforms::TreeNodeRef& source, mforms::TreeNodeRef& target,
                          GPatternSpec* pattern = NULL);
+    bool refine_children(ObjectType type, mforms::TreeNodeRef& target, GPatternSpec* pattern);
     bool is_object_type(ObjectTypeValidation validation, ObjectType type);
 
   public:
@@ -462,6 +463,10 @@ namespace wb {
     mforms::TreeNodeRef get_node_from_path(std::vector<std::string> path);
     void enable_events(bool enable) {
       _enabled_events = enable;
+
+      // While disabled the tree doesn't follow the changes on the base tree, so the next filter can't build on it
+      if (!enable)
+        _applied_filter.clear();
     }
 
   private:
@@ -470,6 +475,7 @@ namespace wb {
 
     LiveSchemaTree* _base;
     std::string _filter;
+    std::string _applied_filter; // The filter the current content of the tree was created with.
     ObjectType _filter_type;
     GPatternSpec* _schema_pattern;
     GPatternSpec* _object_pattern;
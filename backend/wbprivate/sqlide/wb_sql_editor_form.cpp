@@ -54,6 +54,8 @@
 #include "workbench/wb_context_names.h"
 
 #include <mysql_connection.h>
+#include <glib.h>
+#include <algorithm>
 
 #include <boost/signals2/connection.hpp>
 
@@ -300,8 +302,11 @@ SqlEditorForm::~SqlEditorForm() {
     mforms::Utilities::forget_cached_password(_connection->hostIdentifier(),
                                               _connection->parameterValues().get_string("userName"));
 
-  if (_auto_completion_cache)
+  if (_auto_completion_cache) {
     _auto_completion_cache->shutdown();
+    if (!_auto_completion_cache_snapshot.empty())
+      _auto_completion_cache->saveSnapshot(_auto_completion_cache_snapshot);
+  }
 
   delete _column_width_cache;
 
@@ -390,6 +395,11 @@ void SqlEditorForm::finish_startup() {
         },
         [this](bool active) { _live_tree->mark_busy(active); });
 
+      // Serve names from the last session until the refresh has fetched the current ones.
+      _auto_completion_cache_snapshot =
+        base::makePath(cache_dir, sanitize_file_name(get_session_name())) + ".object_names";
+      _auto_completion_cache->loadSnapshot(_auto_completion_cache_snapshot);
+
       _auto_completion_cache->refreshSchemaCache(); // Start fetching schema names immediately.
     } catch (std::exception &e) {
       _auto_completion_cache = NULL;
@@ -1938,6 +1948,13 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
           std::shared_ptr<sql::Statement> dbc_statement(_usr_dbc_conn->ref->createStatement());
           bool is_result_set_first = false;
 
+          // results shown in an editor are read unbuffered, so the first rows can be displayed before the rest
+          // is transferred from the server
+          bool incremental_fetch =
+            editor && !result_list && bec::GRTManager::get()->get_app_option_int("SqlEditor:IncrementalFetch", 1);
+          if (incremental_fetch)
+            dbc_statement->setResultSetType(sql::ResultSet::TYPE_FORWARD_ONLY);
+
           if (_usr_dbc_conn->is_stop_query_requested)
             throw std::runtime_error(
               _("Query execution has been stopped, the connection to the DB server was not restarted, any open "
@@ -2131,6 +2148,7 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
                     data_storage->dbc_resultset(dbc_resultset);
                     data_storage->reloadable(!is_multiple_statement &&
                                              (Sql_syntax_check::sql_select == statement_type));
+                    data_storage->incremental_fetch(incremental_fetch);
 
                     logDebug3("Creation and setup of a new result set...\n");
 
@@ -2169,7 +2187,22 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
                       if (editor)
                         editor->add_panel_for_recordset_from_main(rs);
 
-                      std::string statement_res_msg = std::to_string(rs->row_count()) + _(" row(s) returned");
+                      // the panel already shows the first rows, store the rest while it's being displayed
+                      RowId row_count = rs->row_count();
+                      if (data_storage->has_pending_rows()) {
+                        {
+                          base::ScopeExitTrigger schedule_statement_fetch_timer_stop(
+                            std::bind(&Timer::stop, &statement_fetch_timer));
+                          statement_fetch_timer.run();
+                          row_count = rs->fetch_pending_rows();
+                        }
+                        exec_and_fetch_durations =
+                          (((updated_rows_count >= 0) || (resultset_count)) ? std::string("-")
+                                                                            : statement_exec_timer.duration_formatted()) +
+                          " / " + statement_fetch_timer.duration_formatted();
+                      }
+
+                      std::string statement_res_msg = std::to_string(row_count) + _(" row(s) returned");
                       if (!last_statement_info->empty())
                         statement_res_msg.append("\n").append(last_statement_info);
 
@@ -2229,6 +2262,219 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
   return grt::StringRef("");
 }
 
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Runs a script file without loading it into an editor (e.g. to restore a dump that is larger than the available
+ * memory). Execution happens in the background like for editor contents, see do_exec_sql_script_file.
+ */
+void SqlEditorForm::exec_sql_script_file(const std::string &path) {
+  if (!connected())
+    throw grt::db_not_connected("Not connected");
+
+  exec_sql_task->exec(false, std::bind(&SqlEditorForm::do_exec_sql_script_file, this, weak_ptr_from(this), path));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Follows DELIMITER commands in text the statement splitter placed between two statements. Such text consists only
+ * of white space, comments, delimiters and DELIMITER commands.
+ */
+static void track_delimiter_changes(const char *head, const char *end, std::string &delimiter) {
+  static const char *comment_end = "*/";
+  while (head < end) {
+    if (*head == '#' ||
+        (*head == '-' && end - head > 2 && head[1] == '-' && (head[2] == ' ' || head[2] == '\t' || head[2] == '\n')))
+      head = std::find(head, end, '\n');
+    else if (*head == '/' && end - head > 1 && head[1] == '*') {
+      head = std::search(head + 2, end, comment_end, comment_end + 2);
+      if (head < end)
+        head += 2;
+    } else if ((*head == 'd' || *head == 'D') && end - head > 10 &&
+               base::tolower(std::string(head, 10)) == "delimiter ") {
+      const char *line_end = std::find(head + 10, end, '\n');
+      delimiter = base::trim(std::string(head + 10, line_end));
+      head = line_end;
+    } else
+      head++;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Splits a script in chunks of chunk_size bytes, so that no more than a chunk is looked at at once, and calls
+ * process with the start and length of each statement plus the offset in the script up to which it was processed.
+ * The last statement of a chunk might continue in the next one, so it is split again as part of that. A chunk
+ * holding only a single statement is doubled instead. DELIMITER commands are followed across chunks.
+ * Stops and returns false as soon as process returns false.
+ */
+bool SqlEditorForm::split_script_in_chunks(SqlFacade *sql_facade, const char *data, size_t size, size_t chunk_size,
+                                           const std::function<bool(const char *, size_t, size_t)> &process) {
+  std::string delimiter = ";";
+  std::string last_chunk_copy;
+  std::vector<std::pair<std::size_t, std::size_t>> statement_ranges;
+  size_t current_chunk_size = chunk_size;
+  size_t offset = 0;
+  while (offset < size) {
+    const char *chunk = data + offset;
+    size_t length = size - offset;
+
+    // The splitter looks at the bytes right after its input, which must not be beyond the end of the data. Hence
+    // the end of the data (the last chunk plus what would be too little for another one) is copied.
+    bool last_chunk = length <= current_chunk_size + 1024;
+    if (last_chunk) {
+      last_chunk_copy.assign(chunk, length);
+      chunk = last_chunk_copy.c_str();
+    } else
+      length = current_chunk_size;
+
+    statement_ranges.clear();
+    sql_facade->splitSqlScript(chunk, length, delimiter, statement_ranges);
+
+    size_t next_offset = size;
+    if (!last_chunk) {
+      if (statement_ranges.size() < 2) {
+        current_chunk_size *= 2; // A statement larger than a chunk.
+        continue;
+      }
+      next_offset = offset + statement_ranges.back().first;
+      statement_ranges.pop_back();
+
+      size_t gap_start = 0;
+      for (auto &statement_range : statement_ranges) {
+        track_delimiter_changes(chunk + gap_start, chunk + statement_range.first, delimiter);
+        gap_start = statement_range.first + statement_range.second;
+      }
+      track_delimiter_changes(chunk + gap_start, data + next_offset, delimiter);
+    }
+
+    for (auto &statement_range : statement_ranges) {
+      if (!process(chunk + statement_range.first, statement_range.second,
+                   offset + statement_range.first + statement_range.second))
+        return false;
+    }
+
+    offset = next_offset;
+    current_chunk_size = chunk_size;
+  }
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * The file is mapped into memory and split in chunks of SCRIPT_FILE_CHUNK_SIZE bytes, so memory use doesn't depend
+ * on the size of the script. Only the statement being executed is copied (into the string sent to the server).
+ * Errors and progress are reported through the on_sql_script_run_* signals and the action log.
+ */
+grt::StringRef SqlEditorForm::do_exec_sql_script_file(Ptr self_ptr, const std::string &path) {
+  static const size_t SCRIPT_FILE_CHUNK_SIZE = 16 * 1024 * 1024;
+
+  std::shared_ptr<SqlEditorForm> self_ref = (self_ptr).lock();
+  if (!self_ref)
+    return grt::StringRef("");
+
+  GError *error = NULL;
+  GMappedFile *file = g_mapped_file_new(path.c_str(), FALSE, &error);
+  if (file == NULL) {
+    add_log_message(DbSqlEditorLog::ErrorMsg, strfmt(_("Could not open script file: %s"), error->message), path, "");
+    g_error_free(error);
+    return grt::StringRef("");
+  }
+  base::ScopeExitTrigger unmap_file(std::bind(&g_mapped_file_unref, file));
+  const char *data = g_mapped_file_get_contents(file);
+  size_t size = g_mapped_file_get_length(file);
+
+  bec::GRTManager::get()->replace_status_text(_("Executing Script File..."));
+
+  _exec_sql_error_count = 0;
+  long success_count = 0;
+  long error_count = 0;
+  std::string statement;
+  RowId log_message_index = add_log_message(DbSqlEditorLog::BusyMsg, _("Running script file..."), path, "");
+  Timer script_timer(true);
+
+  sql::Driver *dbc_driver = NULL;
+  try {
+    RecMutexLock use_dbc_conn_mutex(ensure_valid_usr_connection());
+
+    dbc_driver = _usr_dbc_conn->ref->getDriver();
+    dbc_driver->threadInit();
+
+    bool is_running_query = true;
+    AutoSwap<bool> is_running_query_keeper(_is_running_query, is_running_query);
+    update_menu_and_toolbar();
+
+    base::ScopeExitTrigger schedule_log_messages_refresh(std::bind(&SqlEditorForm::refresh_log_messages, this, true));
+
+    SqlFacade::Ref sql_facade = SqlFacade::instance_for_rdbms(rdbms());
+    std::unique_ptr<sql::Statement> dbc_statement(_usr_dbc_conn->ref->createStatement());
+
+    time_t last_progress_report = time(NULL);
+    bool completed = split_script_in_chunks(
+      sql_facade, data, size, SCRIPT_FILE_CHUNK_SIZE, [&](const char *text, size_t length, size_t end_offset) {
+        if (_usr_dbc_conn->is_stop_query_requested)
+          throw std::runtime_error(
+            _("Query execution has been stopped, the connection to the DB server was not restarted, any open "
+              "transaction remains open"));
+
+        try {
+          // All results must be read, otherwise the next statement fails (e.g. for a CALL returning result sets).
+          dbc_statement->execute(sql::SQLString(text, length));
+          do {
+            std::unique_ptr<sql::ResultSet> dbc_resultset(dbc_statement->getResultSet());
+          } while (dbc_statement->getMoreResults());
+          ++success_count;
+        } catch (sql::SQLException &e) {
+          ++error_count;
+          ++_exec_sql_error_count;
+          statement.assign(text, length);
+          add_log_message(DbSqlEditorLog::ErrorMsg, strfmt(SQL_EXCEPTION_MSG_FORMAT, e.getErrorCode(), e.what()),
+                          statement, "");
+          on_sql_script_run_error(e.getErrorCode(), e.what(), statement);
+          if (!_continueOnError)
+            return false;
+        }
+
+        if (time(NULL) != last_progress_report) {
+          last_progress_report = time(NULL);
+          float progress = (float)end_offset / size;
+          on_sql_script_run_progress(progress);
+          set_log_message(log_message_index, DbSqlEditorLog::BusyMsg,
+                          strfmt(_("Running script file... %i%%, %li statement(s) executed"), (int)(progress * 100),
+                                 success_count + error_count),
+                          path, script_timer.duration_formatted());
+        }
+        return true;
+      });
+    if (completed)
+      bec::GRTManager::get()->replace_status_text(_("Script File Executed"));
+    else
+      bec::GRTManager::get()->replace_status_text(_("Script file execution interrupted"));
+
+    // the script may have changed the default schema or the sql mode
+    cache_active_schema_name();
+    cache_sql_mode();
+  }
+  CATCH_ANY_EXCEPTION_AND_DISPATCH(statement)
+
+  if (dbc_driver)
+    dbc_driver->threadEnd();
+
+  on_sql_script_run_statistics(success_count, error_count);
+  set_log_message(log_message_index, error_count ? DbSqlEditorLog::ErrorMsg : DbSqlEditorLog::OKMsg,
+                  strfmt(_("%li statement(s) executed, %li failed"), success_count + error_count, error_count), path,
+                  script_timer.duration_formatted());
+
+  update_menu_and_toolbar();
+
+  _usr_dbc_conn->is_stop_query_requested = false;
+
+  return grt::StringRef("");
+}
+
 void SqlEditorForm::exec_management_sql(const std::string &sql, bool log) {
   sql::Dbc_connection_handler::Ref conn;
   base::RecMutexLock lock(ensure_valid_aux_connection(conn));
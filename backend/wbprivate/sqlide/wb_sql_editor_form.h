@@ -61,6 +61,7 @@ class MySQLObjectNamesCache;
 class ColumnWidthCache;
 class SqlEditorPanel;
 class SqlEditorResult;
+class SqlFacade;
 
 typedef std::vector<Recordset::Ref> Recordsets;
 typedef std::shared_ptr<Recordsets> RecordsetsRef;
@@ -360,6 +361,7 @@ private:
   base::RecMutexLock getUserConnection(sql::Dbc_connection_handler::Ref &conn, bool lockOnly = false);
 
   MySQLObjectNamesCache *_auto_completion_cache;
+  std::string _auto_completion_cache_snapshot; // File the cached names are kept in between sessions.
   void onCacheAction(bool active);
 
   ColumnWidthCache *_column_width_cache;
@@ -380,6 +382,9 @@ public:
                                           bool dont_add_limit_clause = false);
 
   RecordsetsRef exec_sql_returning_results(const std::string &sql_script, bool dont_add_limit_clause);
+  void exec_sql_script_file(const std::string &path);
+  static bool split_script_in_chunks(SqlFacade *sql_facade, const char *data, size_t size, size_t chunk_size,
+                                     const std::function<bool(const char *, size_t, size_t)> &process);
 
   void exec_management_sql(const std::string &sql, bool log);
   db_query_ResultsetRef exec_management_query(const std::string &sql, bool log);
@@ -400,6 +405,7 @@ private:
 
   grt::StringRef do_exec_sql(Ptr self_ptr, std::shared_ptr<std::string> sql, SqlEditorPanel *editor, ExecFlags flags,
                              RecordsetsRef result_list);
+  grt::StringRef do_exec_sql_script_file(Ptr self_ptr, const std::string &path);
 
   void handle_command_side_effects(const std::string &sql);
 
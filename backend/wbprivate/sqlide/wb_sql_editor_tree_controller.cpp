@@ -130,6 +130,7 @@ SqlEditorTreeController::SqlEditorTreeController(SqlEditorForm *owner)
     _is_refreshing_schema_tree(false),
     _unified_mode(false),
     _use_show_procedure(false),
+    _use_bulk_table_details(true),
     _side_splitter(nullptr),
     _info_tabview(nullptr),
     _object_info(nullptr),
@@ -142,6 +143,7 @@ SqlEditorTreeController::SqlEditorTreeController(SqlEditorForm *owner)
     bec::GRTManager::get()->get_app_option_int("DbSqlEditor:ShowSchemaTreeSchemaContents", 1) != 0);
   _filtered_schema_tree.is_schema_contents_enabled(
     bec::GRTManager::get()->get_app_option_int("DbSqlEditor:ShowSchemaTreeSchemaContents", 1) != 0);
+  _use_bulk_table_details = bec::GRTManager::get()->get_app_option_int("DbSqlEditor:BulkFetchTableDetails", 1) != 0;
 
   _base_schema_tree.sql_editor_text_insert_signal.connect(
     std::bind(&SqlEditorTreeController::insert_text_to_active_editor, this, std::placeholders::_1));
@@ -466,6 +468,16 @@ void SqlEditorTreeController::refresh_live_object_in_overview(wb::LiveSchemaTree
                                                               const std::string schema_name,
                                                               const std::string old_obj_name,
                                                               const std::string new_obj_name) {
+  // Cached table details might be outdated now.
+  if (type == wb::LiveSchemaTree::Schema)
+    forget_table_details(old_obj_name);
+  else if (type == wb::LiveSchemaTree::Table) {
+    forget_table_details(schema_name, old_obj_name);
+    forget_table_details(schema_name, new_obj_name);
+  } else if (type == wb::LiveSchemaTree::Trigger || type == wb::LiveSchemaTree::Index ||
+             type == wb::LiveSchemaTree::ForeignKey)
+    forget_table_details(schema_name);
+
   try {
     // update schema tree even if no object was added/dropped, to clear details attribute which contents might to be
     // changed
@@ -560,6 +572,17 @@ grt::StringRef SqlEditorTreeController::do_fetch_live_schema_contents(
       }
     }
 
+    // The object lists are shown right away, the details of all tables are fetched afterwards by a separate
+    // task that doesn't keep the aux connection locked. Tables expanded meanwhile are loaded once it finished.
+    if (_use_bulk_table_details && !tables->empty()) {
+      {
+        MutexLock lock(_table_details_mutex);
+        _pending_table_details[schema_name].fetch_count++;
+      }
+      live_schema_fetch_task->exec(
+        false, std::bind(&SqlEditorTreeController::do_fetch_table_details, this, weak_ptr_from(this), schema_name));
+    }
+
     if (arrived_slot) {
       std::function<void()> schema_contents_arrived =
         std::bind(arrived_slot, schema_name, tables, views, procedures, functions, false);
@@ -587,6 +610,283 @@ grt::StringRef SqlEditorTreeController::do_fetch_live_schema_contents(
 
 //--------------------------------------------------------------------------------------------------
 
+struct SqlEditorTreeController::TableDetails {
+  StringListPtr columns;
+  std::map<std::string, LiveSchemaTree::ColumnData> column_data;
+  StringListPtr indexes;
+  std::map<std::string, LiveSchemaTree::IndexData> index_data;
+  StringListPtr triggers;
+  std::map<std::string, LiveSchemaTree::TriggerData> trigger_data;
+  StringListPtr foreign_keys;
+  std::map<std::string, LiveSchemaTree::FKData> fk_data;
+
+  TableDetails()
+    : columns(new std::list<std::string>()),
+      indexes(new std::list<std::string>()),
+      triggers(new std::list<std::string>()),
+      foreign_keys(new std::list<std::string>()) {
+  }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+grt::StringRef SqlEditorTreeController::do_fetch_table_details(std::weak_ptr<SqlEditorTreeController> self_ptr,
+                                                               const std::string &schema_name) {
+  RETVAL_IF_FAIL_TO_RETAIN_WEAK_PTR(SqlEditorTreeController, self_ptr, self, grt::StringRef(""))
+
+  fetch_table_details_for_schema(schema_name);
+  bec::GRTManager::get()->run_once_when_idle(
+    this, std::bind(&SqlEditorTreeController::table_details_fetched, this, schema_name));
+
+  return grt::StringRef("");
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Fetches columns, indexes, triggers and foreign keys of all tables in the given schema, with one
+ * information_schema query per kind of object (instead of up to 4 queries per table when they are expanded).
+ * The aux connection is only locked for each query, so other users of it don't wait for the whole fetch.
+ * The result is kept until the schema contents are fetched again or the table is changed, unless the cached
+ * details of the schema were dropped while fetching.
+ */
+void SqlEditorTreeController::fetch_table_details_for_schema(const std::string &schema_name) {
+  SchemaTableDetails details;
+  auto table_details = [&details](const std::string &table_name) -> TableDetails & {
+    std::shared_ptr<TableDetails> &entry = details[table_name];
+    if (!entry)
+      entry = std::make_shared<TableDetails>();
+    return *entry;
+  };
+
+  int generation;
+  {
+    MutexLock lock(_table_details_mutex);
+    generation = _table_details_generation[schema_name];
+  }
+
+  gint64 start = g_get_monotonic_time();
+  try {
+    sql::Dbc_connection_handler::Ref conn;
+
+    {
+      RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
+      std::auto_ptr<sql::Statement> stmt(conn->ref->createStatement());
+      std::auto_ptr<sql::ResultSet> rs(stmt->executeQuery(std::string(
+        sqlstring("SELECT TABLE_NAME, COLUMN_NAME, COLUMN_TYPE, COLLATION_NAME, IS_NULLABLE, COLUMN_KEY, "
+                  "COLUMN_DEFAULT, EXTRA FROM information_schema.COLUMNS WHERE TABLE_SCHEMA = ? "
+                  "ORDER BY TABLE_NAME, ORDINAL_POSITION",
+                  0)
+        << schema_name)));
+      while (rs->next()) {
+        TableDetails &table = table_details(rs->getString(1));
+        LiveSchemaTree::ColumnData col_node(LiveSchemaTree::Table);
+        std::string column_name = rs->getString(2);
+
+        std::string type = rs->getString(3);
+        std::string nullable = rs->getString(5);
+        std::string key = rs->getString(6);
+
+        base::replaceStringInplace(type, "unsigned", "UN");
+        if (rs->getString(8) == "auto_increment")
+          type += " AI";
+
+        col_node.name = column_name;
+        col_node.type = type;
+        col_node.charset_collation = rs->isNull(4) ? "" : rs->getString(4);
+        col_node.is_pk = key == "PRI";
+        col_node.is_id = (col_node.is_pk || (nullable == "NO" && key == "UNI"));
+        col_node.is_idx = key != "";
+        col_node.default_value = rs->getString(7);
+
+        table.columns->push_back(column_name);
+        table.column_data[column_name] = col_node;
+      }
+    }
+
+    {
+      // PRIMARY goes first, as in SHOW INDEXES.
+      RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
+      std::auto_ptr<sql::Statement> stmt(conn->ref->createStatement());
+      std::auto_ptr<sql::ResultSet> rs(stmt->executeQuery(
+        std::string(sqlstring("SELECT TABLE_NAME, NON_UNIQUE, INDEX_NAME, COLUMN_NAME, INDEX_TYPE "
+                              "FROM information_schema.STATISTICS WHERE TABLE_SCHEMA = ? "
+                              "ORDER BY TABLE_NAME, INDEX_NAME <> 'PRIMARY', INDEX_NAME, SEQ_IN_INDEX",
+                              0)
+                    << schema_name)));
+      while (rs->next()) {
+        TableDetails &table = table_details(rs->getString(1));
+        std::string name = rs->getString(3);
+
+        if (!table.index_data.count(name)) {
+          LiveSchemaTree::IndexData index_data;
+          index_data.type = wb::LiveSchemaTree::internalize_token(rs->getString(5));
+          index_data.unique = (rs->getInt(2) == 0);
+
+          table.indexes->push_back(name);
+          table.index_data[name] = index_data;
+        }
+        table.index_data[name].columns.push_back(rs->getString(4));
+      }
+    }
+
+    {
+      RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
+      std::auto_ptr<sql::Statement> stmt(conn->ref->createStatement());
+      std::auto_ptr<sql::ResultSet> rs(stmt->executeQuery(
+        std::string(sqlstring("SELECT EVENT_OBJECT_TABLE, TRIGGER_NAME, EVENT_MANIPULATION, ACTION_TIMING "
+                              "FROM information_schema.TRIGGERS WHERE TRIGGER_SCHEMA = ?",
+                              0)
+                    << schema_name)));
+      while (rs->next()) {
+        TableDetails &table = table_details(rs->getString(1));
+        std::string name = rs->getString(2);
+
+        LiveSchemaTree::TriggerData trigger_node;
+        trigger_node.event_manipulation = wb::LiveSchemaTree::internalize_token(rs->getString(3));
+        trigger_node.timing = wb::LiveSchemaTree::internalize_token(rs->getString(4));
+
+        table.triggers->push_back(name);
+        table.trigger_data[name] = trigger_node;
+      }
+    }
+
+    {
+      RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
+      std::auto_ptr<sql::Statement> stmt(conn->ref->createStatement());
+      std::auto_ptr<sql::ResultSet> rs(stmt->executeQuery(std::string(
+        sqlstring("SELECT kcu.TABLE_NAME, kcu.CONSTRAINT_NAME, kcu.COLUMN_NAME, kcu.REFERENCED_TABLE_SCHEMA, "
+                  "kcu.REFERENCED_TABLE_NAME, kcu.REFERENCED_COLUMN_NAME, rc.UPDATE_RULE, rc.DELETE_RULE "
+                  "FROM information_schema.KEY_COLUMN_USAGE kcu JOIN information_schema.REFERENTIAL_CONSTRAINTS rc "
+                  "ON rc.CONSTRAINT_SCHEMA = kcu.CONSTRAINT_SCHEMA AND rc.TABLE_NAME = kcu.TABLE_NAME "
+                  "AND rc.CONSTRAINT_NAME = kcu.CONSTRAINT_NAME "
+                  "WHERE kcu.TABLE_SCHEMA = ? AND rc.CONSTRAINT_SCHEMA = ? "
+                  "ORDER BY kcu.TABLE_NAME, kcu.CONSTRAINT_NAME, kcu.ORDINAL_POSITION",
+                  0)
+        << schema_name << schema_name)));
+      while (rs->next()) {
+        TableDetails &table = table_details(rs->getString(1));
+        std::string name = rs->getString(2);
+
+        if (!table.fk_data.count(name)) {
+          LiveSchemaTree::FKData new_fk;
+          std::string referenced_schema = rs->getString(4);
+          new_fk.referenced_table = rs->getString(5);
+          if (referenced_schema != schema_name)
+            new_fk.referenced_table = referenced_schema + "." + new_fk.referenced_table;
+          new_fk.update_rule = wb::LiveSchemaTree::internalize_token(rs->getString(7));
+          new_fk.delete_rule = wb::LiveSchemaTree::internalize_token(rs->getString(8));
+
+          table.foreign_keys->push_back(name);
+          table.fk_data[name] = new_fk;
+        }
+
+        LiveSchemaTree::FKData &fk = table.fk_data[name];
+        if (!fk.from_cols.empty()) {
+          fk.from_cols.append(", ");
+          fk.to_cols.append(", ");
+        }
+        fk.from_cols.append(rs->getString(3));
+        fk.to_cols.append(rs->getString(6));
+      }
+    }
+  } catch (const std::exception &exc) {
+    logWarning("Error fetching table details for schema '%s', tables will be queried separately: %s\n",
+               schema_name.c_str(), exc.what());
+    forget_table_details(schema_name);
+    return;
+  }
+
+  logDebug("Fetched details of %i tables in schema '%s' in %.3fs\n", (int)details.size(), schema_name.c_str(),
+           (g_get_monotonic_time() - start) / 1000000.0);
+
+  MutexLock lock(_table_details_mutex);
+  if (_table_details_generation[schema_name] != generation) {
+    logDebug("Details of schema '%s' changed while fetching them, discarding them\n", schema_name.c_str());
+    return;
+  }
+  _table_details[schema_name].swap(details);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Called in the main thread once a fetch of the details of all tables in the schema finished, successfully
+ * or not. Table details requested in the meantime are loaded now, from the cache if it was filled.
+ */
+void SqlEditorTreeController::table_details_fetched(const std::string &schema_name) {
+  std::list<DeferredTableDetails> requests;
+  {
+    MutexLock lock(_table_details_mutex);
+    auto pending = _pending_table_details.find(schema_name);
+    if (pending == _pending_table_details.end())
+      return;
+
+    requests.swap(pending->second.requests);
+    if (--pending->second.fetch_count <= 0)
+      _pending_table_details.erase(pending);
+  }
+
+  for (auto &request : requests)
+    fetch_object_details(schema_name, request.table_name, LiveSchemaTree::Table, request.flags, request.updater_slot);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Keeps the request for the details of a table if the details of its schema are being fetched right now.
+ * Returns false if the request has to be served right away.
+ */
+bool SqlEditorTreeController::defer_table_details(const std::string &schema_name, const std::string &table_name,
+                                                  short flags,
+                                                  const wb::LiveSchemaTree::NodeChildrenUpdaterSlot &updater_slot) {
+  MutexLock lock(_table_details_mutex);
+  auto pending = _pending_table_details.find(schema_name);
+  if (pending == _pending_table_details.end())
+    return false;
+
+  DeferredTableDetails request;
+  request.table_name = table_name;
+  request.flags = flags;
+  request.updater_slot = updater_slot;
+  pending->second.requests.push_back(request);
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::shared_ptr<SqlEditorTreeController::TableDetails> SqlEditorTreeController::cached_table_details(
+  const std::string &schema_name, const std::string &table_name) {
+  MutexLock lock(_table_details_mutex);
+  auto schema = _table_details.find(schema_name);
+  if (schema != _table_details.end()) {
+    auto table = schema->second.find(table_name);
+    if (table != schema->second.end())
+      return table->second;
+  }
+  return std::shared_ptr<TableDetails>();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Drops the cached details of the given table, or of all tables in the schema if no table name is given.
+ * Details which are not cached are fetched for each table separately again.
+ */
+void SqlEditorTreeController::forget_table_details(const std::string &schema_name, const std::string &table_name) {
+  MutexLock lock(_table_details_mutex);
+  _table_details_generation[schema_name]++;
+  if (table_name.empty())
+    _table_details.erase(schema_name);
+  else {
+    auto schema = _table_details.find(schema_name);
+    if (schema != _table_details.end())
+      schema->second.erase(table_name);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
 grt::StringRef SqlEditorTreeController::do_fetch_data_for_filter(
   std::weak_ptr<SqlEditorTreeController> self_ptr, const std::string &schema_filter, const std::string &object_filter,
   wb::LiveSchemaTree::NewSchemaContentArrivedSlot arrived_slot) {
@@ -686,41 +986,51 @@ void SqlEditorTreeController::fetch_column_data(const std::string &schema_name,
   logDebug3("Fetching column data for %s.%s\n", schema_name.c_str(), obj_name.c_str());
 
   try {
-    sql::Dbc_connection_handler::Ref conn;
+    // Views are always queried separately, to find out if they are broken.
+    std::shared_ptr<TableDetails> details;
+    if (type == LiveSchemaTree::Table)
+      details = cached_table_details(schema_name, obj_name);
+
+    if (details) {
+      columns = std::make_shared<StringList>(*details->columns);
+      column_data = details->column_data;
+    } else {
+      sql::Dbc_connection_handler::Ref conn;
 
-    RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
+      RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
 
-    std::auto_ptr<sql::Statement> stmt(conn->ref->createStatement());
-    std::auto_ptr<sql::ResultSet> rs(
-      stmt->executeQuery(std::string(base::sqlstring("SHOW FULL COLUMNS FROM !.!", 0) << schema_name << obj_name)));
+      std::auto_ptr<sql::Statement> stmt(conn->ref->createStatement());
+      std::auto_ptr<sql::ResultSet> rs(
+        stmt->executeQuery(std::string(base::sqlstring("SHOW FULL COLUMNS FROM !.!", 0) << schema_name << obj_name)));
 
-    while (rs->next()) {
-      LiveSchemaTree::ColumnData col_node(type);
-      std::string column_name = rs->getString(1);
+      while (rs->next()) {
+        LiveSchemaTree::ColumnData col_node(type);
+        std::string column_name = rs->getString(1);
 
-      columns->push_back(column_name);
+        columns->push_back(column_name);
 
-      std::string type = rs->getString(2);
-      std::string collation = rs->isNull(3) ? "" : rs->getString(3);
-      std::string nullable = rs->getString(4);
-      std::string key = rs->getString(5);
-      std::string default_value = rs->getString(6);
-      std::string extra = rs->getString(7);
+        std::string type = rs->getString(2);
+        std::string collation = rs->isNull(3) ? "" : rs->getString(3);
+        std::string nullable = rs->getString(4);
+        std::string key = rs->getString(5);
+        std::string default_value = rs->getString(6);
+        std::string extra = rs->getString(7);
 
-      base::replaceStringInplace(type, "unsigned", "UN");
+        base::replaceStringInplace(type, "unsigned", "UN");
 
-      if (extra == "auto_increment")
-        type += " AI";
+        if (extra == "auto_increment")
+          type += " AI";
 
-      col_node.name = column_name;
-      col_node.type = type;
-      col_node.charset_collation = collation;
-      col_node.is_pk = key == "PRI";
-      col_node.is_id = (col_node.is_pk || (nullable == "NO" && key == "UNI"));
-      col_node.is_idx = key != "";
-      col_node.default_value = default_value;
+        col_node.name = column_name;
+        col_node.type = type;
+        col_node.charset_collation = collation;
+        col_node.is_pk = key == "PRI";
+        col_node.is_id = (col_node.is_pk || (nullable == "NO" && key == "UNI"));
+        col_node.is_idx = key != "";
+        col_node.default_value = default_value;
 
-      column_data[column_name] = col_node;
+        column_data[column_name] = col_node;
+      }
     }
 
     // If information was found, creates the TreeNode structure for it
@@ -787,23 +1097,29 @@ void SqlEditorTreeController::fetch_trigger_data(const std::string &schema_name,
   std::map<std::string, LiveSchemaTree::TriggerData> trigger_data_dict;
 
   try {
-    sql::Dbc_connection_handler::Ref conn;
+    std::shared_ptr<TableDetails> details = cached_table_details(schema_name, obj_name);
+    if (details) {
+      triggers = std::make_shared<StringList>(*details->triggers);
+      trigger_data_dict = details->trigger_data;
+    } else {
+      sql::Dbc_connection_handler::Ref conn;
 
-    RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
+      RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
 
-    std::auto_ptr<sql::Statement> stmt(conn->ref->createStatement());
-    std::auto_ptr<sql::ResultSet> rs(
-      stmt->executeQuery(std::string(base::sqlstring("SHOW TRIGGERS FROM ! LIKE ?", 0) << schema_name << obj_name)));
+      std::auto_ptr<sql::Statement> stmt(conn->ref->createStatement());
+      std::auto_ptr<sql::ResultSet> rs(
+        stmt->executeQuery(std::string(base::sqlstring("SHOW TRIGGERS FROM ! LIKE ?", 0) << schema_name << obj_name)));
 
-    while (rs->next()) {
-      wb::LiveSchemaTree::TriggerData trigger_node;
+      while (rs->next()) {
+        wb::LiveSchemaTree::TriggerData trigger_node;
 
-      std::string name = rs->getString(1);
-      trigger_node.event_manipulation = wb::LiveSchemaTree::internalize_token(rs->getString(2));
-      trigger_node.timing = wb::LiveSchemaTree::internalize_token(rs->getString(5));
+        std::string name = rs->getString(1);
+        trigger_node.event_manipulation = wb::LiveSchemaTree::internalize_token(rs->getString(2));
+        trigger_node.timing = wb::LiveSchemaTree::internalize_token(rs->getString(5));
 
-      triggers->push_back(name);
-      trigger_data_dict[name] = trigger_node;
+        triggers->push_back(name);
+        trigger_data_dict[name] = trigger_node;
+      }
     }
 
     // If information was found, creates the TreeNode structure for it
@@ -843,31 +1159,37 @@ void SqlEditorTreeController::fetch_index_data(const std::string &schema_name, c
   std::map<std::string, LiveSchemaTree::IndexData> index_data_dict;
 
   try {
-    sql::Dbc_connection_handler::Ref conn;
+    std::shared_ptr<TableDetails> details = cached_table_details(schema_name, obj_name);
+    if (details) {
+      indexes = std::make_shared<StringList>(*details->indexes);
+      index_data_dict = details->index_data;
+    } else {
+      sql::Dbc_connection_handler::Ref conn;
 
-    RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
+      RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
 
-    std::auto_ptr<sql::Statement> stmt(conn->ref->createStatement());
-    std::auto_ptr<sql::ResultSet> rs(
-      stmt->executeQuery(std::string(base::sqlstring("SHOW INDEXES FROM !.!", 0) << schema_name << obj_name)));
+      std::auto_ptr<sql::Statement> stmt(conn->ref->createStatement());
+      std::auto_ptr<sql::ResultSet> rs(
+        stmt->executeQuery(std::string(base::sqlstring("SHOW INDEXES FROM !.!", 0) << schema_name << obj_name)));
 
-    while (rs->next()) {
-      LiveSchemaTree::IndexData index_data;
+      while (rs->next()) {
+        LiveSchemaTree::IndexData index_data;
 
-      std::string name = rs->getString(3);
+        std::string name = rs->getString(3);
 
-      // Inserts the index to the list
-      if (!index_data_dict.count(name)) {
-        indexes->push_back(name);
+        // Inserts the index to the list
+        if (!index_data_dict.count(name)) {
+          indexes->push_back(name);
 
-        index_data.type = wb::LiveSchemaTree::internalize_token(rs->getString(11));
-        index_data.unique = (rs->getInt(2) == 0);
+          index_data.type = wb::LiveSchemaTree::internalize_token(rs->getString(11));
+          index_data.unique = (rs->getInt(2) == 0);
 
-        index_data_dict[name] = index_data;
-      }
+          index_data_dict[name] = index_data;
+        }
 
-      // Adds the column
-      index_data_dict[name].columns.push_back(rs->getString(5));
+        // Adds the column
+        index_data_dict[name].columns.push_back(rs->getString(5));
+      }
     }
 
     // Searches for the target node...
@@ -902,125 +1224,131 @@ void SqlEditorTreeController::fetch_foreign_key_data(const std::string &schema_n
   StringListPtr foreign_keys(new std::list<std::string>());
   std::map<std::string, LiveSchemaTree::FKData> fk_data_dict;
 
-  sql::Dbc_connection_handler::Ref conn;
-
-  RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
-
   try {
-    std::auto_ptr<sql::Statement> stmt(conn->ref->createStatement());
-    std::auto_ptr<sql::ResultSet> rs(
-      stmt->executeQuery(std::string(base::sqlstring("SHOW CREATE TABLE !.!", 0) << schema_name << obj_name)));
-
-    while (rs->next()) {
-      std::string statement = rs->getString(2);
-
-      size_t def_start = statement.find("(");
-      size_t def_end = statement.rfind(")");
-
-      std::vector<std::string> def_lines = base::split(statement.substr(def_start, def_end - def_start), "\n");
-
-      const char *errptr;
-      int erroffs = 0;
-      const char *pattern =
-        "CONSTRAINT\\s*(\\S*)\\s*FOREIGN "
-        "KEY\\s*\\((\\S*)\\)\\s*REFERENCES\\s*(\\S*)\\s*\\((\\S*)\\)\\s*((\\w*\\s*)*),?$";
-      int patres[64];
-
-      pcre *patre = pcre_compile(pattern, 0, &errptr, &erroffs, NULL);
-      if (!patre)
-        throw std::logic_error("error compiling regex " + std::string(errptr));
-
-      std::string fk_name;
-      std::string fk_columns;
-      std::string fk_ref_table;
-      std::string fk_ref_columns;
-      std::string fk_rules;
-      const char *value;
-
-      for (size_t index = 0; index < def_lines.size(); index++) {
-        int rc = pcre_exec(patre, NULL, def_lines[index].c_str(), (int)def_lines[index].length(), 0, 0, patres,
-                           sizeof(patres) / sizeof(int));
-
-        if (rc > 0) {
-          // gets the values timestamp and
-          pcre_get_substring(def_lines[index].c_str(), patres, rc, 1, &value);
-          fk_name = value;
-          pcre_free_substring(value);
-          fk_name = base::unquote_identifier(fk_name);
-
-          pcre_get_substring(def_lines[index].c_str(), patres, rc, 2, &value);
-          fk_columns = value;
-          pcre_free_substring(value);
-
-          pcre_get_substring(def_lines[index].c_str(), patres, rc, 3, &value);
-          fk_ref_table = value;
-          pcre_free_substring(value);
-          fk_ref_table = base::unquote_identifier(fk_ref_table);
-
-          pcre_get_substring(def_lines[index].c_str(), patres, rc, 4, &value);
-          fk_ref_columns = value;
-          pcre_free_substring(value);
-
-          pcre_get_substring(def_lines[index].c_str(), patres, rc, 5, &value);
-          fk_rules = value;
-          pcre_free_substring(value);
-
-          // Parses the list fields
-          std::vector<std::string> fk_column_list = base::split(fk_columns, ",");
-          std::vector<std::string> fk_ref_column_list = base::split(fk_ref_columns, ",");
-          std::vector<std::string> fk_rule_tokens = base::split(fk_rules, " ");
-
-          // Create the foreign key node
-          wb::LiveSchemaTree::FKData new_fk;
-          foreign_keys->push_back(fk_name);
-          new_fk.referenced_table = (fk_ref_table);
-
-          // Set the default update and delete rules
-          new_fk.update_rule = new_fk.delete_rule = wb::LiveSchemaTree::internalize_token("RESTRICT");
-
-          // A rule has at least 3 tokens so the number of tokens could be
-          // 3 or 4 for 1 rule and 6,7,8 for two rules, so we get the number with this
-          size_t rule_count = fk_rule_tokens.size() / 3;
-
-          int token_offset = 0;
-          for (size_t index = 0; index < rule_count; index++) {
-            // Skips the ON token
-            token_offset++;
-
-            // Gets the UPDATE/DELETE token
-            std::string rule = fk_rule_tokens[token_offset++];
-
-            // Gets the action
-            std::string action = fk_rule_tokens[token_offset++];
-
-            if (action == "SET" || action == "NO")
-              action += " " + fk_rule_tokens[token_offset++];
-
-            const unsigned char value = wb::LiveSchemaTree::internalize_token(action);
-
-            if (rule == "UPDATE")
-              new_fk.update_rule = value;
-            else
-              new_fk.delete_rule = value;
-          }
+    std::shared_ptr<TableDetails> details = cached_table_details(schema_name, obj_name);
+    if (details) {
+      foreign_keys = std::make_shared<StringList>(*details->foreign_keys);
+      fk_data_dict = details->fk_data;
+    } else {
+      sql::Dbc_connection_handler::Ref conn;
 
-          std::string from(""), to("");
-          for (size_t column_index = 0; column_index < fk_column_list.size(); column_index++) {
-            std::string from_col = base::unquote_identifier(fk_column_list[column_index]);
-            std::string to_col = base::unquote_identifier(fk_ref_column_list[column_index]);
+      RecMutexLock aux_dbc_conn_mutex(_owner->ensure_valid_aux_connection(conn));
 
-            if (from.empty())
-              from = from_col;
-            else
-              from.append(", ").append(from_col);
-            if (to.empty())
-              to = to_col;
-            else
-              to.append(", ").append(to_col);
+      std::auto_ptr<sql::Statement> stmt(conn->ref->createStatement());
+      std::auto_ptr<sql::ResultSet> rs(
+        stmt->executeQuery(std::string(base::sqlstring("SHOW CREATE TABLE !.!", 0) << schema_name << obj_name)));
+
+      while (rs->next()) {
+        std::string statement = rs->getString(2);
+
+        size_t def_start = statement.find("(");
+        size_t def_end = statement.rfind(")");
+
+        std::vector<std::string> def_lines = base::split(statement.substr(def_start, def_end - def_start), "\n");
+
+        const char *errptr;
+        int erroffs = 0;
+        const char *pattern =
+          "CONSTRAINT\\s*(\\S*)\\s*FOREIGN "
+          "KEY\\s*\\((\\S*)\\)\\s*REFERENCES\\s*(\\S*)\\s*\\((\\S*)\\)\\s*((\\w*\\s*)*),?$";
+        int patres[64];
+
+        pcre *patre = pcre_compile(pattern, 0, &errptr, &erroffs, NULL);
+        if (!patre)
+          throw std::logic_error("error compiling regex " + std::string(errptr));
+
+        std::string fk_name;
+        std::string fk_columns;
+        std::string fk_ref_table;
+        std::string fk_ref_columns;
+        std::string fk_rules;
+        const char *value;
+
+        for (size_t index = 0; index < def_lines.size(); index++) {
+          int rc = pcre_exec(patre, NULL, def_lines[index].c_str(), (int)def_lines[index].length(), 0, 0, patres,
+                             sizeof(patres) / sizeof(int));
+
+          if (rc > 0) {
+            // gets the values timestamp and
+            pcre_get_substring(def_lines[index].c_str(), patres, rc, 1, &value);
+            fk_name = value;
+            pcre_free_substring(value);
+            fk_name = base::unquote_identifier(fk_name);
+
+            pcre_get_substring(def_lines[index].c_str(), patres, rc, 2, &value);
+            fk_columns = value;
+            pcre_free_substring(value);
+
+            pcre_get_substring(def_lines[index].c_str(), patres, rc, 3, &value);
+            fk_ref_table = value;
+            pcre_free_substring(value);
+            fk_ref_table = base::unquote_identifier(fk_ref_table);
+
+            pcre_get_substring(def_lines[index].c_str(), patres, rc, 4, &value);
+            fk_ref_columns = value;
+            pcre_free_substring(value);
+
+            pcre_get_substring(def_lines[index].c_str(), patres, rc, 5, &value);
+            fk_rules = value;
+            pcre_free_substring(value);
+
+            // Parses the list fields
+            std::vector<std::string> fk_column_list = base::split(fk_columns, ",");
+            std::vector<std::string> fk_ref_column_list = base::split(fk_ref_columns, ",");
+            std::vector<std::string> fk_rule_tokens = base::split(fk_rules, " ");
+
+            // Create the foreign key node
+            wb::LiveSchemaTree::FKData new_fk;
+            foreign_keys->push_back(fk_name);
+            new_fk.referenced_table = (fk_ref_table);
+
+            // Set the default update and delete rules
+            new_fk.update_rule = new_fk.delete_rule = wb::LiveSchemaTree::internalize_token("RESTRICT");
+
+            // A rule has at least 3 tokens so the number of tokens could be
+            // 3 or 4 for 1 rule and 6,7,8 for two rules, so we get the number with this
+            size_t rule_count = fk_rule_tokens.size() / 3;
+
+            int token_offset = 0;
+            for (size_t index = 0; index < rule_count; index++) {
+              // Skips the ON token
+              token_offset++;
+
+              // Gets the UPDATE/DELETE token
+              std::string rule = fk_rule_tokens[token_offset++];
+
+              // Gets the action
+              std::string action = fk_rule_tokens[token_offset++];
+
+              if (action == "SET" || action == "NO")
+                action += " " + fk_rule_tokens[token_offset++];
+
+              const unsigned char value = wb::LiveSchemaTree::internalize_token(action);
+
+              if (rule == "UPDATE")
+                new_fk.update_rule = value;
+              else
+                new_fk.delete_rule = value;
+            }
+
+            std::string from(""), to("");
+            for (size_t column_index = 0; column_index < fk_column_list.size(); column_index++) {
+              std::string from_col = base::unquote_identifier(fk_column_list[column_index]);
+              std::string to_col = base::unquote_identifier(fk_ref_column_list[column_index]);
+
+              if (from.empty())
+                from = from_col;
+              else
+                from.append(", ").append(from_col);
+              if (to.empty())
+                to = to_col;
+              else
+                to.append(", ").append(to_col);
+            }
+            new_fk.from_cols = from;
+            new_fk.to_cols = to;
+            fk_data_dict[fk_name] = new_fk;
           }
-          new_fk.from_cols = from;
-          new_fk.to_cols = to;
-          fk_data_dict[fk_name] = new_fk;
         }
       }
     }
@@ -1062,6 +1390,10 @@ bool SqlEditorTreeController::fetch_object_details(const std::string &schema_nam
   if (type == wb::LiveSchemaTree::Any)
     type = fetch_object_type(schema_name, object_name);
 
+  // Tables are filled from the cached schema details once they are fetched.
+  if (type == wb::LiveSchemaTree::Table && defer_table_details(schema_name, object_name, flags, updater_slot))
+    return false;
+
   if (type != wb::LiveSchemaTree::Any) {
     if (flags & wb::LiveSchemaTree::COLUMN_DATA)
       fetch_column_data(schema_name, object_name, type, updater_slot);
@@ -1185,6 +1517,13 @@ wb::LiveSchemaTree::ObjectType SqlEditorTreeController::fetch_object_type(const
 //--------------------------------------------------------------------------------------------------
 
 void SqlEditorTreeController::tree_refresh() {
+  {
+    MutexLock lock(_table_details_mutex);
+    _table_details.clear();
+    for (auto &generation : _table_details_generation)
+      generation.second++;
+  }
+
   if (_owner->connected()) {
     live_schemata_refresh_task->exec(false, std::bind((grt::StringRef(SqlEditorTreeController::*)(SqlEditorForm::Ptr)) &
                                                         SqlEditorTreeController::do_refresh_schema_tree_safe,
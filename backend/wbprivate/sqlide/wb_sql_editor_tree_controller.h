@@ -48,6 +48,10 @@ namespace wb {
   class SimpleSidebar;
 }
 
+namespace sql {
+  class Statement;
+}
+
 class MYSQLWBBACKEND_PUBLIC_FUNC SqlEditorTreeController
   : public base::trackable,
     public grt::GRTObserver,
@@ -86,6 +90,33 @@ private:
   bool _unified_mode;
 
   bool _use_show_procedure;
+  bool _use_bulk_table_details;
+
+  // Columns, indexes, triggers and foreign keys of all tables in a schema. They are fetched with a few
+  // information_schema queries together with the schema contents, so that expanding a table in the tree
+  // doesn't need extra round trips to the server.
+  struct TableDetails;
+  typedef std::map<std::string, std::shared_ptr<TableDetails> > SchemaTableDetails;
+  base::Mutex _table_details_mutex;
+  std::map<std::string, SchemaTableDetails> _table_details; // Keyed by schema name.
+  // Increased whenever cached details of a schema are dropped, so fetches started before are discarded.
+  std::map<std::string, int> _table_details_generation;
+
+  // Table details requested while the details of their schema are being fetched. They are answered from
+  // the cache once the fetch is done, instead of waiting for the aux connection.
+  struct DeferredTableDetails {
+    std::string table_name;
+    short flags;
+    wb::LiveSchemaTree::NodeChildrenUpdaterSlot updater_slot;
+  };
+  struct PendingTableDetails {
+    int fetch_count;
+    std::list<DeferredTableDetails> requests;
+
+    PendingTableDetails() : fetch_count(0) {
+    }
+  };
+  std::map<std::string, PendingTableDetails> _pending_table_details; // Keyed by schema name.
 
   mforms::Splitter *_side_splitter;
   mforms::TabView *_info_tabview;
@@ -124,6 +155,14 @@ private:
   grt::StringRef do_fetch_live_schema_contents(std::weak_ptr<SqlEditorTreeController> self_ptr,
                                                const std::string &schema_name,
                                                wb::LiveSchemaTree::NewSchemaContentArrivedSlot arrived_slot);
+  grt::StringRef do_fetch_table_details(std::weak_ptr<SqlEditorTreeController> self_ptr,
+                                        const std::string &schema_name);
+  void fetch_table_details_for_schema(const std::string &schema_name);
+  void table_details_fetched(const std::string &schema_name);
+  bool defer_table_details(const std::string &schema_name, const std::string &table_name, short flags,
+                           const wb::LiveSchemaTree::NodeChildrenUpdaterSlot &updater_slot);
+  std::shared_ptr<TableDetails> cached_table_details(const std::string &schema_name, const std::string &table_name);
+  void forget_table_details(const std::string &schema_name, const std::string &table_name = "");
   wb::LiveSchemaTree::ObjectType fetch_object_type(const std::string &schema_name, const std::string &obj_name);
   void fetch_column_data(const std::string &schema_name, const std::string &obj_name,
                          wb::LiveSchemaTree::ObjectType type,
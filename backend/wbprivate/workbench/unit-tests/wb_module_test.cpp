@@ -19,6 +19,7 @@
 
 #include "wb_helpers.h"
 #include "workbench/wb_module.h"
+#include "grts/structs.workbench.physical.h"
 
 BEGIN_TEST_DATA_CLASS(wb_module_test)
 
@@ -119,6 +120,59 @@ TEST_FUNCTION(5) // test WorkbenchImpl::isOsSupported()
   ensure_true("Fedora, supported", isOsSupportedProxy("Fedora release 24 x86_64"));
 }
 
+// Lays out the tables and views of the root layer with the autolayout of the WbModel module.
+static std::vector<base::Rect> autolayout_diagram(const model_DiagramRef &diagram) {
+  grt::Module* module = grt::GRT::get()->get_module("WbModel");
+  grt::BaseListRef arguments(true);
+  arguments.ginsert(diagram);
+  module->call_function("autolayout", arguments);
+
+  std::vector<base::Rect> bounds;
+  for (size_t i = 0; i < diagram->rootLayer()->figures().count(); ++i) {
+    model_FigureRef figure(diagram->rootLayer()->figures()[i]);
+    bounds.push_back(base::Rect(*figure->left(), *figure->top(), *figure->width(), *figure->height()));
+  }
+  return bounds;
+}
+
+TEST_FUNCTION(10) // test WbModelImpl::autolayout()
+{
+  ensure("Failed opening document", tester->wb->open_document("data/workbench/sakila.mwb"));
+
+  workbench_WorkbenchRef root(tester->wb->get_root());
+  model_DiagramRef diagram(root->doc()->physicalModels()[0]->diagrams()[0]);
+  model_LayerRef layer(diagram->rootLayer());
+  ensure("figure count", layer->figures().count() > 1);
+
+  std::vector<base::Rect> first = autolayout_diagram(diagram);
+
+  // The layout doesn't depend on where the figures were before, only on the figures, their connections and the seed.
+  for (size_t i = 0; i < layer->figures().count(); ++i) {
+    layer->figures()[i]->left(0);
+    layer->figures()[i]->top(0);
+  }
+  std::vector<base::Rect> second = autolayout_diagram(diagram);
+
+  ensure_equals("figure count after layout", second.size(), first.size());
+  for (size_t i = 0; i < first.size(); ++i) {
+    ensure_equals("same left position", second[i].left(), first[i].left());
+    ensure_equals("same top position", second[i].top(), first[i].top());
+  }
+
+  for (size_t i = 0; i < first.size(); ++i) {
+    ensure("figure inside the layer (left, top)", first[i].left() >= 0 && first[i].top() >= 0);
+    ensure("figure inside the layer (right)", first[i].right() <= *layer->width());
+    ensure("figure inside the layer (bottom)", first[i].bottom() <= *layer->height());
+
+    for (size_t j = i + 1; j < first.size(); ++j)
+      ensure("figures don't overlap", first[i].right() <= first[j].left() || first[j].right() <= first[i].left() ||
+                                         first[i].bottom() <= first[j].top() || first[j].bottom() <= first[i].top());
+  }
+
+  ensure("Could not close document", tester->close_document());
+  tester->wb->close_document_finish();
+}
+
 // Due to the tut nature, this must be executed as a last test always,
 // we can't have this inside of the d-tor.
 TEST_FUNCTION(99) {
@@ -35,6 +35,7 @@
 #include "base/file_utilities.h"
 #include "base/file_functions.h"
 #include "base/util_functions.h"
+#include "base/xml_functions.h"
 
 #include "mforms/utilities.h"
 #include "mdc_image.h"
@@ -393,6 +394,14 @@ std::string ModelFile::get_path_for(const std::string &file) {
 workbench_DocumentRef ModelFile::retrieve_document() {
   RecMutexLock lock(_mutex);
 
+  workbench_DocumentRef streamed(stream_document(get_path_for(MAIN_DOCUMENT_NAME)));
+  if (streamed.is_valid()) {
+    if (!semantic_check(streamed))
+      throw std::logic_error(_("Invalid model file content."));
+
+    return streamed;
+  }
+
   xmlDocPtr xmldoc = grt::GRT::get()->load_xml(get_path_for(MAIN_DOCUMENT_NAME));
 
 retry:
@@ -715,6 +724,47 @@ workbench_DocumentRef ModelFile::unserialize_document(xmlDocPtr xmldoc, const st
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * Loads a document in the current format straight from the file, without building a DOM of it first.
+ * Returns an invalid ref if the file has to go through unserialize_document() instead, which can upgrade
+ * older formats and repair known damage at the XML level.
+ */
+workbench_DocumentRef ModelFile::stream_document(const std::string &path) {
+  std::string doctype, version;
+
+  base::xml::getXMLFileMetainfo(path, doctype, version);
+  if (doctype != DOCUMENT_FORMAT || version != DOCUMENT_VERSION)
+    return workbench_DocumentRef();
+
+  grt::ValueRef value;
+  try {
+    value = grt::GRT::get()->unserialize(path, doctype, version);
+  } catch (std::exception &exc) {
+    logWarning("Could not load %s directly, loading it again with repairs: %s\n", path.c_str(), exc.what());
+    return workbench_DocumentRef();
+  }
+
+  if (!workbench_DocumentRef::can_wrap(value))
+    return workbench_DocumentRef();
+
+  workbench_DocumentRef doc(workbench_DocumentRef::cast_from(value));
+  if (has_broken_foreign_keys(doc))
+    return workbench_DocumentRef();
+
+  _loaded_version = version;
+  _load_warnings.clear();
+
+  doc = attempt_document_upgrade(doc, NULL, version);
+
+  cleanup_upgrade_data();
+
+  check_and_fix_inconsistencies(doc, version);
+
+  return doc;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 /**
  * Core save routine for model files. It does a backup of the existing model file of the given name
  * (if there is one). Checks are performed to ensure existing backup files can be removed and existing
@@ -125,6 +125,7 @@ namespace wb {
     boost::signals2::signal<void()> _changed_signal;
 
     workbench_DocumentRef unserialize_document(xmlDocPtr xmldoc, const std::string &path);
+    workbench_DocumentRef stream_document(const std::string &path);
 
   private:
     bool attempt_xml_document_upgrade(xmlDocPtr xmldoc, const std::string &version);
@@ -138,6 +139,7 @@ namespace wb {
     void check_and_fix_inconsistencies(xmlDocPtr xmldoc, const std::string &version);
 
     void check_and_fix_inconsistencies(const workbench_DocumentRef &doc, const std::string &version);
+    bool has_broken_foreign_keys(const workbench_DocumentRef &doc);
 
   public:
     static std::list<std::string> unpack_zip(const std::string &zipfile, const std::string &destdir);
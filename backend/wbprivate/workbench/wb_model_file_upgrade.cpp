@@ -785,6 +785,24 @@ static void fix_broken_foreign_keys(XMLTraverser &traverser, std::list<std::stri
   }
 }
 
+// Foreign keys that fix_broken_foreign_keys() would trim. Only the DOM based loader can repair these.
+bool ModelFile::has_broken_foreign_keys(const workbench_DocumentRef &doc) {
+  for (size_t mc = doc->physicalModels().count(), m = 0; m < mc; m++) {
+    ListRef<db_Schema> schemata(doc->physicalModels()[m]->catalog()->schemata());
+    for (size_t sc = schemata.count(), s = 0; s < sc; s++) {
+      ListRef<db_Table> tables(schemata[s]->tables());
+      for (size_t tc = tables.count(), t = 0; t < tc; t++) {
+        ListRef<db_ForeignKey> fks(tables[t]->foreignKeys());
+        for (size_t fc = fks.count(), f = 0; f < fc; f++) {
+          if (fks[f]->columns().count() != fks[f]->referencedColumns().count())
+            return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
 static int fix_duplicate_uuid_bug(xmlNodePtr node, std::map<std::string, std::string> &object_types,
                                   std::map<std::string, std::map<std::string, std::string> > &remapped_ids) {
   xmlNodePtr n;
@@ -802,8 +802,11 @@ void grt::NormalizedComparer::load_rules() {
 };
 
 bool grt::NormalizedComparer::normalizedComparison(const ValueRef obj1, const ValueRef obj2, const std::string name) {
-  std::list<comparison_rule>& rul_list = rules[name];
-  for (std::list<comparison_rule>::iterator It = rul_list.begin(); It != rul_list.end(); ++It)
+  // Read only access, this is also called from the worker threads of a parallel diff.
+  std::map<std::string, std::list<comparison_rule> >::const_iterator rul_list = rules.find(name);
+  if (rul_list == rules.end())
+    return false;
+  for (std::list<comparison_rule>::const_iterator It = rul_list->second.begin(); It != rul_list->second.end(); ++It)
     if ((*It)(obj1, obj2, name))
       return true;
   return false;
@@ -103,6 +103,13 @@ std::shared_ptr<MySQLQueryIdentifier> MySQLParserContext::createQueryIdentifier(
 
 //--------------------------------------------------------------------------------------------------
 
+std::shared_ptr<MySQLRecognizer> MySQLParserContext::createRecognizer() {
+  long version = short_version(_version);
+  return std::shared_ptr<MySQLRecognizer>(new MySQLRecognizer(version, _sql_mode, _filtered_charsets));
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void MySQLParserContext::use_sql_mode(const std::string &mode) {
   _sql_mode = mode;
   _recognizer->set_sql_mode(mode);
@@ -63,6 +63,7 @@ namespace parser {
     std::shared_ptr<MySQLScanner> createScanner(
       const std::string &text); // The scanner uses the same version etc as the other recognizers.
     std::shared_ptr<MySQLQueryIdentifier> createQueryIdentifier();
+    std::shared_ptr<MySQLRecognizer> createRecognizer(); // Additional recognizer, e.g. for use in a worker thread.
 
     void use_sql_mode(const std::string &mode);
     std::string get_sql_mode();
@@ -117,6 +117,12 @@ grt::IntegerRef db_query_Editor::executeScriptAndOutputToGrid(const std::string
   return grt::IntegerRef(0);
 }
 
+grt::IntegerRef db_query_Editor::executeScriptFile(const std::string &path) {
+  if (_data)
+    return _data->executeScriptFile(path);
+  return grt::IntegerRef(0);
+}
+
 db_query_ResultsetRef db_query_Editor::executeManagementQuery(const std::string &sql, ssize_t log) {
   if (_data)
     return _data->executeManagementQuery(sql, log != 0);
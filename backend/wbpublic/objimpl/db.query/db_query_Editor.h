@@ -40,6 +40,7 @@ public:
   virtual grt::IntegerRef addToOutput(const std::string &text, long bringToFront) = 0;
   virtual grt::ListRef<db_query_Resultset> executeScript(const std::string &sql) = 0;
   virtual grt::IntegerRef executeScriptAndOutputToGrid(const std::string &sql) = 0;
+  virtual grt::IntegerRef executeScriptFile(const std::string &path) = 0;
   virtual db_query_EditableResultsetRef createTableEditResultset(const std::string &schema, const std::string &table,
                                                                  const std::string &where, bool showGrid) = 0;
 
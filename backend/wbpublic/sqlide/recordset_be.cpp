@@ -80,6 +80,10 @@ Recordset::Recordset()
   _toolbar = NULL;
   _client_data = NULL;
   _context_menu = 0;
+  _fetching_rows = false;
+  _fetch_generation = 0;
+  _pending_rows_complete = false;
+  _pending_rows_refresh_scheduled = false;
   _id = g_atomic_int_get(&next_id);
   g_atomic_int_inc(&next_id);
 
@@ -95,6 +99,10 @@ Recordset::Recordset(GrtThreadedTask::Ref parent_task)
   _toolbar = NULL;
   _client_data = NULL;
   _context_menu = 0;
+  _fetching_rows = false;
+  _fetch_generation = 0;
+  _pending_rows_complete = false;
+  _pending_rows_refresh_scheduled = false;
   _id = g_atomic_int_get(&next_id);
   g_atomic_int_inc(&next_id);
 
@@ -125,6 +133,16 @@ bool Recordset::reset(Recordset_data_storage::Ptr data_storage_ptr, bool rethrow
   _sort_columns.clear();
   _column_filter_expr_map.clear();
   _data_search_string.clear();
+  {
+    base::MutexLock lock(_pending_rows_mutex);
+    _fetching_rows = false;
+    ++_fetch_generation;
+    _pending_row_batches.clear();
+    _pending_rows_complete = false;
+    _pending_rows_cond.broadcast(); // a waiting fetch_pending_rows gives up
+  }
+
+  _data_index.invalidate();
 
   RETAIN_WEAK_PTR(Recordset_data_storage, data_storage_ptr, data_storage)
   if (data_storage) {
@@ -160,6 +178,17 @@ bool Recordset::reset(Recordset_data_storage::Ptr data_storage_ptr, bool rethrow
       _readonly = data_storage->readonly();
 
       _readonly_reason = data_storage->readonly_reason();
+
+      // rows still being fetched can't be edited
+      bool fetching_rows = data_storage->has_pending_rows();
+      {
+        base::MutexLock lock(_pending_rows_mutex);
+        _fetching_rows = fetching_rows;
+      }
+      if (fetching_rows) {
+        _readonly = true;
+        _readonly_reason = _("Rows of the result set are still being fetched.");
+      }
       res = true;
     }
     CATCH_AND_DISPATCH_EXCEPTION(rethrow, "Reset recordset")
@@ -194,6 +223,11 @@ void Recordset::reset() {
 }
 
 bool Recordset::reset(bool rethrow) {
+  // reading the data storage again would drop the rows it still has to deliver
+  if (is_fetching_rows()) {
+    logWarning("Recordset reset while rows are still being fetched, ignored\n");
+    return false;
+  }
   return reset(_data_storage, rethrow);
 }
 
@@ -236,6 +270,10 @@ void Recordset::refresh() {
     task->send_msg(grt::ErrorMsg, ERRMSG_PENDING_CHANGES, _("Refresh Recordset"));
     return;
   }
+  if (is_fetching_rows()) {
+    task->send_msg(grt::ErrorMsg, _("Rows of the result set are still being fetched."), _("Refresh Recordset"));
+    return;
+  }
 
   std::string data_search_string = _data_search_string;
 
@@ -251,6 +289,11 @@ void Recordset::refresh() {
 }
 
 void Recordset::rollback() {
+  if (is_fetching_rows()) {
+    task->send_msg(grt::ErrorMsg, _("Rows of the result set are still being fetched."),
+                   _("Rollback recordset changes"));
+    return;
+  }
   if (!reset(false))
     task->send_msg(grt::ErrorMsg, _("Rollback failed"), _("Rollback recordset changes"));
   else
@@ -292,6 +335,144 @@ void Recordset::recalc_row_count(sqlite::connection *data_swap_db) {
   }
 }
 
+RowId Recordset::fetch_pending_rows() {
+  static const size_t batch_row_count = 10000;
+  // batches waiting to be stored before the reading stops, so that a huge result doesn't pile up in memory
+  static const size_t max_pending_batch_count = 4;
+
+  Recordset_data_storage_Ref data_storage = _data_storage;
+  bool fetching_rows;
+  size_t generation;
+  {
+    base::MutexLock lock(_pending_rows_mutex);
+    fetching_rows = _fetching_rows;
+    generation = _fetch_generation;
+  }
+  if (!data_storage || !fetching_rows)
+    return row_count();
+
+  // rows are only read here, storing them is left to the main thread so that the data swap db is never written
+  // through 2 connections at once
+  RowId fetched_row_count = real_row_count();
+  bool more_rows = true;
+  try {
+    while (more_rows) {
+      std::shared_ptr<Row_batch> rows(new Row_batch());
+      more_rows = data_storage->do_fetch_pending_rows(batch_row_count, *rows);
+      fetched_row_count += rows->size();
+
+      base::MutexLock lock(_pending_rows_mutex);
+      while (_fetch_generation == generation && _pending_row_batches.size() >= max_pending_batch_count)
+        _pending_rows_cond.wait(_pending_rows_mutex);
+      if (_fetch_generation != generation) { // recordset was reset meanwhile, the rows belong to an old result
+        data_storage->discard_pending_rows();
+        break;
+      }
+
+      _pending_row_batches.push_back(rows);
+      _pending_rows_complete = !more_rows;
+      if (!_pending_rows_refresh_scheduled) {
+        _pending_rows_refresh_scheduled = true;
+        bec::GRTManager::get()->run_once_when_idle(this, std::bind(&Recordset::pending_rows_fetched, this));
+      }
+    }
+  } catch (...) {
+    data_storage->discard_pending_rows();
+    base::MutexLock lock(_pending_rows_mutex);
+    if (_fetch_generation != generation)
+      throw;
+    _pending_rows_complete = true;
+    if (!_pending_rows_refresh_scheduled) {
+      _pending_rows_refresh_scheduled = true;
+      bec::GRTManager::get()->run_once_when_idle(this, std::bind(&Recordset::pending_rows_fetched, this));
+    }
+    throw;
+  }
+
+  return fetched_row_count;
+}
+
+bool Recordset::is_fetching_rows() const {
+  base::MutexLock lock(_pending_rows_mutex);
+  return _fetching_rows;
+}
+
+/**
+ * Stores the oldest batch of rows read by fetch_pending_rows and makes it visible, executed in the main thread.
+ * Runs again on the next idle while more batches are queued, so that the UI keeps responding in between.
+ */
+void Recordset::pending_rows_fetched() {
+  std::shared_ptr<Row_batch> rows;
+  bool complete;
+  size_t generation;
+  {
+    base::MutexLock lock(_pending_rows_mutex);
+    generation = _fetch_generation;
+    if (!_pending_row_batches.empty()) {
+      rows = _pending_row_batches.front();
+      _pending_row_batches.pop_front();
+      _pending_rows_cond.signal();
+    }
+    complete = _pending_rows_complete && _pending_row_batches.empty();
+
+    if (_pending_row_batches.empty())
+      _pending_rows_refresh_scheduled = false;
+    else
+      bec::GRTManager::get()->run_once_when_idle(this, std::bind(&Recordset::pending_rows_fetched, this));
+  }
+
+  std::shared_ptr<sqlite::connection> data_swap_db = this->data_swap_db();
+  {
+    base::RecMutexLock data_mutex(_data_mutex);
+    {
+      // reset holds the data mutex while it starts a new generation, so the check stays valid from here on
+      base::MutexLock lock(_pending_rows_mutex);
+      if (!_fetching_rows || _fetch_generation != generation) // recordset was reset meanwhile
+        return;
+    }
+
+    if (_data_storage && rows)
+      _data_storage->store_rows(data_swap_db.get(), _column_names, *rows);
+    _data_index.invalidate();
+
+    if (_sort_columns.empty() && _column_filter_expr_map.empty() && _data_search_string.empty()) {
+      // no need to rebuild the data index, fetched rows go after the ones already shown
+      sqlite::execute(*data_swap_db,
+                      "insert into `data_index` (id) select id from `data` where id > (select coalesce(max(id), -1) "
+                      "from `data_index`) order by id",
+                      true);
+      recalc_row_count(data_swap_db.get());
+    } else if (complete) {
+      // a sorted or filtered view gets the fetched rows once all of them are there, so that the data index is
+      // rebuilt only once
+      rebuild_data_index(data_swap_db.get(), false, false);
+      cache_data_frame(-1, false);
+    }
+
+    if (complete) {
+      {
+        base::MutexLock lock(_pending_rows_mutex);
+        _fetching_rows = false;
+      }
+      if (_data_storage) {
+        _readonly = _data_storage->readonly();
+        _readonly_reason = _data_storage->readonly_reason();
+      }
+
+      sqlite::query q(*data_swap_db, "select coalesce(max(id)+1, 0) from `data`");
+      if (q.emit()) {
+        std::shared_ptr<sqlite::result> rs = BoostHelper::convertPointer(q.get_result());
+        _min_new_rowid = rs->get_int(0);
+        _next_new_rowid = _min_new_rowid;
+      }
+    }
+  }
+
+  refresh_ui();
+  if (rows_changed)
+    rows_changed();
+}
+
 Recordset::Cell Recordset::cell(RowId row, ColumnId column) {
   if (_row_count == row) {
     RowId rowid = _next_new_rowid++; // rowid of the new record
@@ -326,6 +507,7 @@ Recordset::Cell Recordset::cell(RowId row, ColumnId column) {
 
       transaction_guarder.commit();
     }
+    _data_index.invalidate();
 
     _data.resize(_data.size() + _column_count);
     ++_row_count;
@@ -382,6 +564,7 @@ void Recordset::mark_dirty(RowId row, ColumnId column, const sqlite::variant_t &
     }
 
     transaction_guarder.commit();
+    _data_index.invalidate_column(column);
   }
 }
 
@@ -457,9 +640,11 @@ bool Recordset::delete_nodes(std::vector<bec::NodeId> &nodes) {
         }
 
         transaction_guarder.commit();
+        _data_index.invalidate();
 
         --_row_count;
         --_data_frame_end;
+        discard_cached_data_frames();
 
         // delete record from cached data frame
         {
@@ -806,118 +991,34 @@ void Recordset::rebuild_data_index(sqlite::connection *data_swap_db, bool do_cac
   {
     base::RecMutexLock data_mutex(_data_mutex);
 
-    std::string where_clause;
-    {
-      sqlide::QuoteVar qv;
-      {
-        qv.escape_string = std::bind(sqlide::QuoteVar::escape_ansi_sql_string, std::placeholders::_1);
-        qv.store_unknown_as_string = true;
-        qv.allow_func_escaping = false;
-      }
-      sqlite::variant_t var_string_type = std::string();
-      sqlite::variant_t var_string;
-      std::string sql_string;
-
-      // column filters subclause
-      std::string where_subclause1;
-      {
-        for (auto &column_filter_expr : _column_filter_expr_map) {
-          var_string = column_filter_expr.second;
-          sql_string = boost::apply_visitor(qv, var_string_type, var_string);
-          where_subclause1 += strfmt("_%u like %s and ", (unsigned int)column_filter_expr.first, sql_string.c_str());
-        }
-        if (!where_subclause1.empty()) {
-          where_subclause1.resize(where_subclause1.size() - std::string(" and ").size());
-          where_subclause1.insert(0, "(");
-          where_subclause1.append(")");
-        }
-      }
-
-      // data search subclause
-      std::string where_subclause2;
-      if (!_data_search_string.empty()) {
-        var_string = "%" + _data_search_string + "%";
-        sql_string = boost::apply_visitor(qv, var_string_type, var_string);
-        for (ColumnId column = 0, column_count = get_column_count(); column < column_count; ++column) {
-          where_subclause2 += strfmt("_%u like %s or ", (unsigned int)column, sql_string.c_str());
-        }
-        if (!where_subclause2.empty()) {
-          where_subclause2.resize(where_subclause2.size() - std::string(" or ").size());
-          where_subclause2.insert(0, "(");
-          where_subclause2.append(")");
-        }
-      }
-
-      if (!where_subclause1.empty() || !where_subclause2.empty()) {
-        std::string subclauses_mediator = (!where_subclause1.empty() && !where_subclause2.empty()) ? " and " : "";
-        where_clause =
-          strfmt("where %s%s%s", where_subclause1.c_str(), subclauses_mediator.c_str(), where_subclause2.c_str());
-      }
-    }
-
-    std::string orderby_clause;
-    {
-      for (auto &sort_column : _sort_columns) {
-        std::string column_expr;
-        switch (get_real_column_type(sort_column.first)) {
-          case NumericType:
-          case FloatType:
-          case DatetimeType:
-            column_expr = strfmt("cast(_%u as numeric)", (unsigned int)sort_column.first);
-            break;
-          case StringType:
-            column_expr = strfmt("_%u COLLATE NOCASE", (unsigned int)sort_column.first);
-            break;
-
-          default:
-            column_expr = strfmt("_%u", (unsigned int)sort_column.first);
-            break;
-        }
-        const char *dir;
-        switch (sort_column.second) {
-          case 1:
-            dir = "ASC";
-            break;
-          case -1:
-            dir = "DESC";
-            break;
-          default:
-            dir = "";
-            break;
-        }
-        orderby_clause += strfmt("%s %s, ", column_expr.c_str(), dir);
-      }
-      if (!orderby_clause.empty()) {
-        orderby_clause.resize(orderby_clause.size() - std::string(", ").size());
-        orderby_clause.insert(0, "order by ");
-      }
-    }
+    Recordset_data_index::Sort_keys sort_keys;
+    for (auto &sort_column : _sort_columns) {
+      Recordset_data_index::Sort_key sort_key;
+      sort_key.column = sort_column.first;
+      sort_key.direction = sort_column.second;
+      switch (get_real_column_type(sort_column.first)) {
+        case NumericType:
+        case FloatType:
+        case DatetimeType:
+          // natively stored integers sort as they are, everything else is kept as text in the swap db
+          if ((sort_column.first < _column_flags.size()) && (_column_flags[sort_column.first] & IntegerStorageFlag))
+            sort_key.collation = Recordset_data_index::BinaryCollation;
+          else
+            sort_key.collation = Recordset_data_index::NumericCollation;
+          break;
+        case StringType:
+          sort_key.collation = Recordset_data_index::NocaseCollation;
+          break;
 
-    std::string tables_join = "`data`";
-    {
-      for (size_t partition = 1, partition_count = data_swap_db_partition_count(); partition < partition_count;
-           ++partition) {
-        std::string partition_suffix = data_swap_db_partition_suffix(partition);
-        tables_join +=
-          strfmt(" inner join `data%s` on (`data`.id=`data%s`.id)", partition_suffix.c_str(), partition_suffix.c_str());
+        default:
+          sort_key.collation = Recordset_data_index::BinaryCollation;
+          break;
       }
+      sort_keys.push_back(sort_key);
     }
 
-    {
-      sqlide::Sqlite_transaction_guarder transaction_guarder(data_swap_db);
-
-      std::string temp_table_name = "`data_index_" + grt::get_guid() + "`";
-
-      sqlite::execute(*data_swap_db, strfmt("create table if not exists %s (`id` integer)", temp_table_name.c_str()),
-                      true);
-      sqlite::execute(*data_swap_db, strfmt("insert into %s select `data`.`id` from %s %s %s", temp_table_name.c_str(),
-                                            tables_join.c_str(), where_clause.c_str(), orderby_clause.c_str()),
-                      true);
-      sqlite::execute(*data_swap_db, "drop table if exists `data_index`", true);
-      sqlite::execute(*data_swap_db, strfmt("alter table %s rename to `data_index`", temp_table_name.c_str()), true);
-
-      transaction_guarder.commit();
-    }
+    _data_index.rebuild(data_swap_db, _column_filter_expr_map, _data_search_string, get_column_count(), sort_keys);
+    discard_cached_data_frames();
 
     recalc_row_count(data_swap_db);
 
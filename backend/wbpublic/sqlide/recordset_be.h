@@ -22,6 +22,7 @@
 #include "wbpublic_public_interface.h"
 #include "sqlide/sqlide_generics.h"
 #include "sqlide/var_grid_model_be.h"
+#include "sqlide/recordset_data_index.h"
 #include "grt/action_list.h"
 #include <map>
 #include <set>
@@ -104,6 +105,28 @@ private:
 private:
   size_t _real_row_count;
 
+public:
+  typedef std::vector<std::vector<sqlite::variant_t> > Row_batch;
+
+  // Reads the rows the data storage left to be fetched after reset (see Recordset_cdbc_storage::incremental_fetch),
+  // in batches that are handed over to the main thread, which stores them in the data swap db and makes them visible.
+  // Reading waits while the main thread is behind by a few batches. Meant to be called from the thread that executed
+  // the query, returns the total number of rows of the recordset.
+  RowId fetch_pending_rows();
+  bool is_fetching_rows() const;
+
+private:
+  void pending_rows_fetched();
+
+  // fetch state, batches read by fetch_pending_rows & not stored yet, all guarded by _pending_rows_mutex
+  mutable base::Mutex _pending_rows_mutex;
+  base::Cond _pending_rows_cond; // signaled when a batch was taken from the queue or the queue was cleared
+  bool _fetching_rows;
+  size_t _fetch_generation; // increased by every reset, a fetch started before doesn't queue its rows anymore
+  std::list<std::shared_ptr<Row_batch> > _pending_row_batches;
+  bool _pending_rows_complete;
+  bool _pending_rows_refresh_scheduled;
+
 public:
   const Column_names *column_names() const {
     return &_column_names;
@@ -263,6 +286,7 @@ private:
 
 private:
   void rebuild_data_index(sqlite::connection *data_swap_db, bool do_cache_data_frame, bool do_refresh_ui);
+  Recordset_data_index _data_index;
 
 public:
   void caption(const std::string &val) {
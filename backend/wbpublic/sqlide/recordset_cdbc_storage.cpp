@@ -34,12 +34,25 @@ using namespace grt;
 using namespace base;
 
 Recordset_cdbc_storage::Recordset_cdbc_storage()
-  : Recordset_sql_storage(), _reloadable(true), _gather_field_info(false) {
+  : Recordset_sql_storage(), _reloadable(true), _gather_field_info(false), _incremental_fetch(false) {
 }
 
 Recordset_cdbc_storage::~Recordset_cdbc_storage() {
 }
 
+// number of rows an incremental unserialize stores before handing over to Recordset::fetch_pending_rows
+static const size_t INCREMENTAL_FETCH_FIRST_ROW_COUNT = 1000;
+
+struct Recordset_cdbc_storage::Fetch_state {
+  std::shared_ptr<sql::Statement> stmt;
+  std::shared_ptr<sql::ResultSet> rs;
+  Recordset::Column_names column_names; // including the copies of pk columns
+  Recordset::Column_types storage_types;
+  std::vector<bool> null_value_columns;
+  std::vector<ColumnId> pkey_columns; // columns the pk copies are made from
+  ColumnId editable_col_count;
+};
+
 class FetchVar : public boost::static_visitor<sqlite::variant_t> {
 public:
   FetchVar(sql::ResultSet *rs) : _rs(rs), _foreknown_blob_size(-1) {
@@ -106,6 +119,10 @@ private:
   size_t _foreknown_blob_size;
 };
 
+static bool is_integer_type(const sqlite::variant_t &type) {
+  return (boost::get<int>(&type) != NULL) || (boost::get<std::int64_t>(&type) != NULL);
+}
+
 size_t Recordset_cdbc_storage::determine_pkey_columns(Recordset::Column_names &column_names,
                                                       Recordset::Column_types &column_types,
                                                       Recordset::Column_types &real_column_types) {
@@ -275,6 +292,10 @@ void Recordset_cdbc_storage::do_unserialize(Recordset *recordset, sqlite::connec
   ColumnId editable_col_count = rs_meta->getColumnCount();
 
   // column types
+  // known_types are the presentation types, which stay strings for numbers & temporals so that editing and display
+  // keep the server's textual form. what is actually kept per cell is decided below: integer columns are fetched and
+  // swapped natively (IntegerStorageFlag), decimals, floats & temporals stay text since a binary form would not
+  // round-trip their text. typed per column buffers for sorting & filtering are built by Recordset_data_index
   static std::map<std::string, sqlite::variant_t> known_types;
   static std::map<std::string, sqlite::variant_t> known_real_types;
   {
@@ -392,6 +413,11 @@ void Recordset_cdbc_storage::do_unserialize(Recordset *recordset, sqlite::connec
     int flags = 0;
     if (!rs_meta->isNumeric(n + 1) && (sql::DataType::DECIMAL != rs_meta->getColumnType(n + 1)))
       flags = Recordset::NeedsQuoteFlag;
+    // integers are fetched and swapped natively instead of as one string per cell. values that don't fit int64 or
+    // whose textual form matters (zerofill) are left to the string path
+    if (is_integer_type(real_column_types.back()) && (rs_meta->isSigned(n + 1) || (type_name != "BIGINT")) &&
+        !rs_meta->isZerofill(n + 1))
+      flags |= Recordset::IntegerStorageFlag;
     column_flags.push_back(flags);
   }
 
@@ -422,41 +448,115 @@ void Recordset_cdbc_storage::do_unserialize(Recordset *recordset, sqlite::connec
 
   // data
   {
-    sqlide::Sqlite_transaction_guarder transaction_guarder(data_swap_db, false);
+    std::shared_ptr<Fetch_state> fetch(new Fetch_state());
+    fetch->stmt = stmt;
+    fetch->rs = rs;
+    fetch->column_names = column_names;
+    fetch->editable_col_count = editable_col_count;
+    fetch->null_value_columns = null_value_columns;
+    fetch->pkey_columns.assign(_pkey_columns.begin(), _pkey_columns.begin() + rowid_col_count);
+
+    // types values are fetched & stored as. differ from presentation types for natively stored integer columns
+    fetch->storage_types = column_types;
+    for (ColumnId col = 0; editable_col_count > col; ++col)
+      if ((col < column_flags.size()) && (column_flags[col] & Recordset::IntegerStorageFlag))
+        fetch->storage_types[col] = std::int64_t();
+    for (ColumnId n = 0; rowid_col_count > n; ++n)
+      fetch->storage_types[editable_col_count + n] = fetch->storage_types[_pkey_columns[n]];
+
+    create_data_swap_tables(data_swap_db, column_names, fetch->storage_types);
+
+    // the first rows are enough to show something, the rest is left to Recordset::fetch_pending_rows
+    discard_pending_rows();
+    {
+      sqlide::Sqlite_transaction_guarder transaction_guarder(data_swap_db, false);
+
+      std::list<std::shared_ptr<sqlite::command> > insert_commands =
+        prepare_data_swap_record_add_statement(data_swap_db, column_names);
+      if (fetch_rows(*fetch, _incremental_fetch ? INCREMENTAL_FETCH_FIRST_ROW_COUNT : (size_t)-1,
+                     [this, &insert_commands](const Var_vector &row_values) {
+                       add_data_swap_record(insert_commands, row_values);
+                     })) {
+        base::MutexLock lock(_pending_fetch_mutex);
+        _pending_fetch = fetch;
+      }
 
-    create_data_swap_tables(data_swap_db, column_names, column_types);
+      transaction_guarder.commit();
+    }
+  }
 
-    FetchVar fetch_var(rs.get());
-    Var_vector row_values(editable_col_count + rowid_col_count);
+  // remap rowid columns to duplicated columns
+  for (ColumnId rowid_col = 0, col = editable_col_count; rowid_col_count > rowid_col; ++col, ++rowid_col)
+    _pkey_columns[rowid_col] = col;
+}
 
-    std::list<std::shared_ptr<sqlite::command> > insert_commands =
-      prepare_data_swap_record_add_statement(data_swap_db, column_names);
-    // XXX this will fetch all records before displaying them, which will result in a huge unnecessary lag in the UI
-    while (rs->next()) {
-      for (ColumnId n = 0; editable_col_count > n; ++n) {
-        if (rs->isNull((int)n + 1) || null_value_columns[n]) {
-          row_values[n] = sqlite::null_t();
-        } else {
-          sqlite::variant_t index = (int)n + 1;
-          row_values[n] = boost::apply_visitor(fetch_var, column_types[n], index);
-        }
+bool Recordset_cdbc_storage::fetch_rows(Fetch_state &fetch, size_t max_row_count,
+                                        const std::function<void(const Var_vector &)> &add_row) {
+  sql::Dbc_connection_handler::Ref conn;
+  base::RecMutexLock lock(_getUserConnection(conn, true));
+
+  ColumnId editable_col_count = fetch.editable_col_count;
+  ColumnId rowid_col_count = fetch.pkey_columns.size();
+  FetchVar fetch_var(fetch.rs.get());
+  Var_vector row_values(editable_col_count + rowid_col_count);
+
+  for (size_t row_count = 0; row_count < max_row_count; ++row_count) {
+    if (!fetch.rs->next())
+      return false;
+
+    for (ColumnId n = 0; editable_col_count > n; ++n) {
+      if (fetch.rs->isNull((int)n + 1) || fetch.null_value_columns[n]) {
+        row_values[n] = sqlite::null_t();
+      } else {
+        sqlite::variant_t index = (int)n + 1;
+        row_values[n] = boost::apply_visitor(fetch_var, fetch.storage_types[n], index);
       }
-      for (ColumnId n = 0; rowid_col_count > n; ++n) // copy original value of pk field(s)
-        row_values[editable_col_count + n] = row_values[_pkey_columns[n]];
-      add_data_swap_record(insert_commands, row_values);
-
-      if (conn->is_stop_query_requested)
-        throw std::runtime_error(
-          _("Query execution has been stopped, the connection to the DB server was not restarted, any open transaction "
-            "remains open"));
     }
+    for (ColumnId n = 0; rowid_col_count > n; ++n) // copy original value of pk field(s)
+      row_values[editable_col_count + n] = row_values[fetch.pkey_columns[n]];
+    add_row(row_values);
+
+    if (conn->is_stop_query_requested)
+      throw std::runtime_error(
+        _("Query execution has been stopped, the connection to the DB server was not restarted, any open transaction "
+          "remains open"));
+  }
+
+  return true;
+}
+
+bool Recordset_cdbc_storage::has_pending_rows() {
+  base::MutexLock lock(_pending_fetch_mutex);
+  return _pending_fetch.get() != NULL;
+}
 
-    transaction_guarder.commit();
+bool Recordset_cdbc_storage::do_fetch_pending_rows(size_t max_row_count, Row_batch &rows) {
+  std::shared_ptr<Fetch_state> fetch;
+  {
+    base::MutexLock lock(_pending_fetch_mutex);
+    fetch = _pending_fetch;
+  }
+  if (!fetch)
+    return false;
+
+  rows.reserve(max_row_count);
+  if (!fetch_rows(*fetch, max_row_count, [&rows](const Var_vector &row_values) { rows.push_back(row_values); })) {
+    // the state may have been discarded or replaced by a new unserialize meanwhile, which must be kept
+    base::MutexLock lock(_pending_fetch_mutex);
+    if (_pending_fetch == fetch)
+      _pending_fetch.reset();
+    return false;
   }
+  return true;
+}
 
-  // remap rowid columns to duplicated columns
-  for (ColumnId rowid_col = 0, col = editable_col_count; rowid_col_count > rowid_col; ++col, ++rowid_col)
-    _pkey_columns[rowid_col] = col;
+void Recordset_cdbc_storage::discard_pending_rows() {
+  std::shared_ptr<Fetch_state> fetch;
+  {
+    base::MutexLock lock(_pending_fetch_mutex);
+    fetch.swap(_pending_fetch);
+  }
+  // the resultset is closed here, outside of the mutex
 }
 
 void Recordset_cdbc_storage::do_fetch_blob_value(Recordset *recordset, sqlite::connection *data_swap_db, RowId rowid,
@@ -471,6 +571,10 @@ void Recordset_cdbc_storage::do_fetch_blob_value(Recordset *recordset, sqlite::c
   if (column >= column_names.size())
     return;
 
+  // the connection can't run other queries until the unbuffered resultset is fully read
+  if (has_pending_rows())
+    throw std::runtime_error(_("Rows of the result set are still being fetched."));
+
   std::string sql_query = decorated_sql_query();
   {
     std::string pkey_predicate;
@@ -50,6 +50,11 @@ protected:
   virtual void do_unserialize(Recordset *recordset, sqlite::connection *data_swap_db);
   virtual void do_fetch_blob_value(Recordset *recordset, sqlite::connection *data_swap_db, RowId rowid, ColumnId column,
                                    sqlite::variant_t &blob_value);
+  virtual bool do_fetch_pending_rows(size_t max_row_count, Row_batch &rows);
+  virtual void discard_pending_rows();
+
+public:
+  virtual bool has_pending_rows();
 
 protected:
   virtual void run_sql_script(const Sql_script &sql_script, bool skip_transaction);
@@ -83,6 +88,12 @@ public:
   void set_gather_field_info(bool flag) {
     _gather_field_info = flag;
   }
+
+  // when set, unserialize stores only the first rows of the resultset and keeps it open for
+  // Recordset::fetch_pending_rows to store the rest (best used with an unbuffered resultset)
+  void incremental_fetch(bool val) {
+    _incremental_fetch = val;
+  }
   std::vector<FieldInfo> &field_info() {
     return _field_info;
   }
@@ -96,6 +107,15 @@ private:
   std::vector<FieldInfo> _field_info;
   bool _reloadable; // whether can be reloaded using stored sql query
   bool _gather_field_info;
+  bool _incremental_fetch;
+
+  struct Fetch_state;
+  // resultset left open by an incremental unserialize. Read & replaced from the fetch thread as well, so it's only
+  // accessed under _pending_fetch_mutex, a fetch works on its own reference to the state without holding the mutex
+  std::shared_ptr<Fetch_state> _pending_fetch;
+  base::Mutex _pending_fetch_mutex;
+  // reads up to max_row_count rows of the resultset & passes them to add_row, returns false when no rows are left
+  bool fetch_rows(Fetch_state &fetch, size_t max_row_count, const std::function<void(const Var_vector &)> &add_row);
 
   size_t determine_pkey_columns(Recordset::Column_names &column_names, Recordset::Column_types &column_types,
                                 Recordset::Column_types &real_column_types);
@@ -0,0 +1,685 @@
+/*
+ * Copyright (c) 2017, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include "sqlide_generics_private.h"
+
+#include "recordset_data_index.h"
+#include "var_grid_model_be.h"
+#include "base/string_utilities.h"
+#include "base/threading.h"
+#include "base/boost_smart_ptr_helpers.h"
+#include <sqlite/execute.hpp>
+#include <sqlite/query.hpp>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+using namespace base;
+
+//--------------------------------------------------------------------------------------------------
+
+// below that number of rows sorting threads don't pay off
+static const size_t PARALLEL_SORT_MIN_ROW_COUNT = 100000;
+static const size_t MAX_SORT_THREAD_COUNT = 8;
+
+// number of ids inserted into `data_index` by a single statement
+static const size_t DATA_INDEX_INSERT_BATCH_SIZE = 256;
+
+//--------------------------------------------------------------------------------------------------
+
+// sqlite's LIKE and NOCASE collation are case insensitive for ascii characters only
+static inline char fold_char(char c) {
+  return ((c >= 'A') && (c <= 'Z')) ? (char)(c + ('a' - 'A')) : c;
+}
+
+static std::string fold_text(const std::string &text) {
+  std::string folded(text);
+  std::transform(folded.begin(), folded.end(), folded.begin(), fold_char);
+  return folded;
+}
+
+static inline size_t utf8_char_length(unsigned char c) {
+  if (c < 0xC0)
+    return 1;
+  if (c < 0xE0)
+    return 2;
+  if (c < 0xF0)
+    return 3;
+  return 4;
+}
+
+static inline int compare_bytes(const char *a, size_t a_length, const char *b, size_t b_length) {
+  int res = memcmp(a, b, std::min(a_length, b_length));
+  if (res != 0)
+    return res;
+  return (a_length < b_length) ? -1 : ((a_length > b_length) ? 1 : 0);
+}
+
+template <typename T>
+static inline int compare_values(const T &a, const T &b) {
+  return (a < b) ? -1 : ((b < a) ? 1 : 0);
+}
+
+// memchr does the heavy lifting here, it's vectorized by all the C runtimes we build with
+static const char *find_substring(const char *text, size_t length, const char *substring, size_t substring_length) {
+  if (substring_length == 0)
+    return text;
+
+  const char *end = text + length;
+  while ((size_t)(end - text) >= substring_length) {
+    const char *candidate = (const char *)memchr(text, substring[0], (end - text) - substring_length + 1);
+    if (candidate == NULL)
+      return NULL;
+    if (memcmp(candidate + 1, substring + 1, substring_length - 1) == 0)
+      return candidate;
+    text = candidate + 1;
+  }
+  return NULL;
+}
+
+// text representation of a real value the way sqlite renders it (%!.15g, which always has a decimal point in the
+// mantissa, e.g. 2.0 or 1.0e+20)
+static std::string real_to_text(long double value) {
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%.15g", (double)value);
+  std::string text(buffer);
+  if (text.find_first_of(".in") == std::string::npos) {
+    size_t exponent = text.find('e');
+    text.insert(exponent == std::string::npos ? text.size() : exponent, ".0");
+  }
+  return text;
+}
+
+// numeric value of a text according to sqlite's `cast(text as numeric)`: the longest prefix looking like a number
+static long double text_to_number(const char *text, size_t length) {
+  size_t i = 0;
+  while ((i < length) && isspace((unsigned char)text[i]))
+    ++i;
+  size_t start = i;
+  if ((i < length) && ((text[i] == '-') || (text[i] == '+')))
+    ++i;
+  size_t digits = 0;
+  while ((i < length) && isdigit((unsigned char)text[i]))
+    ++i, ++digits;
+  if ((i < length) && (text[i] == '.')) {
+    ++i;
+    while ((i < length) && isdigit((unsigned char)text[i]))
+      ++i, ++digits;
+  }
+  if (digits == 0)
+    return 0;
+  if ((i < length) && ((text[i] == 'e') || (text[i] == 'E'))) {
+    size_t exponent = i + 1;
+    if ((exponent < length) && ((text[exponent] == '-') || (text[exponent] == '+')))
+      ++exponent;
+    if ((exponent < length) && isdigit((unsigned char)text[exponent])) {
+      i = exponent;
+      while ((i < length) && isdigit((unsigned char)text[i]))
+        ++i;
+    }
+  }
+  std::string number(text + start, i - start);
+  return g_ascii_strtod(number.c_str(), NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Values of a single swap db column, one cell per row in rowid order. Text of all non-NULL cells (including the
+ * rendering of numbers) is kept back to back in one buffer, which is what LIKE filtering scans.
+ */
+class Recordset_data_index::Column : public boost::static_visitor<void> {
+public:
+  enum Cell_type { NullCell, IntegerCell, RealCell, TextCell, BlobCell };
+
+  Column() : _has_text_numbers(false) {
+    _offsets.push_back(0);
+  }
+
+  void reserve(size_t row_count) {
+    _types.reserve(row_count);
+    _integers.reserve(row_count);
+    _numbers.reserve(row_count);
+    _offsets.reserve(row_count + 1);
+  }
+
+  void append(const sqlite::variant_t &value) {
+    boost::apply_visitor(*this, value);
+  }
+
+  size_t size() const {
+    return _types.size();
+  }
+
+  bool is_null(size_t row) const {
+    return _types[row] == NullCell;
+  }
+
+  const char *text(size_t row) const {
+    return _text.data() + _offsets[row];
+  }
+
+  const char *folded_text(size_t row) const {
+    return _folded_text.data() + _offsets[row];
+  }
+
+  size_t text_length(size_t row) const {
+    return _offsets[row + 1] - _offsets[row];
+  }
+
+  const std::string &folded_text() const {
+    return _folded_text;
+  }
+
+  // returns the row whose text contains given offset of the text buffer
+  size_t row_at(size_t offset, size_t first_row) const {
+    return (std::upper_bound(_offsets.begin() + first_row, _offsets.end(), offset) - _offsets.begin()) - 1;
+  }
+
+  size_t row_end(size_t row) const {
+    return _offsets[row + 1];
+  }
+
+  void prepare(Collation collation) {
+    switch (collation) {
+      case NumericCollation:
+        if (!_has_text_numbers) {
+          for (size_t row = 0, count = size(); row < count; ++row)
+            if ((_types[row] == TextCell) || (_types[row] == BlobCell))
+              _numbers[row] = text_to_number(text(row), text_length(row));
+          _has_text_numbers = true;
+        }
+        break;
+      case NocaseCollation:
+        prepare_folded_text();
+        break;
+      case BinaryCollation:
+        break;
+    }
+  }
+
+  void prepare_folded_text() {
+    if (_folded_text.size() != _text.size())
+      _folded_text = fold_text(_text);
+  }
+
+  // same ordering sqlite applies: NULLs first, then numbers, text and blobs (the latter compared bytewise)
+  int compare(size_t a, size_t b, Collation collation) const {
+    int a_rank = rank(a, collation);
+    int b_rank = rank(b, collation);
+    if (a_rank != b_rank)
+      return (a_rank < b_rank) ? -1 : 1;
+
+    switch (a_rank) {
+      case 0:
+        return 0;
+      case 1:
+        if ((_types[a] == IntegerCell) && (_types[b] == IntegerCell))
+          return compare_values(_integers[a], _integers[b]);
+        return compare_values(_numbers[a], _numbers[b]);
+      case 2:
+        if (collation == NocaseCollation)
+          return compare_bytes(folded_text(a), text_length(a), folded_text(b), text_length(b));
+        return compare_bytes(text(a), text_length(a), text(b), text_length(b));
+      default:
+        return compare_bytes(text(a), text_length(a), text(b), text_length(b));
+    }
+  }
+
+public:
+  void operator()(const sqlite::null_t &) {
+    append_cell(NullCell, 0, 0);
+  }
+  void operator()(const sqlite::unknown_t &) {
+    append_cell(NullCell, 0, 0);
+  }
+  void operator()(const int &v) {
+    std::string text = std::to_string(v);
+    append_cell(IntegerCell, v, v, text.data(), text.size());
+  }
+  void operator()(const std::int64_t &v) {
+    std::string text = std::to_string(v);
+    append_cell(IntegerCell, v, (long double)v, text.data(), text.size());
+  }
+  void operator()(const long double &v) {
+    std::string text = real_to_text(v);
+    append_cell(RealCell, 0, v, text.data(), text.size());
+  }
+  void operator()(const std::string &v) {
+    append_cell(TextCell, 0, 0, v.data(), v.size());
+  }
+  void operator()(const sqlite::blob_ref_t &v) {
+    if (!v || v->empty())
+      append_cell(BlobCell, 0, 0);
+    else
+      append_cell(BlobCell, 0, 0, (const char *)&(*v)[0], v->size());
+  }
+  template <typename T>
+  void operator()(const T &) {
+    append_cell(NullCell, 0, 0);
+  }
+
+private:
+  void append_cell(Cell_type type, std::int64_t integer, long double number, const char *text = NULL,
+                   size_t length = 0) {
+    _types.push_back((unsigned char)type);
+    _integers.push_back(integer);
+    _numbers.push_back(number);
+    if (length > 0)
+      _text.append(text, length);
+    _offsets.push_back(_text.size());
+  }
+
+  int rank(size_t row, Collation collation) const {
+    switch (_types[row]) {
+      case NullCell:
+        return 0;
+      case IntegerCell:
+      case RealCell:
+        return 1;
+      case TextCell:
+        return (collation == NumericCollation) ? 1 : 2;
+      default:
+        return (collation == NumericCollation) ? 1 : 3;
+    }
+  }
+
+  std::vector<unsigned char> _types; // Cell_type of each row, NullCell marks NULLs
+  std::vector<std::int64_t> _integers;
+  std::vector<long double> _numbers; // numeric value of number cells, of text cells once prepared for sorting
+  std::vector<size_t> _offsets;      // text of row n is [_offsets[n], _offsets[n + 1]) of the text buffer
+  std::string _text;
+  std::string _folded_text;
+  bool _has_text_numbers;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * A sqlite LIKE pattern, matched against folded text. The common '%literal%' form (data search) is looked up as a
+ * plain substring.
+ */
+class Recordset_data_index::Like_pattern {
+public:
+  Like_pattern(const std::string &pattern) : _pattern(fold_text(pattern)), _is_substring(false) {
+    if ((_pattern.size() >= 2) && (_pattern[0] == '%') && (_pattern[_pattern.size() - 1] == '%')) {
+      std::string literal = _pattern.substr(1, _pattern.size() - 2);
+      if (literal.find_first_of("%_") == std::string::npos) {
+        _literal = literal;
+        _is_substring = true;
+      }
+    }
+  }
+
+  bool is_substring() const {
+    return _is_substring;
+  }
+
+  const std::string &literal() const {
+    return _literal;
+  }
+
+  bool matches(const char *text, size_t length) const {
+    if (_is_substring)
+      return find_substring(text, length, _literal.data(), _literal.size()) != NULL;
+
+    const char *pattern = _pattern.data();
+    size_t pattern_length = _pattern.size();
+    size_t t = 0, p = 0;
+    size_t star_p = std::string::npos, star_t = 0;
+    while (t < length) {
+      if ((p < pattern_length) && (pattern[p] == '%')) {
+        star_p = ++p;
+        star_t = t;
+      } else if ((p < pattern_length) && (pattern[p] == '_')) {
+        ++p;
+        t = std::min(t + utf8_char_length(text[t]), length);
+      } else if ((p < pattern_length) && (pattern[p] == text[t])) {
+        ++p;
+        ++t;
+      } else if (star_p != std::string::npos) {
+        // let the last % swallow one more character and retry from there
+        star_t = std::min(star_t + utf8_char_length(text[star_t]), length);
+        t = star_t;
+        p = star_p;
+      } else
+        return false;
+    }
+    while ((p < pattern_length) && (pattern[p] == '%'))
+      ++p;
+    return p == pattern_length;
+  }
+
+private:
+  std::string _pattern;
+  std::string _literal;
+  bool _is_substring;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+class Recordset_data_index::Row_less {
+public:
+  Row_less(const std::vector<const Column *> &columns, const Sort_keys &sort_keys)
+    : _columns(columns), _sort_keys(sort_keys) {
+  }
+
+  bool operator()(size_t a, size_t b) const {
+    for (size_t n = 0, count = _sort_keys.size(); n < count; ++n) {
+      int res = _columns[n]->compare(a, b, _sort_keys[n].collation);
+      if (res != 0)
+        return (_sort_keys[n].direction < 0) ? (res > 0) : (res < 0);
+    }
+    return false;
+  }
+
+private:
+  const std::vector<const Column *> &_columns;
+  const Sort_keys &_sort_keys;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+template <typename Iterator, typename Less>
+struct Sort_range {
+  Iterator begin;
+  Iterator end;
+  const Less *less;
+
+  static gpointer sort(gpointer data) {
+    Sort_range *range = static_cast<Sort_range *>(data);
+    std::stable_sort(range->begin, range->end, *range->less);
+    return NULL;
+  }
+};
+
+// stable sort of consecutive chunks in worker threads, merged back pairwise afterwards
+template <typename Iterator, typename Less>
+static void parallel_stable_sort(Iterator begin, Iterator end, const Less &less) {
+  size_t count = end - begin;
+  size_t thread_count = std::min<size_t>(MAX_SORT_THREAD_COUNT, g_get_num_processors());
+  if ((count < PARALLEL_SORT_MIN_ROW_COUNT) || (thread_count < 2)) {
+    std::stable_sort(begin, end, less);
+    return;
+  }
+
+  std::vector<Sort_range<Iterator, Less> > ranges(thread_count);
+  size_t chunk_size = (count + thread_count - 1) / thread_count;
+  for (size_t n = 0; n < thread_count; ++n) {
+    ranges[n].begin = begin + std::min(n * chunk_size, count);
+    ranges[n].end = begin + std::min((n + 1) * chunk_size, count);
+    ranges[n].less = &less;
+  }
+
+  std::vector<GThread *> threads(thread_count, (GThread *)NULL);
+  for (size_t n = 1; n < thread_count; ++n) {
+    threads[n] = base::create_thread(&Sort_range<Iterator, Less>::sort, &ranges[n]);
+    if (threads[n] == NULL)
+      Sort_range<Iterator, Less>::sort(&ranges[n]);
+  }
+  Sort_range<Iterator, Less>::sort(&ranges[0]);
+  for (size_t n = 1; n < thread_count; ++n)
+    if (threads[n] != NULL)
+      g_thread_join(threads[n]);
+
+  for (size_t width = 1; width < thread_count; width *= 2)
+    for (size_t n = 0; n + width < thread_count; n += 2 * width)
+      std::inplace_merge(ranges[n].begin, ranges[n + width].begin,
+                         ranges[std::min(n + 2 * width, thread_count) - 1].end, less);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void Recordset_data_index::mark_matches(const Column &column, const Like_pattern &pattern, const Rows &rows,
+                                        std::vector<bool> &matched) {
+  // with most of the rows still in question it's cheaper to scan the whole text buffer for substring occurrences
+  // than to look at each row separately
+  if (pattern.is_substring() && !pattern.literal().empty() && (rows.size() > column.size() / 4)) {
+    const std::string &literal = pattern.literal();
+    const std::string &text = column.folded_text();
+    size_t offset = 0;
+    size_t row = 0;
+    while (offset < text.size()) {
+      const char *hit =
+        find_substring(text.data() + offset, text.size() - offset, literal.data(), literal.size());
+      if (hit == NULL)
+        break;
+      size_t hit_offset = hit - text.data();
+      row = column.row_at(hit_offset, row);
+      if (hit_offset + literal.size() <= column.row_end(row)) {
+        matched[row] = true;
+        offset = column.row_end(row);
+      } else
+        offset = hit_offset + 1;
+    }
+    return;
+  }
+
+  for (size_t row : rows)
+    if (!matched[row] && !column.is_null(row) && pattern.matches(column.folded_text(row), column.text_length(row)))
+      matched[row] = true;
+}
+
+static void keep_matched(std::vector<size_t> &rows, const std::vector<bool> &matched) {
+  rows.erase(std::remove_if(rows.begin(), rows.end(), [&matched](size_t row) { return !matched[row]; }), rows.end());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+Recordset_data_index::Recordset_data_index() : _rowids_loaded(false), _filtered(false), _filtered_search_column_count(0) {
+}
+
+//--------------------------------------------------------------------------------------------------
+
+Recordset_data_index::~Recordset_data_index() {
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void Recordset_data_index::invalidate() {
+  reinit(_rowids);
+  _rowids_loaded = false;
+  _columns.clear();
+  reinit(_filtered_rows);
+  _filtered = false;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void Recordset_data_index::invalidate_column(ColumnId column) {
+  _columns.erase(column);
+  reinit(_filtered_rows);
+  _filtered = false;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void Recordset_data_index::rebuild(sqlite::connection *data_swap_db, const Column_filters &column_filters,
+                                   const std::string &search_string, ColumnId search_column_count,
+                                   const Sort_keys &sort_keys) {
+  if (column_filters.empty() && search_string.empty() && sort_keys.empty()) {
+    // natural order of the swap db, nothing to compute
+    reinit(_filtered_rows);
+    _filtered = false;
+
+    sqlide::Sqlite_transaction_guarder transaction_guarder(data_swap_db);
+    sqlite::execute(*data_swap_db, "delete from `data_index`", true);
+    sqlite::execute(*data_swap_db, "insert into `data_index` (`id`) select `id` from `data`", true);
+    transaction_guarder.commit();
+    return;
+  }
+
+  load_rowids(data_swap_db);
+  filter(data_swap_db, column_filters, search_string, search_column_count);
+
+  Rows rows(_filtered_rows);
+  if (!sort_keys.empty())
+    sort(data_swap_db, sort_keys, rows);
+  store(data_swap_db, rows);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void Recordset_data_index::load_rowids(sqlite::connection *data_swap_db) {
+  if (_rowids_loaded)
+    return;
+
+  _rowids.clear();
+  sqlite::query q(*data_swap_db, "select `id` from `data` order by `id`");
+  if (q.emit()) {
+    std::shared_ptr<sqlite::result> rs = BoostHelper::convertPointer(q.get_result());
+    do
+      _rowids.push_back((RowId)rs->get_int64(0));
+    while (rs->next_row());
+  }
+  _rowids_loaded = true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+Recordset_data_index::Column &Recordset_data_index::column(sqlite::connection *data_swap_db, ColumnId column) {
+  std::map<ColumnId, std::shared_ptr<Column> >::iterator i = _columns.find(column);
+  if (i != _columns.end())
+    return *i->second;
+
+  load_rowids(data_swap_db);
+
+  std::shared_ptr<Column> values(new Column());
+  values->reserve(_rowids.size());
+  {
+    std::string partition_suffix =
+      VarGridModel::data_swap_db_partition_suffix(VarGridModel::data_swap_db_column_partition(column));
+    sqlite::query q(*data_swap_db,
+                    strfmt("select `_%u` from `data%s` order by `id`", (unsigned int)column, partition_suffix.c_str()));
+    if (q.emit()) {
+      std::shared_ptr<sqlite::result> rs = BoostHelper::convertPointer(q.get_result());
+      do
+        values->append(rs->get_variant(0));
+      while (rs->next_row());
+    }
+  }
+  if (values->size() != _rowids.size())
+    throw std::logic_error(strfmt("Data swap db column _%u has %u rows, %u expected", (unsigned int)column,
+                                  (unsigned int)values->size(), (unsigned int)_rowids.size()));
+
+  _columns[column] = values;
+  return *values;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void Recordset_data_index::filter(sqlite::connection *data_swap_db, const Column_filters &column_filters,
+                                  const std::string &search_string, ColumnId search_column_count) {
+  // the previous result can be narrowed down if all its conditions still apply, which is the case when filters
+  // are added or the search string gets longer
+  bool refine = _filtered && (_filtered_search_column_count == search_column_count) &&
+                (search_string.find(_filtered_search_string) != std::string::npos);
+  for (Column_filters::const_iterator i = _filtered_column_filters.begin(); refine && (i != _filtered_column_filters.end());
+       ++i) {
+    Column_filters::const_iterator filter = column_filters.find(i->first);
+    refine = (filter != column_filters.end()) && (filter->second == i->second);
+  }
+
+  Rows rows;
+  if (refine)
+    rows.swap(_filtered_rows);
+  else {
+    rows.resize(_rowids.size());
+    std::iota(rows.begin(), rows.end(), 0);
+  }
+  _filtered = false;
+
+  std::vector<bool> matched;
+  for (const Column_filters::value_type &column_filter : column_filters) {
+    if (refine && (_filtered_column_filters.find(column_filter.first) != _filtered_column_filters.end()))
+      continue;
+
+    Column &values = column(data_swap_db, column_filter.first);
+    values.prepare_folded_text();
+    matched.assign(_rowids.size(), false);
+    mark_matches(values, Like_pattern(column_filter.second), rows, matched);
+    keep_matched(rows, matched);
+  }
+
+  if (!search_string.empty() && !(refine && (search_string == _filtered_search_string))) {
+    Like_pattern pattern("%" + search_string + "%");
+    matched.assign(_rowids.size(), false);
+    for (ColumnId col = 0; col < search_column_count; ++col) {
+      Column &values = column(data_swap_db, col);
+      values.prepare_folded_text();
+      mark_matches(values, pattern, rows, matched);
+    }
+    keep_matched(rows, matched);
+  }
+
+  _filtered_rows.swap(rows);
+  _filtered_column_filters = column_filters;
+  _filtered_search_string = search_string;
+  _filtered_search_column_count = search_column_count;
+  _filtered = true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void Recordset_data_index::sort(sqlite::connection *data_swap_db, const Sort_keys &sort_keys, Rows &rows) {
+  std::vector<const Column *> columns;
+  columns.reserve(sort_keys.size());
+  for (const Sort_key &sort_key : sort_keys) {
+    Column &values = column(data_swap_db, sort_key.column);
+    values.prepare(sort_key.collation);
+    columns.push_back(&values);
+  }
+
+  parallel_stable_sort(rows.begin(), rows.end(), Row_less(columns, sort_keys));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void Recordset_data_index::store(sqlite::connection *data_swap_db, const Rows &rows) {
+  sqlide::Sqlite_transaction_guarder transaction_guarder(data_swap_db);
+
+  sqlite::execute(*data_swap_db, "delete from `data_index`", true);
+
+  size_t n = 0;
+  if (rows.size() >= DATA_INDEX_INSERT_BATCH_SIZE) {
+    std::string sql = "insert into `data_index` (`id`) values (?)";
+    for (size_t i = 1; i < DATA_INDEX_INSERT_BATCH_SIZE; ++i)
+      sql.append(", (?)");
+    sqlite::command insert_batch_statement(*data_swap_db, sql);
+    for (; n + DATA_INDEX_INSERT_BATCH_SIZE <= rows.size(); n += DATA_INDEX_INSERT_BATCH_SIZE) {
+      insert_batch_statement.clear();
+      for (size_t i = n; i < n + DATA_INDEX_INSERT_BATCH_SIZE; ++i)
+        insert_batch_statement % (std::int64_t)_rowids[rows[i]];
+      insert_batch_statement.emit();
+    }
+  }
+  if (n < rows.size()) {
+    sqlite::command insert_statement(*data_swap_db, "insert into `data_index` (`id`) values (?)");
+    for (; n < rows.size(); ++n) {
+      insert_statement.clear();
+      insert_statement % (std::int64_t)_rowids[rows[n]];
+      insert_statement.emit();
+    }
+  }
+
+  transaction_guarder.commit();
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2017, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#pragma once
+
+#include "wbpublic_public_interface.h"
+#include "sqlide/sqlide_generics.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Computes the `data_index` table of a recordset (which rows of the data swap db are visible and in what order)
+ * in memory, instead of running a filtering/sorting query over all data partitions.
+ *
+ * Values of the columns taking part in filtering or sorting are loaded once from the swap db into typed column
+ * buffers and kept until the recordset data changes. The last filtering result is kept as well, so that sorting
+ * a filtered recordset or refining a filter (e.g. typing more characters of a search string) only has to look
+ * at the rows that are still visible.
+ */
+class WBPUBLICBACKEND_PUBLIC_FUNC Recordset_data_index {
+public:
+  // mirror the sqlite collations the index used to be built with
+  enum Collation {
+    NumericCollation, // `cast(value as numeric)`
+    NocaseCollation,  // `value collate nocase`
+    BinaryCollation   // plain `value`
+  };
+
+  struct Sort_key {
+    ColumnId column;
+    int direction; // 1 - ascending, -1 - descending
+    Collation collation;
+  };
+  typedef std::vector<Sort_key> Sort_keys;
+  typedef std::map<ColumnId, std::string> Column_filters; // column:like pattern
+
+  Recordset_data_index();
+  ~Recordset_data_index();
+
+  // must be called whenever rows are added to or removed from the swap db
+  void invalidate();
+  // must be called whenever a value of the given column changes in the swap db
+  void invalidate_column(ColumnId column);
+
+  void rebuild(sqlite::connection *data_swap_db, const Column_filters &column_filters,
+               const std::string &search_string, ColumnId search_column_count, const Sort_keys &sort_keys);
+
+private:
+  class Column;
+  class Like_pattern;
+  class Row_less;
+  typedef std::vector<size_t> Rows; // positions in _rowids
+
+  void load_rowids(sqlite::connection *data_swap_db);
+  Column &column(sqlite::connection *data_swap_db, ColumnId column);
+  void filter(sqlite::connection *data_swap_db, const Column_filters &column_filters,
+              const std::string &search_string, ColumnId search_column_count);
+  void sort(sqlite::connection *data_swap_db, const Sort_keys &sort_keys, Rows &rows);
+  void store(sqlite::connection *data_swap_db, const Rows &rows);
+  // marks rows (of the given candidates) whose value matches the pattern
+  static void mark_matches(const Column &column, const Like_pattern &pattern, const Rows &rows,
+                           std::vector<bool> &matched);
+
+  std::vector<RowId> _rowids; // ids of all rows in the swap db, ascending
+  bool _rowids_loaded;
+  std::map<ColumnId, std::shared_ptr<Column> > _columns;
+
+  // last filtering result & the conditions it was computed for
+  Rows _filtered_rows;
+  bool _filtered;
+  Column_filters _filtered_column_filters;
+  std::string _filtered_search_string;
+  ColumnId _filtered_search_column_count;
+};
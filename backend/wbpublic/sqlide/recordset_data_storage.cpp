@@ -58,6 +58,7 @@ void Recordset_data_storage::serialize(Recordset::Ptr recordset_ptr) {
 void Recordset_data_storage::unserialize(Recordset::Ptr recordset_ptr) {
   RETURN_IF_FAIL_TO_RETAIN_WEAK_PTR(Recordset, recordset_ptr, recordset)
   std::shared_ptr<sqlite::connection> data_swap_db = recordset->data_swap_db();
+  recordset->_data_index.invalidate();
   do_unserialize(recordset, data_swap_db.get());
   recordset->rebuild_data_index(data_swap_db.get(), false, false);
 }
@@ -80,6 +81,7 @@ void Recordset_data_storage::fetch_blob_value(Recordset *recordset, sqlite::conn
     sqlide::Sqlite_transaction_guarder transaction_guarder(data_swap_db);
     update_data_swap_record(data_swap_db, rowid, column, blob_value);
     transaction_guarder.commit();
+    recordset->_data_index.invalidate_column(column);
   }
 }
 
@@ -190,6 +192,21 @@ void Recordset_data_storage::add_data_swap_record(std::list<std::shared_ptr<sqli
   }
 }
 
+void Recordset_data_storage::store_rows(sqlite::connection *data_swap_db, Recordset::Column_names &column_names,
+                                        const Row_batch &rows) {
+  if (rows.empty())
+    return;
+
+  sqlide::Sqlite_transaction_guarder transaction_guarder(data_swap_db, false);
+
+  std::list<std::shared_ptr<sqlite::command> > insert_commands =
+    prepare_data_swap_record_add_statement(data_swap_db, column_names);
+  for (const Var_vector &row_values : rows)
+    add_data_swap_record(insert_commands, row_values);
+
+  transaction_guarder.commit();
+}
+
 void Recordset_data_storage::update_data_swap_record(sqlite::connection *data_swap_db, RowId rowid, ColumnId column,
                                                      const sqlite::variant_t &value) {
   size_t partition = Recordset::data_swap_db_column_partition(column);
@@ -40,6 +40,7 @@ protected:
 public:
   typedef std::list<sqlite::variant_t> Var_list;
   typedef std::vector<sqlite::variant_t> Var_vector;
+  typedef Recordset::Row_batch Row_batch;
 
 protected:
   std::shared_ptr<sqlite::connection> data_swap_db(const Recordset::Ref &recordset);
@@ -54,6 +55,22 @@ protected:
   virtual void fetch_blob_value(Recordset *recordset, sqlite::connection *data_swap_db, RowId rowid, ColumnId column,
                                 sqlite::variant_t &blob_value);
 
+public:
+  // whether the last unserialize left rows to be fetched later on by Recordset::fetch_pending_rows
+  virtual bool has_pending_rows() {
+    return false;
+  }
+
+protected:
+  // reads up to max_row_count pending rows into rows, returns false when no rows are left. runs in the thread that
+  // executed the query and doesn't touch the data swap db, the rows are stored by store_rows in the main thread
+  virtual bool do_fetch_pending_rows(size_t max_row_count, Row_batch &rows) {
+    return false;
+  }
+  virtual void discard_pending_rows() {
+  }
+  void store_rows(sqlite::connection *data_swap_db, Recordset::Column_names &column_names, const Row_batch &rows);
+
 protected:
   virtual void do_apply_changes(const Recordset *recordset, sqlite::connection *data_swap_db, bool skip_commit) = 0;
   virtual void do_serialize(const Recordset *recordset, sqlite::connection *data_swap_db) = 0;
@@ -62,6 +62,7 @@ static void process_templates(const std::list<std::string> &files) {
       info.include_column_types = cf.get_value("include_column_types");
       info.null_syntax = cf.get_value("null_syntax");
       info.row_separator = cf.get_value("row_separator");
+      info.row_writer = cf.get_value("row_writer");
       if (info.include_column_types != "xls")
         info.include_column_types = "";
       std::string args = cf.get_value("arguments");
@@ -114,11 +115,19 @@ struct CSVTokenQuoteModifier : public mtemplate::Modifier {
   }
 };
 
+// string escaper for JSON strings, the quotes around the string are part of the template
+struct JSONEscapeModifier : public mtemplate::Modifier {
+  virtual base::utf8string modify(const base::utf8string &input, const base::utf8string arg = "") {
+    return base::escape_json_string(input);
+  }
+};
+
 Recordset_text_storage::Recordset_text_storage() : Recordset_data_storage() {
-  static bool registered_csvquote = false;
-  if (!registered_csvquote) {
-    registered_csvquote = true;
+  static bool registered_modifiers = false;
+  if (!registered_modifiers) {
+    registered_modifiers = true;
     mtemplate::Modifier::addModifier<CSVTokenQuoteModifier>("csv_quote");
+    mtemplate::Modifier::addModifier<JSONEscapeModifier>("json_escape");
   }
 }
 
@@ -142,6 +151,121 @@ static std::string escape_json_string_(const std::string &s) {
   return base::escape_json_string(s);
 }
 
+// Formats data rows for the templates that name a row_writer in their .tpli file, producing the same text their row
+// template would (field names in JSON go through the same escaping as the json_escape modifier in JSON.tpl). Avoids
+// creating a dictionary for every row & field (which dominated exports of big resultsets) and collects the output in
+// a large buffer instead of writing it piece by piece. flush() must be called once all rows were added, what's left in
+// the buffer is dropped on destruction so that a failed export doesn't throw from there.
+class Row_writer {
+public:
+  Row_writer(const std::string &format, const Recordset::Column_names &column_names, const std::string &row_separator,
+             const std::string &table_name, mtemplate::TemplateOutput &output)
+    : _row_separator(row_separator), _output(output) {
+    if (format == "csv" || format == "csv_semicolon" || format == "tab") {
+      _format = CSVFormat;
+      // same rules as the csv_quote modifier
+      if (format == "tab") {
+        _separator = "\t";
+        _quoted_chars = "\t";
+      } else {
+        _separator = (format == "csv") ? "," : ";";
+        _quoted_chars = " \"\t\r\n" + _separator;
+      }
+    } else if (format == "json") {
+      _format = JSONFormat;
+      for (const std::string &name : column_names)
+        _field_prefixes.push_back("\n\t\t\"" + base::escape_json_string(name) + "\" : ");
+    } else if (format == "sql_inserts") {
+      _format = SQLInsertsFormat;
+      _row_prefix = "INSERT INTO `" + table_name + "` (";
+      for (size_t i = 0; i < column_names.size(); ++i)
+        _row_prefix.append(i > 0 ? ",`" : "`").append(column_names[i]).append("`");
+      _row_prefix.append(") VALUES (");
+    } else
+      throw std::invalid_argument(strfmt("Unknown row writer %s", format.c_str()));
+    _buffer.reserve(BUFFER_SIZE + BUFFER_SIZE / 4);
+  }
+
+  void begin_row() {
+    switch (_format) {
+      case CSVFormat:
+        break;
+      case JSONFormat:
+        _buffer.append("\t{");
+        break;
+      case SQLInsertsFormat:
+        _buffer.append(_row_prefix);
+        break;
+    }
+  }
+
+  void add_field(ColumnId column, const std::string &value) {
+    switch (_format) {
+      case CSVFormat:
+        if (column > 0)
+          _buffer.append(_separator);
+        if (value.find_first_of(_quoted_chars) == std::string::npos)
+          _buffer.append(value);
+        else {
+          _buffer.push_back('"');
+          for (char c : value) {
+            if (c == '"')
+              _buffer.push_back('"');
+            _buffer.push_back(c);
+          }
+          _buffer.push_back('"');
+        }
+        break;
+      case JSONFormat:
+        if (column > 0)
+          _buffer.push_back(',');
+        _buffer.append(_field_prefixes[column]).append(value);
+        break;
+      case SQLInsertsFormat:
+        if (column > 0)
+          _buffer.push_back(',');
+        _buffer.append(value);
+        break;
+    }
+  }
+
+  void end_row(bool last_row) {
+    switch (_format) {
+      case CSVFormat:
+        _buffer.push_back('\n');
+        break;
+      case JSONFormat:
+        _buffer.append("\n\t}").append(last_row ? "" : _row_separator).push_back('\n');
+        break;
+      case SQLInsertsFormat:
+        _buffer.append(");\n");
+        break;
+    }
+    if (_buffer.size() >= BUFFER_SIZE)
+      flush();
+  }
+
+  void flush() {
+    if (!_buffer.empty()) {
+      _output.out(_buffer);
+      _buffer.clear();
+    }
+  }
+
+private:
+  enum Format { CSVFormat, JSONFormat, SQLInsertsFormat };
+  static const size_t BUFFER_SIZE = 1024 * 1024;
+
+  Format _format;
+  std::string _separator;
+  std::string _quoted_chars;
+  std::vector<std::string> _field_prefixes;
+  std::string _row_prefix;
+  std::string _row_separator;
+  std::string _buffer;
+  mtemplate::TemplateOutput &_output;
+};
+
 void Recordset_text_storage::do_serialize(const Recordset *recordset, sqlite::connection *data_swap_db) {
   const TemplateInfo &info(template_info(_data_format));
   std::string template_name(info.name);
@@ -256,7 +380,41 @@ void Recordset_text_storage::do_serialize(const Recordset *recordset, sqlite::co
       Recordset::prepare_partition_queries(data_swap_db, "select * from `data%s`", data_queries);
       std::vector<std::shared_ptr<sqlite::result> > data_results(data_queries.size());
 
-      if (Recordset::emit_partition_queries(data_swap_db, data_queries, data_results)) {
+      if (!info.row_writer.empty()) {
+        if (Recordset::emit_partition_queries(data_swap_db, data_queries, data_results)) {
+          Row_writer row_writer(info.row_writer, *column_names, info.row_separator, parameter_value("TABLE_NAME"),
+                                output);
+          sqlide::VarToStr var_to_str;
+          std::string field_value;
+          bool next_row_exists = true;
+          sqlite::variant_t v;
+          do {
+            row_writer.begin_row();
+            for (size_t partition = 0; partition < partition_count; ++partition) {
+              std::shared_ptr<sqlite::result> &data_rs = data_results[partition];
+              for (ColumnId col_begin = partition * Recordset::DATA_SWAP_DB_TABLE_MAX_COL_COUNT, col = col_begin,
+                            col_end = std::min<ColumnId>(
+                              visible_col_count, (partition + 1) * Recordset::DATA_SWAP_DB_TABLE_MAX_COL_COUNT);
+                   col < col_end; ++col) {
+                v = data_rs->get_variant((int)(col - col_begin));
+                if (sqlide::is_var_null(v))
+                  field_value = null_syntax;
+                else if (strings_are_pre_quoted && (column_flags[col] & Recordset::NeedsQuoteFlag))
+                  field_value = boost::apply_visitor(qv, column_types[col], v);
+                else
+                  field_value = boost::apply_visitor(var_to_str, v);
+                row_writer.add_field(col, field_value);
+              }
+            }
+
+            for (std::shared_ptr<sqlite::result> &data_rs : data_results)
+              next_row_exists = data_rs->next_row();
+
+            row_writer.end_row(!next_row_exists);
+          } while (next_row_exists);
+          row_writer.flush();
+        }
+      } else if (Recordset::emit_partition_queries(data_swap_db, data_queries, data_results)) {
         bool next_row_exists = true;
         sqlite::variant_t v;
         do {
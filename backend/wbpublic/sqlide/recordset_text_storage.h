@@ -32,6 +32,7 @@ public:
     std::string include_column_types; // syntax type
     std::string null_syntax;
     std::string row_separator;
+    std::string row_writer; // csv, csv_semicolon, tab, json or sql_inserts: rows are formatted without the template
     bool pre_quote_strings;
     std::string quote;
   };
@@ -37,11 +37,14 @@
 #include "mforms/filechooser.h"
 
 #include "grts/structs.db.mysql.h"
+#include "grtdb/db_helpers.h"
 
 #include "mysql-scanner.h"
 #include "code-completion/mysql-code-completion.h"
 #include "sql_editor_be.h"
 
+#include <unordered_map>
+
 DEFAULT_LOG_DOMAIN("MySQL editor");
 
 using namespace bec;
@@ -84,6 +87,8 @@ public:
   std::pair<const char *, size_t> _text_info; // Only valid during a parse run.
 
   std::vector<ParserErrorEntry> _recognition_errors; // List of errors from the last sql check run.
+
+  StatementErrorsCache _statement_errors_cache; // Filled with the settings returned by parse_settings().
   std::set<size_t> _error_marker_lines;
 
   bool _splitting_required;
@@ -129,6 +134,17 @@ public:
 
   //------------------------------------------------------------------------------------------------
 
+  /**
+   * Returns a description of everything besides the statement text that determines the result of a syntax check.
+   */
+  std::string parse_settings() {
+    GrtVersionRef version = _parser_context->get_server_version();
+    return base::strfmt("%s|%i|%i", _parser_context->get_sql_mode().c_str(),
+                        version.is_valid() ? bec::version_to_int(version) : 0, (int)_parse_unit);
+  }
+
+  //------------------------------------------------------------------------------------------------
+
   /**
    * Determines ranges for all statements in the current text.
    */
@@ -189,6 +205,61 @@ public:
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * Starts a new check run. All results are dropped if the settings changed since the previous run.
+ */
+void StatementErrorsCache::begin_run(const std::string &settings) {
+  _checked_entries.clear();
+  if (settings != _settings) {
+    _entries.clear();
+    _settings = settings;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the errors of the statement, either from the previous or the current run or by calling the checker.
+ */
+const std::vector<ParserErrorEntry> &StatementErrorsCache::errors(const std::string &statement,
+                                                                  const Checker &checker) {
+  Entries::iterator entry = _checked_entries.find(statement);
+  if (entry != _checked_entries.end())
+    return entry->second;
+
+  Entries::iterator cached = _entries.find(statement);
+  if (cached != _entries.end()) {
+    entry = _checked_entries.insert(std::move(*cached)).first;
+    _entries.erase(cached);
+  } else
+    entry = _checked_entries.insert(std::make_pair(statement, checker(statement))).first;
+  return entry->second;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Ends a run that was stopped because the text changed. What was checked so far is kept for the next run,
+ * together with the results of the previous run.
+ */
+void StatementErrorsCache::interrupt_run() {
+  _entries.insert(std::make_move_iterator(_checked_entries.begin()), std::make_move_iterator(_checked_entries.end()));
+  _checked_entries.clear();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Ends a complete run. Results for statements that no longer exist are dropped, to keep the cache in line with
+ * the text.
+ */
+void StatementErrorsCache::end_run() {
+  _entries.swap(_checked_entries);
+  _checked_entries.clear();
+}
+
+//--------------------------------------------------------------------------------------------------
+
 MySQLEditor::Ref MySQLEditor::create(MySQLParserContext::Ref syntax_check_context,
                                      MySQLParserContext::Ref autocopmlete_context, db_query_QueryBufferRef grtobj) {
   Ref sql_editor = MySQLEditor::Ref(new MySQLEditor(syntax_check_context, autocopmlete_context));
@@ -738,18 +809,31 @@ bool MySQLEditor::do_statement_split_and_check(int id) {
   base::RecMutexLock lock(d->_sql_checker_mutex);
 
   // Now do error checking for each of the statements, collecting error positions for later markup.
+  // Only statements not checked in the previous run are parsed, for all others the cached result is used.
+  StatementErrorsCache::Checker checker = [this](const std::string &statement) {
+    std::vector<ParserErrorEntry> errors;
+    if (d->_services->checkSqlSyntax(d->_parser_context, statement.c_str(), statement.size(), d->_parse_unit) > 0)
+      errors = d->_parser_context->get_errors_with_offset(0, true);
+    return errors;
+  };
+
+  d->_statement_errors_cache.begin_run(d->parse_settings());
   d->_last_sql_check_progress_msg_timestamp = timestamp();
   for (std::vector<std::pair<size_t, size_t>>::const_iterator range_iterator = d->_statement_ranges.begin();
        range_iterator != d->_statement_ranges.end(); ++range_iterator) {
-    if (d->_stop_processing)
+    if (d->_stop_processing) {
+      d->_statement_errors_cache.interrupt_run();
       return false;
+    }
 
-    if (d->_services->checkSqlSyntax(d->_parser_context, d->_text_info.first + range_iterator->first,
-                                     range_iterator->second, d->_parse_unit) > 0) {
-      std::vector<ParserErrorEntry> errors = d->_parser_context->get_errors_with_offset(range_iterator->first, true);
-      d->_recognition_errors.insert(d->_recognition_errors.end(), errors.begin(), errors.end());
+    std::string statement(d->_text_info.first + range_iterator->first, range_iterator->second);
+    const std::vector<ParserErrorEntry> &errors = d->_statement_errors_cache.errors(statement, checker);
+    for (std::vector<ParserErrorEntry>::const_iterator error = errors.begin(); error != errors.end(); ++error) {
+      d->_recognition_errors.push_back(*error);
+      d->_recognition_errors.back().position += range_iterator->first;
     }
   }
+  d->_statement_errors_cache.end_run();
 
   bec::GRTManager::get()->run_once_when_idle(this, std::bind(&MySQLEditor::update_error_markers, this));
 
@@ -24,8 +24,10 @@
 #include "base/trackable.h"
 
 #ifndef _WIN32
+#include <functional>
 #include <memory>
 #include <set>
+#include <unordered_map>
 
 #include "grts/structs.db.mgmt.h"
 #include "grts/structs.db.query.h"
@@ -52,6 +54,34 @@ namespace mforms {
 class MySQLObjectNamesCache;
 class MySQLRecognizer;
 
+/**
+ * Syntax errors found per statement in the last sql check run of an editor, keyed by statement text (error positions
+ * are relative to the statement start). Statements that didn't change since then are not parsed again.
+ * The results are only valid for the settings (sql mode, server version, parse unit) they were found with.
+ */
+class WBPUBLICBACKEND_PUBLIC_FUNC StatementErrorsCache {
+public:
+  typedef std::function<std::vector<parser::ParserErrorEntry>(const std::string &statement)> Checker;
+
+  void begin_run(const std::string &settings);
+  const std::vector<parser::ParserErrorEntry> &errors(const std::string &statement, const Checker &checker);
+  void interrupt_run();
+  void end_run();
+
+  size_t count() const {
+    return _entries.size();
+  }
+
+private:
+  typedef std::unordered_map<std::string, std::vector<parser::ParserErrorEntry>> Entries;
+
+  Entries _entries;         // Results of the previous run.
+  Entries _checked_entries; // Results of the current run.
+  std::string _settings;
+};
+
+//--------------------------------------------------------------------------------------------------
+
 /**
  * The legacy MySQL editor class.
  */
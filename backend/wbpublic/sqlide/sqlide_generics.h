@@ -146,6 +146,13 @@ namespace sqlide {
     result_type operator()(const std::string &t, const std::string &v) {
       return v;
     }
+    // integer columns can be kept natively in the data swap db while being presented as strings
+    result_type operator()(const std::string &t, const int &v) {
+      return std::to_string(v);
+    }
+    result_type operator()(const std::string &t, const std::int64_t &v) {
+      return std::to_string(v);
+    }
     template <typename T>
     result_type operator()(const T &t, const std::string &v) {
       T res;
@@ -344,6 +351,9 @@ namespace sqlide {
     result_type operator()(const int &v) const {
       return "INTEGER";
     }
+    result_type operator()(const std::int64_t &v) const {
+      return "INTEGER";
+    }
     result_type operator()(const std::string &v) const {
       return "VARCHAR";
     }
@@ -172,6 +172,12 @@ TEST_FUNCTION(12) {
   list2 = _cache->getMatchingViewNames("sakila", "ac");
   std::copy(list2.begin(), list2.end(), std::back_inserter(list));
   ensure_list_equals("tables sakila.actor_*", list, sakila_actor_);
+
+  // Prefix matching ignores the letter case.
+  list = _cache->getMatchingTableNames("sakila", "AC");
+  list2 = _cache->getMatchingViewNames("sakila", "aC");
+  std::copy(list2.begin(), list2.end(), std::back_inserter(list));
+  ensure_list_equals("tables sakila.AC*", list, sakila_ac);
 }
 
 TEST_FUNCTION(14) {
@@ -268,4 +274,175 @@ TEST_FUNCTION(28) {
   ensure_list_equals("columns sakila.actor.a*", list, sakila_a);
 }
 
+//--------------------------------------------------------------------------------------------------
+
+// Schemas snap and other, with tables, a view plus columns and triggers (type 1 and 2) of snap.actor and other.a:b.
+static const std::string validSnapshot =
+  "MySQLObjectNamesCache snapshot 1\n"
+  "T7:schemas2:5:other4:snap"
+  "S5:other6:tables1:3:a:b"
+  "S4:snap6:tables2:5:actor4:film"
+  "S4:snap5:views1:10:actor_info"
+  "C5:other3:a:b1:1:1:x"
+  "C4:snap5:actor1:2:8:actor_id10:first_name"
+  "C4:snap5:actor2:1:10:actor_trig";
+
+static void writeSnapshot(const std::string &path, const std::string &contents) {
+  ensure("snapshot file written",
+         g_file_set_contents(path.c_str(), contents.data(), (gssize)contents.size(), NULL) != FALSE);
+}
+
+// A cache without a server behind it. Once the initial refresh ran all caches are empty, and as long as only
+// lookups without a schema are used no further refresh is triggered which could overwrite the snapshot data.
+static MySQLObjectNamesCache *createOfflineCache() {
+  MySQLObjectNamesCache *cache =
+    new MySQLObjectNamesCache([](const std::string &) { return std::vector<std::pair<std::string, std::string>>(); },
+                              std::function<void(bool)>());
+  g_usleep(1000000);
+  return cache;
+}
+
+static void deleteCache(MySQLObjectNamesCache *cache) {
+  cache->shutdown();
+  delete cache;
+}
+
+static void ensureSnapshotContent(MySQLObjectNamesCache *cache) {
+  static const char *schemas[] = {"other", "snap", NULL};
+  static const char *tables[] = {"a:b", "actor", "film", NULL};
+  static const char *views[] = {"actor_info", NULL};
+  static const char *actor_columns[] = {"actor_id", "first_name", NULL};
+  static const char *actor_triggers[] = {"actor_trig", NULL};
+  static const char *ab_columns[] = {"x", NULL};
+
+  ensure_list_equals("snapshot schemas", cache->getMatchingSchemaNames(), schemas);
+  ensure_list_equals("snapshot tables", cache->getMatchingTableNames(), tables);
+  ensure_list_equals("snapshot views", cache->getMatchingViewNames("", "ACT"), views);
+  ensure_list_equals("snapshot columns actor", cache->getMatchingColumnNames("", "actor"), actor_columns);
+  ensure_list_equals("snapshot triggers actor", cache->getMatchingTriggerNames("", "actor"), actor_triggers);
+  ensure_list_equals("snapshot columns a:b", cache->getMatchingColumnNames("", "a:b"), ab_columns);
+}
+
+// Snapshot round trip: load a hand written file, save it and load the saved file into another cache.
+TEST_FUNCTION(30) {
+  writeSnapshot("name_cache_snapshot_in", validSnapshot);
+
+  MySQLObjectNamesCache *cache = createOfflineCache();
+  ensure("snapshot loaded", cache->loadSnapshot("name_cache_snapshot_in"));
+  ensureSnapshotContent(cache);
+  ensure("snapshot saved", cache->saveSnapshot("name_cache_snapshot_out"));
+  deleteCache(cache);
+
+  cache = createOfflineCache();
+  ensure("saved snapshot loaded", cache->loadSnapshot("name_cache_snapshot_out"));
+  ensureSnapshotContent(cache);
+  ensure("snapshot saved again", cache->saveSnapshot("name_cache_snapshot_out2"));
+  deleteCache(cache);
+
+  gchar *saved = NULL, *savedAgain = NULL;
+  ensure("saved snapshot read", g_file_get_contents("name_cache_snapshot_out", &saved, NULL, NULL) != FALSE);
+  ensure("saved snapshot read", g_file_get_contents("name_cache_snapshot_out2", &savedAgain, NULL, NULL) != FALSE);
+  ensure_equals("snapshot unchanged by the round trip", std::string(saved), std::string(savedAgain));
+  g_free(saved);
+  g_free(savedAgain);
+
+  base::remove("name_cache_snapshot_in");
+  base::remove("name_cache_snapshot_out");
+  base::remove("name_cache_snapshot_out2");
+}
+
+// Invalid snapshots are rejected as a whole and leave the cache untouched.
+TEST_FUNCTION(32) {
+  static const char *header = "MySQLObjectNamesCache snapshot 1\n";
+  const std::string invalidSnapshots[] = {
+    "",
+    "MySQLObjectNames",
+    "MySQLObjectNamesCache snapshot 2\nT7:schemas1:4:snap",
+    "T7:schemas1:4:snap",
+    validSnapshot.substr(0, validSnapshot.size() - 1), // Truncated name.
+    validSnapshot.substr(0, validSnapshot.size() - 4), // Truncated name list.
+    validSnapshot.substr(0, validSnapshot.size() - 16), // Truncated record header.
+    std::string(header) + "X7:schemas1:4:snap",        // Unknown record type.
+    std::string(header) + "T7:schemas2:4:snap",         // Fewer names than announced.
+    std::string(header) + "T70:schemas1:4:snap",        // String length beyond the end.
+    std::string(header) + "T7:schemas1;4:snap",         // Missing separator.
+    std::string(header) + "C4:snap5:actor0:1:1:x",      // Record for schema objects stored as table objects.
+    std::string(header) + "C4:snap5:actor7:1:1:x",      // Unknown table object type.
+  };
+
+  MySQLObjectNamesCache *cache = createOfflineCache();
+  ensure("missing snapshot", !cache->loadSnapshot("name_cache_snapshot_missing"));
+
+  for (auto &snapshot : invalidSnapshots) {
+    writeSnapshot("name_cache_snapshot_bad", snapshot);
+    ensure("invalid snapshot rejected: " + snapshot, !cache->loadSnapshot("name_cache_snapshot_bad"));
+  }
+
+  ensure("no schemas from invalid snapshots", cache->getMatchingSchemaNames().empty());
+  ensure("no tables from invalid snapshots", cache->getMatchingTableNames().empty());
+  ensure("no columns from invalid snapshots", cache->getMatchingColumnNames("", "").empty());
+  ensure("no triggers from invalid snapshots", cache->getMatchingTriggerNames("", "").empty());
+
+  // Only the header is a valid (empty) snapshot.
+  writeSnapshot("name_cache_snapshot_bad", header);
+  ensure("empty snapshot", cache->loadSnapshot("name_cache_snapshot_bad"));
+  deleteCache(cache);
+
+  base::remove("name_cache_snapshot_bad");
+}
+
+// Names from a snapshot for objects the server no longer has are dropped.
+TEST_FUNCTION(34) {
+  static const char *tables[] = {"film", NULL};
+  static const char *views[] = {"film_list", NULL};
+  static const char *ab_columns[] = {"x", NULL};
+
+  writeSnapshot("name_cache_snapshot_in", validSnapshot);
+
+  // Schema objects already fetched from the server win over the snapshot, columns and triggers of the tables
+  // which are gone are removed when merging the snapshot.
+  MySQLObjectNamesCache *cache = createOfflineCache();
+  base::StringListPtr serverTables(new base::StringList({"film"}));
+  base::StringListPtr serverViews(new base::StringList({"film_list"}));
+  cache->updateTables("snap", serverTables);
+  cache->updateViews("snap", serverViews);
+  ensure("snapshot loaded", cache->loadSnapshot("name_cache_snapshot_in"));
+
+  ensure_list_equals("server tables kept", cache->getMatchingTableNames("", "f"), tables);
+  ensure_list_equals("server views kept", cache->getMatchingViewNames(), views);
+  ensure("columns of dropped table removed", cache->getMatchingColumnNames("", "actor").empty());
+  ensure("triggers of dropped table removed", cache->getMatchingTriggerNames("", "actor").empty());
+  ensure_list_equals("columns of other schemas kept", cache->getMatchingColumnNames("", "a:b"), ab_columns);
+
+  // A new table list from the server removes the columns of tables no longer in it.
+  cache->updateTables("other", serverTables);
+  cache->updateViews("other", serverViews);
+  ensure("columns of table dropped later removed", cache->getMatchingColumnNames("", "a:b").empty());
+  deleteCache(cache);
+
+  // Schemas the server no longer reports are removed entirely.
+  cache = createOfflineCache();
+  cache->updateSchemas({"snap"});
+  ensure("snapshot loaded", cache->loadSnapshot("name_cache_snapshot_in"));
+
+  static const char *schemas[] = {"snap", NULL};
+  static const char *snap_tables[] = {"actor", "film", NULL};
+  ensure_list_equals("server schemas kept", cache->getMatchingSchemaNames(), schemas);
+  ensure_list_equals("tables of dropped schema removed", cache->getMatchingTableNames(), snap_tables);
+  ensure("columns of dropped schema removed", cache->getMatchingColumnNames("", "a:b").empty());
+  ensure("columns of kept schema", !cache->getMatchingColumnNames("", "actor").empty());
+
+  // Nothing of the dropped schema is written to a new snapshot either.
+  ensure("snapshot saved", cache->saveSnapshot("name_cache_snapshot_out"));
+  deleteCache(cache);
+
+  gchar *saved = NULL;
+  ensure("saved snapshot read", g_file_get_contents("name_cache_snapshot_out", &saved, NULL, NULL) != FALSE);
+  ensure("dropped schema not saved", std::string(saved).find("other") == std::string::npos);
+  g_free(saved);
+
+  base::remove("name_cache_snapshot_in");
+  base::remove("name_cache_snapshot_out");
+}
+
 END_TESTS
@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2017, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include "sqlide/recordset_data_index.h"
+#include "base/string_utilities.h"
+#include "base/boost_smart_ptr_helpers.h"
+#include "wb_helpers.h"
+
+#include <sqlite/execute.hpp>
+#include <sqlite/query.hpp>
+
+using namespace base;
+
+static const ColumnId COLUMN_COUNT = 4;
+
+// Columns of the test data: _0 text, _1 integer, _2 text, _3 real.
+static const char *test_rows[] = {
+  "'apple', 10, 'a%b', 1.5",
+  "'Apple', 2, 'a_b', NULL",
+  "NULL, NULL, 'A\\b', 100.0",
+  "'banana', 10, 'ab', -3.25",
+  "'BANANA', -5, NULL, 2",
+  "'cherry', 7, '50%', 0.5",
+  "'apple pie', 100, 'x_y', 1e20",
+  "'', 0, '%', 10",
+  "'\xC3\x84rger', 3, '\xC3\xA4', 7",
+  "'12abc', 12, '12', 12.0",
+  "'9', 9, '9', 9",
+  "'aPPle', 10, 'A%B', 1.5",
+  NULL};
+
+static std::string quote(const std::string &text) {
+  return "'" + base::replaceString(text, "'", "''") + "'";
+}
+
+// The ids of the rows in the data index, in their order.
+static std::vector<std::int64_t> index_ids(sqlite::connection &db) {
+  std::vector<std::int64_t> ids;
+  sqlite::query q(db, "select `id` from `data_index` order by rowid");
+  if (q.emit()) {
+    std::shared_ptr<sqlite::result> rs = BoostHelper::convertPointer(q.get_result());
+    do
+      ids.push_back(rs->get_int64(0));
+    while (rs->next_row());
+  }
+  return ids;
+}
+
+/*
+ * The ids the data index was built with before it was computed in memory: a query over the swap db with LIKE
+ * conditions and an ORDER BY using the collations of the sort keys. The id is added as last sort column, as the
+ * in-memory sort is stable and sqlite's isn't.
+ */
+static std::vector<std::int64_t> sql_ids(sqlite::connection &db, const Recordset_data_index::Column_filters &filters,
+                                         const std::string &search_string,
+                                         const Recordset_data_index::Sort_keys &sort_keys) {
+  std::vector<std::string> conditions;
+  for (auto &filter : filters)
+    conditions.push_back(strfmt("_%u like %s", (unsigned int)filter.first, quote(filter.second).c_str()));
+  if (!search_string.empty()) {
+    std::vector<std::string> search_conditions;
+    for (ColumnId column = 0; column < COLUMN_COUNT; ++column)
+      search_conditions.push_back(strfmt("_%u like %s", (unsigned int)column, quote("%" + search_string + "%").c_str()));
+    conditions.push_back("(" + base::join(search_conditions, " or ") + ")");
+  }
+
+  std::vector<std::string> order;
+  for (auto &sort_key : sort_keys) {
+    std::string expression;
+    switch (sort_key.collation) {
+      case Recordset_data_index::NumericCollation:
+        expression = strfmt("cast(_%u as numeric)", (unsigned int)sort_key.column);
+        break;
+      case Recordset_data_index::NocaseCollation:
+        expression = strfmt("_%u collate nocase", (unsigned int)sort_key.column);
+        break;
+      case Recordset_data_index::BinaryCollation:
+        expression = strfmt("_%u", (unsigned int)sort_key.column);
+        break;
+    }
+    order.push_back(expression + (sort_key.direction < 0 ? " desc" : " asc"));
+  }
+  order.push_back("id");
+
+  std::string sql = "select `id` from `data`";
+  if (!conditions.empty())
+    sql += " where " + base::join(conditions, " and ");
+  sql += " order by " + base::join(order, ", ");
+
+  std::vector<std::int64_t> ids;
+  sqlite::query q(db, sql);
+  if (q.emit()) {
+    std::shared_ptr<sqlite::result> rs = BoostHelper::convertPointer(q.get_result());
+    do
+      ids.push_back(rs->get_int64(0));
+    while (rs->next_row());
+  }
+  return ids;
+}
+
+static Recordset_data_index::Sort_key sort_key(ColumnId column, int direction,
+                                                Recordset_data_index::Collation collation) {
+  Recordset_data_index::Sort_key key;
+  key.column = column;
+  key.direction = direction;
+  key.collation = collation;
+  return key;
+}
+
+BEGIN_TEST_DATA_CLASS(recordset_data_index_test)
+protected:
+sqlite::connection *db;
+Recordset_data_index data_index;
+
+TEST_DATA_CONSTRUCTOR(recordset_data_index_test) {
+  db = new sqlite::connection(":memory:");
+  sqlite::execute(*db, "create table `data` (`_0` text, `_1` integer, `_2` text, `_3` real, "
+                       "id integer primary key autoincrement)",
+                  true);
+  sqlite::execute(*db, "create table `data_index` (`id` integer)", true);
+
+  for (const char **row = test_rows; *row; ++row)
+    sqlite::execute(*db, strfmt("insert into `data` (`_0`, `_1`, `_2`, `_3`) values (%s)", *row), true);
+
+  // enough rows for the substring search to scan the whole column text, which a refined search doesn't do
+  for (int i = 0; i < 200; ++i)
+    sqlite::execute(*db, strfmt("insert into `data` (`_0`, `_1`, `_2`, `_3`) values ('Item %i', %i, 'c%i', %i.5)", i,
+                                i % 17, i % 5, i),
+                    true);
+
+  // ids beyond the 32 bit range
+  sqlite::execute(*db, "insert into `data` (`_0`, `_1`, `_2`, `_3`, id) values ('apple big', 1, 'z', 3, 5000000000)",
+                  true);
+  sqlite::execute(*db, "insert into `data` (`_0`, `_1`, `_2`, `_3`, id) values ('Big', 2, 'y', 4, 5000000001)", true);
+}
+
+// Rebuilds the index and compares it with the SQL result for the same conditions.
+void check(const std::string &name, const Recordset_data_index::Column_filters &filters,
+           const std::string &search_string, const Recordset_data_index::Sort_keys &sort_keys) {
+  data_index.rebuild(db, filters, search_string, COLUMN_COUNT, sort_keys);
+  std::vector<std::int64_t> expected = sql_ids(*db, filters, search_string, sort_keys);
+  std::vector<std::int64_t> actual = index_ids(*db);
+
+  ensure_equals(name + ": row count", actual.size(), expected.size());
+  for (size_t n = 0; n < expected.size(); ++n)
+    ensure_equals(strfmt("%s: id at %u", name.c_str(), (unsigned int)n), actual[n], expected[n]);
+}
+
+END_TEST_DATA_CLASS;
+
+TEST_MODULE(recordset_data_index_test, "recordset data index");
+
+// No conditions keep all rows in id order, including ids that don't fit in 32 bits.
+TEST_FUNCTION(5) {
+  check("no conditions", Recordset_data_index::Column_filters(), "", Recordset_data_index::Sort_keys());
+
+  std::vector<std::int64_t> ids = index_ids(*db);
+  ensure("big ids", ids.size() > 2);
+  ensure_equals("big id", ids[ids.size() - 2], 5000000000LL);
+  ensure_equals("last id", ids.back(), 5000000001LL);
+}
+
+// Sorting with each collation, in both directions, with NULLs and mixed case values.
+TEST_FUNCTION(10) {
+  Recordset_data_index::Column_filters no_filters;
+  Recordset_data_index::Sort_keys keys;
+
+  const Recordset_data_index::Collation collations[] = {Recordset_data_index::NumericCollation,
+                                                        Recordset_data_index::NocaseCollation,
+                                                        Recordset_data_index::BinaryCollation};
+  for (ColumnId column = 0; column < COLUMN_COUNT; ++column)
+    for (Recordset_data_index::Collation collation : collations)
+      for (int direction = -1; direction <= 1; direction += 2) {
+        keys.assign(1, sort_key(column, direction, collation));
+        check(strfmt("sort _%u collation %i direction %i", (unsigned int)column, (int)collation, direction),
+              no_filters, "", keys);
+      }
+
+  // several sort columns
+  keys.clear();
+  keys.push_back(sort_key(1, 1, Recordset_data_index::BinaryCollation));
+  keys.push_back(sort_key(0, -1, Recordset_data_index::NocaseCollation));
+  check("sort _1, _0 desc", no_filters, "", keys);
+
+  keys.clear();
+  keys.push_back(sort_key(2, -1, Recordset_data_index::NocaseCollation));
+  keys.push_back(sort_key(3, 1, Recordset_data_index::NumericCollation));
+  check("sort _2 desc, _3", no_filters, "", keys);
+}
+
+// Column filters, including the LIKE wildcards % and _ and a literal backslash.
+TEST_FUNCTION(15) {
+  Recordset_data_index::Sort_keys no_sort;
+  const char *patterns[] = {"apple", "APPLE", "%pp%", "a_b", "A%B", "%\\%", "50%", "%", "_", "", "\xC3\x84%",
+                            "%1%",   "%.5",   "1e%", "-%",  "%c_", NULL};
+
+  for (const char **pattern = patterns; *pattern; ++pattern)
+    for (ColumnId column = 0; column < COLUMN_COUNT; ++column) {
+      Recordset_data_index::Column_filters filters;
+      filters[column] = *pattern;
+      check(strfmt("filter _%u like '%s'", (unsigned int)column, *pattern), filters, "", no_sort);
+    }
+
+  Recordset_data_index::Column_filters filters;
+  filters[0] = "%a%";
+  filters[1] = "1%";
+  check("two filters", filters, "", no_sort);
+}
+
+// The data search over all columns, refined by typing more characters and widened again.
+TEST_FUNCTION(20) {
+  Recordset_data_index::Column_filters no_filters;
+  Recordset_data_index::Sort_keys no_sort;
+
+  check("search a", no_filters, "a", no_sort);
+  check("search ap (refined)", no_filters, "ap", no_sort);
+  check("search APP (refined)", no_filters, "APP", no_sort);
+  check("search apple big (refined)", no_filters, "apple big", no_sort);
+  check("search a (widened)", no_filters, "a", no_sort);
+  check("search cleared", no_filters, "", no_sort);
+
+  // the wildcards in a search string keep their LIKE meaning
+  check("search %", no_filters, "%", no_sort);
+  check("search _", no_filters, "_", no_sort);
+  check("search a_b", no_filters, "a_b", no_sort);
+  check("search 1%5", no_filters, "1%5", no_sort);
+  check("search 1", no_filters, "1", no_sort);
+  check("search 12 (refined)", no_filters, "12", no_sort);
+
+  // refining & widening with column filters, sorted
+  Recordset_data_index::Sort_keys keys;
+  keys.push_back(sort_key(3, -1, Recordset_data_index::NumericCollation));
+  Recordset_data_index::Column_filters filters;
+  check("search e", no_filters, "e", keys);
+  filters[0] = "%p%";
+  check("search e, filter _0 (refined)", filters, "e", keys);
+  filters[2] = "a%";
+  check("search e, filters _0 _2 (refined)", filters, "e", keys);
+  filters.erase(0);
+  check("search e, filter _2 (widened)", filters, "e", keys);
+  check("filter _2 (widened)", filters, "", keys);
+}
+
+// Changed values are seen once the column was invalidated.
+TEST_FUNCTION(25) {
+  Recordset_data_index::Column_filters no_filters;
+  Recordset_data_index::Sort_keys keys;
+  keys.push_back(sort_key(0, 1, Recordset_data_index::NocaseCollation));
+
+  check("sort _0", no_filters, "", keys);
+  sqlite::execute(*db, "update `data` set `_0` = 'AAA' where `_0` = 'cherry'", true);
+  data_index.invalidate_column(0);
+  check("sort _0 after update", no_filters, "", keys);
+  check("search aaa after update", no_filters, "aaa", keys);
+
+  sqlite::execute(*db, "delete from `data` where `_1` = 10", true);
+  data_index.invalidate();
+  check("sort _0 after delete", no_filters, "", keys);
+}
+
+TEST_FUNCTION(99) {
+  delete db;
+}
+
+END_TESTS
@@ -22,7 +22,9 @@
 #endif
 
 #include "sqlide/recordset_cdbc_storage.h"
+#include "sqlide/recordset_text_storage.h"
 #include "sqlide/recordset_be.h"
+#include "mtemplate/template.h"
 #include "connection_helpers.h"
 #include "cppdbc.h"
 #include "wb_helpers.h"
@@ -80,6 +82,315 @@ TEST_FUNCTION(2) {
   ensure("NULL blob is NULL", rs->is_field_null(0, 1));
 }
 
+// The JSON export formats the rows without the row template, field names must still come out as JSON.tpl writes them
+TEST_FUNCTION(3) {
+  Recordset_cdbc_storage::Ref data_storage(Recordset_cdbc_storage::create());
+
+  base::RecMutex _connLock;
+  data_storage->setUserConnectionGetter(
+    [&](sql::Dbc_connection_handler::Ref &conn, bool LockOnly = false) -> base::RecMutexLock {
+      base::RecMutexLock lock(_connLock, false);
+      conn = dbc_conn;
+      return lock;
+    });
+
+  Recordset::Ref rs = Recordset::create();
+  rs->data_storage(data_storage);
+
+  std::shared_ptr<sql::Statement> dbc_statement(dbc_conn->ref->createStatement());
+  dbc_statement->execute("select 1 as `a&b<c>\"d`");
+
+  std::shared_ptr<sql::ResultSet> rset(dbc_statement->getResultSet());
+  data_storage->dbc_resultset(rset);
+
+  rs->reset(true);
+
+  std::string path = "recordset_export_test.json";
+  Recordset_text_storage::Ref export_storage =
+    std::dynamic_pointer_cast<Recordset_text_storage>(rs->data_storage_for_export("JSON"));
+  ensure("JSON export storage", export_storage.get() != NULL);
+  export_storage->file_path(path);
+  export_storage->serialize(rs);
+
+  gchar *contents = NULL;
+  ensure("exported file", g_file_get_contents(path.c_str(), &contents, NULL, NULL) != FALSE);
+  std::string exported(contents);
+  g_free(contents);
+  base::remove(path);
+
+  ensure("field name escaped in the export", exported.find("\"a&b<c>\\\"d\" : 1") != std::string::npos);
+
+  // The row template must give the same field text
+  mtemplate::Template *row_template = mtemplate::GetTemplate("../../res/sqlidedata/templates/JSON.tpl");
+  ensure("JSON row template", row_template != NULL);
+
+  mtemplate::Dictionary *dictionary = mtemplate::CreateMainDictionary();
+  mtemplate::DictionaryInterface *field_dictionary =
+    dictionary->addSectionDictionary("ROW")->addSectionDictionary("FIELD");
+  field_dictionary->setValue("FIELD_NAME", "a&b<c>\"d");
+  field_dictionary->setValue("FIELD_VALUE", "1");
+
+  mtemplate::TemplateOutputString output;
+  row_template->expand(dictionary, &output);
+
+  ensure("field name escaped by the row template",
+         std::string(output.get()).find("\"a&b<c>\\\"d\" : 1") != std::string::npos);
+}
+
+// A query returning the numbers 0 to count - 1 (up to 10000) in column `n`, ordered.
+static std::string numbers_query(int count) {
+  std::string digits = "(select 0 d union all select 1 union all select 2 union all select 3 union all select 4 "
+                       "union all select 5 union all select 6 union all select 7 union all select 8 union all "
+                       "select 9)";
+  return base::strfmt(
+    "select a.d + b.d * 10 + c.d * 100 + e.d * 1000 as n, convert(concat('blob', a.d), binary) as b from %s a, %s b, %s "
+    "c, %s e having n < %i order by n",
+    digits.c_str(), digits.c_str(), digits.c_str(), digits.c_str(), count);
+}
+
+static Recordset_cdbc_storage::Ref incremental_storage(base::RecMutex &conn_lock,
+                                                       sql::Dbc_connection_handler::Ref &dbc_conn) {
+  Recordset_cdbc_storage::Ref data_storage(Recordset_cdbc_storage::create());
+  data_storage->setUserConnectionGetter(
+    [&](sql::Dbc_connection_handler::Ref &conn, bool LockOnly = false) -> base::RecMutexLock {
+      base::RecMutexLock lock(conn_lock, false);
+      conn = dbc_conn;
+      return lock;
+    });
+  data_storage->incremental_fetch(true);
+  return data_storage;
+}
+
+static void set_query(Recordset_cdbc_storage::Ref data_storage, sql::Dbc_connection_handler::Ref &dbc_conn,
+                      const std::string &query) {
+  std::shared_ptr<sql::Statement> dbc_statement(dbc_conn->ref->createStatement());
+  dbc_statement->execute(query);
+  std::shared_ptr<sql::ResultSet> rset(dbc_statement->getResultSet());
+  data_storage->dbc_resultset(rset);
+}
+
+// An incremental fetch stores the first rows on reset and the rest once fetch_pending_rows read them.
+TEST_FUNCTION(4) {
+  base::RecMutex conn_lock;
+  Recordset_cdbc_storage::Ref data_storage = incremental_storage(conn_lock, dbc_conn);
+
+  Recordset::Ref rs = Recordset::create();
+  rs->data_storage(data_storage);
+  set_query(data_storage, dbc_conn, numbers_query(2500));
+  rs->reset(true);
+
+  ensure_equals("first batch", rs->row_count(), 1000U);
+  ensure("rows pending", data_storage->has_pending_rows());
+  ensure("fetching rows", rs->is_fetching_rows());
+  ensure("read only while fetching", rs->is_readonly());
+
+  ensure_equals("fetched row count", rs->fetch_pending_rows(), 2500U);
+  ensure("no rows pending", !data_storage->has_pending_rows());
+
+  // the rows are stored in the main thread
+  bec::GRTManager::get()->perform_idle_tasks();
+  ensure_equals("all rows", rs->row_count(), 2500U);
+  ensure("fetch complete", !rs->is_fetching_rows());
+
+  ssize_t value = -1;
+  rs->get_field(bec::NodeId(999), 0, value);
+  ensure_equals("last row of the first batch", value, 999);
+  rs->get_field(bec::NodeId(1000), 0, value);
+  ensure_equals("first fetched row", value, 1000);
+  rs->get_field(bec::NodeId(2499), 0, value);
+  ensure_equals("last row", value, 2499);
+}
+
+// Resetting the recordset is refused while rows are pending, as it would drop the rows still to be stored.
+TEST_FUNCTION(5) {
+  base::RecMutex conn_lock;
+  Recordset_cdbc_storage::Ref data_storage = incremental_storage(conn_lock, dbc_conn);
+
+  Recordset::Ref rs = Recordset::create();
+  rs->data_storage(data_storage);
+  set_query(data_storage, dbc_conn, numbers_query(2500));
+  rs->reset(true);
+  ensure("rows pending", data_storage->has_pending_rows());
+
+  set_query(data_storage, dbc_conn, numbers_query(10));
+  ensure("reset ignored before the fetch", !rs->reset(true));
+  ensure("rows still pending", data_storage->has_pending_rows());
+  ensure_equals("first batch kept", rs->row_count(), 1000U);
+
+  // rows read but not stored yet
+  ensure_equals("fetched row count", rs->fetch_pending_rows(), 2500U);
+  ensure("reset ignored before the rows are stored", !rs->reset(true));
+  ensure("still fetching", rs->is_fetching_rows());
+
+  bec::GRTManager::get()->perform_idle_tasks();
+  ensure_equals("all rows", rs->row_count(), 2500U);
+  ensure("fetch complete", !rs->is_fetching_rows());
+
+  // the small result set on the storage is used now
+  ensure("reset after the fetch", rs->reset(true));
+  ensure("no rows pending", !data_storage->has_pending_rows());
+  ensure_equals("rows of the new result", rs->row_count(), 10U);
+  ensure_equals("nothing to fetch", rs->fetch_pending_rows(), 10U);
+}
+
+// Blobs can't be fetched while the connection still has the pending rows to read.
+TEST_FUNCTION(6) {
+  base::RecMutex conn_lock;
+  Recordset_cdbc_storage::Ref data_storage = incremental_storage(conn_lock, dbc_conn);
+
+  Recordset::Ref rs = Recordset::create();
+  rs->data_storage(data_storage);
+  set_query(data_storage, dbc_conn, numbers_query(2500));
+  rs->reset(true);
+  ensure("rows pending", data_storage->has_pending_rows());
+
+  sqlite::variant_t blob_value;
+  try {
+    data_storage->fetch_blob_value(rs, 0, 1, blob_value);
+    fail("blob fetched while rows are pending");
+  } catch (std::runtime_error &) {
+    // expected
+  }
+  ensure("rows still pending", data_storage->has_pending_rows());
+
+  ensure_equals("fetched row count", rs->fetch_pending_rows(), 2500U);
+  bec::GRTManager::get()->perform_idle_tasks();
+  ensure_equals("all rows", rs->row_count(), 2500U);
+}
+
+// Frames ahead in scroll direction are prefetched, frames left are kept, and reordering the rows drops them all.
+TEST_FUNCTION(7) {
+  Recordset_cdbc_storage::Ref data_storage(Recordset_cdbc_storage::create());
+  base::RecMutex conn_lock;
+  data_storage->setUserConnectionGetter(
+    [&](sql::Dbc_connection_handler::Ref &conn, bool LockOnly = false) -> base::RecMutexLock {
+      base::RecMutexLock lock(conn_lock, false);
+      conn = dbc_conn;
+      return lock;
+    });
+
+  Recordset::Ref rs = Recordset::create();
+  rs->data_storage(data_storage);
+  set_query(data_storage, dbc_conn, numbers_query(5000));
+  rs->reset(true);
+  ensure_equals("all rows", rs->row_count(), 5000U);
+
+  // Frames hold 1000 rows by default (Recordset:DataFrameRowCount).
+  ssize_t value = -1;
+  rs->get_field(bec::NodeId(10), 0, value);
+  size_t hits = rs->data_frame_cache_hits();
+  size_t misses = rs->data_frame_cache_misses();
+
+  // Moving to the next frame loads it and prefetches the one after it.
+  rs->get_field(bec::NodeId(1010), 0, value);
+  ensure_equals("second frame", value, 1010);
+  ensure_equals("second frame loaded", rs->data_frame_cache_misses(), misses + 1);
+  bec::GRTManager::get()->perform_idle_tasks();
+
+  rs->get_field(bec::NodeId(2010), 0, value);
+  ensure_equals("third frame", value, 2010);
+  ensure_equals("third frame prefetched", rs->data_frame_cache_hits(), hits + 1);
+
+  // Scrolling on in the same direction prefetches more frames ahead, one per idle call.
+  bec::GRTManager::get()->perform_idle_tasks();
+  bec::GRTManager::get()->perform_idle_tasks();
+  rs->get_field(bec::NodeId(3010), 0, value);
+  ensure_equals("fourth frame", value, 3010);
+  rs->get_field(bec::NodeId(4010), 0, value);
+  ensure_equals("fifth frame", value, 4010);
+  ensure_equals("fourth and fifth frame prefetched", rs->data_frame_cache_hits(), hits + 3);
+
+  // Frames that were left are still cached.
+  rs->get_field(bec::NodeId(10), 0, value);
+  ensure_equals("first frame", value, 10);
+  rs->get_field(bec::NodeId(1999), 0, value);
+  ensure_equals("last row of the second frame", value, 1999);
+  ensure_equals("frames kept", rs->data_frame_cache_hits(), hits + 5);
+  ensure_equals("no more loads", rs->data_frame_cache_misses(), misses + 1);
+
+  // Reordering the rows discards the cached frames, they must not be used for the new order.
+  bec::GRTManager::get()->perform_idle_tasks();
+  rs->sort_by(0, -1, false);
+  bec::GRTManager::get()->perform_idle_tasks();
+  hits = rs->data_frame_cache_hits();
+  rs->get_field(bec::NodeId(10), 0, value);
+  ensure_equals("first frame sorted", value, 4989);
+  rs->get_field(bec::NodeId(2010), 0, value);
+  ensure_equals("third frame sorted", value, 2989);
+  rs->get_field(bec::NodeId(1010), 0, value);
+  ensure_equals("second frame sorted", value, 3989);
+  ensure_equals("no stale frames", rs->data_frame_cache_hits(), hits);
+}
+
+// Integer columns are stored natively in the swap db, except those whose values or text don't survive that.
+TEST_FUNCTION(8) {
+  std::shared_ptr<sql::Statement> dbc_statement(dbc_conn->ref->createStatement());
+  dbc_statement->execute("DROP DATABASE IF EXISTS recordset_test");
+  dbc_statement->execute("CREATE DATABASE recordset_test");
+  dbc_statement->execute(
+    "CREATE TABLE recordset_test.numbers (id INT PRIMARY KEY, i INT, u BIGINT UNSIGNED, z INT(5) ZEROFILL, "
+    "s SMALLINT UNSIGNED)");
+  dbc_statement->execute(
+    "INSERT INTO recordset_test.numbers VALUES (1, 10, 18446744073709551615, 42, 65535), "
+    "(2, NULL, NULL, NULL, NULL), (3, -5, 5, 1234, 0), (4, 2, 9223372036854775808, 7, 300)");
+
+  Recordset_cdbc_storage::Ref data_storage(Recordset_cdbc_storage::create());
+  base::RecMutex conn_lock;
+  data_storage->setUserConnectionGetter(
+    [&](sql::Dbc_connection_handler::Ref &conn, bool LockOnly = false) -> base::RecMutexLock {
+      base::RecMutexLock lock(conn_lock, false);
+      conn = dbc_conn;
+      return lock;
+    });
+
+  Recordset::Ref rs = Recordset::create();
+  rs->data_storage(data_storage);
+  set_query(data_storage, dbc_conn, "SELECT i, u, z, s FROM recordset_test.numbers ORDER BY id");
+  rs->reset(true);
+  ensure_equals("row count", rs->row_count(), 4U);
+
+  std::string value;
+  rs->get_field(bec::NodeId(0), 0, value);
+  ensure_equals("signed int", value, "10");
+  rs->get_field(bec::NodeId(2), 0, value);
+  ensure_equals("negative int", value, "-5");
+  rs->get_field(bec::NodeId(0), 1, value);
+  ensure_equals("unsigned bigint beyond int64", value, "18446744073709551615");
+  rs->get_field(bec::NodeId(3), 1, value);
+  ensure_equals("unsigned bigint beyond int64 max", value, "9223372036854775808");
+  rs->get_field(bec::NodeId(0), 2, value);
+  ensure_equals("zerofill keeps its text", value, "00042");
+  rs->get_field(bec::NodeId(0), 3, value);
+  ensure_equals("unsigned smallint", value, "65535");
+
+  for (ColumnId column = 0; column < 4; ++column) {
+    ensure("NULL", rs->is_field_null(bec::NodeId(1), column));
+    ensure("not NULL", !rs->is_field_null(bec::NodeId(2), column));
+  }
+
+  // Sorting compares the values as numbers, whether they are stored as integers or as text.
+  const char *expected[][4] = {{"", "-5", "2", "10"},
+                                {"", "5", "9223372036854775808", "18446744073709551615"},
+                                {"", "00007", "00042", "01234"},
+                                {"", "0", "300", "65535"}};
+  for (ColumnId column = 0; column < 4; ++column) {
+    rs->sort_by(column, 1, false);
+    ensure(base::strfmt("column %u: NULL first", (unsigned int)column), rs->is_field_null(bec::NodeId(0), column));
+    for (RowId row = 1; row < 4; ++row) {
+      rs->get_field(bec::NodeId(row), column, value);
+      ensure_equals(base::strfmt("column %u, row %u", (unsigned int)column, (unsigned int)row), value,
+                    expected[column][row]);
+    }
+  }
+
+  rs->sort_by(0, -1, false);
+  rs->get_field(bec::NodeId(0), 0, value);
+  ensure_equals("descending", value, "10");
+  ensure("descending, NULL last", rs->is_field_null(bec::NodeId(3), 0));
+
+  dbc_statement->execute("DROP DATABASE recordset_test");
+}
+
 // Due to the tut nature, this must be executed as a last test always,
 // we can't have this inside of the d-tor.
 TEST_FUNCTION(99) {
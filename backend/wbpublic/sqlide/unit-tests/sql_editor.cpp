@@ -60,6 +60,62 @@ TEST_FUNCTION(1) {
   }
 }
 
+// Syntax check results are reused for unchanged statements.
+TEST_FUNCTION(5) {
+  std::vector<std::string> checked;
+  StatementErrorsCache::Checker checker = [&checked](const std::string &statement) {
+    checked.push_back(statement);
+    std::vector<parser::ParserErrorEntry> errors;
+    if (statement.find("selec ") != std::string::npos) {
+      parser::ParserErrorEntry error = {"syntax error", 0, 1, 5};
+      errors.push_back(error);
+    }
+    return errors;
+  };
+
+  StatementErrorsCache cache;
+  cache.begin_run("ANSI_QUOTES|50610|0");
+  ensure("no errors", cache.errors("select 1", checker).empty());
+  ensure_equals("error", cache.errors("selec 2", checker).size(), 1U);
+  ensure_equals("same statement twice", cache.errors("select 1", checker).size(), 0U);
+  cache.end_run();
+  ensure_equals("checked statements", checked.size(), 2U);
+  ensure_equals("cached statements", cache.count(), 2U);
+
+  // Unchanged statements are not checked again, an edited one is.
+  checked.clear();
+  cache.begin_run("ANSI_QUOTES|50610|0");
+  ensure("cached no errors", cache.errors("select 1", checker).empty());
+  ensure_equals("edited", cache.errors("select 2", checker).size(), 0U);
+  cache.end_run();
+  ensure_equals("checked after edit", checked.size(), 1U);
+  ensure_equals("edited statement checked", checked[0], "select 2");
+  ensure_equals("removed statement dropped", cache.count(), 2U);
+
+  checked.clear();
+  cache.begin_run("ANSI_QUOTES|50610|0");
+  ensure_equals("removed statement checked again", cache.errors("selec 2", checker).size(), 1U);
+  ensure_equals("checked removed statement", checked.size(), 1U);
+
+  // An interrupted run keeps the results of both runs.
+  cache.interrupt_run();
+  ensure_equals("interrupted run", cache.count(), 3U);
+
+  // Another sql mode or server version invalidates all results.
+  checked.clear();
+  cache.begin_run("|50610|0");
+  cache.errors("select 1", checker);
+  cache.end_run();
+  ensure_equals("sql mode changed", checked.size(), 1U);
+  ensure_equals("sql mode changed, cache", cache.count(), 1U);
+
+  checked.clear();
+  cache.begin_run("|80000|0");
+  cache.errors("select 1", checker);
+  cache.end_run();
+  ensure_equals("server version changed", checked.size(), 1U);
+}
+
 // Due to the tut nature, this must be executed as a last test always,
 // we can't have this inside of the d-tor.
 TEST_FUNCTION(99) {
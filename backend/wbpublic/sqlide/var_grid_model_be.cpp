@@ -85,10 +85,18 @@ VarGridModel::VarGridModel()
     _data_frame_end(0),
     _is_field_value_truncation_enabled(false),
     _edited_field_row(-1),
-    _edited_field_col(-1) {
+    _edited_field_col(-1),
+    _scroll_direction(0),
+    _scroll_streak(0),
+    _prefetch_frame_begin(0),
+    _prefetch_frame_count(0),
+    _data_frame_cache_hits(0),
+    _data_frame_cache_misses(0) {
   {
     grt::DictRef options = DictRef::cast_from(grt::GRT::get()->get("/wb/options/options"));
     _optimized_blob_fetching = (options.get_int("Recordset:OptimizeBlobFetching", 0) != 0);
+    _data_frame_row_count = (RowId)std::max<ssize_t>(options.get_int("Recordset:DataFrameRowCount", 1000), 100);
+    _data_frame_cache_size = (size_t)std::max<ssize_t>(options.get_int("Recordset:DataFrameCacheSize", 8), 1);
   }
 }
 
@@ -132,6 +140,9 @@ void VarGridModel::reset() {
   _row_count = 0;
   _data_frame_begin = 0;
   _data_frame_end = 0;
+  discard_cached_data_frames();
+  _scroll_direction = 0;
+  _scroll_streak = 0;
 
   _icon_for_val.reset(new IconForVal(_optimized_blob_fetching));
 }
@@ -471,80 +482,199 @@ void VarGridModel::add_column(const std::string &name, const sqlite::variant_t &
 //--------------------------------------------------------------------------------------------------
 
 void VarGridModel::cache_data_frame(RowId center_row, bool force_reload) {
-  static const RowId half_row_count = 500; //! load from options
-  RowId row_count = half_row_count * 2;
+  base::RecMutexLock data_mutex WB_UNUSED(_data_mutex);
+
+  if (force_reload)
+    discard_cached_data_frames();
 
   // center_row of -1 means only to forcibly reload current data frame
-  if (-1 != (int)center_row) {
-    RowId starting_row = (center_row < half_row_count) ? 0 : (center_row - half_row_count);
-
-    // adjust range borders to comply with row count & cache frame size
-    // e.g. shift back and/or resize requested cache frame
-    if (starting_row + row_count > _row_count) {
-      if (row_count < _row_count) {
-        starting_row = _row_count - row_count;
-      } else {
-        starting_row = 0;
-        row_count = _row_count;
+  if (-1 == (int)center_row) {
+    discard_cached_data_frames();
+    ++_data_frame_cache_misses;
+    load_data_frame(_data_frame_begin, _data_frame_end - _data_frame_begin, _data);
+    return;
+  }
+
+  RowId starting_row = center_row - center_row % _data_frame_row_count;
+  RowId row_count = (starting_row < _row_count) ? std::min(_data_frame_row_count, _row_count - starting_row) : 0;
+
+  if (!force_reload && (_data_frame_begin == starting_row) && (_data_frame_begin != _data_frame_end) &&
+      (_data_frame_end - _data_frame_begin == row_count)) {
+    return;
+  }
+
+  if (force_reload) {
+    _scroll_direction = 0;
+    _scroll_streak = 0;
+  } else if ((_data_frame_begin != _data_frame_end) && (_data_frame_begin != starting_row)) {
+    // figure out how the user moves through the data to decide how much to prefetch
+    int direction = (starting_row > _data_frame_begin) ? 1 : -1;
+    RowId distance = (direction > 0) ? starting_row - _data_frame_begin : _data_frame_begin - starting_row;
+    if ((direction == _scroll_direction) && (distance == _data_frame_row_count))
+      ++_scroll_streak;
+    else
+      _scroll_streak = 1;
+    _scroll_direction = direction;
+
+    // keep the frame being left, replacing an older copy of it
+    for (std::list<Data_frame>::iterator frame = _cached_data_frames.begin(); frame != _cached_data_frames.end();
+         ++frame) {
+      if (frame->begin == _data_frame_begin) {
+        _cached_data_frames.erase(frame);
+        break;
       }
     }
+    _cached_data_frames.push_front(Data_frame());
+    _cached_data_frames.front().begin = _data_frame_begin;
+    _cached_data_frames.front().end = _data_frame_end;
+    _cached_data_frames.front().data.swap(_data);
+  }
+
+  _data_frame_begin = starting_row;
+  _data_frame_end = starting_row + row_count;
 
-    if (!force_reload && (_data_frame_begin == starting_row) && (_data_frame_begin != _data_frame_end) &&
-        (_data_frame_end - _data_frame_begin == row_count)) {
-      return;
+  bool cached = false;
+  for (std::list<Data_frame>::iterator frame = _cached_data_frames.begin(); frame != _cached_data_frames.end();
+       ++frame) {
+    if (frame->begin == _data_frame_begin) {
+      if (frame->end == _data_frame_end) {
+        _data.swap(frame->data);
+        cached = true;
+      }
+      _cached_data_frames.erase(frame);
+      break;
     }
+  }
 
-    _data_frame_begin = starting_row;
-    _data_frame_end = starting_row + row_count;
-  } else {
-    row_count = _data_frame_end - _data_frame_begin;
+  while (_cached_data_frames.size() > _data_frame_cache_size)
+    _cached_data_frames.pop_back();
+
+  if (cached)
+    ++_data_frame_cache_hits;
+  else {
+    ++_data_frame_cache_misses;
+    load_data_frame(_data_frame_begin, row_count, _data);
+  }
+
+  // load the frames ahead when the UI is idle, more of them the longer the user keeps scrolling the same way
+  if (_scroll_direction != 0 && _scroll_streak > 0) {
+    _prefetch_frame_count = std::min(_scroll_streak, std::max<size_t>(_data_frame_cache_size / 2, 1));
+    _prefetch_frame_begin = _data_frame_begin;
+    if (!_prefetch_connection.connected())
+      _prefetch_connection =
+        GRTManager::get()->run_once_when_idle(this, std::bind(&VarGridModel::prefetch_data_frames, this));
   }
+}
 
-  _data.clear();
+//--------------------------------------------------------------------------------------------------
 
-  // load data
-  {
-    std::shared_ptr<sqlite::connection> data_swap_db = this->data_swap_db();
-    const size_t partition_count = data_swap_db_partition_count();
-
-    std::list<std::shared_ptr<sqlite::query> > data_queries(partition_count);
-    prepare_partition_queries(
-      data_swap_db.get(),
-      "select d.* from `data%s` d inner join `data_index` di on (di.`id`=d.`id`) order by di.`rowid` limit ? offset ?",
-      data_queries);
-    std::list<sqlite::variant_t> bind_vars;
-    bind_vars.push_back((int)row_count);
-    bind_vars.push_back((int)_data_frame_begin);
-    std::vector<std::shared_ptr<sqlite::result> > data_results(data_queries.size());
-    if (emit_partition_queries(data_swap_db.get(), data_queries, data_results, bind_vars)) {
-      bool next_row_exists = true;
-
-      std::vector<bool> blob_columns(_column_count);
-      for (ColumnId col = 0; _column_count > col; ++col)
-        blob_columns[col] = sqlide::is_var_blob(_real_column_types[col]);
-
-      _data.reserve(row_count * _column_count);
-      do {
-        for (size_t partition = 0; partition < partition_count; ++partition) {
-          std::shared_ptr<sqlite::result> &data_rs = data_results[partition];
-          for (ColumnId col_begin = partition * DATA_SWAP_DB_TABLE_MAX_COL_COUNT, col = col_begin,
-                        col_end = std::min<ColumnId>(_column_count, (partition + 1) * DATA_SWAP_DB_TABLE_MAX_COL_COUNT);
-               col < col_end; ++col) {
-            sqlite::variant_t v;
-            if (_optimized_blob_fetching && blob_columns[col]) {
-              v = sqlite::null_t();
-            } else {
-              ColumnId partition_column = col - col_begin;
-              v = data_rs->get_variant((int)partition_column);
-              v = boost::apply_visitor(_var_cast, _column_types[col], v);
-            }
-            _data.push_back(v);
+void VarGridModel::discard_cached_data_frames() {
+  _prefetch_connection.disconnect();
+  _prefetch_frame_count = 0;
+  _cached_data_frames.clear();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Loads the next frame in scroll direction that isn't cached yet, one frame per idle call.
+ */
+void VarGridModel::prefetch_data_frames() {
+  base::RecMutexLock data_mutex WB_UNUSED(_data_mutex);
+
+  while (_prefetch_frame_count > 0) {
+    --_prefetch_frame_count;
+    if (_scroll_direction > 0) {
+      _prefetch_frame_begin += _data_frame_row_count;
+      if (_prefetch_frame_begin >= _row_count)
+        break;
+    } else {
+      if (_prefetch_frame_begin < _data_frame_row_count)
+        break;
+      _prefetch_frame_begin -= _data_frame_row_count;
+    }
+
+    if (_prefetch_frame_begin == _data_frame_begin)
+      continue;
+    RowId row_count = std::min(_data_frame_row_count, _row_count - _prefetch_frame_begin);
+    bool cached = false;
+    for (const Data_frame &frame : _cached_data_frames) {
+      if (frame.begin == _prefetch_frame_begin) {
+        cached = (frame.end == _prefetch_frame_begin + row_count);
+        break;
+      }
+    }
+    if (cached)
+      continue;
+
+    Data data;
+    load_data_frame(_prefetch_frame_begin, row_count, data);
+    for (std::list<Data_frame>::iterator frame = _cached_data_frames.begin(); frame != _cached_data_frames.end();
+         ++frame) {
+      if (frame->begin == _prefetch_frame_begin) {
+        _cached_data_frames.erase(frame);
+        break;
+      }
+    }
+    _cached_data_frames.push_front(Data_frame());
+    _cached_data_frames.front().begin = _prefetch_frame_begin;
+    _cached_data_frames.front().end = _prefetch_frame_begin + row_count;
+    _cached_data_frames.front().data.swap(data);
+    while (_cached_data_frames.size() > _data_frame_cache_size)
+      _cached_data_frames.pop_back();
+
+    if (_prefetch_frame_count > 0)
+      _prefetch_connection =
+        GRTManager::get()->run_once_when_idle(this, std::bind(&VarGridModel::prefetch_data_frames, this));
+    break;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void VarGridModel::load_data_frame(RowId begin, RowId row_count, Data &data) {
+  data.clear();
+
+  std::shared_ptr<sqlite::connection> data_swap_db = this->data_swap_db();
+  const size_t partition_count = data_swap_db_partition_count();
+
+  std::list<std::shared_ptr<sqlite::query> > data_queries(partition_count);
+  prepare_partition_queries(
+    data_swap_db.get(),
+    "select d.* from `data%s` d inner join `data_index` di on (di.`id`=d.`id`) order by di.`rowid` limit ? offset ?",
+    data_queries);
+  std::list<sqlite::variant_t> bind_vars;
+  bind_vars.push_back((int)row_count);
+  bind_vars.push_back((int)begin);
+  std::vector<std::shared_ptr<sqlite::result> > data_results(data_queries.size());
+  if (emit_partition_queries(data_swap_db.get(), data_queries, data_results, bind_vars)) {
+    bool next_row_exists = true;
+
+    std::vector<bool> blob_columns(_column_count);
+    for (ColumnId col = 0; _column_count > col; ++col)
+      blob_columns[col] = sqlide::is_var_blob(_real_column_types[col]);
+
+    data.reserve(row_count * _column_count);
+    do {
+      for (size_t partition = 0; partition < partition_count; ++partition) {
+        std::shared_ptr<sqlite::result> &data_rs = data_results[partition];
+        for (ColumnId col_begin = partition * DATA_SWAP_DB_TABLE_MAX_COL_COUNT, col = col_begin,
+                      col_end = std::min<ColumnId>(_column_count, (partition + 1) * DATA_SWAP_DB_TABLE_MAX_COL_COUNT);
+             col < col_end; ++col) {
+          sqlite::variant_t v;
+          if (_optimized_blob_fetching && blob_columns[col]) {
+            v = sqlite::null_t();
+          } else {
+            ColumnId partition_column = col - col_begin;
+            v = data_rs->get_variant((int)partition_column);
+            v = boost::apply_visitor(_var_cast, _column_types[col], v);
           }
+          data.push_back(v);
         }
-        for (auto &data_rs : data_results)
-          next_row_exists = data_rs->next_row();
-      } while (next_row_exists);
-    }
+      }
+      for (auto &data_rs : data_results)
+        next_row_exists = data_rs->next_row();
+    } while (next_row_exists);
   }
 }
 
@@ -25,6 +25,7 @@
 #include "grt/grt_threaded_task.h"
 #include "grt/tree_model.h"
 #include "grt/grt_manager.h"
+#include <list>
 #include <vector>
 
 class Recordset_data_storage;
@@ -85,7 +86,8 @@ protected:
   std::string _readonly_reason;
 
 public:
-  enum ColumnFlags { NeedsQuoteFlag = 1, NotNullFlag = 2 };
+  // IntegerStorageFlag: values are kept as native integers in the data swap db (presented using the column type)
+  enum ColumnFlags { NeedsQuoteFlag = 1, NotNullFlag = 2, IntegerStorageFlag = 4 };
 
   typedef std::vector<std::string> Column_names;
   typedef std::vector<sqlite::variant_t> Column_types;
@@ -190,12 +192,45 @@ public:
 
 protected:
   void cache_data_frame(RowId center_row, bool force_reload);
+  // must be called when rows are added, removed or reordered, as that makes previously cached frames invalid
+  void discard_cached_data_frames();
 
 protected:
   RowId _data_frame_begin;
   RowId _data_frame_end;
   sqlide::VarCast _var_cast;
 
+public:
+  // number of frame switches served from the frame cache / loaded from the data swap db
+  size_t data_frame_cache_hits() const {
+    return _data_frame_cache_hits;
+  }
+  size_t data_frame_cache_misses() const {
+    return _data_frame_cache_misses;
+  }
+
+private:
+  // frames are aligned to multiples of _data_frame_row_count, so cached frames never overlap
+  struct Data_frame {
+    RowId begin;
+    RowId end;
+    Data data;
+  };
+
+  void load_data_frame(RowId begin, RowId row_count, Data &data);
+  void prefetch_data_frames();
+
+  std::list<Data_frame> _cached_data_frames; // most recently used first, excluding the current frame
+  RowId _data_frame_row_count;
+  size_t _data_frame_cache_size;
+  int _scroll_direction;
+  size_t _scroll_streak; // number of consecutive switches to the adjacent frame in _scroll_direction
+  RowId _prefetch_frame_begin;
+  size_t _prefetch_frame_count;
+  boost::signals2::scoped_connection _prefetch_connection;
+  size_t _data_frame_cache_hits;
+  size_t _data_frame_cache_misses;
+
 public:
   virtual int floating_point_visible_scale();
   const sqlide::VarToStr *var2str_convertor() const {
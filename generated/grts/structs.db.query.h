@@ -1408,6 +1408,13 @@ obj.sidebar = value
 
    */
   virtual grt::IntegerRef executeScriptAndOutputToGrid(const std::string &sql);
+  /** Method. executes the SQL script file in the background without loading it into memory, logging the progress in
+  the action log
+  \param path path of the script file
+  \return
+
+   */
+  virtual grt::IntegerRef executeScriptFile(const std::string &path);
 
   ImplData *get_data() const {
     return _data;
@@ -1489,6 +1496,10 @@ private: // wrapper methods for use by grt
     return dynamic_cast<db_query_Editor *>(self)->executeScriptAndOutputToGrid(grt::StringRef::cast_from(args[0]));
   }
 
+  static grt::ValueRef call_executeScriptFile(grt::internal::Object *self, const grt::BaseListRef &args) {
+    return dynamic_cast<db_query_Editor *>(self)->executeScriptFile(grt::StringRef::cast_from(args[0]));
+  }
+
 public:
   static void grt_register() {
     grt::MetaClass *meta = grt::GRT::get()->get_metaclass(static_class_name());
@@ -1553,6 +1564,7 @@ public:
     meta->bind_method("executeQuery", &db_query_Editor::call_executeQuery);
     meta->bind_method("executeScript", &db_query_Editor::call_executeScript);
     meta->bind_method("executeScriptAndOutputToGrid", &db_query_Editor::call_executeScriptAndOutputToGrid);
+    meta->bind_method("executeScriptFile", &db_query_Editor::call_executeScriptFile);
   }
 };
 
@@ -30,6 +30,8 @@ namespace base {
     BASELIBRARY_PUBLIC_FUNC bool nameIs(xmlNodePtr node, const std::string &name);
     BASELIBRARY_PUBLIC_FUNC bool nameIs(xmlAttrPtr attrib, const std::string &name);
     BASELIBRARY_PUBLIC_FUNC void getXMLDocMetainfo(xmlDocPtr doc, std::string &doctype, std::string &docversion);
+    BASELIBRARY_PUBLIC_FUNC void getXMLFileMetainfo(const std::string &path, std::string &doctype,
+                                                    std::string &docversion);
     BASELIBRARY_PUBLIC_FUNC std::string getProp(xmlNodePtr node, const std::string &name);
     BASELIBRARY_PUBLIC_FUNC std::string getContent(xmlNodePtr node);
     BASELIBRARY_PUBLIC_FUNC std::string getContentRecursive(xmlNodePtr node);
@@ -22,6 +22,7 @@
 #include "base/string_utilities.h"
 #include "base/file_utilities.h"
 #include <libxml/HTMLparser.h>
+#include <libxml/xmlreader.h>
 
 #include <glib.h>
 #include <stdexcept>
@@ -91,6 +92,27 @@ void base::xml::getXMLDocMetainfo(xmlDocPtr doc, std::string &doctype, std::stri
   }
 }
 
+// Same as getXMLDocMetainfo(), but only reads the file up to its root element.
+void base::xml::getXMLFileMetainfo(const std::string &path, std::string &doctype, std::string &docversion) {
+  xmlTextReaderPtr reader = xmlReaderForFile(path.c_str(), NULL, 0);
+  if (reader == nullptr)
+    return;
+
+  while (xmlTextReaderRead(reader) == 1) {
+    if (xmlTextReaderNodeType(reader) == XML_READER_TYPE_ELEMENT) {
+      xmlChar *prop = xmlTextReaderGetAttribute(reader, (xmlChar *)"document_type");
+      doctype = prop ? (char *)prop : "";
+      xmlFree(prop);
+
+      prop = xmlTextReaderGetAttribute(reader, (xmlChar *)"version");
+      docversion = prop ? (char *)prop : "";
+      xmlFree(prop);
+      break;
+    }
+  }
+  xmlFreeTextReader(reader);
+}
+
 std::string base::xml::getProp(xmlNodePtr node, const std::string &name) {
   xmlChar *prop = xmlGetProp(node, (xmlChar *)name.c_str());
   std::string tmp = prop ? (char *)prop : "";
@@ -65,6 +65,14 @@ namespace grt {
       : DiffChange(type), _v(dupvalue ? copy_value(v, true) : v), _free_value(dupvalue) {
     }
 
+    // Copies the value of a change that was created without copying it.
+    void clone_value() {
+      if (!_free_value && _v.is_valid()) {
+        _v = copy_value(_v, true);
+        _free_value = true;
+      }
+    }
+
     virtual ~ValueAddedChange() {
       if (_free_value && _v.is_valid())
         _v.valueptr()->reset_references();
@@ -106,6 +114,14 @@ namespace grt {
       : DiffChange(DictItemAdded), _v(dupvalue ? copy_value(v, true) : v), key(i), _free_values(dupvalue) {
     }
 
+    // Copies the value of a change that was created without copying it.
+    void clone_value() {
+      if (!_free_values && _v.is_valid()) {
+        _v = copy_value(_v, true);
+        _free_values = true;
+      }
+    }
+
     virtual ~DictItemAddedChange() {
       if (_free_values && _v.is_valid())
         _v.valueptr()->reset_references();
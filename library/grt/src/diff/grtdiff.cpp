@@ -28,6 +28,7 @@
 #include "grtdiff.h"
 #include "diffchange.h"
 #include "changefactory.h"
+#include "changeobjects.h"
 #include "grtlistdiff.h"
 #include "grtpp_util.h"
 
@@ -91,6 +92,220 @@ namespace grt {
            (XOR(is_any(source), is_any(target)) && (is_simple_type(type) || type == ObjectType));
   }
 
+  //------------------------------------------------------------------------------------------------
+
+  struct GrtDiff::RunCache {
+    // Members to compare per metaclass: name and whether the value is followed (compared in depth).
+    std::map<MetaClass *, std::vector<std::pair<std::string, bool> > > plans;
+
+    // Structure hashes of the objects seen so far and the objects currently being hashed.
+    std::map<internal::Value *, guint64> hashes;
+    std::set<internal::Value *> hashing;
+  };
+
+  // The run cache of the diff currently running in this thread, if any.
+  static GPrivate current_run_cache = G_PRIVATE_INIT(NULL);
+
+  // The list the values of added changes are collected in instead of copying them, if any (see defer_value_copies).
+  static GPrivate deferred_value_copies = G_PRIVATE_INIT(NULL);
+
+  void GrtDiff::defer_value_copies(DeferredCopies *copies) {
+    g_private_set(&deferred_value_copies, copies);
+  }
+
+  static void clone_added_value(DiffChange *change) {
+    if (change->get_change_type() == ValueAdded)
+      static_cast<ValueAddedChange *>(change)->clone_value();
+    else if (change->get_change_type() == DictItemAdded)
+      static_cast<DictItemAddedChange *>(change)->clone_value();
+  }
+
+  void GrtDiff::copy_deferred_values(const DeferredCopies &copies) {
+    for (DeferredCopies::const_iterator iter = copies.begin(); iter != copies.end(); ++iter)
+      clone_added_value(iter->get());
+  }
+
+  /**
+   * Copies the value of a change created without a copy, or leaves that to the thread that started the diff.
+   */
+  std::shared_ptr<DiffChange> GrtDiff::copy_added_value(const std::shared_ptr<DiffChange> &change) {
+    DeferredCopies *copies = static_cast<DeferredCopies *>(g_private_get(&deferred_value_copies));
+    if (copies != NULL)
+      copies->push_back(change);
+    else
+      clone_added_value(change.get());
+    return change;
+  }
+
+  //------------------------------------------------------------------------------------------------
+
+  GrtDiff::GrtDiff(const Omf *o, bool dont_clone_values) : omf(o), _dont_clone_values(dont_clone_values) {
+    _cache = static_cast<RunCache *>(g_private_get(&current_run_cache));
+    _owns_cache = _cache == NULL;
+    if (_owns_cache) {
+      _cache = new RunCache();
+      g_private_set(&current_run_cache, _cache);
+    }
+  }
+
+  GrtDiff::~GrtDiff() {
+    if (_owns_cache) {
+      g_private_set(&current_run_cache, NULL);
+      delete _cache;
+    }
+  }
+
+  //------------------------------------------------------------------------------------------------
+
+  /**
+   * Returns the members of objects with the given metaclass that take part in a diff, in the order they are
+   * compared. Overridden and dontdiff members (for the current mask) are left out.
+   */
+  const std::vector<std::pair<std::string, bool> > &GrtDiff::diff_plan(MetaClass *meta) {
+    std::map<MetaClass *, std::vector<std::pair<std::string, bool> > >::iterator plan = _cache->plans.find(meta);
+    if (plan != _cache->plans.end())
+      return plan->second;
+
+    std::vector<std::pair<std::string, bool> > &members = _cache->plans[meta];
+    bool skip_definer =
+      omf->skip_routine_definer && (meta->name() == "db.mysql.Routine" || meta->name() == "db.Routine");
+    MetaClass *current = meta;
+    do {
+      for (MetaClass::MemberList::const_iterator iter = current->get_members_partial().begin();
+           iter != current->get_members_partial().end(); ++iter) {
+        if (iter->second.overrides)
+          continue;
+
+        std::string name = iter->second.name;
+        std::string attr = current->get_member_attribute(name, "dontdiff");
+        if (attr.size() && (base::atoi<int>(attr, 0) & omf->dontdiff_mask))
+          continue;
+
+        if (skip_definer && (name == "sqlDefinition" || name == "definer"))
+          continue;
+
+        bool follow =
+          iter->second.owned_object || (name == "flags") || (name == "columns" && !current->is_a("db.Index"));
+        members.push_back(std::make_pair(name, follow));
+      }
+      current = current->parent();
+    } while (current != 0);
+
+    return members;
+  }
+
+  //------------------------------------------------------------------------------------------------
+
+  static inline void hash_bytes(guint64 &hash, const void *data, size_t length) {
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < length; ++i) {
+      hash ^= bytes[i];
+      hash *= 1099511628211ULL; // FNV-1a
+    }
+  }
+
+  static inline void hash_string(guint64 &hash, const std::string &text) {
+    guint64 length = text.size();
+    hash_bytes(hash, &length, sizeof(length));
+    hash_bytes(hash, text.data(), text.size());
+  }
+
+  /**
+   * Computes a hash over all the values of the object the diff would look at, so 2 objects with the same
+   * hash can't have any difference. References which are not followed contribute with the name of the referenced
+   * object only (that is all the diff compares for them). Object ids are not part of the hash.
+   */
+  guint64 GrtDiff::structure_hash(const ObjectRef &object) {
+    internal::Value *key = object.valueptr();
+    std::map<internal::Value *, guint64>::const_iterator cached = _cache->hashes.find(key);
+    if (cached != _cache->hashes.end())
+      return cached->second;
+
+    guint64 hash = 14695981039346656037ULL;
+    hash_string(hash, object.class_name());
+
+    if (_cache->hashing.count(key) > 0) {
+      // A reference cycle. Make the result unique, so nothing on the cycle is ever taken as unchanged.
+      hash_bytes(hash, &key, sizeof(key));
+      return hash;
+    }
+    _cache->hashing.insert(key);
+
+    const std::vector<std::pair<std::string, bool> > &plan = diff_plan(object.get_metaclass());
+    for (std::vector<std::pair<std::string, bool> >::const_iterator member = plan.begin(); member != plan.end();
+         ++member) {
+      ValueRef value = object.get_member(member->first);
+      if (member->second) {
+        guint64 member_hash = value_hash(value);
+        hash_bytes(hash, &member_hash, sizeof(member_hash));
+      } else if (value.is_valid() && value.type() == ObjectType) {
+        if (GrtObjectRef::can_wrap(value))
+          hash_string(hash, GrtObjectRef::cast_from(value)->name());
+        else
+          hash_bytes(hash, &key, sizeof(key)); // Always reported as changed by the diff.
+      } else if (value.is_valid() && is_simple_type(value.type())) {
+        guint64 member_hash = value_hash(value);
+        hash_bytes(hash, &member_hash, sizeof(member_hash));
+      }
+      // Lists and dicts which are not followed are never reported as changed.
+    }
+
+    _cache->hashing.erase(key);
+    _cache->hashes[key] = hash;
+    return hash;
+  }
+
+  guint64 GrtDiff::value_hash(const ValueRef &value) {
+    guint64 hash = 14695981039346656037ULL;
+    if (!value.is_valid())
+      return hash;
+
+    Type type = value.type();
+    hash_bytes(hash, &type, sizeof(type));
+    switch (type) {
+      case IntegerType: {
+        IntegerRef::storage_type number = *IntegerRef::cast_from(value);
+        hash_bytes(hash, &number, sizeof(number));
+        break;
+      }
+      case DoubleType: {
+        DoubleRef::storage_type number = *DoubleRef::cast_from(value);
+        hash_bytes(hash, &number, sizeof(number));
+        break;
+      }
+      case StringType:
+        hash_string(hash, *StringRef::cast_from(value));
+        break;
+      case ListType: {
+        BaseListRef list(BaseListRef::cast_from(value));
+        for (size_t i = 0; i < list.count(); ++i) {
+          guint64 item_hash = value_hash(list[i]);
+          hash_bytes(hash, &item_hash, sizeof(item_hash));
+        }
+        break;
+      }
+      case DictType: {
+        DictRef dict(DictRef::cast_from(value));
+        for (internal::Dict::const_iterator iter = dict.begin(); iter != dict.end(); ++iter) {
+          hash_string(hash, iter->first);
+          guint64 item_hash = value_hash(iter->second);
+          hash_bytes(hash, &item_hash, sizeof(item_hash));
+        }
+        break;
+      }
+      case ObjectType: {
+        guint64 object_hash = structure_hash(ObjectRef::cast_from(value));
+        hash_bytes(hash, &object_hash, sizeof(object_hash));
+        break;
+      }
+      default:
+        break;
+    }
+    return hash;
+  }
+
+  //------------------------------------------------------------------------------------------------
+
   std::shared_ptr<DiffChange> GrtDiff::diff(const ValueRef &source, const ValueRef &target, const Omf *omf) {
     return on_value(std::shared_ptr<DiffChange>(), source, target);
   }
@@ -101,8 +316,10 @@ namespace grt {
     if (!are_compatible(source, target, &type))
       return on_uncompatible(parent, source, target);
 
-    if (is_any(source))
-      return ChangeFactory::create_value_added_change(parent, source, target, !_dont_clone_values);
+    if (is_any(source)) {
+      std::shared_ptr<DiffChange> change = ChangeFactory::create_value_added_change(parent, source, target, false);
+      return _dont_clone_values ? change : copy_added_value(change);
+    }
 
     if (is_any(target))
       return ChangeFactory::create_value_removed_change(parent, source, target);
@@ -149,98 +366,86 @@ namespace grt {
         return std::shared_ptr<DiffChange>();
     }
 
+    // Objects with identical structure can't have any difference, no need to go through them (and all their
+    // sub objects) member by member.
+    if (omf->skip_identical_objects && source.class_name() == target.class_name() &&
+        structure_hash(source) == structure_hash(target))
+      return std::shared_ptr<DiffChange>();
+
     // Compare all members of the objects with each other, looking for any differences
-    do {
-      for (MetaClass::MemberList::const_iterator iter = meta->get_members_partial().begin();
-           iter != meta->get_members_partial().end(); ++iter) {
-        if (iter->second.overrides)
-          continue;
+    const std::vector<std::pair<std::string, bool> > &plan = diff_plan(meta);
+    for (std::vector<std::pair<std::string, bool> >::const_iterator iter = plan.begin(); iter != plan.end(); ++iter) {
+      const std::string &name = iter->first;
 
-        std::string name = iter->second.name;
-        std::string attr = meta->get_member_attribute(name, "dontdiff");
-        int dontdiff = attr.size() && (base::atoi<int>(attr, 0) & omf->dontdiff_mask);
+      ValueRef v1 = source.get_member(name);
+      ValueRef v2 = target.get_member(name);
 
-        if (dontdiff)
-          continue;
+      if (!v1.is_valid() && !v2.is_valid())
+        continue;
 
-        ValueRef v1 = source.get_member(name);
-        ValueRef v2 = target.get_member(name);
+      // don't bother with the rest if the values are simple and identical
+      if (v1.type() == v2.type() && is_simple_type(v1.type()) && v1 == v2)
+        continue;
 
-        if (!v1.is_valid() && !v2.is_valid())
+      // skip empty containers
+      if (v1.type() == grt::ListType)
+        if (grt::BaseListRef::cast_from(v1).count() == 0 && grt::BaseListRef::cast_from(v2).count() == 0)
           continue;
-
-        // don't bother with the rest if the values are simple and identical
-        if (v1.type() == v2.type() && is_simple_type(v1.type()) && v1 == v2)
+      if (v1.type() == grt::DictType)
+        if (grt::DictRef::cast_from(v1).count() == 0 && grt::DictRef::cast_from(v2).count() == 0)
           continue;
 
-        // skip empty containers
-        if (v1.type() == grt::ListType)
-          if (grt::BaseListRef::cast_from(v1).count() == 0 && grt::BaseListRef::cast_from(v2).count() == 0)
-            continue;
-        if (v1.type() == grt::DictType)
-          if (grt::DictRef::cast_from(v1).count() == 0 && grt::DictRef::cast_from(v2).count() == 0)
-            continue;
-
-        if (omf->skip_routine_definer &&
-            (source.class_name() == "db.mysql.Routine" || source.class_name() == "db.Routine") &&
-            (name == "sqlDefinition" || name == "definer"))
-          continue;
+      if (omf->normalizer && omf->normalizer(source, target, name))
+        continue;
 
-        if (omf->normalizer && omf->normalizer(source, target, name))
+      //        if (name == "sqlDefinition") continue;
+      // v2 is our model
+      std::shared_ptr<DiffChange> change;
+      const bool dontfollow = !iter->second;
+      if (dontfollow && GrtObjectRef::can_wrap(v1) && GrtObjectRef::can_wrap(v2)) {
+        if (omf->normalizer && omf->normalizer(GrtObjectRef::cast_from(v1), GrtObjectRef::cast_from(v2), "name"))
           continue;
-
-        //        if (name == "sqlDefinition") continue;
-        // v2 is our model
-        std::shared_ptr<DiffChange> change;
-        const bool dontfollow =
-          !iter->second.owned_object && (name != "flags") && (name != "columns" || meta->is_a("db.Index"));
-        if (dontfollow && GrtObjectRef::can_wrap(v1) && GrtObjectRef::can_wrap(v2)) {
-          if (omf->normalizer && omf->normalizer(GrtObjectRef::cast_from(v1), GrtObjectRef::cast_from(v2), "name"))
-            continue;
-          StringRef n1(v1.is_valid() ? GrtObjectRef::cast_from(v1)->name() : "");
-          StringRef n2(v2.is_valid() ? GrtObjectRef::cast_from(v2)->name() : "");
-          if (n1 == n2)
-            continue;
-        }
+        StringRef n1(v1.is_valid() ? GrtObjectRef::cast_from(v1)->name() : "");
+        StringRef n2(v2.is_valid() ? GrtObjectRef::cast_from(v2)->name() : "");
+        if (n1 == n2)
+          continue;
+      }
 
 #if 0
 #error "don't use log_calls* for debug output! This is output is not meant to end up in the log."
-      // Debug code below, modify it to suit your needs to see what is the exact difference being detected
-      // between 2 objects
-      if (source.class_name() == "db.mysql.Routine")
+    // Debug code below, modify it to suit your needs to see what is the exact difference being detected
+    // between 2 objects
+    if (source.class_name() == "db.mysql.Routine")
+    {
+      if (changes.empty())
+        log_info("\nObject: %s <%s>  [%s]\n", source.get_string_member("name").c_str(), source.class_name().c_str(), source.id().c_str());
+
+      std::string s1 = v1.description();
+      std::string s2 = v2.description();
+      if (s1 == s2)
+        log_info("field %s came as different, but looks the same?\n", name.c_str());
+      else
       {
-        if (changes.empty())
-          log_info("\nObject: %s <%s>  [%s]\n", source.get_string_member("name").c_str(), source.class_name().c_str(), source.id().c_str());
-
-        std::string s1 = v1.description();
-        std::string s2 = v2.description();
-        if (s1 == s2)
-          log_info("field %s came as different, but looks the same?\n", name.c_str());
-        else
+        if (false)
         {
-          if (false)
-          {
-            int first_diff = strspn(s1.data(), s2.data());
-            log_info("Changed field %s.'%s': [%i] %s -> %s\n", source.get_string_member("name").c_str(), name.c_str(), first_diff,
-                     (s1.substr(std::max(first_diff-20, 0), 40)+"...").c_str(), (s2.substr(std::max(first_diff-20, 0), 40)+"...").c_str());
-          }
-          else
-            log_info("Changed field %s.'%s':\nOBJECT 1: %s\n\nOBJECT 2: %s\n\n", source.get_string_member("name").c_str(), name.c_str(),
-                     s1.c_str(), s2.c_str());
-
+          int first_diff = strspn(s1.data(), s2.data());
+          log_info("Changed field %s.'%s': [%i] %s -> %s\n", source.get_string_member("name").c_str(), name.c_str(), first_diff,
+                   (s1.substr(std::max(first_diff-20, 0), 40)+"...").c_str(), (s2.substr(std::max(first_diff-20, 0), 40)+"...").c_str());
         }
+        else
+          log_info("Changed field %s.'%s':\nOBJECT 1: %s\n\nOBJECT 2: %s\n\n", source.get_string_member("name").c_str(), name.c_str(),
+                   s1.c_str(), s2.c_str());
+
       }
+    }
 #endif
 
-        change = ChangeFactory::create_object_attr_modified_change(
-          parent, source, target, name, dontfollow ? ChangeFactory::create_simple_value_change(parent, v1, v2)
-                                                   : on_value(std::shared_ptr<DiffChange>(), v1, v2));
+      change = ChangeFactory::create_object_attr_modified_change(
+        parent, source, target, name, dontfollow ? ChangeFactory::create_simple_value_change(parent, v1, v2)
+                                                 : on_value(std::shared_ptr<DiffChange>(), v1, v2));
 
-        changes.append(change);
-      }
-
-      meta = meta->parent();
-    } while (meta != 0);
+      changes.append(change);
+    }
     return ChangeFactory::create_object_modified_change(parent, source, target, changes);
   }
 
@@ -274,7 +479,8 @@ namespace grt {
       ValueRef target_item(iter->second);
 
       if (!source.has_key(key))
-        changes.append(ChangeFactory::create_dict_item_added_change(parent, source, target, key, target_item));
+        changes.append(copy_added_value(
+          ChangeFactory::create_dict_item_added_change(parent, source, target, key, target_item, false)));
     }
 
     return ChangeFactory::create_dict_change(parent, source, target, changes);
@@ -282,6 +488,6 @@ namespace grt {
 
   std::shared_ptr<DiffChange> GrtDiff::on_uncompatible(std::shared_ptr<DiffChange> parent, const ValueRef &source,
                                                        const ValueRef &target) {
-    return ChangeFactory::create_value_added_change(parent, source, target);
+    return copy_added_value(ChangeFactory::create_value_added_change(parent, source, target, false));
   }
 }
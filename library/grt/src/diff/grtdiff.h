@@ -30,9 +30,19 @@ namespace grt {
 
   class GrtDiff {
   protected:
+    struct RunCache;
+
     const Omf *omf;
     bool _dont_clone_values;
 
+    // Data shared by all GrtDiff instances of a diff run (list items are compared by separate instances).
+    RunCache *_cache;
+    bool _owns_cache;
+
+    const std::vector<std::pair<std::string, bool> > &diff_plan(MetaClass *meta);
+    guint64 structure_hash(const ObjectRef &object);
+    guint64 value_hash(const ValueRef &value);
+
     virtual std::shared_ptr<DiffChange> on_list(std::shared_ptr<DiffChange> parent, const BaseListRef &source,
                                                 const BaseListRef &target);
     virtual std::shared_ptr<DiffChange> on_dict(std::shared_ptr<DiffChange> parent, const DictRef &source,
@@ -46,11 +56,19 @@ namespace grt {
     std::shared_ptr<DiffChange> on_value(std::shared_ptr<DiffChange> parent, const ValueRef &source,
                                          const ValueRef &target);
 
+    std::shared_ptr<DiffChange> copy_added_value(const std::shared_ptr<DiffChange> &change);
+
   public:
-    GrtDiff(const Omf *o, bool dont_clone_values = false) : omf(o), _dont_clone_values(dont_clone_values) {
-    }
+    typedef std::vector<std::shared_ptr<DiffChange> > DeferredCopies;
+
+    // While set for a thread, the values of added changes created by its diffs are not copied but collected
+    // in the given list. New GRT objects are only created by the thread that started the diff, which copies
+    // them with copy_deferred_values() once the worker is done.
+    static void defer_value_copies(DeferredCopies *copies);
+    static void copy_deferred_values(const DeferredCopies &copies);
+
+    GrtDiff(const Omf *o, bool dont_clone_values = false);
     std::shared_ptr<DiffChange> diff(const ValueRef &source, const ValueRef &target, const Omf *omf);
-    virtual ~GrtDiff() {
-    }
+    virtual ~GrtDiff();
   };
 }
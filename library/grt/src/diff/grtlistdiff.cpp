@@ -24,9 +24,12 @@
 #include "changelistobjects.h"
 #include "grtdiff.h"
 #include "base/log.h"
+#include "base/threading.h"
+#include "base/scope_exit_trigger.h"
 
 #include <memory>
 #include <algorithm>
+#include <exception>
 
 namespace grt {
   // typedef ListDifference<ValueRef, internal::List::raw_iterator, internal::List::raw_iterator> GrtListDifference;
@@ -133,6 +136,102 @@ namespace grt {
       return a->get_index() < b->get_index();
   }
 
+  //------------------------------------------------------------------------------------------------
+
+#define PARALLEL_LIST_DIFF_MIN_COUNT 32
+#define MAX_LIST_DIFF_THREAD_COUNT 8
+
+  // Set while the items of a list are diffed in worker threads. Lists nested in those items (and lists diffed
+  // concurrently by other threads) are then diffed sequentially.
+  static volatile gint parallel_list_diff_running = 0;
+
+  // Items existing in both lists, which must be diffed themselves.
+  struct ItemPairs {
+    std::vector<ValueRef> sources;
+    std::vector<ValueRef> targets;
+    std::vector<size_t> indexes;
+  };
+
+  struct ItemPairsRange {
+    const ItemPairs *pairs;
+    const Omf *omf;
+    std::vector<std::shared_ptr<ListItemModifiedChange> > *results;
+    size_t begin;
+    size_t end;
+    std::exception_ptr error; // Thrown in a worker thread, rethrown by the calling thread.
+    GrtDiff::DeferredCopies copies; // Values of added changes, copied by the calling thread.
+
+    void diff() {
+      for (size_t i = begin; i < end; ++i)
+        (*results)[i] = create_item_modified_change(pairs->sources[i], pairs->targets[i], omf, pairs->indexes[i]);
+    }
+
+    static gpointer run(gpointer data) {
+      ItemPairsRange *range = static_cast<ItemPairsRange *>(data);
+      GrtDiff::defer_value_copies(&range->copies);
+      try {
+        range->diff();
+      } catch (...) {
+        range->error = std::current_exception();
+      }
+      GrtDiff::defer_value_copies(NULL);
+      return NULL;
+    }
+  };
+
+  /**
+   * Diffs the given item pairs, storing the results in the same order. Lists with many items (e.g. the tables of
+   * a schema) are split into consecutive ranges, which are diffed in worker threads. The workers only read the
+   * GRT trees, the values of added changes they create are copied by the calling thread after they finished.
+   */
+  static void diff_item_pairs(const ItemPairs &pairs, const Omf *omf,
+                              std::vector<std::shared_ptr<ListItemModifiedChange> > &results) {
+    size_t count = pairs.sources.size();
+    size_t thread_count = std::min<size_t>(MAX_LIST_DIFF_THREAD_COUNT, g_get_num_processors());
+    if (count < PARALLEL_LIST_DIFF_MIN_COUNT || thread_count < 2 || (omf != NULL && !omf->parallel_list_diff) ||
+        !g_atomic_int_compare_and_exchange(&parallel_list_diff_running, 0, 1)) {
+      ItemPairsRange range = {&pairs, omf, &results, 0, count, std::exception_ptr()};
+      range.diff();
+      return;
+    }
+
+    std::vector<ItemPairsRange> ranges(thread_count);
+    size_t chunk_size = (count + thread_count - 1) / thread_count;
+    for (size_t n = 0; n < thread_count; ++n) {
+      ItemPairsRange range = {&pairs, omf, &results, std::min(n * chunk_size, count),
+                              std::min((n + 1) * chunk_size, count), std::exception_ptr()};
+      ranges[n] = range;
+    }
+
+    std::vector<GThread *> threads(thread_count, (GThread *)NULL);
+    {
+      // Whatever happens, the workers are joined before their ranges go away and nested lists may run in parallel
+      // again.
+      base::ScopeExitTrigger join_threads([&threads]() {
+        for (size_t n = 1; n < threads.size(); ++n)
+          if (threads[n] != NULL)
+            g_thread_join(threads[n]);
+        g_atomic_int_set(&parallel_list_diff_running, 0);
+      });
+
+      for (size_t n = 1; n < thread_count; ++n) {
+        threads[n] = base::create_thread(&ItemPairsRange::run, &ranges[n]);
+        if (threads[n] == NULL)
+          ItemPairsRange::run(&ranges[n]);
+      }
+      ranges[0].diff();
+    }
+
+    for (size_t n = 0; n < thread_count; ++n)
+      if (ranges[n].error)
+        std::rethrow_exception(ranges[n].error);
+
+    for (size_t n = 1; n < thread_count; ++n)
+      GrtDiff::copy_deferred_values(ranges[n].copies);
+  }
+
+  //------------------------------------------------------------------------------------------------
+
   std::shared_ptr<MultiChange> GrtListDiff::diff(const BaseListRef &source, const BaseListRef &target, const Omf *omf) {
     typedef std::vector<size_t> TIndexContainer;
     default_omf def_omf;
@@ -203,16 +302,23 @@ namespace grt {
       changes.push_back(orderchange);
     }
 
+    ItemPairs pairs;
     for (TIndexContainer::iterator It = stable_elements.begin(); It != stable_elements.end(); ++It) {
       internal::List::raw_const_iterator It_target = find_if(target.content().raw_begin(), target.content().raw_end(),
                                                              std::bind2nd(OmfEqPred(comparer), source.get(*It)));
       if (It_target != target.content().raw_end()) {
-        std::shared_ptr<ListItemChange> change =
-          create_item_modified_change(source.get(*It), *It_target, omf, target.get_index(*It_target));
-        if (change)
-          changes.push_back(change);
+        pairs.sources.push_back(source.get(*It));
+        pairs.targets.push_back(*It_target);
+        pairs.indexes.push_back(target.get_index(*It_target));
       }
     }
+
+    std::vector<std::shared_ptr<ListItemModifiedChange> > modified(pairs.sources.size());
+    diff_item_pairs(pairs, omf, modified);
+    for (size_t i = 0; i < modified.size(); ++i) {
+      if (modified[i])
+        changes.push_back(modified[i]);
+    }
     ChangeSet retval;
     std::sort(changes.begin(), changes.end(), diffPred);
     for (std::vector<std::shared_ptr<ListItemChange> >::const_iterator It = changes.begin(); It != changes.end(); ++It)
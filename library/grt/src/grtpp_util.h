@@ -77,6 +77,14 @@ namespace grt {
   template <class O>
   inline Ref<O> find_named_object_in_list(const ListRef<O> &list, const std::string &value, bool case_sensitive = true,
                                           const std::string &name = "name") {
+    if (!list.is_valid())
+      return Ref<O>();
+
+    if (name == "name") {
+      size_t index = list.content().find_object_by_name(value, case_sensitive);
+      return index == BaseListRef::npos ? Ref<O>() : list[index];
+    }
+
     for (size_t i = 0; i < list.count(); i++) {
       Ref<O> tmp = list[i];
 
@@ -88,14 +96,11 @@ namespace grt {
 
   template <class O>
   inline Ref<O> find_object_in_list(const ListRef<O> &list, const std::string &id) {
-    size_t i, c = list.count();
-    for (i = 0; i < c; i++) {
-      Ref<O> value = list[i];
+    if (!list.is_valid())
+      return Ref<O>();
 
-      if (value.is_valid() && value->id() == id)
-        return value;
-    }
-    return Ref<O>();
+    size_t index = list.content().find_object_by_id(id);
+    return index == BaseListRef::npos ? Ref<O>() : list[index];
   }
 
   template <class O>
@@ -220,7 +225,16 @@ namespace grt {
     //_dontdiff_mask will hold mask to allow selective bypass of ceratin fields
     // 1 always diff, 2 diff only vs db, 4 diff only vs live object
     unsigned int dontdiff_mask;
-    Omf() : case_sensitive(true), skip_routine_definer(false), dontdiff_mask(1){};
+    // objects with equal structure hashes are taken as unchanged without comparing their members one by one
+    bool skip_identical_objects;
+    // items of big lists may be diffed in worker threads
+    bool parallel_list_diff;
+    Omf()
+      : case_sensitive(true),
+        skip_routine_definer(false),
+        dontdiff_mask(1),
+        skip_identical_objects(true),
+        parallel_list_diff(true){};
     virtual ~Omf(){};
     virtual bool less(const ValueRef &, const ValueRef &) const = 0;
     virtual bool equal(const ValueRef &, const ValueRef &) const = 0;
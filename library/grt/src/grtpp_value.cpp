@@ -24,7 +24,9 @@
 #include "grtpp_util.h"
 #include "grtpp_undo_manager.h"
 
+#include <algorithm>
 #include <glib.h>
+#include <unordered_map>
 
 #ifdef GRT_LEAK_DETECTOR_ENABLED
 #include <iostream>
@@ -201,11 +203,62 @@ std::string List::toString() const {
   return s;
 }
 
-List::List(bool allow_null) : _allow_null(allow_null) {
+//--------------------------------------------------------------------------------------------------
+
+// Smaller lists are searched sequentially, building an index for them doesn't pay off.
+#define LIST_INDEX_MIN_COUNT 16
+
+// Guards the lists registered in Object::_indexing_lists. Taken while holding a list's index mutex, but never the
+// other way around, so renaming an object doesn't have to wait for lookups in its lists.
+static base::Mutex list_index_registry_mutex;
+
+struct List::Index {
+  bool names_built;
+  bool folded_names_built;
+  bool ids_built;
+
+  // Key -> position of the first object in the list with that key.
+  std::unordered_map<std::string, size_t> names;
+  std::unordered_map<std::string, size_t> folded_names;
+  std::unordered_map<std::string, size_t> ids;
+
+  Index() : names_built(false), folded_names_built(false), ids_built(false) {
+  }
+};
+
+/**
+ * Names are compared with base::same_string(), so the index uses the same normalization (and case folding).
+ */
+static std::string name_index_key(const std::string& name, bool case_sensitive) {
+  gchar* normalized = g_utf8_normalize(name.c_str(), -1, G_NORMALIZE_DEFAULT);
+  if (normalized == NULL)
+    return name;
+
+  if (!case_sensitive) {
+    gchar* folded = g_utf8_casefold(normalized, -1);
+    g_free(normalized);
+    normalized = folded;
+  }
+
+  std::string key = normalized;
+  g_free(normalized);
+  return key;
+}
+
+static Object* object_in_list(const ValueRef& value) {
+  if (!value.is_valid() || value.type() != ObjectType)
+    return NULL;
+  return static_cast<Object*>(value.valueptr());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+List::List(bool allow_null) : _allow_null(allow_null), _index(NULL), _index_stale(0) {
   _is_global = 0;
 }
 
-List::List(Type content_type, const std::string& content_class, bool allow_null) : _allow_null(allow_null) {
+List::List(Type content_type, const std::string& content_class, bool allow_null)
+  : _allow_null(allow_null), _index(NULL), _index_stale(0) {
   _content_type.type = content_type;
   _content_type.object_class = content_class;
 
@@ -213,8 +266,142 @@ List::List(Type content_type, const std::string& content_class, bool allow_null)
 }
 
 List::~List() {
+  // Unregisters the list from the indexed objects, which may outlive it.
+  drop_index();
 }
 
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the index for this list, creating a new one if there is none yet or an object in it was renamed.
+ * The index mutex must be held by the caller.
+ */
+const List::Index* List::index() const {
+  if (g_atomic_int_get(&_index_stale)) {
+    delete _index;
+    _index = NULL;
+  }
+
+  if (_index == NULL) {
+    // Cleared before the index is filled, so a rename during the build makes the new index stale again.
+    g_atomic_int_set(&_index_stale, 0);
+    _index = new Index();
+  }
+  return _index;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Records that the object is in the index of this list, so that renaming it or changing its id only invalidates
+ * the indexes of the lists it is in. The index mutex must be held by the caller.
+ */
+void List::register_indexed_object(Object* object) const {
+  MutexLock lock(list_index_registry_mutex);
+  if (std::find(object->_indexing_lists.begin(), object->_indexing_lists.end(), this) ==
+      object->_indexing_lists.end())
+    object->_indexing_lists.push_back(this);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Called by all functions changing the list content, before the change is made. The index is built again on the
+ * next lookup. The content must still be the one the index was built from, as the list is unregistered from the
+ * objects in it here.
+ */
+void List::drop_index() const {
+  MutexLock lock(_index_mutex);
+  if (_index == NULL)
+    return;
+
+  if (_index->names_built || _index->folded_names_built || _index->ids_built) {
+    MutexLock registry_lock(list_index_registry_mutex);
+    for (size_t i = 0; i < _content.size(); ++i) {
+      Object* object = object_in_list(_content[i]);
+      if (object != NULL)
+        object->_indexing_lists.erase(
+          std::remove(object->_indexing_lists.begin(), object->_indexing_lists.end(), this),
+          object->_indexing_lists.end());
+    }
+  }
+
+  delete _index;
+  _index = NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Called when an object in the index of this list changed its name or id. Only sets a flag, so it can be called
+ * without the index mutex (and from a thread other than the one doing lookups).
+ */
+void List::mark_index_stale() const {
+  g_atomic_int_set(&_index_stale, 1);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+size_t List::find_object_by_name(const std::string& name, bool case_sensitive) const {
+  if (_content.size() < LIST_INDEX_MIN_COUNT) {
+    for (size_t i = 0; i < _content.size(); ++i) {
+      Object* object = object_in_list(_content[i]);
+      if (object != NULL && base::same_string(object->get_string_member("name"), name, case_sensitive))
+        return i;
+    }
+    return npos;
+  }
+
+  MutexLock lock(_index_mutex);
+  Index* list_index = const_cast<Index*>(index());
+  std::unordered_map<std::string, size_t>& names = case_sensitive ? list_index->names : list_index->folded_names;
+  bool& built = case_sensitive ? list_index->names_built : list_index->folded_names_built;
+  if (!built) {
+    for (size_t i = 0; i < _content.size(); ++i) {
+      Object* object = object_in_list(_content[i]);
+      if (object != NULL && object->has_member("name")) {
+        register_indexed_object(object);
+        names.insert(std::make_pair(name_index_key(object->get_string_member("name"), case_sensitive), i));
+      }
+    }
+    built = true;
+  }
+
+  std::unordered_map<std::string, size_t>::const_iterator entry = names.find(name_index_key(name, case_sensitive));
+  return entry == names.end() ? (size_t)npos : entry->second;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+size_t List::find_object_by_id(const std::string& id) const {
+  if (_content.size() < LIST_INDEX_MIN_COUNT) {
+    for (size_t i = 0; i < _content.size(); ++i) {
+      Object* object = object_in_list(_content[i]);
+      if (object != NULL && object->id() == id)
+        return i;
+    }
+    return npos;
+  }
+
+  MutexLock lock(_index_mutex);
+  Index* list_index = const_cast<Index*>(index());
+  if (!list_index->ids_built) {
+    for (size_t i = 0; i < _content.size(); ++i) {
+      Object* object = object_in_list(_content[i]);
+      if (object != NULL) {
+        register_indexed_object(object);
+        list_index->ids.insert(std::make_pair(object->id(), i));
+      }
+    }
+    list_index->ids_built = true;
+  }
+
+  std::unordered_map<std::string, size_t>::const_iterator entry = list_index->ids.find(id);
+  return entry == list_index->ids.end() ? (size_t)npos : entry->second;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void List::set_unchecked(size_t index, const ValueRef& value) {
   if (index >= count())
     throw bad_item(index, count());
@@ -237,6 +424,7 @@ void List::set_unchecked(size_t index, const ValueRef& value) {
       value.mark_global();
     }
 
+    drop_index();
     _content[index] = value;
   }
 }
@@ -245,6 +433,8 @@ void List::insert_unchecked(const ValueRef& value, size_t index) {
   if (_is_global > 0 && value.is_valid())
     value.mark_global();
 
+  drop_index();
+
   if (index == npos) {
     if (_is_global > 0 && grt::GRT::get()->tracking_changes())
       grt::GRT::get()->get_undo_manager()->add_undo(new UndoListInsertAction(this, index));
@@ -270,6 +460,7 @@ void List::remove(const ValueRef& value) {
       if (_is_global > 0 && grt::GRT::get()->tracking_changes())
         grt::GRT::get()->get_undo_manager()->add_undo(new UndoListRemoveAction(this, i));
 
+      drop_index();
       _content.erase(_content.begin() + i);
     }
   }
@@ -285,6 +476,7 @@ void List::remove(size_t index) {
   if (_is_global > 0 && grt::GRT::get()->tracking_changes())
     grt::GRT::get()->get_undo_manager()->add_undo(new UndoListRemoveAction(this, index));
 
+  drop_index();
   _content.erase(_content.begin() + index);
 }
 
@@ -295,6 +487,8 @@ void List::reorder(size_t oi, size_t ni) {
   if (_is_global > 0 && grt::GRT::get()->tracking_changes())
     grt::GRT::get()->get_undo_manager()->add_undo(new UndoListReorderAction(this, oi, ni));
 
+  drop_index();
+
   ValueRef tmp(_content[oi]);
   _content.erase(_content.begin() + oi);
   if (ni >= _content.size())
@@ -926,10 +1120,23 @@ ValueRef Object::call(const std::string& method, const BaseListRef& args) {
   return _metaclass->call_method(this, method, args);
 }
 
+/**
+ * Makes the indexes of the lists this object is indexed in stale, see List::find_object_by_name().
+ * Indexes of other lists are kept.
+ */
+void Object::invalidate_list_indexes() {
+  MutexLock lock(list_index_registry_mutex);
+  for (std::vector<const List*>::const_iterator list = _indexing_lists.begin(); list != _indexing_lists.end(); ++list)
+    (*list)->mark_index_stale();
+}
+
+//--------------------------------------------------------------------------------------------------
+
 /** Evil function to set ID of an object, use only if you know what you're doing.
  */
 void Object::__set_id(const std::string& id) {
   _id = id;
+  invalidate_list_indexes();
 }
 
 bool process_reset_references_for_member(const MetaClass::Member* m, Object* obj) {
@@ -1011,6 +1218,9 @@ void Object::owned_member_changed(const std::string& name, const grt::ValueRef&
 }
 
 void Object::member_changed(const std::string& name, const grt::ValueRef& ovalue, const grt::ValueRef& nvalue) {
+  if (name == "name")
+    invalidate_list_indexes();
+
   if (_is_global && grt::GRT::get()->tracking_changes())
     grt::GRT::get()->get_undo_manager()->add_undo(new UndoObjectChangeAction(this, name, ovalue));
   _changed_signal(name, ovalue);
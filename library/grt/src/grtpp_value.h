@@ -340,6 +340,12 @@ namespace grt {
 
       size_t get_index(const ValueRef &value);
 
+      // Position of the first object with the given name or id in the list (npos if there is none).
+      // Larger lists are searched through an index, which is built on demand and dropped again when the
+      // list changes or one of the indexed objects gets renamed.
+      size_t find_object_by_name(const std::string &name, bool case_sensitive) const;
+      size_t find_object_by_id(const std::string &id) const;
+
       inline const ValueRef &operator[](size_t i) const {
         return get(i);
       }
@@ -380,14 +386,24 @@ namespace grt {
       friend class ::grt::GRT;
       friend class internal::Serializer;
       friend class internal::Unserializer;
+      friend class Object;
 
       virtual ~List();
 
+      struct Index;
+      const Index *index() const;
+      void register_indexed_object(Object *object) const;
+      void drop_index() const;
+      void mark_index_stale() const;
+
       storage_type _content;
       SimpleTypeSpec _content_type;
       bool _allow_null;
 
       mutable short _is_global;
+      mutable Index *_index; // Lookup index for find_object_by_name/id, NULL if not built (yet).
+      mutable base::Mutex _index_mutex; // Guards _index, lookups can come from different threads.
+      mutable volatile gint _index_stale; // Set when an object in the index was renamed or got a new id.
     };
 
     class MYSQLGRT_PUBLIC OwnedList : public List {
@@ -555,6 +571,7 @@ namespace grt {
       virtual void unmark_global() const;
 
     protected:
+      friend class List;
       friend class OwnedList;
       friend class OwnedDict;
       friend class ::grt::GRT;
@@ -567,6 +584,7 @@ namespace grt {
 
       void owned_member_changed(const std::string &name, const grt::ValueRef &ovalue, const grt::ValueRef &nvalue);
       void member_changed(const std::string &name, const grt::ValueRef &ovalue, const grt::ValueRef &nvalue);
+      void invalidate_list_indexes();
 
       virtual void owned_list_item_added(OwnedList *list, const grt::ValueRef &value);
       virtual void owned_list_item_removed(OwnedList *list, const grt::ValueRef &value);
@@ -583,6 +601,8 @@ namespace grt {
       // ObjectValidFlag _valid_flag;
 
       mutable short _is_global; // whether object is attached to the global GRT tree
+      // lists that have this object in their lookup index, see List::find_object_by_name()
+      mutable std::vector<const List *> _indexing_lists;
 
       //    public:
       //      const ObjectValidFlag &weakref_valid_flag() const { return _valid_flag; }
@@ -24,17 +24,94 @@
 #include "base/string_utilities.h"
 #include "base/log.h"
 #include "base/xml_functions.h"
+#include "base/file_utilities.h"
 
 DEFAULT_LOG_DOMAIN(DOMAIN_GRT)
 
 using namespace grt;
 using namespace grt::internal;
 
+static std::string reader_attribute(xmlTextReaderPtr reader, const char *name) {
+  xmlChar *prop = xmlTextReaderGetAttribute(reader, (xmlChar *)name);
+  std::string tmp = prop ? (char *)prop : "";
+  xmlFree(prop);
+  return tmp;
+}
+
+static bool reader_read(xmlTextReaderPtr reader) {
+  int result = xmlTextReaderRead(reader);
+  if (result < 0) {
+    xmlErrorPtr error = xmlGetLastError();
+
+    if (error)
+      throw std::runtime_error(base::strfmt("Could not parse XML data. Line %d, %s", error->line, error->message));
+    else
+      throw std::runtime_error("Could not parse XML data");
+  }
+  return result == 1;
+}
+
+// Moves the reader to the next child element of the element at the given depth.
+// Returns false when the end of that element was reached instead.
+static bool reader_next_child(xmlTextReaderPtr reader, int depth) {
+  while (reader_read(reader)) {
+    int type = xmlTextReaderNodeType(reader);
+    if (type == XML_READER_TYPE_ELEMENT)
+      return true;
+    if (type == XML_READER_TYPE_END_ELEMENT && xmlTextReaderDepth(reader) == depth)
+      return false;
+  }
+  throw std::runtime_error("Unexpected end of XML data");
+}
+
+// Returns the text of the current element, leaving the reader at its end.
+static std::string reader_content(xmlTextReaderPtr reader) {
+  std::string content;
+
+  if (xmlTextReaderIsEmptyElement(reader))
+    return content;
+
+  int depth = xmlTextReaderDepth(reader);
+  while (reader_read(reader)) {
+    switch (xmlTextReaderNodeType(reader)) {
+      case XML_READER_TYPE_TEXT:
+      case XML_READER_TYPE_CDATA:
+      case XML_READER_TYPE_WHITESPACE:
+      case XML_READER_TYPE_SIGNIFICANT_WHITESPACE:
+        content.append((const char *)xmlTextReaderConstValue(reader));
+        break;
+
+      case XML_READER_TYPE_END_ELEMENT:
+        if (xmlTextReaderDepth(reader) == depth)
+          return content;
+        break;
+
+      default:
+        break;
+    }
+  }
+  throw std::runtime_error("Unexpected end of XML data");
+}
+
+// Moves the reader to the end of the current element, ignoring its contents.
+static void reader_skip(xmlTextReaderPtr reader) {
+  if (xmlTextReaderIsEmptyElement(reader))
+    return;
+
+  int depth = xmlTextReaderDepth(reader);
+  while (reader_next_child(reader, depth))
+    continue;
+}
+
+static bool reader_name_is(xmlTextReaderPtr reader, const char *name) {
+  return xmlStrcmp(xmlTextReaderConstLocalName(reader), (xmlChar *)name) == 0;
+}
+
 internal::Unserializer::Unserializer(bool check_crc) : _check_serialized_crc(check_crc) {
 }
 
 ValueRef internal::Unserializer::find_cached(const std::string &id) {
-  std::map<std::string, ValueRef>::const_iterator iter;
+  std::unordered_map<std::string, ValueRef>::const_iterator iter;
   if ((iter = _cache.find(id)) == _cache.end())
     return ValueRef();
 
@@ -42,14 +119,25 @@ ValueRef internal::Unserializer::find_cached(const std::string &id) {
 }
 
 ValueRef internal::Unserializer::load_from_xml(const std::string &path, std::string *doctype, std::string *docversion) {
-  xmlDocPtr doc = base::xml::loadXMLDoc(path);
+  if (!base::file_exists(path))
+    throw std::runtime_error("unable to open XML file, doesn't exists: " + path);
 
-  ValueRef value = unserialize_xmldoc(doc, path);
+  xmlTextReaderPtr reader = xmlReaderForFile(path.c_str(), NULL, 0);
+  if (!reader)
+    throw std::runtime_error("unable to parse XML file " + path);
 
-  if (doctype && docversion)
-    base::xml::getXMLDocMetainfo(doc, *doctype, *docversion);
+  _source_name = path;
 
-  xmlFreeDoc(doc);
+  ValueRef value;
+  try {
+    value = stream_from_xml(reader, doctype, docversion);
+  } catch (...) {
+    xmlFreeTextReader(reader);
+    discard_streamed();
+    throw;
+  }
+  xmlFreeTextReader(reader);
+  _streamed_keys.clear();
 
   return value;
 }
@@ -289,33 +377,26 @@ ValueRef internal::Unserializer::traverse_xml_recreating_tree(xmlNodePtr node) {
   return value;
 }
 
-ObjectRef internal::Unserializer::unserialize_object_step1(xmlNodePtr node) {
+ObjectRef internal::Unserializer::create_object(const std::string &struct_name, const std::string &id,
+                                                const std::string &checksum, int line) {
   MetaClass *gstruct;
-  std::string id;
 
-  std::string prop = base::xml::getProp(node, "type");
-  if (prop != "object")
-    throw std::runtime_error("error unserializing object (unexpected type)");
-
-  prop = base::xml::getProp(node, "struct-name");
-  if (prop.empty())
+  if (struct_name.empty())
     throw std::runtime_error("error unserializing object (missing struct-name)");
 
-  gstruct = grt::GRT::get()->get_metaclass(prop);
+  gstruct = grt::GRT::get()->get_metaclass(struct_name);
   if (!gstruct) {
-    logWarning("%s:%i: error unserializing object: struct '%s' unknown", _source_name.c_str(), node->line,
-               prop.c_str());
-    throw std::runtime_error(base::strfmt("error unserializing object (struct '%s' unknown)", prop.c_str()));
+    logWarning("%s:%i: error unserializing object: struct '%s' unknown", _source_name.c_str(), line,
+               struct_name.c_str());
+    throw std::runtime_error(base::strfmt("error unserializing object (struct '%s' unknown)", struct_name.c_str()));
   }
 
-  id = base::xml::getProp(node, "id");
   if (id.empty())
     throw std::runtime_error("missing id in unserialized object");
 
-  prop = base::xml::getProp(node, "struct-checksum");
-  if (!prop.empty()) {
-    unsigned int checksum = (unsigned int)strtol(prop.c_str(), NULL, 0);
-    if (_check_serialized_crc && checksum != gstruct->crc32()) {
+  if (!checksum.empty()) {
+    unsigned int crc = (unsigned int)strtol(checksum.c_str(), NULL, 0);
+    if (_check_serialized_crc && crc != gstruct->crc32()) {
       logWarning("current checksum of struct of serialized object %s (%s) differs from the one when it was saved",
                  id.c_str(), gstruct->name().c_str());
     }
@@ -327,6 +408,15 @@ ObjectRef internal::Unserializer::unserialize_object_step1(xmlNodePtr node) {
   return value;
 }
 
+ObjectRef internal::Unserializer::unserialize_object_step1(xmlNodePtr node) {
+  std::string prop = base::xml::getProp(node, "type");
+  if (prop != "object")
+    throw std::runtime_error("error unserializing object (unexpected type)");
+
+  return create_object(base::xml::getProp(node, "struct-name"), base::xml::getProp(node, "id"),
+                       base::xml::getProp(node, "struct-checksum"), node->line);
+}
+
 ObjectRef internal::Unserializer::unserialize_object_step2(xmlNodePtr node) {
   std::string id = base::xml::getProp(node, "id");
 
@@ -411,3 +501,399 @@ ValueRef internal::Unserializer::unserialize_xmldata(const char *data, size_t si
 
   return value;
 }
+
+//--------------------------------------------------------------------------------------------------
+
+// Streaming loader. Values are created while the file is read, so the document is never held in memory as a DOM.
+// Links to objects that only come later in the file are collected and resolved once everything was read.
+
+ValueRef internal::Unserializer::stream_from_xml(xmlTextReaderPtr reader, std::string *doctype,
+                                                 std::string *docversion) {
+  do {
+    if (!reader_read(reader))
+      return ValueRef();
+  } while (xmlTextReaderNodeType(reader) != XML_READER_TYPE_ELEMENT);
+
+  if (doctype && docversion) {
+    *doctype = reader_attribute(reader, "document_type");
+    *docversion = reader_attribute(reader, "version");
+  }
+
+  ValueRef value;
+  int depth = xmlTextReaderDepth(reader);
+  bool has_children = !xmlTextReaderIsEmptyElement(reader);
+  while (has_children && reader_next_child(reader, depth)) {
+    if (reader_name_is(reader, "value")) {
+      value = stream_value(reader, NULL);
+      break;
+    }
+
+    // Not part of the value tree, so no objects are created for it either.
+    reader_skip(reader);
+  }
+
+  resolve_pending_links();
+
+  return value;
+}
+
+ValueRef internal::Unserializer::stream_value(xmlTextReaderPtr reader, PendingLink *link) {
+  if (reader_name_is(reader, "link"))
+    return stream_link(reader, link);
+  else if (!reader_name_is(reader, "value")) {
+    skip_xml_element(reader);
+    return ValueRef();
+  }
+
+  std::string node_type = reader_attribute(reader, "type");
+  if (node_type.empty())
+    throw std::runtime_error("Node 'value' in xml doesn't have a type property");
+
+  Type vtype = str_to_type(node_type);
+  ValueRef value;
+  int depth = xmlTextReaderDepth(reader);
+  bool has_children = !xmlTextReaderIsEmptyElement(reader);
+
+  switch (vtype) {
+    case IntegerType:
+      value = IntegerRef(strtol(reader_content(reader).c_str(), NULL, 0));
+      break;
+
+    case DoubleType:
+      value = DoubleRef(base::atof<double>(reader_content(reader)));
+      break;
+
+    case StringType:
+      value = StringRef(reader_content(reader));
+      break;
+
+    case DictType: {
+      std::string ptr;
+      DictRef dict;
+
+      // check if the dictionary was already created
+      ptr = reader_attribute(reader, "_ptr_");
+      if (!ptr.empty())
+        value = find_cached(ptr);
+
+      if (!value.is_valid()) {
+        std::string prop = reader_attribute(reader, "content-type");
+        if (!prop.empty()) {
+          Type content_type = str_to_type(prop);
+          if (content_type != UnknownType) {
+            std::string content_class_name = reader_attribute(reader, "content-struct-name");
+
+            value = dict = DictRef(content_type, content_class_name);
+          } else
+            throw std::runtime_error("Error parsing XML. Invalid type " + prop);
+        } else
+          value = dict = DictRef(true);
+
+        if (!ptr.empty())
+          cache_streamed(ptr, value);
+      } else
+        dict = DictRef::cast_from(value);
+
+      while (has_children && reader_next_child(reader, depth)) {
+        std::string key = reader_attribute(reader, "key");
+        if (key.empty()) {
+          skip_xml_element(reader);
+          continue;
+        }
+
+        PendingLink pending;
+        ValueRef sub_value = stream_value(reader, &pending);
+        if (!pending.id.empty())
+          defer_link(pending, dict, key, 0);
+        else
+          dict.set(key, sub_value);
+      }
+      break;
+    }
+
+    case ListType: {
+      Type content_type = str_to_type(reader_attribute(reader, "content-type"));
+      std::string cclass_name = reader_attribute(reader, "content-struct-name");
+      std::string prop;
+      BaseListRef list;
+
+      prop = reader_attribute(reader, "_ptr_");
+
+      if (!prop.empty()) {
+        // look up for this ptr, in case the owner object already has created this list
+        value = find_cached(prop);
+        if (!value.is_valid()) {
+          value = list = BaseListRef(content_type, cclass_name);
+
+          cache_streamed(prop, value);
+        } else
+          list = BaseListRef::cast_from(value);
+      } else
+        value = list = BaseListRef(content_type, cclass_name);
+
+      // Position of the next item, including deferred links which are inserted later.
+      size_t position = list.count();
+      while (has_children && reader_next_child(reader, depth)) {
+        if (reader_name_is(reader, "null")) {
+          if (!list->null_allowed()) {
+            logWarning("%s: Attempt o add null value to %s list", _source_name.c_str(), cclass_name.c_str());
+          }
+          list.ginsert(ValueRef());
+          ++position;
+          skip_xml_element(reader);
+          continue;
+        }
+
+        int line = xmlTextReaderGetParserLineNumber(reader);
+        PendingLink pending;
+        ValueRef sub_value = stream_value(reader, &pending);
+
+        if (!pending.id.empty())
+          defer_link(pending, list, "", position++);
+        else if (sub_value.is_valid()) {
+          try {
+            list.ginsert(sub_value);
+            ++position;
+          } catch (const std::exception &exc) {
+            logWarning("%s: Error inserting %s to list: %s", _source_name.c_str(), sub_value.debugDescription().c_str(),
+                       exc.what());
+            throw;
+          }
+        } else {
+          // error!
+          logWarning("%s: skipping element '%s' in unserialized document, line %i", _source_name.c_str(),
+                     (const char *)xmlTextReaderConstLocalName(reader), line);
+          value.clear();
+
+          while (reader_next_child(reader, depth))
+            skip_xml_element(reader);
+          break;
+        }
+      }
+      break;
+    }
+
+    case ObjectType: {
+      ObjectRef object(stream_object(reader));
+      stream_object_contents(object, reader);
+      value = object;
+      break;
+    }
+
+    case UnknownType:
+      skip_xml_element(reader);
+      break;
+  }
+
+  return value;
+}
+
+ValueRef internal::Unserializer::stream_link(xmlTextReaderPtr reader, PendingLink *link) {
+  PendingLink pending;
+  std::string node_type = reader_attribute(reader, "type");
+
+  pending.struct_name = reader_attribute(reader, "struct-name");
+  pending.key = reader_attribute(reader, "key");
+  pending.line = xmlTextReaderGetParserLineNumber(reader);
+  pending.id = reader_content(reader);
+
+  ValueRef value = find_cached(pending.id);
+  if (value.is_valid() || _invalid_cache.find(pending.id) != _invalid_cache.end())
+    return value;
+
+  // if link is not object, then quit
+  if (node_type != "object") {
+    logWarning("%s: link of type '%s' could not be resolved during unserialized", _source_name.c_str(),
+               node_type.c_str());
+    return ValueRef();
+  }
+
+  // the object might still come further down in the file
+  if (link) {
+    *link = pending;
+    return ValueRef();
+  }
+  return resolve_link(pending);
+}
+
+ObjectRef internal::Unserializer::stream_object(xmlTextReaderPtr reader) {
+  std::string struct_name = reader_attribute(reader, "struct-name");
+  std::string id = reader_attribute(reader, "id");
+  int line = xmlTextReaderGetParserLineNumber(reader);
+
+  // The DOM loader keeps one object per id, which all nodes with that id fill and all links point to.
+  // Reusing the object read first gives the same result, without another pass over the file.
+  if (!id.empty() && _streamed_keys.find(id) != _streamed_keys.end()) {
+    ObjectRef object(ObjectRef::cast_from(find_cached(id)));
+    if (object.is_valid()) {
+      logWarning("%s:%i: duplicate object id '%s' in unserialized document\n", _source_name.c_str(), line, id.c_str());
+      if (object.class_name() != struct_name)
+        throw std::runtime_error(base::strfmt("error unserializing object (id '%s' used for %s and %s)", id.c_str(),
+                                              object.class_name().c_str(), struct_name.c_str()));
+      return object;
+    }
+  }
+
+  ObjectRef object = create_object(struct_name, id, reader_attribute(reader, "struct-checksum"), line);
+
+  _streamed_keys.insert(id);
+  _cache[id] = object;
+
+  return object;
+}
+
+void internal::Unserializer::stream_object_contents(const ObjectRef &object, xmlTextReaderPtr reader) {
+  if (xmlTextReaderIsEmptyElement(reader))
+    return;
+
+  int depth = xmlTextReaderDepth(reader);
+  while (reader_next_child(reader, depth)) {
+    std::string key = reader_attribute(reader, "key");
+
+    if (key.empty()) {
+      skip_xml_element(reader);
+    } else if (!object->has_member(key)) {
+      logWarning("in %s: %s", object.id().c_str(),
+                 std::string("unserialized XML contains invalid member " + object.class_name() + "::" + key).c_str());
+      skip_xml_element(reader);
+    } else {
+      // containers created by the object itself are reused for the unserialized contents
+      ValueRef sub_value = object->get_member(key);
+      if (sub_value.is_valid()) {
+        std::string ptr = reader_attribute(reader, "_ptr_");
+        if (!ptr.empty())
+          cache_streamed(ptr, sub_value);
+      }
+
+      PendingLink pending;
+      try {
+        sub_value = stream_value(reader, &pending);
+      } catch (grt::null_value &exc) {
+        logWarning("%s in %s:%s %s", exc.what(), object->class_name().c_str(), key.c_str(), object->id().c_str());
+        throw;
+      }
+
+      if (!pending.id.empty())
+        defer_link(pending, object, key, 0);
+      else if (sub_value.is_valid())
+        assign_member(object, key, sub_value);
+    }
+  }
+}
+
+// Skips an element that doesn't go into the value tree. Objects in it are created anyway, as the DOM loader
+// creates all objects of the file before filling them, so links to them still resolve.
+void internal::Unserializer::skip_xml_element(xmlTextReaderPtr reader) {
+  if (reader_name_is(reader, "value") && reader_attribute(reader, "type") == "object")
+    stream_object(reader);
+
+  if (xmlTextReaderIsEmptyElement(reader))
+    return;
+
+  int depth = xmlTextReaderDepth(reader);
+  while (reader_next_child(reader, depth))
+    skip_xml_element(reader);
+}
+
+void internal::Unserializer::cache_streamed(const std::string &key, const ValueRef &value) {
+  _cache[key] = value;
+  _streamed_keys.insert(key);
+}
+
+// Forgets everything a failed streaming load left in the cache, which is shared with later loads.
+void internal::Unserializer::discard_streamed() {
+  for (std::unordered_set<std::string>::const_iterator iter = _streamed_keys.begin(); iter != _streamed_keys.end();
+       ++iter)
+    _cache.erase(*iter);
+  _streamed_keys.clear();
+  _pending_links.clear();
+}
+
+void internal::Unserializer::defer_link(PendingLink &link, const ValueRef &container, const std::string &member,
+                                        size_t index) {
+  link.container = container;
+  link.member = member;
+  link.index = index;
+  _pending_links.push_back(link);
+}
+
+ValueRef internal::Unserializer::resolve_link(const PendingLink &link) {
+  ValueRef value = find_cached(link.id);
+  if (value.is_valid() || _invalid_cache.find(link.id) != _invalid_cache.end())
+    return value;
+
+  // if the linked object is not in the current tree, look for it in the global tree
+  ObjectRef object(grt::GRT::get()->find_object_by_id(link.id, "/"));
+
+  if (object.is_valid())
+    _cache[object->id()] = object;
+  else {
+    _invalid_cache.insert(link.id);
+    logWarning("%s:%i: link '%s' <object %s> key=%s could not be resolved\n", _source_name.c_str(), link.line,
+               link.id.c_str(), link.struct_name.c_str(), link.key.c_str());
+  }
+
+  return object;
+}
+
+void internal::Unserializer::resolve_pending_links() {
+  std::vector<PendingLink> links;
+  std::unordered_set<internal::Value *> truncated_lists;
+
+  links.swap(_pending_links);
+
+  // Links are in document order, so list items are inserted at increasing positions, each one with all the items
+  // before it already in place.
+  for (std::vector<PendingLink>::const_iterator link = links.begin(); link != links.end(); ++link) {
+    ValueRef value = resolve_link(*link);
+
+    switch (link->container.type()) {
+      case ObjectType:
+        if (value.is_valid())
+          assign_member(ObjectRef::cast_from(link->container), link->member, value);
+        break;
+
+      case DictType:
+        DictRef::cast_from(link->container).set(link->member, value);
+        break;
+
+      case ListType: {
+        BaseListRef list(BaseListRef::cast_from(link->container));
+
+        if (truncated_lists.find(list.valueptr()) != truncated_lists.end())
+          break;
+
+        if (value.is_valid()) {
+          try {
+            list.ginsert(value, link->index);
+          } catch (const std::exception &exc) {
+            logWarning("%s: Error inserting %s to list: %s", _source_name.c_str(), value.debugDescription().c_str(),
+                       exc.what());
+            throw;
+          }
+        } else {
+          // Like the DOM loader, drop this and all following items of the list.
+          logWarning("%s: skipping element 'link' in unserialized document, line %i", _source_name.c_str(),
+                     link->line);
+          while (list.count() > link->index)
+            list.remove(list.count() - 1);
+          truncated_lists.insert(list.valueptr());
+        }
+        break;
+      }
+
+      default:
+        break;
+    }
+  }
+}
+
+void internal::Unserializer::assign_member(const ObjectRef &object, const std::string &key, const ValueRef &value) {
+  try {
+    object->get_metaclass()->set_member_internal((internal::Object *)object.valueptr(), key, value, true);
+  } catch (const std::exception &exc) {
+    logWarning("exception setting %s<%s>:%s to %s %s", object.id().c_str(), object.class_name().c_str(), key.c_str(),
+               value.debugDescription().c_str(), exc.what());
+    throw;
+  }
+}
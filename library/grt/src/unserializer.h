@@ -20,7 +20,9 @@
 #pragma once
 
 #include "grt.h"
-#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <libxml/xmlreader.h>
 
 namespace grt {
   namespace internal {
@@ -35,15 +37,44 @@ namespace grt {
       ValueRef unserialize_xmldata(const char *data, size_t size);
 
     protected:
+      // A link to an object further down in the streamed document, resolved once the whole file was read.
+      struct PendingLink {
+        std::string id;
+        std::string struct_name;
+        std::string key;
+        int line = 0;
+
+        ValueRef container; // The object, list or dict receiving the linked object.
+        std::string member;
+        size_t index = 0;
+      };
+
       std::string _source_name;
-      std::map<std::string, ValueRef> _cache;
-      std::set<std::string> _invalid_cache;
+      std::unordered_map<std::string, ValueRef> _cache;
+      std::unordered_set<std::string> _invalid_cache;
+      std::unordered_set<std::string> _streamed_keys; // Cache entries added by the current streaming load.
+      std::vector<PendingLink> _pending_links;
       bool _check_serialized_crc;
 
+      ValueRef stream_from_xml(xmlTextReaderPtr reader, std::string *doctype, std::string *docversion);
+      ValueRef stream_value(xmlTextReaderPtr reader, PendingLink *link);
+      ValueRef stream_link(xmlTextReaderPtr reader, PendingLink *link);
+      ObjectRef stream_object(xmlTextReaderPtr reader);
+      void stream_object_contents(const ObjectRef &object, xmlTextReaderPtr reader);
+      void skip_xml_element(xmlTextReaderPtr reader);
+      void cache_streamed(const std::string &key, const ValueRef &value);
+      void discard_streamed();
+      void defer_link(PendingLink &link, const ValueRef &container, const std::string &member, size_t index);
+      ValueRef resolve_link(const PendingLink &link);
+      void resolve_pending_links();
+      void assign_member(const ObjectRef &object, const std::string &key, const ValueRef &value);
+
       ValueRef unserialize_from_xml(xmlNodePtr node);
       ValueRef traverse_xml_recreating_tree(xmlNodePtr node);
       void traverse_xml_creating_objects(xmlNodePtr node);
 
+      ObjectRef create_object(const std::string &struct_name, const std::string &id, const std::string &checksum,
+                              int line);
       ObjectRef unserialize_object_step1(xmlNodePtr node);
       ObjectRef unserialize_object_step2(xmlNodePtr node);
       void unserialize_object_contents(const ObjectRef &object, xmlNodePtr node);
@@ -194,6 +194,127 @@ TEST_FUNCTION(22) {
   }
 }
 
+static db_mysql_SchemaRef create_diff_schema() {
+  db_mysql_SchemaRef schema(grt::Initialized);
+  schema->name("diff_schema");
+  for (int t = 0; t < 5; ++t) {
+    db_mysql_TableRef table(grt::Initialized);
+    table->owner(schema);
+    table->name("table" + std::to_string(t));
+    for (int c = 0; c < 6; ++c) {
+      db_mysql_ColumnRef column(grt::Initialized);
+      column->owner(table);
+      column->name("column" + std::to_string(c));
+      column->comment("comment " + std::to_string(c));
+      table->columns().insert(column);
+    }
+    schema->tables().insert(table);
+  }
+  return schema;
+}
+
+// dump_log() is the only textual form of a change tree, so capture what it writes.
+static std::string describe_change(const std::shared_ptr<DiffChange> &change) {
+  std::stringstream log;
+  std::streambuf *old_buffer = std::cout.rdbuf(log.rdbuf());
+  if (change)
+    change->dump_log(0);
+  std::cout.rdbuf(old_buffer);
+  return log.str();
+}
+
+// Skipping objects with equal structure hashes must give the same change set as comparing all members.
+TEST_FUNCTION(30) {
+  db_mysql_SchemaRef source(create_diff_schema());
+  db_mysql_SchemaRef target(grt::copy_object(source));
+
+  // Reorder tables and columns, modify a few of them and leave the others unchanged.
+  target->tables().reorder(0, 3);
+  db_mysql_TableRef table(target->tables()[1]);
+  table->columns().reorder(5, 0);
+  table->columns()[2]->comment("changed");
+
+  db_mysql_ColumnRef column(grt::Initialized);
+  column->owner(table);
+  column->name("added");
+  table->columns().insert(column, 3);
+
+  target->tables()[4]->columns().remove(1);
+  target->tables()[2]->name("renamed");
+
+  grt::NormalizedComparer normalizer(get_traits(true));
+  grt::DbObjectMatchAlterOmf omf;
+  omf.dontdiff_mask = 3;
+  normalizer.init_omf(&omf);
+
+  std::shared_ptr<DiffChange> change = diff_make(source, target, &omf);
+  omf.skip_identical_objects = false;
+  std::shared_ptr<DiffChange> full_change = diff_make(source, target, &omf);
+
+  ensure("changes found", change.get() != NULL);
+  ensure_equals("same change set", describe_change(change), describe_change(full_change));
+
+  omf.skip_identical_objects = true;
+  ensure("unchanged copy", !diff_make(source, grt::copy_object(source), &omf));
+}
+
+// Tables of big schemas are diffed in worker threads, which must give the same change set as a sequential diff.
+TEST_FUNCTION(31) {
+  db_mysql_SchemaRef source(grt::Initialized);
+  source->name("parallel_schema");
+  for (int t = 0; t < 80; ++t) {
+    db_mysql_TableRef table(grt::Initialized);
+    table->owner(source);
+    table->name("table" + std::to_string(t));
+    for (int c = 0; c < 4; ++c) {
+      db_mysql_ColumnRef column(grt::Initialized);
+      column->owner(table);
+      column->name("column" + std::to_string(c));
+      table->columns().insert(column);
+    }
+    source->tables().insert(table);
+  }
+  db_mysql_SchemaRef target(grt::copy_object(source));
+
+  // Every third table gets a new column and a new index, some others only a changed comment.
+  for (size_t t = 0; t < target->tables().count(); ++t) {
+    db_mysql_TableRef table(target->tables()[t]);
+    if (t % 3 == 0) {
+      db_mysql_ColumnRef column(grt::Initialized);
+      column->owner(table);
+      column->name("added_column");
+      table->columns().insert(column, 1);
+
+      db_mysql_IndexRef index(grt::Initialized);
+      index->owner(table);
+      index->name("added_index");
+      index->indexType("INDEX");
+      db_mysql_IndexColumnRef index_column(grt::Initialized);
+      index_column->owner(index);
+      index_column->referencedColumn(table->columns()[0]);
+      index->columns().insert(index_column);
+      table->indices().insert(index);
+    } else if (t % 5 == 0)
+      table->comment("changed");
+  }
+
+  grt::NormalizedComparer normalizer(get_traits(true));
+  grt::DbObjectMatchAlterOmf omf;
+  omf.dontdiff_mask = 3;
+  normalizer.init_omf(&omf);
+
+  ensure("enough tables to diff in parallel", source->tables().count() > 32);
+
+  std::shared_ptr<DiffChange> parallel_change = diff_make(source, target, &omf);
+  omf.parallel_list_diff = false;
+  std::shared_ptr<DiffChange> sequential_change = diff_make(source, target, &omf);
+
+  ensure("changes found", parallel_change.get() != NULL);
+  std::string description = describe_change(parallel_change);
+  ensure_equals("same change set", description, describe_change(sequential_change));
+  ensure("added columns listed", description.find("ListItemAdded") != std::string::npos);
+}
+
 // Due to the tut nature, this must be executed as a last test always,
 // we can't have this inside of the d-tor.
 TEST_FUNCTION(99) {
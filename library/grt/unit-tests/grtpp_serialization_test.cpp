@@ -169,6 +169,130 @@ TEST_FUNCTION(5) {
   ensure("list[2]", list[2].is_valid());
 }
 
+// Loads the document through the streaming file loader and through the DOM based loader.
+static ValueRef load_document(const std::string &xml, ValueRef &dom_value) {
+  static const std::string filename("streaming_test.xml");
+
+  g_file_set_contents(filename.c_str(), xml.data(), (gssize)xml.size(), NULL);
+  dom_value = grt::GRT::get()->unserialize_xml_data(xml);
+  return grt::GRT::get()->unserialize(filename);
+}
+
+TEST_FUNCTION(6) {
+  // links to objects which only come further down in the file
+  std::string xml =
+    "<?xml version=\"1.0\"?>\n"
+    "<data grt_format=\"2.0\">\n"
+    " <value type=\"list\" content-type=\"object\">\n"
+    "  <value type=\"object\" struct-name=\"test.Book\" id=\"book\">\n"
+    "   <value type=\"string\" key=\"title\">the book</value>\n"
+    "   <link type=\"object\" struct-name=\"test.Publisher\" key=\"publisher\">publisher</link>\n"
+    "   <value type=\"list\" _ptr_=\"0x1\" content-type=\"object\" content-struct-name=\"test.Author\"\n"
+    "    key=\"authors\">\n"
+    "    <link type=\"object\" struct-name=\"test.Author\">author2</link>\n"
+    "    <value type=\"object\" struct-name=\"test.Author\" id=\"author1\">\n"
+    "     <value type=\"string\" key=\"name\">author1</value>\n"
+    "    </value>\n"
+    "    <link type=\"object\" struct-name=\"test.Author\">author3</link>\n"
+    "   </value>\n"
+    "  </value>\n"
+    "  <link type=\"object\" struct-name=\"test.Publisher\">publisher</link>\n"
+    "  <value type=\"object\" struct-name=\"test.Publisher\" id=\"publisher\">\n"
+    "   <value type=\"string\" key=\"name\">the publisher</value>\n"
+    "  </value>\n"
+    "  <value type=\"object\" struct-name=\"test.Author\" id=\"author2\">\n"
+    "   <value type=\"string\" key=\"name\">author2</value>\n"
+    "  </value>\n"
+    "  <value type=\"object\" struct-name=\"test.Author\" id=\"author3\">\n"
+    "   <value type=\"string\" key=\"name\">author3</value>\n"
+    "  </value>\n"
+    " </value>\n"
+    "</data>\n";
+
+  ValueRef dom_value;
+  ObjectListRef list(ObjectListRef::cast_from(load_document(xml, dom_value)));
+  grt_ensure_equals("same as DOM loader", list, dom_value, true);
+
+  ensure_equals("list count", list.count(), 5U);
+  test_BookRef book(test_BookRef::cast_from(list[0]));
+  ensure("forward link in member", book->publisher().valueptr() == list[2].valueptr());
+  ensure("forward link in list", list[1].valueptr() == list[2].valueptr());
+  ensure_equals("publisher name", *book->publisher()->name(), "the publisher");
+
+  ensure_equals("author count", book->authors().count(), 3U);
+  ensure_equals("author position 0", *book->authors()[0]->name(), "author2");
+  ensure_equals("author position 1", *book->authors()[1]->name(), "author1");
+  ensure_equals("author position 2", *book->authors()[2]->name(), "author3");
+  ensure("linked author", book->authors()[0].valueptr() == list[3].valueptr());
+}
+
+TEST_FUNCTION(7) {
+  // a link that can't be resolved drops it and all following items of the list, like in the DOM loader
+  std::string xml =
+    "<?xml version=\"1.0\"?>\n"
+    "<data grt_format=\"2.0\">\n"
+    " <value type=\"object\" struct-name=\"test.Book\" id=\"book\">\n"
+    "  <value type=\"list\" _ptr_=\"0x1\" content-type=\"object\" content-struct-name=\"test.Author\"\n"
+    "   key=\"authors\">\n"
+    "   <value type=\"object\" struct-name=\"test.Author\" id=\"author1\">\n"
+    "    <value type=\"string\" key=\"name\">author1</value>\n"
+    "   </value>\n"
+    "   <link type=\"object\" struct-name=\"test.Author\">missing</link>\n"
+    "   <value type=\"object\" struct-name=\"test.Author\" id=\"author2\">\n"
+    "    <value type=\"string\" key=\"name\">author2</value>\n"
+    "   </value>\n"
+    "  </value>\n"
+    " </value>\n"
+    "</data>\n";
+
+  ValueRef dom_value;
+  test_BookRef book(test_BookRef::cast_from(load_document(xml, dom_value)));
+  grt_ensure_equals("same as DOM loader", book, dom_value, true);
+  ensure_equals("truncated list", book->authors().count(), 1U);
+  ensure_equals("remaining author", *book->authors()[0]->name(), "author1");
+
+  // a file that ends in the middle of the document must fail
+  std::string truncated = xml.substr(0, xml.find("author2"));
+  g_file_set_contents("streaming_truncated.xml", truncated.data(), (gssize)truncated.size(), NULL);
+  try {
+    grt::GRT::get()->unserialize("streaming_truncated.xml");
+    fail("truncated file loaded");
+  } catch (std::runtime_error &) {
+  }
+}
+
+TEST_FUNCTION(8) {
+  // nodes with the same object id fill the same object and all links point to it, as in the DOM loader
+  std::string xml =
+    "<?xml version=\"1.0\"?>\n"
+    "<data grt_format=\"2.0\">\n"
+    " <value type=\"list\" content-type=\"object\">\n"
+    "  <value type=\"object\" struct-name=\"test.Book\" id=\"book\">\n"
+    "   <link type=\"object\" struct-name=\"test.Publisher\" key=\"publisher\">publisher</link>\n"
+    "  </value>\n"
+    "  <value type=\"object\" struct-name=\"test.Publisher\" id=\"publisher\">\n"
+    "   <value type=\"string\" key=\"name\">first</value>\n"
+    "   <value type=\"string\" key=\"phone\">555</value>\n"
+    "  </value>\n"
+    "  <value type=\"object\" struct-name=\"test.Publisher\" id=\"publisher\">\n"
+    "   <value type=\"string\" key=\"name\">second</value>\n"
+    "  </value>\n"
+    " </value>\n"
+    "</data>\n";
+
+  ValueRef dom_value;
+  ObjectListRef list(ObjectListRef::cast_from(load_document(xml, dom_value)));
+  grt_ensure_equals("same as DOM loader", list, dom_value, true);
+
+  ensure_equals("list count", list.count(), 3U);
+  ensure("one object per id", list[1].valueptr() == list[2].valueptr());
+  ensure("link to duplicate id", test_BookRef::cast_from(list[0])->publisher().valueptr() == list[1].valueptr());
+
+  test_PublisherRef publisher(test_PublisherRef::cast_from(list[1]));
+  ensure_equals("last value wins", *publisher->name(), "second");
+  ensure_equals("values of all nodes", *publisher->phone(), "555");
+}
+
 #ifdef badtest
 TEST_FUNCTION(5) {
   // dontfollow means the object will be saved as a link, not that it wont be saved
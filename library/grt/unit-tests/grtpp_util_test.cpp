@@ -84,4 +84,111 @@ TEST_FUNCTION(10) {
   ensure_equals("don't modify owned objects Bug #17324160", book->publisher().id(), publisher.id());
 }
 
+// Name and id lookups in lists large enough to be indexed must follow all list and object changes.
+TEST_FUNCTION(20) {
+  test_BookRef book(grt::Initialized);
+  grt::ListRef<test_Author> authors(book->authors());
+
+  for (size_t i = 0; i < 40; ++i) {
+    test_AuthorRef author(grt::Initialized);
+    author->name(grt::StringRef("Author" + std::to_string(i)));
+    authors.insert(author);
+  }
+
+  ensure_equals("find by name", find_named_object_in_list(authors, "Author10").id(), authors[10].id());
+  ensure_equals("find by name, case insensitive", find_named_object_in_list(authors, "AUTHOR11", false).id(),
+                authors[11].id());
+  ensure("case sensitive mismatch", !find_named_object_in_list(authors, "AUTHOR11", true).is_valid());
+  ensure("unknown name", !find_named_object_in_list(authors, "Author40").is_valid());
+  ensure_equals("find by id", *find_object_in_list(authors, authors[20].id())->name(), "Author20");
+
+  // Insert at the front, all positions shift.
+  test_AuthorRef first(grt::Initialized);
+  first->name("First");
+  authors.insert(first, 0);
+  ensure_equals("inserted found", find_named_object_in_list(authors, "First").id(), first.id());
+  ensure_equals("shifted by name", find_named_object_in_list(authors, "Author10").id(), authors[11].id());
+  ensure_equals("shifted by id", *find_object_in_list(authors, authors[21].id())->name(), "Author20");
+
+  // Remove.
+  std::string removed_id = authors[6].id();
+  authors.remove(6);
+  ensure("removed by name", !find_named_object_in_list(authors, "Author5").is_valid());
+  ensure("removed by id", !find_object_in_list(authors, removed_id).is_valid());
+  ensure_equals("after remove", find_named_object_in_list(authors, "Author10").id(), authors[10].id());
+
+  // Reorder.
+  authors.reorder(0, authors.count() - 1);
+  ensure_equals("reordered", find_named_object_in_list(authors, "First").id(), authors[authors.count() - 1].id());
+  ensure_equals("reordered others", find_named_object_in_list(authors, "Author10").id(), authors[9].id());
+
+  // Rename and id change of an object that is already indexed.
+  test_AuthorRef renamed(authors[15]);
+  renamed->name("Renamed");
+  ensure("old name gone", !find_named_object_in_list(authors, "Author16").is_valid());
+  ensure_equals("new name found", find_named_object_in_list(authors, "renamed", false).id(), renamed.id());
+
+  std::string old_id = renamed.id();
+  renamed->__set_id("{00000000-0000-0000-0000-000000000001}");
+  ensure("old id gone", !find_object_in_list(authors, old_id).is_valid());
+  ensure_equals("new id found", *find_object_in_list(authors, "{00000000-0000-0000-0000-000000000001}")->name(),
+                "Renamed");
+
+  // Replace an element.
+  test_AuthorRef replacement(grt::Initialized);
+  replacement->name("Replacement");
+  authors.set(15, replacement);
+  ensure("replaced gone", !find_named_object_in_list(authors, "Renamed").is_valid());
+  ensure_equals("replacement found", *find_object_in_list(authors, replacement.id())->name(), "Replacement");
+}
+
+// A renamed object only invalidates the indexes of the lists it is in, and lists it left or that went away are
+// no longer notified.
+TEST_FUNCTION(25) {
+  test_BookRef book(grt::Initialized);
+  test_BookRef other_book(grt::Initialized);
+  grt::ListRef<test_Author> authors(book->authors());
+  grt::ListRef<test_Author> other_authors(other_book->authors());
+  grt::ListRef<test_Author> selection(true);
+
+  for (size_t i = 0; i < 40; ++i) {
+    test_AuthorRef author(grt::Initialized);
+    author->name(grt::StringRef("Author" + std::to_string(i)));
+    authors.insert(author);
+    if (i % 2 == 0)
+      selection.insert(author);
+
+    test_AuthorRef other_author(grt::Initialized);
+    other_author->name(grt::StringRef("Other" + std::to_string(i)));
+    other_authors.insert(other_author);
+  }
+
+  // Build the name indexes of all lists.
+  ensure("indexed", find_named_object_in_list(authors, "Author0").is_valid());
+  ensure("selection indexed", find_named_object_in_list(selection, "Author0").is_valid());
+  ensure("other indexed", find_named_object_in_list(other_authors, "Other0").is_valid());
+
+  // The renamed object is in the index of two lists, both must see the change.
+  test_AuthorRef renamed(authors[10]);
+  renamed->name("Renamed");
+  ensure("old name gone", !find_named_object_in_list(authors, "Author10").is_valid());
+  ensure_equals("new name found", find_named_object_in_list(authors, "Renamed").id(), renamed.id());
+  ensure("old name gone from selection", !find_named_object_in_list(selection, "Author10").is_valid());
+  ensure_equals("new name found in selection", find_named_object_in_list(selection, "Renamed").id(), renamed.id());
+  ensure_equals("other list unchanged", find_named_object_in_list(other_authors, "Other10").id(),
+                other_authors[10].id());
+
+  // Removed from one list, the object is still indexed by the other.
+  selection.remove_value(renamed);
+  renamed->name("Renamed again");
+  ensure("removed from selection", !find_named_object_in_list(selection, "Renamed again").is_valid());
+  ensure_equals("renamed again", find_named_object_in_list(authors, "Renamed again").id(), renamed.id());
+
+  // Objects outliving an indexed list can still be renamed.
+  test_AuthorRef survivor(selection[0]);
+  selection = grt::ListRef<test_Author>();
+  survivor->name("Survivor");
+  ensure_equals("survivor found", find_named_object_in_list(authors, "Survivor").id(), survivor.id());
+}
+
 END_TESTS
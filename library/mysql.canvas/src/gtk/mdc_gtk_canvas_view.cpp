@@ -318,10 +318,15 @@ bool GtkCanvas::redraw(::Cairo::RefPtr< ::Cairo::Context> context) {
     _canvas->repaint(x1, y1, x2 - x1, y2 - y1);
     gettimeofday(&tv2, NULL);
 
+    size_t pixels = _canvas->take_repainted_pixels();
+    size_t text_hits, text_misses;
+    mdc::take_text_extents_cache_stats(text_hits, text_misses);
     static const char *debug_canvas = getenv("DEBUG_CANVAS");
     if (debug_canvas)
-      printf("rendertime= %.4f (%.1ffps)\n", (tv2.tv_sec - tv.tv_sec) + (tv2.tv_usec - tv.tv_usec) / 1000000.0,
-             1.0 / ((tv2.tv_sec - tv.tv_sec) + (tv2.tv_usec - tv.tv_usec) / 1000000.0));
+      printf("rendertime= %.4f (%.1ffps) pixels= %lu text extents hits= %lu misses= %lu\n",
+             (tv2.tv_sec - tv.tv_sec) + (tv2.tv_usec - tv.tv_usec) / 1000000.0,
+             1.0 / ((tv2.tv_sec - tv.tv_sec) + (tv2.tv_usec - tv.tv_usec) / 1000000.0), (unsigned long)pixels,
+             (unsigned long)text_hits, (unsigned long)text_misses);
   }
 
   return true;
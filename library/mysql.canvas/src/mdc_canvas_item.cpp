@@ -127,6 +127,10 @@ void CanvasItem::set_bounds(const Rect &rect) {
     _size = rect.size;
 
     //  _bounds_changed_signal.emit(obounds);
+    // The bounds signal is not emitted here, so tell the parent directly to keep its item index current.
+    Group *group = dynamic_cast<Group *>(_parent);
+    if (group)
+      group->update_item_index(this);
 
     update_handles();
   }
@@ -45,6 +45,14 @@ using namespace base;
 // XXX: use the values defined by the platform!
 #define DOUBLE_CLICK_TIME 0.5
 
+// PNG exports with more pixels than this are rendered in tiles and written band by band,
+// instead of on a single image surface.
+#define EXPORT_MAX_SURFACE_PIXELS (4096 * 4096)
+
+// Size of the tiles rendered for such exports. A row of tiles makes up one band of the image.
+#define EXPORT_TILE_SIZE 1024
+#define EXPORT_BAND_HEIGHT 256
+
 #include <stdio.h>
 
 struct CanvasAutoLock {
@@ -58,7 +66,8 @@ struct CanvasAutoLock {
   }
 };
 
-CanvasView::CanvasView(int width, int height) : _fps(0), _total_item_cache_mem(0), _last_click_info(3) {
+CanvasView::CanvasView(int width, int height)
+  : _fps(0), _repainted_pixels(0), _total_item_cache_mem(0), _last_click_info(3) {
   base::threading_init();
 
   _page_size = Size(2000, 1500);
@@ -658,27 +667,43 @@ void CanvasView::repaint() {
 }
 
 void CanvasView::repaint(int x, int y, int width, int height) {
-  if (_ui_lock > 0)
+  if (_ui_lock > 0) {
+    // Not painted, but the platform considers the area handled.
+    if (!_destroying)
+      clear_pending_areas(window_to_canvas(x, y, width, height));
     return;
+  }
 
   CanvasAutoLock lock(this);
   repaint_area(window_to_canvas(x, y, width, height), x, y, width, height);
 }
 
+void CanvasView::clear_pending_areas(const Rect &bounds) {
+  for (LayerList::iterator iter = _layers.begin(); iter != _layers.end(); ++iter)
+    (*iter)->clear_pending_areas(bounds);
+  _blayer->clear_pending_areas(bounds);
+  _ilayer->clear_pending_areas(bounds);
+}
+
 void CanvasView::repaint_area(const Rect &aBounds, int wx, int wy, int ww, int wh) {
   if (_destroying || _ui_lock > 0)
     return;
 
   Rect bounds;
 
-  if (has_gl())
+  if (has_gl()) {
     bounds = window_to_canvas(0, 0, _view_width, _view_height);
-  else
+    _repainted_pixels += (size_t)_view_width * _view_height;
+  } else {
     bounds = aBounds;
+    _repainted_pixels += (size_t)std::max(ww, 0) * std::max(wh, 0);
+  }
 
   CanvasAutoLock lock(this);
   Rect clip;
 
+  clear_pending_areas(bounds);
+
   begin_repaint(wx, wy, ww, wh);
   if (has_gl())
     glGetError(); // Resets error flag.
@@ -800,6 +825,11 @@ void CanvasView::export_png(const std::string &filename, bool crop) {
     bounds.size.height += 20;
   }
 
+  if ((double)(int)bounds.width() * (int)bounds.height() > EXPORT_MAX_SURFACE_PIXELS) {
+    export_png_tiled(fh.file(), bounds);
+    return;
+  }
+
   cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, (int)bounds.width(), (int)bounds.height());
   try {
     CairoCtx ctx(surface);
@@ -820,6 +850,102 @@ void CanvasView::export_png(const std::string &filename, bool crop) {
   cairo_surface_destroy(surface);
 }
 
+struct PNGBandJob {
+  PNGStreamWriter *writer;
+  std::vector<cairo_surface_t *> tiles;
+  int rows;
+  bool result;
+
+  static gpointer encode(gpointer data) {
+    PNGBandJob *job = static_cast<PNGBandJob *>(data);
+    job->result = job->writer->write_band(job->tiles, job->rows);
+    return NULL;
+  }
+};
+
+static void destroy_tiles(std::vector<cairo_surface_t *> &tiles) {
+  for (std::vector<cairo_surface_t *>::iterator iter = tiles.begin(); iter != tiles.end(); ++iter)
+    cairo_surface_destroy(*iter);
+  tiles.clear();
+}
+
+/**
+ * Exports the given area as PNG, rendering one band of tiles at a time. While a band is rendered,
+ * the previous one is compressed and written in a separate thread, so only two bands are in memory.
+ * Rendering itself stays in this thread, as the canvas items are not thread safe.
+ */
+void CanvasView::export_png_tiled(FILE *file, const Rect &bounds) {
+  int width = (int)bounds.width();
+  int height = (int)bounds.height();
+  PNGStreamWriter writer(file, width, height);
+  PNGBandJob jobs[2];
+  GThread *encoder = NULL;
+  PNGBandJob *encoding = NULL;
+  bool result = writer.write_header();
+
+  try {
+    for (int y = 0, band = 0; y < height && result; y += EXPORT_BAND_HEIGHT, ++band) {
+      PNGBandJob &job = jobs[band % 2];
+
+      job.writer = &writer;
+      job.rows = std::min(EXPORT_BAND_HEIGHT, height - y);
+      job.result = false;
+      if (job.tiles.empty()) {
+        for (int x = 0; x < width; x += EXPORT_TILE_SIZE) {
+          job.tiles.push_back(
+            cairo_image_surface_create(CAIRO_FORMAT_RGB24, std::min(EXPORT_TILE_SIZE, width - x), EXPORT_BAND_HEIGHT));
+          if (cairo_surface_status(job.tiles.back()) != CAIRO_STATUS_SUCCESS)
+            throw canvas_error(cairo_status_to_string(cairo_surface_status(job.tiles.back())));
+        }
+      }
+
+      int x = 0;
+      for (std::vector<cairo_surface_t *>::iterator tile = job.tiles.begin(); tile != job.tiles.end(); ++tile) {
+        Rect tile_bounds(bounds.left() + x, bounds.top() + y, cairo_image_surface_get_width(*tile), job.rows);
+        CairoCtx ctx(*tile);
+
+        ctx.rectangle(0, 0, tile_bounds.width(), EXPORT_BAND_HEIGHT);
+        ctx.set_color(Color::White());
+        ctx.fill();
+        render_for_export(tile_bounds, &ctx);
+        cairo_surface_flush(*tile);
+        x += (int)tile_bounds.width();
+      }
+
+      // Bands must be written in order, so wait for the previous one before passing on this one.
+      if (encoder) {
+        g_thread_join(encoder);
+        encoder = NULL;
+        result = encoding->result;
+      }
+      encoding = &job;
+      if (result) {
+        encoder = base::create_thread(&PNGBandJob::encode, &job);
+        if (!encoder) {
+          PNGBandJob::encode(&job);
+          result = job.result;
+        }
+      }
+    }
+    if (encoder) {
+      g_thread_join(encoder);
+      encoder = NULL;
+      result = encoding->result;
+    }
+  } catch (std::exception) {
+    if (encoder)
+      g_thread_join(encoder);
+    destroy_tiles(jobs[0].tiles);
+    destroy_tiles(jobs[1].tiles);
+    throw;
+  }
+  destroy_tiles(jobs[0].tiles);
+  destroy_tiles(jobs[1].tiles);
+
+  if (!result || !writer.finish())
+    throw canvas_error(cairo_status_to_string(CAIRO_STATUS_WRITE_ERROR));
+}
+
 void CanvasView::export_pdf(const std::string &filename, const Size &size_in_pt) {
   CanvasAutoLock lock(this);
 
@@ -248,6 +248,13 @@ namespace mdc {
     double get_fps() {
       return _fps;
     }
+
+    // Number of window pixels painted since the last call, to measure the cost of a frame.
+    size_t take_repainted_pixels() {
+      size_t pixels = _repainted_pixels;
+      _repainted_pixels = 0;
+      return pixels;
+    }
     inline void bookkeep_cache_mem(int amount) {
       _total_item_cache_mem += amount;
     }
@@ -296,6 +303,7 @@ namespace mdc {
     bool _debug;
 
     double _fps;
+    size_t _repainted_pixels;
 
     size_t _total_item_cache_mem;
 
@@ -314,6 +322,7 @@ namespace mdc {
     virtual void end_repaint() = 0;
 
     void repaint_area(const base::Rect &rect, int wx, int wy, int ww, int wh);
+    void clear_pending_areas(const base::Rect &bounds);
 
     void update_offsets();
     void apply_transformations();
@@ -324,6 +333,7 @@ namespace mdc {
     bool perform_auto_scroll(const base::Point &mouse_pos);
 
     void render_for_export(const base::Rect &bounds, CairoCtx *cr);
+    void export_png_tiled(FILE *file, const base::Rect &bounds);
 
   private:
     struct ClickInfo {
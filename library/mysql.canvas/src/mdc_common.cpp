@@ -27,15 +27,21 @@
 #endif
 
 #include <errno.h>
+#include <unordered_map>
+#include <zlib.h>
 
 #include <cairo/cairo-ps.h>
 #include <cairo/cairo-pdf.h>
 
 #include "mdc_common.h"
 #include "base/file_utilities.h"
+#include "base/threading.h"
 
 using namespace mdc;
 
+// Number of text extents kept in the cache shared by all CairoCtx instances.
+#define TEXT_EXTENTS_CACHE_SIZE 20000
+
 struct ScaledFont {
   FontSpec spec;
   cairo_scaled_font_t *font;
@@ -186,6 +192,82 @@ public:
   }
 };
 
+/**
+ * LRU cache for the extents of text measured with the fonts from FontManager. Those fonts are always
+ * created with an identity ctm and without metrics hinting, so the extents only depend on the font spec
+ * and the text, not on the context or the zoom, and can be shared by all views and exports.
+ */
+class TextExtentsCache {
+  struct Entry {
+    std::string key;
+    cairo_text_extents_t extents;
+  };
+
+  std::list<Entry> _entries; // Most recently used first.
+  std::unordered_map<std::string, std::list<Entry>::iterator> _index;
+  base::Mutex _mutex;
+  size_t _hits;
+  size_t _misses;
+
+  TextExtentsCache() : _hits(0), _misses(0) {
+  }
+
+public:
+  static TextExtentsCache *get() {
+    static TextExtentsCache cache;
+    return &cache;
+  }
+
+  static std::string make_key(const FontSpec &font, const char *text) {
+    return base::strfmt("%s\n%i %i %f\n", font.family.c_str(), font.slant, font.weight, font.size) + text;
+  }
+
+  bool lookup(const std::string &key, cairo_text_extents_t &extents) {
+    base::MutexLock lock(_mutex);
+    std::unordered_map<std::string, std::list<Entry>::iterator>::iterator iter = _index.find(key);
+
+    if (iter == _index.end()) {
+      _misses++;
+      return false;
+    }
+    _hits++;
+    _entries.splice(_entries.begin(), _entries, iter->second);
+    extents = iter->second->extents;
+    return true;
+  }
+
+  void add(const std::string &key, const cairo_text_extents_t &extents) {
+    base::MutexLock lock(_mutex);
+
+    if (_index.find(key) != _index.end())
+      return;
+
+    Entry entry;
+    entry.key = key;
+    entry.extents = extents;
+    _entries.push_front(entry);
+    _index[key] = _entries.begin();
+
+    if (_entries.size() > TEXT_EXTENTS_CACHE_SIZE) {
+      _index.erase(_entries.back().key);
+      _entries.pop_back();
+    }
+  }
+
+  void take_stats(size_t &hits, size_t &misses) {
+    base::MutexLock lock(_mutex);
+
+    hits = _hits;
+    misses = _misses;
+    _hits = 0;
+    _misses = 0;
+  }
+};
+
+void mdc::take_text_extents_cache_stats(size_t &hits, size_t &misses) {
+  TextExtentsCache::get()->take_stats(hits, misses);
+}
+
 Surface::Surface(const Surface &other) : surface(cairo_surface_reference(other.surface)) {
 }
 
@@ -308,11 +390,17 @@ void CairoCtx::set_font(const FontSpec &font) const {
 }
 
 void CairoCtx::get_text_extents(const FontSpec &font, const std::string &text, cairo_text_extents_t &extents) {
-  cairo_scaled_font_text_extents(fm->get_font(font), text.c_str(), &extents);
+  get_text_extents(font, text.c_str(), extents);
 }
 
 void CairoCtx::get_text_extents(const FontSpec &font, const char *text, cairo_text_extents_t &extents) {
-  cairo_scaled_font_text_extents(fm->get_font(font), text, &extents);
+  TextExtentsCache *cache = TextExtentsCache::get();
+  std::string key = TextExtentsCache::make_key(font, text);
+
+  if (!cache->lookup(key, extents)) {
+    cairo_scaled_font_text_extents(fm->get_font(font), text, &extents);
+    cache->add(key, extents);
+  }
 }
 
 bool CairoCtx::get_font_extents(const FontSpec &font, cairo_font_extents_t &extents) {
@@ -349,3 +437,146 @@ cairo_status_t mdc::write_to_surface(void *closure, const unsigned char *data, u
   cairo_status_t ret = (res == length) ? CAIRO_STATUS_SUCCESS : CAIRO_STATUS_WRITE_ERROR;
   return ret;
 }
+
+//--------------------------------------------------------------------------------------------------
+
+static void put_be32(unsigned char *buffer, uint32_t value) {
+  buffer[0] = (unsigned char)(value >> 24);
+  buffer[1] = (unsigned char)(value >> 16);
+  buffer[2] = (unsigned char)(value >> 8);
+  buffer[3] = (unsigned char)value;
+}
+
+PNGStreamWriter::PNGStreamWriter(FILE *file, int width, int height)
+  : _file(file), _width(width), _height(height), _rows_written(0), _stream(NULL) {
+}
+
+PNGStreamWriter::~PNGStreamWriter() {
+  if (_stream != NULL) {
+    deflateEnd(_stream);
+    delete _stream;
+  }
+}
+
+bool PNGStreamWriter::write_header() {
+  static const unsigned char signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+  std::vector<unsigned char> header(13, 0);
+
+  put_be32(&header[0], (uint32_t)_width);
+  put_be32(&header[4], (uint32_t)_height);
+  header[8] = 8;  // Bit depth.
+  header[9] = 2;  // RGB.
+
+  if (fwrite(signature, 1, sizeof(signature), _file) != sizeof(signature) || !write_chunk("IHDR", header))
+    return false;
+
+  _stream = new z_stream();
+  if (deflateInit(_stream, Z_DEFAULT_COMPRESSION) != Z_OK) {
+    delete _stream;
+    _stream = NULL;
+    return false;
+  }
+  return true;
+}
+
+bool PNGStreamWriter::write_band(const std::vector<cairo_surface_t *> &tiles, int rows) {
+  size_t row_size = (size_t)_width * 3;
+  std::vector<unsigned char> row(row_size, 0xff), sub(row_size), up(row_size);
+
+  rows = std::min(rows, _height - _rows_written);
+  _data.clear();
+  _data.reserve(rows * (row_size + 1));
+  for (int y = 0; y < rows; ++y) {
+    unsigned char *out = &row[0];
+    unsigned char *end = out + row_size;
+
+    for (std::vector<cairo_surface_t *>::const_iterator tile = tiles.begin(); tile != tiles.end(); ++tile) {
+      const uint32_t *pixels = (const uint32_t *)(cairo_image_surface_get_data(*tile) +
+                                                  y * cairo_image_surface_get_stride(*tile));
+      int tile_width = cairo_image_surface_get_width(*tile);
+
+      for (int x = 0; x < tile_width && out < end; ++x) {
+        *out++ = (unsigned char)(pixels[x] >> 16);
+        *out++ = (unsigned char)(pixels[x] >> 8);
+        *out++ = (unsigned char)pixels[x];
+      }
+    }
+
+    // Use the Sub or the Up filter, whichever gives the smaller residuals (the usual heuristic).
+    unsigned long sub_sum = 0, up_sum = 0;
+    for (size_t i = 0; i < row_size; ++i) {
+      sub[i] = (unsigned char)(row[i] - (i >= 3 ? row[i - 3] : 0));
+      up[i] = (unsigned char)(row[i] - (_previous_row.empty() ? 0 : _previous_row[i]));
+      sub_sum += sub[i] < 128 ? sub[i] : 256 - sub[i];
+      up_sum += up[i] < 128 ? up[i] : 256 - up[i];
+    }
+    if (!_previous_row.empty() && up_sum < sub_sum) {
+      _data.push_back(2);
+      _data.insert(_data.end(), up.begin(), up.end());
+    } else {
+      _data.push_back(1);
+      _data.insert(_data.end(), sub.begin(), sub.end());
+    }
+    _previous_row = row;
+  }
+
+  _rows_written += rows;
+
+  // A sync flush ends the compressed data of each band on a byte boundary, so that it can go into its own chunk.
+  return compress_data(Z_SYNC_FLUSH) && write_chunk("IDAT", _compressed);
+}
+
+bool PNGStreamWriter::finish() {
+  if (_rows_written < _height)
+    return false;
+
+  _data.clear();
+  return compress_data(Z_FINISH) && write_chunk("IDAT", _compressed) &&
+         write_chunk("IEND", std::vector<unsigned char>());
+}
+
+/**
+ * Compresses the current band into _compressed.
+ */
+bool PNGStreamWriter::compress_data(int flush) {
+  static const size_t buffer_size = 64 * 1024;
+
+  if (_stream == NULL)
+    return false;
+
+  _stream->next_in = _data.empty() ? NULL : &_data[0];
+  _stream->avail_in = (uInt)_data.size();
+  _compressed.clear();
+
+  int result;
+  do {
+    size_t used = _compressed.size();
+    _compressed.resize(used + buffer_size);
+    _stream->next_out = &_compressed[used];
+    _stream->avail_out = (uInt)buffer_size;
+
+    result = deflate(_stream, flush);
+    if (result == Z_STREAM_ERROR)
+      return false;
+    _compressed.resize(used + buffer_size - _stream->avail_out);
+  } while (_stream->avail_out == 0 || (flush == Z_FINISH && result != Z_STREAM_END));
+
+  return true;
+}
+
+bool PNGStreamWriter::write_chunk(const char *type, const std::vector<unsigned char> &data) {
+  unsigned char header[8];
+  unsigned char trailer[4];
+
+  put_be32(header, (uint32_t)data.size());
+  memcpy(header + 4, type, 4);
+
+  uLong crc = crc32(crc32(0, Z_NULL, 0), header + 4, 4);
+  if (!data.empty())
+    crc = crc32(crc, &data[0], (uInt)data.size());
+  put_be32(trailer, (uint32_t)crc);
+
+  return fwrite(header, 1, sizeof(header), _file) == sizeof(header) &&
+         (data.empty() || fwrite(&data[0], 1, data.size(), _file) == data.size()) &&
+         fwrite(trailer, 1, sizeof(trailer), _file) == sizeof(trailer);
+}
@@ -32,6 +32,7 @@
 #include <algorithm>
 #include <typeinfo>
 #include <stdio.h>
+#include <stdint.h>
 
 #define _USE_MATH_DEFINES
 #include <math.h>
@@ -66,6 +67,8 @@
 #define GL_BGRA GL_BGRA_EXT
 #endif
 
+struct z_stream_s;
+
 namespace mdc {
 
   typedef unsigned int Count;
@@ -369,6 +372,40 @@ namespace mdc {
 
   MYSQLCANVAS_PUBLIC_FUNC Timestamp get_time();
 
+  // Hits and misses of the text extents cache shared by all CairoCtx instances, counted since the last call.
+  MYSQLCANVAS_PUBLIC_FUNC void take_text_extents_cache_stats(size_t &hits, size_t &misses);
+
   cairo_status_t write_to_surface(void *closure, const unsigned char *data, unsigned int length);
 
+  // Writes an RGB PNG image band by band (from RGB24 image surfaces), so that images too big for a single
+  // cairo surface can be exported with bounded memory. Each band is compressed with zlib and written as its own
+  // IDAT chunk.
+  class MYSQLCANVAS_PUBLIC_FUNC PNGStreamWriter {
+  public:
+    PNGStreamWriter(FILE *file, int width, int height);
+    ~PNGStreamWriter();
+
+    bool write_header();
+    // Rows are taken from a row of tiles, left to right, that together are as wide as the image.
+    bool write_band(const std::vector<cairo_surface_t *> &tiles, int rows);
+    bool finish();
+
+  private:
+    FILE *_file;
+    int _width;
+    int _height;
+    int _rows_written;
+    z_stream_s *_stream;
+
+    std::vector<unsigned char> _previous_row;
+    std::vector<unsigned char> _data;
+    std::vector<unsigned char> _compressed;
+
+    PNGStreamWriter(const PNGStreamWriter &) = delete;
+    PNGStreamWriter &operator=(const PNGStreamWriter &) = delete;
+
+    bool compress_data(int flush);
+    bool write_chunk(const char *type, const std::vector<unsigned char> &data);
+  };
+
 } // End of mdc namespace
@@ -29,11 +29,37 @@
 using namespace mdc;
 using namespace base;
 
+// Size of the cells (in canvas units) of the grid used to look up subitems by position.
+#define INDEX_CELL_SIZE 256.0
+
+// Items covering more cells than this (e.g. long connection lines) are kept in a separate list
+// that is always checked.
+#define INDEX_MAX_CELLS 64
+
+// Item bounds are enlarged by this before indexing, as some items (lines) accept hits slightly
+// outside of their bounds.
+#define INDEX_SLACK 4
+
+// Groups with less items than this are simply scanned.
+#define INDEX_MIN_ITEMS 32
+
+static inline int64_t index_cell_key(int x, int y) {
+  return ((int64_t)x << 32) | (uint32_t)y;
+}
+
+static void get_index_cell_range(const Rect &rect, int &left, int &top, int &right, int &bottom) {
+  left = (int)floor(rect.left() / INDEX_CELL_SIZE);
+  top = (int)floor(rect.top() / INDEX_CELL_SIZE);
+  right = (int)floor(rect.right() / INDEX_CELL_SIZE);
+  bottom = (int)floor(rect.bottom() / INDEX_CELL_SIZE);
+}
+
 Group::Group(Layer *layer) : Layouter(layer) {
 #ifdef no_group_activate
   _activated = false;
 #endif
   _freeze_bounds_updates = 0;
+  _stack_counter = 0;
 
   set_accepts_focus(true);
   set_accepts_selection(true);
@@ -42,6 +68,11 @@ Group::Group(Layer *layer) : Layouter(layer) {
 }
 
 Group::~Group() {
+  // Contents can outlive the group (e.g. when it is dissolved), their signals must not call into it anymore.
+  for (std::map<CanvasItem *, ItemInfo>::iterator iter = _content_info.begin(); iter != _content_info.end(); ++iter) {
+    iter->second.connection.disconnect();
+    iter->second.bounds_connection.disconnect();
+  }
 }
 
 void Group::repaint(const Rect &clipArea, bool direct) {
@@ -99,11 +130,18 @@ void Group::add(CanvasItem *item) {
 
   info.connection =
     item->signal_focus_change()->connect(std::bind(&Group::focus_changed, this, std::placeholders::_1, item));
+  info.bounds_connection = item->signal_bounds_changed()->connect(std::bind(&Group::update_item_index, this, item));
+  info.stack_order = ++_stack_counter;
+  index_item(item, info);
   _content_info[item] = info;
 }
 
 void Group::remove(CanvasItem *item) {
-  _content_info[item].connection.disconnect();
+  ItemInfo &info = _content_info[item];
+
+  info.connection.disconnect();
+  info.bounds_connection.disconnect();
+  unindex_item(item, info);
 
   _content_info.erase(item);
 
@@ -198,10 +236,115 @@ void Group::set_selected(bool flag) {
   _layer->queue_repaint(get_bounds());
 }
 
+void Group::index_item(CanvasItem *item, ItemInfo &info) {
+  get_index_cell_range(expand_bound(item->get_bounds(), INDEX_SLACK, INDEX_SLACK), info.cell_left, info.cell_top,
+                       info.cell_right, info.cell_bottom);
+
+  info.oversized = (int64_t)(info.cell_right - info.cell_left + 1) * (info.cell_bottom - info.cell_top + 1) >
+                   INDEX_MAX_CELLS;
+  if (info.oversized)
+    _oversized_items.push_back(item);
+  else {
+    for (int x = info.cell_left; x <= info.cell_right; ++x)
+      for (int y = info.cell_top; y <= info.cell_bottom; ++y)
+        _index_cells[index_cell_key(x, y)].push_back(item);
+  }
+  info.indexed = true;
+}
+
+void Group::unindex_item(CanvasItem *item, ItemInfo &info) {
+  if (!info.indexed)
+    return;
+
+  if (info.oversized)
+    _oversized_items.erase(std::find(_oversized_items.begin(), _oversized_items.end(), item));
+  else {
+    for (int x = info.cell_left; x <= info.cell_right; ++x) {
+      for (int y = info.cell_top; y <= info.cell_bottom; ++y) {
+        std::unordered_map<int64_t, std::vector<CanvasItem *> >::iterator cell =
+          _index_cells.find(index_cell_key(x, y));
+        if (cell != _index_cells.end()) {
+          cell->second.erase(std::remove(cell->second.begin(), cell->second.end(), item), cell->second.end());
+          if (cell->second.empty())
+            _index_cells.erase(cell);
+        }
+      }
+    }
+  }
+  info.indexed = false;
+}
+
+/**
+ * Moves the item to the index cells matching its current bounds. Called when the bounds of a subitem change.
+ */
+void Group::update_item_index(CanvasItem *item) {
+  std::map<CanvasItem *, ItemInfo>::iterator iter = _content_info.find(item);
+  if (iter == _content_info.end())
+    return;
+
+  ItemInfo &info = iter->second;
+  int left, top, right, bottom;
+
+  get_index_cell_range(expand_bound(item->get_bounds(), INDEX_SLACK, INDEX_SLACK), left, top, right, bottom);
+  if (info.indexed && left == info.cell_left && top == info.cell_top && right == info.cell_right &&
+      bottom == info.cell_bottom)
+    return;
+
+  unindex_item(item, info);
+  index_item(item, info);
+}
+
+void Group::update_stack_order() {
+  _stack_counter = 0;
+  for (std::list<CanvasItem *>::reverse_iterator iter = _contents.rbegin(); iter != _contents.rend(); ++iter)
+    _content_info[*iter].stack_order = ++_stack_counter;
+}
+
+/**
+ * Returns the direct subitems whose (slightly enlarged) bounds intersect the given rect, in stacking order
+ * with the topmost item first. The result can contain items that do not intersect the rect, so callers still
+ * have to do their own checks.
+ */
+std::vector<CanvasItem *> Group::get_items_near(const Rect &rect) {
+  std::vector<CanvasItem *> result;
+  int left, top, right, bottom;
+
+  get_index_cell_range(rect, left, top, right, bottom);
+  if (_contents.size() < INDEX_MIN_ITEMS ||
+      (int64_t)(right - left + 1) * (bottom - top + 1) > (int64_t)_contents.size()) {
+    result.assign(_contents.begin(), _contents.end());
+    return result;
+  }
+
+  std::vector<std::pair<size_t, CanvasItem *> > found;
+  for (int x = left; x <= right; ++x) {
+    for (int y = top; y <= bottom; ++y) {
+      std::unordered_map<int64_t, std::vector<CanvasItem *> >::const_iterator cell =
+        _index_cells.find(index_cell_key(x, y));
+      if (cell != _index_cells.end()) {
+        for (std::vector<CanvasItem *>::const_iterator iter = cell->second.begin(); iter != cell->second.end(); ++iter)
+          found.push_back(std::make_pair(_content_info[*iter].stack_order, *iter));
+      }
+    }
+  }
+  for (std::vector<CanvasItem *>::const_iterator iter = _oversized_items.begin(); iter != _oversized_items.end();
+       ++iter)
+    found.push_back(std::make_pair(_content_info[*iter].stack_order, *iter));
+
+  std::sort(found.begin(), found.end(), std::greater<std::pair<size_t, CanvasItem *> >());
+  found.erase(std::unique(found.begin(), found.end()), found.end());
+
+  result.reserve(found.size());
+  for (std::vector<std::pair<size_t, CanvasItem *> >::const_iterator iter = found.begin(); iter != found.end(); ++iter)
+    result.push_back(iter->second);
+  return result;
+}
+
 CanvasItem *Group::get_direct_subitem_at(const Point &point) {
   Point npoint = point - get_position();
+  std::vector<CanvasItem *> items = get_items_near(Rect(npoint, Size(0, 0)));
 
-  for (std::list<CanvasItem *>::const_iterator iter = _contents.begin(); iter != _contents.end(); ++iter) {
+  for (std::vector<CanvasItem *>::const_iterator iter = items.begin(); iter != items.end(); ++iter) {
     if ((*iter)->get_visible() && (*iter)->contains_point(npoint)) {
       Group *subgroup = dynamic_cast<Group *>((*iter));
       if (subgroup) {
@@ -218,8 +361,9 @@ CanvasItem *Group::get_direct_subitem_at(const Point &point) {
 
 CanvasItem *Group::get_other_item_at(const Point &point, CanvasItem *other_item) {
   Point npoint = point - get_position();
+  std::vector<CanvasItem *> items = get_items_near(Rect(npoint, Size(0, 0)));
 
-  for (std::list<CanvasItem *>::const_iterator iter = _contents.begin(); iter != _contents.end(); ++iter) {
+  for (std::vector<CanvasItem *>::const_iterator iter = items.begin(); iter != items.end(); ++iter) {
     if ((*iter)->get_visible() && (*iter)->contains_point(npoint) && *iter != other_item) {
       Layouter *litem = dynamic_cast<Layouter *>(*iter);
       if (litem) {
@@ -240,10 +384,12 @@ CanvasItem *Group::get_item_at(const Point &point) {
 
 void Group::raise_item(CanvasItem *item, CanvasItem *above) {
   restack_up(_contents, item, above);
+  update_stack_order();
 }
 
 void Group::lower_item(CanvasItem *item) {
   restack_down(_contents, item);
+  update_stack_order();
 }
 
 void Group::move_item(CanvasItem *item, const Point &pos) {
@@ -20,6 +20,8 @@
 #ifndef _MDC_GROUP_H_
 #define _MDC_GROUP_H_
 
+#include <unordered_map>
+
 #include "mdc_layouter.h"
 
 namespace mdc {
@@ -53,6 +55,10 @@ namespace mdc {
     virtual CanvasItem *get_other_item_at(const base::Point &point, CanvasItem *item);
     virtual CanvasItem *get_item_at(const base::Point &point);
 
+    // Direct subitems whose bounds may intersect the given rect (in group coordinates), topmost first.
+    std::vector<CanvasItem *> get_items_near(const base::Rect &rect);
+    void update_item_index(CanvasItem *item);
+
     virtual void move_item(CanvasItem *child_item, const base::Point &pos);
 
     virtual void raise_item(CanvasItem *item, CanvasItem *above = 0);
@@ -67,6 +73,17 @@ namespace mdc {
   protected:
     struct ItemInfo {
       boost::signals2::connection connection;
+      boost::signals2::connection bounds_connection;
+
+      // Range of index cells the item was stored in.
+      int cell_left, cell_top, cell_right, cell_bottom;
+      bool indexed;
+      bool oversized;
+      size_t stack_order; // Higher is closer to the top of the stack.
+
+      ItemInfo()
+        : cell_left(0), cell_top(0), cell_right(0), cell_bottom(0), indexed(false), oversized(false), stack_order(0) {
+      }
     };
 
     // front of list is top stack
@@ -74,12 +91,21 @@ namespace mdc {
 
     std::map<CanvasItem *, ItemInfo> _content_info;
     int _freeze_bounds_updates;
+
+    // Uniform grid over the direct subitems, for hit testing without walking all contents.
+    std::unordered_map<int64_t, std::vector<CanvasItem *> > _index_cells;
+    std::vector<CanvasItem *> _oversized_items;
+    size_t _stack_counter;
 #ifdef no_group_activate
     bool _activated;
 #endif
 
     virtual void update_bounds();
 
+    void index_item(CanvasItem *item, ItemInfo &info);
+    void unindex_item(CanvasItem *item, ItemInfo &info);
+    void update_stack_order();
+
     void focus_changed(bool f, CanvasItem *item);
 #ifdef no_group_activate
     void activate_group(bool flag);
@@ -28,9 +28,16 @@
 using namespace mdc;
 using namespace base;
 
+// Pending repaint areas are aligned to tiles of this size (in canvas units), so that the many small areas
+// queued while items are dragged around merge into a few larger ones.
+#define REPAINT_TILE_SIZE 64
+
+// With more separate areas than this pending, they are merged into one.
+#define MAX_PENDING_AREAS 16
+
 Layer::Layer(CanvasView *view) : _owner(view) {
   _visible = true;
-  _needs_repaint = true;
+  _painting_bounds = NULL;
 
   _root_area = new AreaGroup(this);
   _root_area->resize_to(_owner->get_total_view_size());
@@ -113,19 +120,16 @@ void Layer::set_needs_repaint_all_items() {
   _root_area->foreach (std::bind(&CanvasItem::set_needs_repaint, std::placeholders::_1));
 }
 
-void Layer::repaint_pending() {
-  if (_needs_repaint) {
-    // XXX record pending areas and repaint only what's needed
-    repaint(Rect(Point(0, 0), _owner->get_total_view_size()));
-    _needs_repaint = false;
-  }
-}
-
 void Layer::repaint(const Rect &bounds) {
+  // The item may have grown, only its old area was queued so far. What lies within bounds is painted
+  // right below, so only the rest of it is queued.
+  _painting_bounds = &bounds;
   for (std::list<CanvasItem *>::iterator iter = _relayout_queue.begin(); iter != _relayout_queue.end(); ++iter) {
     (*iter)->relayout();
+    (*iter)->set_needs_repaint();
   }
   _relayout_queue.clear();
+  _painting_bounds = NULL;
 
   if (_visible)
     _root_area->repaint(bounds, false);
@@ -144,15 +148,86 @@ void Layer::repaint_for_export(const Rect &aBounds) {
 //--------------------------------------------------------------------------------------------------
 
 void Layer::queue_repaint() {
-  _needs_repaint = true;
   _owner->queue_repaint();
 }
 
 //--------------------------------------------------------------------------------------------------
 
 void Layer::queue_repaint(const Rect &bounds) {
-  _needs_repaint = true;
-  _owner->queue_repaint(bounds);
+  Rect area;
+
+  if (_painting_bounds != NULL && bounds_contain_bounds(*_painting_bounds, bounds))
+    return;
+
+  // Areas that are still waiting for their repaint were already passed on to the view.
+  if (add_pending_area(bounds, area))
+    _owner->queue_repaint(area);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Adds the given bounds to the pending areas, merging it with those it touches.
+ * Returns false if the bounds were already covered by a pending area. Otherwise area is set to the
+ * (possibly merged) pending area, which must be repainted as a whole.
+ */
+bool Layer::add_pending_area(const Rect &bounds, Rect &area) {
+  area.set_xmin(floor(bounds.left() / REPAINT_TILE_SIZE) * REPAINT_TILE_SIZE);
+  area.set_ymin(floor(bounds.top() / REPAINT_TILE_SIZE) * REPAINT_TILE_SIZE);
+  area.set_xmax(ceil(bounds.right() / REPAINT_TILE_SIZE) * REPAINT_TILE_SIZE);
+  area.set_ymax(ceil(bounds.bottom() / REPAINT_TILE_SIZE) * REPAINT_TILE_SIZE);
+
+  for (std::vector<Rect>::const_iterator iter = _pending_areas.begin(); iter != _pending_areas.end(); ++iter) {
+    if (bounds_contain_bounds(*iter, bounds))
+      return false;
+  }
+
+  // Merging can make the area touch others, so repeat until nothing changes anymore.
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (std::vector<Rect>::iterator iter = _pending_areas.begin(); iter != _pending_areas.end(); ++iter) {
+      if (bounds_intersect(*iter, area)) {
+        area.set_xmin(std::min(area.left(), iter->left()));
+        area.set_ymin(std::min(area.top(), iter->top()));
+        area.set_xmax(std::max(area.right(), iter->right()));
+        area.set_ymax(std::max(area.bottom(), iter->bottom()));
+        _pending_areas.erase(iter);
+        merged = true;
+        break;
+      }
+    }
+  }
+
+  if (_pending_areas.size() >= MAX_PENDING_AREAS) {
+    for (std::vector<Rect>::const_iterator iter = _pending_areas.begin(); iter != _pending_areas.end(); ++iter) {
+      area.set_xmin(std::min(area.left(), iter->left()));
+      area.set_ymin(std::min(area.top(), iter->top()));
+      area.set_xmax(std::max(area.right(), iter->right()));
+      area.set_ymax(std::max(area.bottom(), iter->bottom()));
+    }
+    _pending_areas.clear();
+  }
+  _pending_areas.push_back(area);
+
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Called by the view for every area it paints (or skips painting), so that new changes in these areas
+ * are passed on to the view again. Partly painted areas are dropped as a whole, the rest of them is
+ * still invalid on the platform side.
+ */
+void Layer::clear_pending_areas(const Rect &painted) {
+  std::vector<Rect>::iterator iter = _pending_areas.begin();
+  while (iter != _pending_areas.end()) {
+    if (bounds_intersect(*iter, painted))
+      iter = _pending_areas.erase(iter);
+    else
+      ++iter;
+  }
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -162,7 +237,8 @@ void Layer::queue_relayout(CanvasItem *item) {
     throw std::logic_error("trying to queue non-toplevel item for relayout");
 
   if (std::find(_relayout_queue.begin(), _relayout_queue.end(), item) == _relayout_queue.end()) {
-    queue_repaint();
+    // Repaint the area the item covers now, the one it gets after relayouting is queued by repaint().
+    item->set_needs_repaint();
     _relayout_queue.push_back(item);
   }
 }
@@ -180,10 +256,11 @@ CanvasItem *Layer::get_top_item_at(const Point &point) {
 }
 
 static std::list<CanvasItem *> get_items_bounded_by(const Rect &rect, const Layer::ItemCheckFunc &pred, Group *group) {
-  std::list<CanvasItem *> &items = group->get_contents();
+  std::vector<CanvasItem *> items =
+    group->get_items_near(Rect(rect.pos - group->get_root_position(), rect.size));
   std::list<CanvasItem *> result;
 
-  for (std::list<CanvasItem *>::iterator iter = items.begin(); iter != items.end(); ++iter) {
+  for (std::vector<CanvasItem *>::iterator iter = items.begin(); iter != items.end(); ++iter) {
     Group *g;
 
     if (bounds_intersect((*iter)->get_root_bounds(), rect) && (!pred || pred(*iter)))
@@ -51,7 +51,6 @@ namespace mdc {
       return _visible;
     };
 
-    virtual void repaint_pending();
     virtual void repaint(const base::Rect &aBounds);
     void repaint_for_export(const base::Rect &aBounds);
 
@@ -66,6 +65,7 @@ namespace mdc {
 
     void queue_repaint();
     void queue_repaint(const base::Rect &bounds);
+    void clear_pending_areas(const base::Rect &painted);
 
     CanvasItem *get_other_item_at(const base::Point &point, CanvasItem *item);
 
@@ -98,12 +98,14 @@ namespace mdc {
 
     bool _visible;
 
-    bool _needs_repaint;
+    std::vector<base::Rect> _pending_areas; // Queued for repaint but not painted yet, aligned to the tile grid.
+    const base::Rect *_painting_bounds; // Area being painted while queued relayouts are done, NULL otherwise.
 
     Layer *get_layer_under_this();
 
   private:
     void view_resized();
+    bool add_pending_area(const base::Rect &bounds, base::Rect &area);
   };
 
 } // end of mdc namespace
@@ -18,8 +18,69 @@
  */
 
 #include "mdc.h"
+#include "mdc_canvas_view_image.h"
+#include "base/file_utilities.h"
 #include "wb_helpers.h"
 
+using namespace mdc;
+using namespace base;
+
+// Test pattern with areas of one color (as in diagrams) and areas where every pixel differs.
+static uint32_t test_pixel(int x, int y) {
+  if ((x / 37 + y / 23) % 3 == 0)
+    return 0xffffff;
+  return ((x * 7) & 0xff) << 16 | ((y * 13) & 0xff) << 8 | ((x ^ y) & 0xff);
+}
+
+// Number of pixels in the PNG file that differ from the test pattern, -1 if the file can't be read.
+static int count_wrong_pixels(const std::string &path, int width, int height) {
+  cairo_surface_t *image = cairo_image_surface_create_from_png(path.c_str());
+  int wrong = -1;
+
+  if (cairo_surface_status(image) == CAIRO_STATUS_SUCCESS && cairo_image_surface_get_width(image) == width &&
+      cairo_image_surface_get_height(image) == height) {
+    wrong = 0;
+    for (int y = 0; y < height; ++y) {
+      const uint32_t *row =
+        (const uint32_t *)(cairo_image_surface_get_data(image) + y * cairo_image_surface_get_stride(image));
+      for (int x = 0; x < width; ++x) {
+        if ((row[x] & 0xffffff) != test_pixel(x, y))
+          ++wrong;
+      }
+    }
+  }
+  cairo_surface_destroy(image);
+  return wrong;
+}
+
+static void write_test_png(const std::string &path, int width, int height, int tile_width, int band_height) {
+  base::FileHandle file(path.c_str(), "wb");
+  PNGStreamWriter writer(file.file(), width, height);
+
+  ensure("header", writer.write_header());
+  for (int y = 0; y < height; y += band_height) {
+    std::vector<cairo_surface_t *> tiles;
+    for (int x = 0; x < width; x += tile_width) {
+      cairo_surface_t *tile =
+        cairo_image_surface_create(CAIRO_FORMAT_RGB24, std::min(tile_width, width - x), band_height);
+      cairo_surface_flush(tile);
+      for (int row = 0; row < band_height && y + row < height; ++row) {
+        uint32_t *pixels =
+          (uint32_t *)(cairo_image_surface_get_data(tile) + row * cairo_image_surface_get_stride(tile));
+        for (int column = 0; column < cairo_image_surface_get_width(tile); ++column)
+          pixels[column] = test_pixel(x + column, y + row);
+      }
+      cairo_surface_mark_dirty(tile);
+      tiles.push_back(tile);
+    }
+
+    ensure("band", writer.write_band(tiles, std::min(band_height, height - y)));
+    for (std::vector<cairo_surface_t *>::iterator iter = tiles.begin(); iter != tiles.end(); ++iter)
+      cairo_surface_destroy(*iter);
+  }
+  ensure("finish", writer.finish());
+}
+
 BEGIN_TEST_DATA_CLASS(canvas_exportpng)
 END_TEST_DATA_CLASS
 
@@ -28,4 +89,58 @@ TEST_MODULE(canvas_exportpng, "Canvas: exportpng");
 TEST_FUNCTION(1) {
 }
 
+TEST_FUNCTION(2) { // PNGStreamWriter output read back by cairo
+  // Several bands with a partial last one, the width is no multiple of the tile width.
+  write_test_png("stream_test1.png", 1000, 700, 256, 64);
+  ensure_equals("multiple bands", count_wrong_pixels("stream_test1.png", 1000, 700), 0);
+
+  // A single tile and band, larger than the image.
+  write_test_png("stream_test2.png", 3, 1, 1024, 256);
+  ensure_equals("single pixel row", count_wrong_pixels("stream_test2.png", 3, 1), 0);
+
+  // One column more than the tile width, long runs of one color across tiles.
+  write_test_png("stream_test3.png", 1025, 300, 1024, 256);
+  ensure_equals("narrow last tile", count_wrong_pixels("stream_test3.png", 1025, 300), 0);
+}
+
+TEST_FUNCTION(3) { // tiled export of a view too big for a single image surface
+  ImageCanvasView view(1000, 1000);
+  view.initialize();
+  view.set_page_size(Size(2000, 1500));
+  view.set_page_layout(3, 3);
+
+  Layer *layer = view.get_current_layer();
+
+  // Crosses the boundaries of tiles and bands.
+  RectangleFigure *figure = new RectangleFigure(layer);
+  layer->add_item(figure);
+  figure->set_filled(true);
+  figure->set_fill_color(Color(1, 0, 0));
+  figure->set_pen_color(Color(1, 0, 0));
+  figure->resize_to(Size(100, 40));
+  figure->move_to(Point(1000, 240));
+
+  Size size = view.get_total_view_size();
+  ensure("tiled export", size.width * size.height > 4096 * 4096);
+  view.export_png("export_tiled.png");
+
+  cairo_surface_t *image = cairo_image_surface_create_from_png("export_tiled.png");
+  ensure("readable", cairo_surface_status(image) == CAIRO_STATUS_SUCCESS);
+  ensure_equals("width", cairo_image_surface_get_width(image), (int)size.width);
+  ensure_equals("height", cairo_image_surface_get_height(image), (int)size.height);
+
+  unsigned char *data = cairo_image_surface_get_data(image);
+  int stride = cairo_image_surface_get_stride(image);
+  const Point points[] = {Point(1010, 250), Point(1030, 250), Point(1010, 262), Point(1030, 262)};
+  for (size_t i = 0; i < sizeof(points) / sizeof(points[0]); ++i) {
+    uint32_t pixel = ((uint32_t *)(data + (int)points[i].y * stride))[(int)points[i].x];
+    ensure_equals("figure", pixel & 0xffffff, 0xff0000U);
+  }
+  ensure_equals("background", ((uint32_t *)(data + 500 * stride))[500] & 0xffffff, 0xffffffU);
+  ensure_equals("last pixel",
+                ((uint32_t *)(data + ((int)size.height - 1) * stride))[(int)size.width - 1] & 0xffffff, 0xffffffU);
+
+  cairo_surface_destroy(image);
+}
+
 END_TESTS
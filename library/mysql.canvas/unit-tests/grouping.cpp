@@ -18,8 +18,12 @@
  */
 
 #include "mdc.h"
+#include "mdc_canvas_view_image.h"
 #include "wb_helpers.h"
 
+using namespace mdc;
+using namespace base;
+
 BEGIN_TEST_DATA_CLASS(canvas_grouping)
 END_TEST_DATA_CLASS
 
@@ -37,4 +41,46 @@ TEST_FUNCTION(3) { // test selection (and inner selection) in groups and areas
 TEST_FUNCTION(4) { // test various coordinate related methods
 }
 
+TEST_FUNCTION(5) { // hit testing in groups large enough to use the position index
+  ImageCanvasView view(2000, 2000);
+  view.initialize();
+
+  Layer *layer = view.get_current_layer();
+  Group *root = layer->get_root_area_group();
+
+  std::vector<RectangleFigure *> items;
+  for (int i = 0; i < 64; i++) {
+    RectangleFigure *item = new RectangleFigure(layer);
+    layer->add_item(item);
+    item->resize_to(Size(100, 100));
+    item->move_to(Point((i % 8) * 200 + 50, (i / 8) * 200 + 50));
+    items.push_back(item);
+  }
+
+  ensure("first item", root->get_direct_subitem_at(Point(60, 60)) == items[0]);
+  ensure("last item", root->get_direct_subitem_at(Point(1500, 1500)) == items[63]);
+  ensure("between items", root->get_direct_subitem_at(Point(200, 200)) == NULL);
+
+  // move to a different index cell
+  items[0]->move_to(Point(1000, 1700));
+  ensure("old position", root->get_direct_subitem_at(Point(60, 60)) == NULL);
+  ensure("new position", root->get_direct_subitem_at(Point(1050, 1750)) == items[0]);
+
+  // overlapping items, the topmost one is hit
+  items[1]->move_to(Point(1020, 1720));
+  root->raise_item(items[1]);
+  ensure("raised", root->get_direct_subitem_at(Point(1080, 1780)) == items[1]);
+  root->raise_item(items[0]);
+  ensure("raised again", root->get_direct_subitem_at(Point(1080, 1780)) == items[0]);
+  root->lower_item(items[0]);
+  ensure("lowered", root->get_direct_subitem_at(Point(1080, 1780)) == items[1]);
+  ensure("not covered", root->get_direct_subitem_at(Point(1010, 1710)) == items[0]);
+
+  // removed items are no longer found
+  layer->remove_item(items[1]);
+  delete items[1];
+  ensure("removed, item below", root->get_direct_subitem_at(Point(1080, 1780)) == items[0]);
+  ensure("removed", root->get_direct_subitem_at(Point(1110, 1810)) == NULL);
+}
+
 END_TESTS
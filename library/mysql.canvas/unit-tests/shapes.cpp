@@ -19,6 +19,7 @@
 
 #include "mdc.h"
 #include "mdc_canvas_view_image.h"
+#include "base/string_utilities.h"
 #include "wb_helpers.h"
 
 using namespace mdc;
@@ -174,4 +175,50 @@ TEST_FUNCTION(3) { // test line ends
 TEST_FUNCTION(4) { // test text rendering
 }
 
+TEST_FUNCTION(5) { // text extents cache
+  cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 10, 10);
+  CairoCtx ctx(surface);
+  FontSpec font("Helvetica", SNormal, WNormal, 12);
+  cairo_text_extents_t extents, cached_extents;
+  size_t hits, misses;
+
+  take_text_extents_cache_stats(hits, misses);
+
+  ctx.get_text_extents(font, "extents test A", extents);
+  ctx.get_text_extents(font, "extents test A", cached_extents);
+  take_text_extents_cache_stats(hits, misses);
+  ensure_equals("first measure", misses, 1U);
+  ensure_equals("second measure", hits, 1U);
+  ensure_equals("cached width", cached_extents.x_advance, extents.x_advance);
+  ensure_equals("cached height", cached_extents.height, extents.height);
+
+  // Every part of the font spec and the text is part of the key.
+  ctx.get_text_extents(FontSpec("Helvetica", SNormal, WNormal, 14), "extents test A", extents);
+  ctx.get_text_extents(FontSpec("Helvetica", SNormal, WBold, 12), "extents test A", extents);
+  ctx.get_text_extents(FontSpec("Helvetica", SItalic, WNormal, 12), "extents test A", extents);
+  ctx.get_text_extents(FontSpec("Courier", SNormal, WNormal, 12), "extents test A", extents);
+  ctx.get_text_extents(font, "extents test a", extents);
+  ctx.get_text_extents(font, "extents test A ", extents);
+  take_text_extents_cache_stats(hits, misses);
+  ensure_equals("other fonts and texts", misses, 6U);
+  ensure_equals("no hits", hits, 0U);
+
+  // The cache keeps the last 20000 entries used. A was used after B, so B is dropped first.
+  ctx.get_text_extents(font, "extents test B", extents);
+  ctx.get_text_extents(font, "extents test A", extents);
+  for (int i = 0; i < 20000 - 1; ++i)
+    ctx.get_text_extents(font, strfmt("extents fill %i", i), extents);
+  take_text_extents_cache_stats(hits, misses);
+
+  ctx.get_text_extents(font, "extents test A", extents);
+  take_text_extents_cache_stats(hits, misses);
+  ensure_equals("recently used kept", hits, 1U);
+
+  ctx.get_text_extents(font, "extents test B", extents);
+  take_text_extents_cache_stats(hits, misses);
+  ensure_equals("least recently used dropped", misses, 1U);
+
+  cairo_surface_destroy(surface);
+}
+
 END_TESTS
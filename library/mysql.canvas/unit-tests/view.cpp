@@ -19,11 +19,19 @@
 
 #include "mdc.h"
 #include "mdc_canvas_view_image.h"
+#include "base/string_utilities.h"
 #include "wb_helpers.h"
 
 using namespace mdc;
 using namespace base;
 
+// The window area the view asks the platform to repaint for the given canvas area.
+static std::string repaint_request(CanvasView &view, const Rect &bounds) {
+  int x, y, w, h;
+  view.canvas_to_window(bounds, x, y, w, h);
+  return strfmt("%i,%i %ix%i", std::max(0, x - 1), std::max(0, y - 1), w + 2, h + 2);
+}
+
 BEGIN_TEST_DATA_CLASS(canvas_view)
 
 END_TEST_DATA_CLASS
@@ -48,4 +56,58 @@ TEST_FUNCTION(1) {
   ensure_equals("viewport for zoom 0.5", view.get_viewport().str(), Rect(0, 0, 500, 400).str());
 }
 
+// Areas queued for repaint are aligned to 64 unit tiles, merged with the pending areas they touch and
+// collapsed into one when more than 16 are pending.
+TEST_FUNCTION(2) {
+  std::vector<std::string> requests;
+  ImageCanvasView view(1000, 1000);
+  view.set_page_size(Size(1000, 1000));
+  Layer *layer = view.get_current_layer();
+
+  view.signal_repaint()->connect(
+    [&requests](int x, int y, int w, int h) { requests.push_back(strfmt("%i,%i %ix%i", x, y, w, h)); });
+  layer->clear_pending_areas(view.get_viewport_range());
+
+  layer->queue_repaint(Rect(10, 10, 20, 20));
+  ensure_equals("aligned area", requests.size(), 1U);
+  ensure_equals("aligned area", requests.back(), repaint_request(view, Rect(0, 0, 64, 64)));
+
+  layer->queue_repaint(Rect(20, 20, 10, 10));
+  layer->queue_repaint(Rect(0, 0, 64, 64));
+  ensure_equals("pending area not requested again", requests.size(), 1U);
+
+  layer->queue_repaint(Rect(70, 10, 10, 10));
+  ensure_equals("touching area", requests.size(), 2U);
+  ensure_equals("touching area merged", requests.back(), repaint_request(view, Rect(0, 0, 128, 64)));
+  layer->queue_repaint(Rect(100, 30, 5, 5));
+  ensure_equals("inside merged area", requests.size(), 2U);
+
+  layer->queue_repaint(Rect(500, 500, 10, 10));
+  ensure_equals("separate area", requests.size(), 3U);
+  ensure_equals("separate area", requests.back(), repaint_request(view, Rect(448, 448, 64, 64)));
+
+  // Painted areas are requested again with the next change.
+  layer->clear_pending_areas(Rect(0, 0, 200, 200));
+  layer->queue_repaint(Rect(20, 20, 10, 10));
+  ensure_equals("painted area", requests.size(), 4U);
+  layer->queue_repaint(Rect(500, 500, 5, 5));
+  ensure_equals("area not painted yet", requests.size(), 4U);
+
+  // 16 separate areas, the 17th collapses them all into one.
+  layer->clear_pending_areas(view.get_viewport_range());
+  requests.clear();
+  for (int i = 0; i < 16; i++) {
+    Rect area((i % 4) * 192, (i / 4) * 192, 64, 64);
+    layer->queue_repaint(Rect(area.left() + 10, area.top() + 10, 10, 10));
+    ensure_equals("separate areas", requests.back(), repaint_request(view, area));
+  }
+  ensure_equals("separate areas", requests.size(), 16U);
+
+  layer->queue_repaint(Rect(900, 900, 10, 10));
+  ensure_equals("overflow", requests.size(), 17U);
+  ensure_equals("overflow collapsed", requests.back(), repaint_request(view, Rect(0, 0, 960, 960)));
+  layer->queue_repaint(Rect(300, 300, 5, 5));
+  ensure_equals("between the former areas", requests.size(), 17U);
+}
+
 END_TESTS
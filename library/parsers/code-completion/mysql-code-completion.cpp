@@ -57,7 +57,8 @@ struct MySQLGrammarNode {
   bool multiple;       // true for + and * operators, otherwise false.
   bool any;            // Set for . as grammar node (which matches any lexer token).
   uint32_t tokenRef;   // In case of a terminal the id of the token.
-  std::string ruleRef; // In case of a non-terminal the name of the rule.
+  uint32_t ruleIndex;  // In case of a non-terminal the index of the rule in the rule table.
+  std::string ruleRef; // In case of a non-terminal the name of the rule (only used to build the rule table).
 
   MySQLGrammarNode() {
     isTerminal = true;
@@ -65,6 +66,7 @@ struct MySQLGrammarNode {
     multiple = false;
     any = false;
     tokenRef = INVALID_TOKEN;
+    ruleIndex = 0;
   }
 };
 
@@ -107,7 +109,7 @@ struct MySQLRuleAlternatives {
 //--------------------------------------------------------------------------------------------------
 
 // A shared data structure for a given grammar file + some additional parsing info.
-static struct {
+struct MySQLGrammarRules {
   std::map<std::string, MySQLRuleAlternatives> rules; // The full grammar.
   std::map<std::string, uint32_t> tokenMap;           // Map token names to token ids.
 
@@ -116,6 +118,20 @@ static struct {
   std::set<std::string> ignoredRules;  // Rules we don't provide completion with (e.g. "literal").
   std::set<std::string> ignoredTokens; // Tokens we don't want to show up (e.g. operators).
 
+  // The grammar in the form used by the completion walker. Rules are addressed by their index, so that
+  // matching needs neither name lookups nor string comparisons (see buildRuleTable()).
+  std::vector<MySQLRuleAlternatives> ruleTable;
+  std::vector<std::string> ruleNames;     // Indexed like ruleTable.
+  std::vector<bool> specialRuleFlags;     // Ditto.
+  std::vector<bool> ignoredRuleFlags;     // Ditto.
+  std::vector<bool> ignoredTokenFlags;    // Indexed by token id.
+
+  // Rules the walker treats in a special way.
+  uint32_t queryRule;
+  uint32_t subqueryRule;
+  uint32_t joinTableListRule;
+  uint32_t tableRefRule;
+
   //------------------------------------------------------------------------------------------------
 
   // Parses the given grammar file (and its associated .tokens file which must be in the same folder)
@@ -249,6 +265,7 @@ static struct {
     std::ifstream stream(name.c_str(), std::ifstream::binary);
     if (!stream.is_open()) {
       logError("Grammar file not found\n");
+      buildRuleTable();
       return;
     }
 
@@ -288,9 +305,98 @@ static struct {
     tokens->free(tokens);
     lexer->free(lexer);
     input->close(input);
+
+    buildRuleTable();
+  }
+
+  //------------------------------------------------------------------------------------------------
+
+  bool isIgnoredToken(uint32_t token) const {
+    return token < ignoredTokenFlags.size() && ignoredTokenFlags[token];
   }
 
 private:
+  /**
+   * Moves the parsed rules into the rule table and resolves all rule references to table indices.
+   * References to rules that don't exist in the grammar get an empty rule (as a lookup in the rule map did before).
+   * Without any parsed rules the table stays empty, which marks the grammar as not loaded.
+   */
+  void buildRuleTable() {
+    std::map<std::string, uint32_t> ruleIndices;
+    ruleTable.clear();
+    ruleNames.clear();
+    if (rules.empty())
+      return;
+
+    ruleTable.reserve(rules.size());
+    ruleNames.reserve(rules.size());
+    for (auto &rule : rules) {
+      ruleIndices[rule.first] = (uint32_t)ruleTable.size();
+      ruleNames.push_back(rule.first);
+      ruleTable.push_back(std::move(rule.second));
+    }
+    rules.clear();
+
+    auto indexOf = [&](const std::string &name) {
+      auto iterator = ruleIndices.find(name);
+      if (iterator != ruleIndices.end())
+        return iterator->second;
+
+      uint32_t index = (uint32_t)ruleTable.size();
+      ruleIndices[name] = index;
+      ruleNames.push_back(name);
+      ruleTable.push_back(MySQLRuleAlternatives());
+      return index;
+    };
+
+    // Collect the referenced names first, as adding missing rules invalidates references into the table.
+    std::set<std::string> referencedRules;
+    for (auto &alternatives : ruleTable)
+      for (auto &sequence : alternatives.sequence)
+        for (auto &node : sequence.nodes)
+          if (!node.isTerminal)
+            referencedRules.insert(node.ruleRef);
+    for (auto &name : referencedRules)
+      indexOf(name);
+
+    for (auto &alternatives : ruleTable)
+      for (auto &sequence : alternatives.sequence)
+        for (auto &node : sequence.nodes)
+          if (!node.isTerminal) {
+            node.ruleIndex = ruleIndices[node.ruleRef];
+            node.ruleRef.clear();
+          }
+
+    queryRule = indexOf("query");
+    subqueryRule = indexOf("subquery");
+    joinTableListRule = indexOf("join_table_list");
+    tableRefRule = indexOf("table_ref");
+
+    specialRuleFlags.assign(ruleTable.size(), false);
+    for (auto &name : specialRules) {
+      auto iterator = ruleIndices.find(name);
+      if (iterator != ruleIndices.end())
+        specialRuleFlags[iterator->second] = true;
+    }
+
+    ignoredRuleFlags.assign(ruleTable.size(), false);
+    for (auto &name : ignoredRules) {
+      auto iterator = ruleIndices.find(name);
+      if (iterator != ruleIndices.end())
+        ignoredRuleFlags[iterator->second] = true;
+    }
+
+    ignoredTokenFlags.clear();
+    for (auto &name : ignoredTokens) {
+      auto iterator = tokenMap.find(name);
+      if (iterator == tokenMap.end())
+        continue;
+      if (iterator->second >= ignoredTokenFlags.size())
+        ignoredTokenFlags.resize(iterator->second + 1, false);
+      ignoredTokenFlags[iterator->second] = true;
+    }
+  }
+
   void handleServerVersion(std::vector<std::string> parts, MySQLGrammarSequence &sequence) {
     bool includesEquality = parts[1].size() == 2;
     int version = atoi(parts[2].c_str());
@@ -647,7 +753,10 @@ private:
 
   //------------------------------------------------------------------------------------------------
 
-} rulesHolder;
+};
+
+// Only written while no completion can run (see waitForGrammar()).
+static MySQLGrammarRules rulesHolder;
 
 //--------------------------------------------------------------------------------------------------
 
@@ -664,8 +773,8 @@ struct AutoCompletionContext {
   long serverVersion;
   int sqlMode;
 
-  std::deque<std::string> walkStack; // The rules as they are being matched or collected from.
-                                     // It's a deque instead of a stack as we need to iterate over it.
+  std::deque<uint32_t> walkStack; // The rules (indices) as they are being matched or collected from.
+                                  // It's a deque instead of a stack as we need to iterate over it.
 
   enum RunState { RunStateMatching, RunStateCollectionPending } runState;
 
@@ -703,11 +812,14 @@ struct AutoCompletionContext {
 
     runState = RunStateMatching;
 
+    if (rulesHolder.ruleTable.empty()) // Grammar not loaded.
+      return false;
+
     if (scanner->token_channel() != 0)
       scanner->next(true);
 
     referencesStack.push_back(std::vector<TableReference>()); // For the root level of table references.
-    bool matched = matchRule("query");
+    bool matched = matchRule(rulesHolder.queryRule);
 
     // Post processing some entries.
     if (completionCandidates.count("NOT2_SYMBOL") > 0) {
@@ -824,13 +936,14 @@ private:
 
       // Skip any optional nodes if they don't match the current input.
       bool matched;
-      MySQLGrammarNode node;
+      const MySQLGrammarNode *current;
       do {
-        node = sequence.nodes[i];
+        current = &sequence.nodes[i];
+        const MySQLGrammarNode &node = *current;
         if (node.isTerminal)
           matched = scanner->is(node.tokenRef) || (node.any && !scanner->is(ANTLR3_TOKEN_EOF));
         else
-          matched = matchRuleAndCollectTableRefs(node.ruleRef);
+          matched = matchRuleAndCollectTableRefs(node.ruleIndex);
 
         if (matched && node.multiple)
           matched_loop = true;
@@ -845,6 +958,7 @@ private:
 
       } while (true);
 
+      const MySQLGrammarNode &node = *current;
       if (matched) {
         // Load next token if the grammar node is a terminal node.
         // Otherwise the match-rule-call will have advanced the input position already.
@@ -860,7 +974,7 @@ private:
               matched = scanner->is(node.tokenRef) || (node.any && !scanner->is(ANTLR3_TOKEN_EOF));
               scanner->next(true);
             } else
-              matched = matchRuleAndCollectTableRefs(node.ruleRef);
+              matched = matchRuleAndCollectTableRefs(node.ruleIndex);
           } while (matched);
 
           if (scanner->is(ANTLR3_TOKEN_EOF))
@@ -887,8 +1001,8 @@ private:
   * We try to match only one of the alts in the given rule (the first wins) and collect
   * table references on the way.
   */
-  bool matchRuleAndCollectTableRefs(const std::string &rule) {
-    MySQLRuleAlternatives alts = rulesHolder.rules[rule];
+  bool matchRuleAndCollectTableRefs(uint32_t rule) {
+    const MySQLRuleAlternatives &alts = rulesHolder.ruleTable[rule];
 
     if (alts.optimized) {
       if (alts.set.count(scanner->token_type()) > 0) {
@@ -909,7 +1023,7 @@ private:
           continue;
 
         if (matchAltAndCollectTableRefs(alternative)) {
-          if (rule == "table_ref") {
+          if (rule == rulesHolder.tableRefRule) {
             TableReference reference;
             size_t position = scanner->position();
 
@@ -979,7 +1093,7 @@ private:
         case FROM_SYMBOL:
           scanner->next(true);
           if (level == 0 && !scanner->is(DUAL_SYMBOL))
-            matchRuleAndCollectTableRefs("join_table_list");
+            matchRuleAndCollectTableRefs(rulesHolder.joinTableListRule);
           break;
 
         case ANTLR3_TOKEN_EOF:
@@ -1055,7 +1169,7 @@ private:
   */
   void collectFromAlternative(const MySQLGrammarSequence &sequence, size_t startIndex) {
     for (size_t i = startIndex; i < sequence.nodes.size(); ++i) {
-      MySQLGrammarNode node = sequence.nodes[i];
+      const MySQLGrammarNode &node = sequence.nodes[i];
       if (node.isTerminal && node.tokenRef == ANTLR3_TOKEN_EOF) {
         runState = RunStateMatching;
         break;
@@ -1064,7 +1178,7 @@ private:
       if (node.isTerminal) {
         // Insert only tokens we are interested in.
         std::string token_ref = (char *)MySQLParserTokenNames[node.tokenRef];
-        bool ignored = rulesHolder.ignoredTokens.find(token_ref) != rulesHolder.ignoredTokens.end();
+        bool ignored = rulesHolder.isIgnoredToken(node.tokenRef);
         bool exists = completionCandidates.find(token_ref) != completionCandidates.end();
         if (!ignored && !exists)
           completionCandidates.insert(token_ref);
@@ -1074,10 +1188,10 @@ private:
           std::string token_refs = token_ref;
           if (!ignored && !node.multiple) {
             while (++i < sequence.nodes.size()) {
-              MySQLGrammarNode node = sequence.nodes[i];
-              if (!node.isTerminal || !node.isRequired || node.multiple)
+              const MySQLGrammarNode &next = sequence.nodes[i];
+              if (!next.isTerminal || !next.isRequired || next.multiple)
                 break;
-              token_refs += std::string(" ") + (char *)MySQLParserTokenNames[node.tokenRef];
+              token_refs += std::string(" ") + (char *)MySQLParserTokenNames[next.tokenRef];
             }
 
             if (token_refs.size() > token_ref.size()) {
@@ -1094,7 +1208,7 @@ private:
           return;
         }
       } else {
-        collectFromRule(node.ruleRef);
+        collectFromRule(node.ruleIndex);
         if (node.isRequired && runState != RunStateCollectionPending)
           return;
       }
@@ -1109,29 +1223,28 @@ private:
   /**
   * Collects possibly reachable tokens from all alternatives in the given rule.
   */
-  void collectFromRule(const std::string rule) {
+  void collectFromRule(uint32_t rule) {
     // Don't go deeper if we have one of the special or ignored rules.
-    if (rulesHolder.specialRules.count(rule) > 0) {
-      completionCandidates.insert(rule);
+    if (rulesHolder.specialRuleFlags[rule]) {
+      completionCandidates.insert(rulesHolder.ruleNames[rule]);
       runState = RunStateMatching;
       return;
     }
 
     // Don't collect anything from an ignored rule.
-    if (rulesHolder.ignoredRules.count(rule) > 0) {
+    if (rulesHolder.ignoredRuleFlags[rule]) {
       runState = RunStateMatching;
       return;
     }
 
     // Any other rule goes here.
     RunState combinedState = RunStateMatching;
-    MySQLRuleAlternatives alts = rulesHolder.rules[rule];
+    const MySQLRuleAlternatives &alts = rulesHolder.ruleTable[rule];
     if (alts.optimized) {
       // Insert only tokens we are interested in.
       for (auto token : alts.set) {
-        std::string tokenRef = (char *)MySQLParserTokenNames[token];
-        if (rulesHolder.ignoredTokens.count(tokenRef) == 0)
-          completionCandidates.insert(tokenRef);
+        if (!rulesHolder.isIgnoredToken(token))
+          completionCandidates.insert((char *)MySQLParserTokenNames[token]);
       }
 
       runState = RunStateMatching;
@@ -1166,7 +1279,7 @@ private:
     if (node.isTerminal)
       return (node.tokenRef == tokenType) || (node.any && !scanner->is(ANTLR3_TOKEN_EOF));
     else
-      return matchRule(node.ruleRef);
+      return matchRule(node.ruleIndex);
   }
 
   //----------------------------------------------------------------------------------------------------------------------
@@ -1198,9 +1311,10 @@ private:
 
       // Skip any optional nodes if they don't match the current input.
       bool matched;
-      MySQLGrammarNode node;
+      const MySQLGrammarNode *current;
       do {
-        node = sequence.nodes[i];
+        current = &sequence.nodes[i];
+        const MySQLGrammarNode &node = *current;
         matched = match(node, scanner->token_type());
 
         // If that match call caused the collection to start then don't continue with matching here.
@@ -1245,6 +1359,7 @@ private:
       //
       // However this is a very special case and we solve this currently by testing for the DOT symbol, but this
       // solution is not universal.
+      const MySQLGrammarNode &node = *current;
       if (matched) {
         // Load next token if the grammar node is a terminal node.
         // Otherwise the match() call will have advanced the input position already.
@@ -1258,8 +1373,8 @@ private:
             //      Using a fixed token look-back might not be valid for all languages.
             if (lastToken == DOT_SYMBOL) {
               for (auto &entry : walkStack) {
-                if (rulesHolder.specialRules.count(entry) > 0) {
-                  completionCandidates.insert(entry);
+                if (rulesHolder.specialRuleFlags[entry]) {
+                  completionCandidates.insert(rulesHolder.ruleNames[entry]);
                   runState = RunStateMatching;
                   return hasMatchedAllMandatoryTokens(sequence, i);
                 }
@@ -1336,11 +1451,11 @@ private:
 
   //----------------------------------------------------------------------------------------------------------------------
 
-  bool matchRule(const std::string &rule) {
-    if (rule == "subquery")
+  bool matchRule(uint32_t rule) {
+    if (rule == rulesHolder.subqueryRule)
       referencesStack.push_front(std::vector<TableReference>()); // Starting a new level.
 
-    if (rule == "join_table_list" || rule == "table_ref") {
+    if (rule == rulesHolder.joinTableListRule || rule == rulesHolder.tableRefRule) {
       // Collect table references as we come along them.
       size_t lastPosition = scanner->position();
       matchRuleAndCollectTableRefs(rule);
@@ -1362,7 +1477,7 @@ private:
     bool matchedAtLeastOnce = false;
 
     // The longest match wins.
-    MySQLRuleAlternatives alts = rulesHolder.rules[rule];
+    const MySQLRuleAlternatives &alts = rulesHolder.ruleTable[rule];
     if (alts.optimized) {
       // In the optimized case we have neither predicates nor sequences.
       // We match a single terminal only, out of a set of alternative terminals.
@@ -1411,7 +1526,7 @@ private:
     runState = resultState;
     walkStack.pop_front();
 
-    if (rule == "subquery")
+    if (rule == rulesHolder.subqueryRule)
       referencesStack.pop_front(); // Subquery ended, no need for the nested references anymore.
 
     return matchedAtLeastOnce;
@@ -1422,9 +1537,77 @@ private:
 
 //--------------------------------------------------------------------------------------------------
 
+// Parsing the grammar takes a noticeable moment, so it's done in a background thread started when the first
+// editor is set up. Code completion waits for it in the (unlikely) case it is invoked before that finished.
+// If no rules could be loaded the state goes back to GrammarNotLoaded, so the next editor tries again.
+// The rules are parsed into a separate instance and only moved into rulesHolder under grammarMutex once complete,
+// completion only reads rulesHolder after seeing GrammarLoaded, so a retry never races with a reader.
+static base::Mutex grammarMutex;
+static base::Cond grammarCond;
+static enum { GrammarNotLoaded, GrammarLoading, GrammarLoaded } grammarState = GrammarNotLoaded;
+static std::string grammarFile;
+
+static bool loadGrammar(MySQLGrammarRules &rules, const std::string &path) {
+  try {
+    rules.parseFile(path);
+  } catch (std::exception &e) {
+    logError("Could not load the code completion grammar %s: %s\n", path.c_str(), e.what());
+  }
+  return !rules.ruleTable.empty();
+}
+
+// Must be called with grammarMutex locked.
+static void publishGrammar(MySQLGrammarRules &rules, bool loaded) {
+  if (loaded)
+    rulesHolder = std::move(rules);
+  grammarState = loaded ? GrammarLoaded : GrammarNotLoaded;
+  grammarCond.broadcast();
+}
+
+static gpointer loadGrammarThread(gpointer data) {
+  std::string path;
+  {
+    base::MutexLock lock(grammarMutex);
+    path = grammarFile;
+  }
+
+  MySQLGrammarRules rules;
+  bool loaded = loadGrammar(rules, path);
+
+  base::MutexLock lock(grammarMutex);
+  publishGrammar(rules, loaded);
+  return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void initializeMySQLCodeCompletionIfNeeded(const std::string &grammarPath) {
-  if (rulesHolder.rules.empty())
-    rulesHolder.parseFile(grammarPath);
+  base::MutexLock lock(grammarMutex);
+  if (grammarState != GrammarNotLoaded)
+    return;
+
+  grammarState = GrammarLoading;
+  grammarFile = grammarPath;
+
+  GThread *thread = base::create_thread(loadGrammarThread, NULL);
+  if (thread != NULL)
+    g_thread_unref(thread); // Nobody joins the thread, completion waits for the state change instead.
+  else {
+    MySQLGrammarRules rules;
+    publishGrammar(rules, loadGrammar(rules, grammarPath));
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Waits for a running grammar load. Returns true if the grammar is available, which from then on never changes.
+ */
+static bool waitForGrammar() {
+  base::MutexLock lock(grammarMutex);
+  while (grammarState == GrammarLoading)
+    grammarCond.wait(grammarMutex);
+  return grammarState == GrammarLoaded;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1625,6 +1808,9 @@ std::vector<std::pair<int, std::string>> getCodeCompletionList(size_t caretLine,
                                                                MySQLObjectNamesCache *cache) {
   logDebug("Invoking code completion\n");
 
+  if (!waitForGrammar())
+    return {};
+
   AutoCompletionContext context;
 
   context.caretLine = ++caretLine;   // ANTLR parser is one-based.
@@ -47,6 +47,7 @@ class MySQLObjectNamesCache;
 
 using CandidatesList = std::vector<std::pair<int, std::string>>;
 
+// Starts loading the grammar in the background (once), getCodeCompletionList() waits for it if necessary.
 PARSERS_PUBLIC_TYPE void initializeMySQLCodeCompletionIfNeeded(const std::string &grammarPath);
 
 PARSERS_PUBLIC_TYPE std::vector<std::pair<int, std::string>> getCodeCompletionList(
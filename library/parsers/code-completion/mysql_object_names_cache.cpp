@@ -211,6 +211,36 @@ std::vector<std::string> MySQLObjectNamesCache::getMatchingCollections(const std
 
 //--------------------------------------------------------------------------------------------------
 
+bool MySQLObjectNamesCache::NameLess::operator()(const std::string &left, const std::string &right) const {
+  int result = g_ascii_strcasecmp(left.c_str(), right.c_str());
+  if (result != 0)
+    return result < 0;
+  return left < right;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Adds all names starting with the given prefix (in any letter case) to the item list. Names are kept in sets
+ * ordered case insensitively, so the matches form a contiguous range and we don't need to scan the entire set.
+ * Among names differing only in letter case the all upper case one sorts first, hence the range starts at the
+ * lower bound of the upper cased prefix.
+ */
+static void appendMatchingNames(const MySQLObjectNamesCache::NameSet &names, const std::string &prefix,
+                                std::vector<std::string> &items) {
+  gchar *upperPrefix = g_ascii_strup(prefix.c_str(), (gssize)prefix.size());
+  auto iterator = names.lower_bound(upperPrefix);
+  g_free(upperPrefix);
+
+  for (; iterator != names.end(); ++iterator) {
+    if (iterator->size() < prefix.size() || g_ascii_strncasecmp(iterator->c_str(), prefix.c_str(), prefix.size()) != 0)
+      break;
+    items.push_back(*iterator);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
 /**
  * Core object retrieval function.
  */
@@ -225,10 +255,7 @@ std::vector<std::string> MySQLObjectNamesCache::getMatchingObjects(const std::st
   base::RecMutexLock lock(_cacheLock);
   switch (type) {
     case RetrieveWithNoQualifier:
-      for (auto &entry : _topLevelCache[cache]) {
-        if (base::hasPrefix(entry, prefix))
-          items.push_back(entry);
-      }
+      appendMatchingNames(_topLevelCache[cache], prefix, items);
       break;
 
     case RetrieveWithSchemaQualifier: {
@@ -236,19 +263,11 @@ std::vector<std::string> MySQLObjectNamesCache::getMatchingObjects(const std::st
       {
         for (auto &entry : _schemaObjectsCache) {
           if (entry.first.second == cache) // Consider only the object type given.
-          {
-            for (auto objectEntry : entry.second) {
-              if (base::hasPrefix(objectEntry, prefix))
-                items.push_back(objectEntry);
-            }
-          }
+            appendMatchingNames(entry.second, prefix, items);
         }
       } else {
         // Most common case, hence optimized.
-        for (auto &entry : _schemaObjectsCache[{schema, cache}]) {
-          if (base::hasPrefix(entry, prefix))
-            items.push_back(entry);
-        }
+        appendMatchingNames(_schemaObjectsCache[{schema, cache}], prefix, items);
       }
 
       break;
@@ -261,12 +280,8 @@ std::vector<std::string> MySQLObjectNamesCache::getMatchingObjects(const std::st
       if (schema.empty() && table.empty()) {
         // Columns/triggers from all tables in all schemas.
         for (auto &schemaEntry : _tableObjectsCache) {
-          for (auto &tableEntry : schemaEntry.second.element) {
-            for (auto &objectEntry : tableEntry.second.element[type]) {
-              if (base::hasPrefix(objectEntry, prefix))
-                items.push_back(objectEntry);
-            }
-          }
+          for (auto &tableEntry : schemaEntry.second.element)
+            appendMatchingNames(tableEntry.second.element[type], prefix, items);
         }
         break;
       }
@@ -274,31 +289,20 @@ std::vector<std::string> MySQLObjectNamesCache::getMatchingObjects(const std::st
       if (!schema.empty() && !table.empty()) {
         // Objects only from a specific table in a specific schema.
         // This is the most common case, hence optimized.
-        for (auto &objectEntry : _tableObjectsCache[schema].element[table].element[type]) {
-          if (base::hasPrefix(objectEntry, prefix))
-            items.push_back(objectEntry);
-        }
+        appendMatchingNames(_tableObjectsCache[schema].element[table].element[type], prefix, items);
         break;
       }
 
       if (!schema.empty()) {
         // Objects from all tables in a specific schema.
-        for (auto &schemaEntry : _tableObjectsCache[schema].element) {
-          for (auto objectEntry : schemaEntry.second.element[type]) {
-            if (base::hasPrefix(objectEntry, prefix))
-              items.push_back(objectEntry);
-          }
-        }
+        for (auto &schemaEntry : _tableObjectsCache[schema].element)
+          appendMatchingNames(schemaEntry.second.element[type], prefix, items);
         break;
       }
 
       // Objects from all schemas, using the same table in all of them.
-      for (auto &schemaEntry : _tableObjectsCache) {
-        for (auto &objectEntry : schemaEntry.second.element[table].element[type]) {
-          if (base::hasPrefix(objectEntry, prefix))
-            items.push_back(objectEntry);
-        }
-      }
+      for (auto &schemaEntry : _tableObjectsCache)
+        appendMatchingNames(schemaEntry.second.element[table].element[type], prefix, items);
 
       break;
     }
@@ -603,7 +607,7 @@ void MySQLObjectNamesCache::doRefreshProcedures(const std::string &schema) {
 
 void MySQLObjectNamesCache::doRefreshColumns(const std::string &schema, const std::string &table) {
   std::string sql = base::sqlstring("SHOW COLUMNS FROM !.!", 0) << schema << table;
-  std::set<std::string> columns;
+  NameSet columns;
   std::vector<std::pair<std::string, std::string>> result = _getValues(sql);
 
   for (auto &entry : result)
@@ -629,7 +633,7 @@ void MySQLObjectNamesCache::doRefreshTriggers(const std::string &schema, const s
     sql = base::sqlstring("SHOW TRIGGERS FROM ! WHERE ! = ?", 0) << schema << "Table" << table;
   else
     sql = base::sqlstring("SHOW TRIGGERS FROM !", 0) << schema;
-  std::set<std::string> triggers;
+  NameSet triggers;
   std::vector<std::pair<std::string, std::string>> result = _getValues(sql);
 
   for (auto &entry : result)
@@ -650,7 +654,7 @@ void MySQLObjectNamesCache::doRefreshTriggers(const std::string &schema, const s
 //--------------------------------------------------------------------------------------------------
 
 void MySQLObjectNamesCache::doRefreshUdfs() {
-  std::set<std::string> udfs;
+  NameSet udfs;
   std::vector<std::pair<std::string, std::string>> result = _getValues("SELECT NAME FROM mysql.func");
 
   for (auto &entry : result)
@@ -671,7 +675,7 @@ void MySQLObjectNamesCache::doRefreshUdfs() {
 //--------------------------------------------------------------------------------------------------
 
 void MySQLObjectNamesCache::doRefreshCharsets() {
-  std::set<std::string> charsets;
+  NameSet charsets;
   std::vector<std::pair<std::string, std::string>> result = _getValues("show charset");
 
   for (auto &entry : result)
@@ -692,7 +696,7 @@ void MySQLObjectNamesCache::doRefreshCharsets() {
 //--------------------------------------------------------------------------------------------------
 
 void MySQLObjectNamesCache::doRefreshCollations() {
-  std::set<std::string> collations;
+  NameSet collations;
   std::vector<std::pair<std::string, std::string>> result = _getValues("show collation");
 
   for (auto &entry : result)
@@ -713,7 +717,7 @@ void MySQLObjectNamesCache::doRefreshCollations() {
 //--------------------------------------------------------------------------------------------------
 
 void MySQLObjectNamesCache::doRefreshVariables() {
-  std::set<std::string> variables;
+  NameSet variables;
   std::vector<std::pair<std::string, std::string>> result = _getValues("SHOW GLOBAL VARIABLES");
 
   for (auto &entry : result)
@@ -734,7 +738,7 @@ void MySQLObjectNamesCache::doRefreshVariables() {
 //--------------------------------------------------------------------------------------------------
 
 void MySQLObjectNamesCache::doRefreshEngines() {
-  std::set<std::string> engines;
+  NameSet engines;
   std::vector<std::pair<std::string, std::string>> result = _getValues("SHOW ENGINES");
 
   for (auto &entry : result)
@@ -748,7 +752,7 @@ void MySQLObjectNamesCache::doRefreshEngines() {
 //--------------------------------------------------------------------------------------------------
 
 void MySQLObjectNamesCache::doRefreshLogfileGroups() {
-  std::set<std::string> logfileGroups;
+  NameSet logfileGroups;
 
   // Logfile groups and tablespaces are referenced as single unqualified identifiers in MySQL syntax.
   // They are stored however together with a table schema and a table name.
@@ -767,7 +771,7 @@ void MySQLObjectNamesCache::doRefreshLogfileGroups() {
 //--------------------------------------------------------------------------------------------------
 
 void MySQLObjectNamesCache::doRefreshTablespaces() {
-  std::set<std::string> tablespaces;
+  NameSet tablespaces;
   std::vector<std::pair<std::string, std::string>> result =
     _getValues("SELECT tablespace_name FROM information_schema.FILES");
 
@@ -908,7 +912,7 @@ void MySQLObjectNamesCache::updateCollections(const std::string &schema, base::S
 /**
  * Update routine for the top level cache.
  */
-void MySQLObjectNamesCache::updateObjectNames(const std::string &cache, const std::set<std::string> &objects) {
+void MySQLObjectNamesCache::updateObjectNames(const std::string &cache, const NameSet &objects) {
   base::RecMutexLock lock(_cacheLock);
   _topLevelCache[cache] = objects;
 }
@@ -922,7 +926,7 @@ void MySQLObjectNamesCache::updateObjectNames(const std::string &cache, const st
  */
 void MySQLObjectNamesCache::updateObjectNames(const std::string &cache, const std::string &schema,
                                               base::StringListPtr objects) {
-  std::set<std::string> objectSet;
+  NameSet objectSet;
   for (auto entry : *objects)
     objectSet.insert(entry);
   updateObjectNames(cache, schema, objectSet, OtherCacheType);
@@ -934,16 +938,70 @@ void MySQLObjectNamesCache::updateObjectNames(const std::string &cache, const st
 // depending on whether we are updating schema objects or columns.
 // In the first case it's the object type name, otherwise the table name.
 void MySQLObjectNamesCache::updateObjectNames(const std::string &context, const std::string &schema,
-                                              const std::set<std::string> &objects, CacheObjectType type) {
+                                              const NameSet &objects, CacheObjectType type) {
   base::RecMutexLock lock(_cacheLock);
-  if (type == OtherCacheType)
+  if (type == OtherCacheType) {
     _schemaObjectsCache[{schema, context}] = objects;
-  else
+    if (context == "tables" || context == "views")
+      pruneTableObjects(schema);
+  } else
     _tableObjectsCache[schema].element[context].element[type] = objects;
 }
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * Removes the columns and triggers of tables and views no longer listed for the given schema (e.g. names taken
+ * from a snapshot for a table dropped since). Nothing is removed before both the table and view lists are known.
+ * The cache lock must be held.
+ */
+void MySQLObjectNamesCache::pruneTableObjects(const std::string &schema) {
+  auto schemaEntry = _tableObjectsCache.find(schema);
+  auto tables = _schemaObjectsCache.find({schema, "tables"});
+  auto views = _schemaObjectsCache.find({schema, "views"});
+  if (schemaEntry == _tableObjectsCache.end() || tables == _schemaObjectsCache.end() ||
+      views == _schemaObjectsCache.end())
+    return;
+
+  auto &tableEntries = schemaEntry->second.element;
+  for (auto iterator = tableEntries.begin(); iterator != tableEntries.end();) {
+    if (tables->second.count(iterator->first) == 0 && views->second.count(iterator->first) == 0)
+      iterator = tableEntries.erase(iterator);
+    else
+      ++iterator;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Removes everything cached for schemas, tables and views the server no longer reports. Used when merging or
+ * writing a snapshot, the regular refreshes keep the cache consistent otherwise. The cache lock must be held.
+ */
+void MySQLObjectNamesCache::pruneDroppedObjects() {
+  auto schemas = _topLevelCache.find("schemas");
+  if (schemas != _topLevelCache.end() && !schemas->second.empty()) {
+    for (auto iterator = _schemaObjectsCache.begin(); iterator != _schemaObjectsCache.end();) {
+      if (schemas->second.count(iterator->first.first) == 0)
+        iterator = _schemaObjectsCache.erase(iterator);
+      else
+        ++iterator;
+    }
+
+    for (auto iterator = _tableObjectsCache.begin(); iterator != _tableObjectsCache.end();) {
+      if (schemas->second.count(iterator->first) == 0)
+        iterator = _tableObjectsCache.erase(iterator);
+      else
+        ++iterator;
+    }
+  }
+
+  for (auto &schemaEntry : _tableObjectsCache)
+    pruneTableObjects(schemaEntry.first);
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void MySQLObjectNamesCache::addPendingRefresh(RefreshTask::RefreshType type, const std::string &schema,
                                               const std::string &table) {
   base::RecMutexLock lock(_pendingMutex);
@@ -1039,3 +1097,210 @@ void MySQLObjectNamesCache::createWorkerThread() {
 }
 
 //--------------------------------------------------------------------------------------------------
+
+// Snapshot format: a header line followed by records, each starting with a record type character.
+// Strings (and string sets) are written with their length in front, so names can contain any character.
+//   T <cache name> <names>                     top level objects
+//   S <schema> <object type> <names>           schema objects
+//   C <schema> <table> <cache type> <names>    columns and triggers
+static const std::string snapshotHeader = "MySQLObjectNamesCache snapshot 1\n";
+
+static void writeSnapshotString(std::string &out, const std::string &value) {
+  out += std::to_string(value.size()) + ":";
+  out += value;
+}
+
+static void writeSnapshotNames(std::string &out, const MySQLObjectNamesCache::NameSet &names) {
+  out += std::to_string(names.size()) + ":";
+  for (auto &name : names)
+    writeSnapshotString(out, name);
+}
+
+class SnapshotReader {
+public:
+  SnapshotReader(const char *data, size_t length) : _position(data), _end(data + length) {
+  }
+
+  bool atEnd() const {
+    return _position == _end;
+  }
+
+  bool readChar(char &value) {
+    if (_position == _end)
+      return false;
+    value = *_position++;
+    return true;
+  }
+
+  bool readNumber(size_t &value) {
+    value = 0;
+    const char *start = _position;
+    while (_position < _end && g_ascii_isdigit(*_position))
+      value = value * 10 + (*_position++ - '0');
+    return _position > start && _position < _end && *_position++ == ':';
+  }
+
+  bool readString(std::string &value) {
+    size_t length;
+    if (!readNumber(length) || length > (size_t)(_end - _position))
+      return false;
+    value.assign(_position, length);
+    _position += length;
+    return true;
+  }
+
+  bool readNames(MySQLObjectNamesCache::NameSet &names) {
+    size_t count;
+    if (!readNumber(count))
+      return false;
+
+    std::string name;
+    for (size_t i = 0; i < count; ++i) {
+      if (!readString(name))
+        return false;
+      names.insert(names.end(), name); // Names were written in order.
+    }
+    return true;
+  }
+
+private:
+  const char *_position;
+  const char *_end;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Fills the cache with the names stored in the given snapshot file. Only cache entries which have not been
+ * fetched from the server yet are taken from the snapshot, so a refresh that is already running always wins.
+ * Schema objects are still loaded from the server when first used (see loadSchemaObjectsIfNeeded), which then
+ * replaces the snapshot data.
+ */
+bool MySQLObjectNamesCache::loadSnapshot(const std::string &path) {
+  gchar *contents = nullptr;
+  gsize length = 0;
+  if (!g_file_get_contents(path.c_str(), &contents, &length, nullptr))
+    return false;
+
+  std::map<std::string, NameSet> topLevel;
+  std::map<std::pair<std::string, std::string>, NameSet> schemaObjects;
+  std::map<std::string, TableObjectsMap> tableObjects;
+
+  bool valid = length >= snapshotHeader.size() &&
+               snapshotHeader.compare(0, std::string::npos, contents, snapshotHeader.size()) == 0;
+  if (valid) {
+    SnapshotReader reader(contents + snapshotHeader.size(), length - snapshotHeader.size());
+    while (valid && !reader.atEnd()) {
+      char recordType;
+      std::string schema, name;
+      size_t type;
+      reader.readChar(recordType);
+      switch (recordType) {
+        case 'T':
+          valid = reader.readString(name) && reader.readNames(topLevel[name]);
+          break;
+        case 'S':
+          valid = reader.readString(schema) && reader.readString(name) &&
+                  reader.readNames(schemaObjects[{schema, name}]);
+          break;
+        case 'C':
+          valid = reader.readString(schema) && reader.readString(name) && reader.readNumber(type) &&
+                  (type == ColumnsCacheType || type == TriggersCacheType) &&
+                  reader.readNames(tableObjects[schema].element[name].element[(CacheObjectType)type]);
+          break;
+        default:
+          valid = false;
+          break;
+      }
+    }
+  }
+  g_free(contents);
+
+  if (!valid) {
+    logWarning("Ignoring invalid name cache snapshot %s\n", path.c_str());
+    return false;
+  }
+
+  base::RecMutexLock lock(_cacheLock);
+  for (auto &entry : topLevel) {
+    NameSet &names = _topLevelCache[entry.first];
+    if (names.empty())
+      names.swap(entry.second);
+  }
+
+  for (auto &entry : schemaObjects) {
+    NameSet &names = _schemaObjectsCache[entry.first];
+    if (names.empty())
+      names.swap(entry.second);
+  }
+
+  for (auto &schemaEntry : tableObjects) {
+    for (auto &tableEntry : schemaEntry.second.element) {
+      for (auto &typeEntry : tableEntry.second.element) {
+        NameSet &names =
+          _tableObjectsCache[schemaEntry.first].element[tableEntry.first].element[typeEntry.first];
+        if (names.empty())
+          names.swap(typeEntry.second);
+      }
+    }
+  }
+
+  // The server data fetched so far wins over the snapshot, also for objects dropped in the meantime.
+  pruneDroppedObjects();
+
+  logDebug("Loaded name cache snapshot %s\n", path.c_str());
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool MySQLObjectNamesCache::saveSnapshot(const std::string &path) {
+  std::string snapshot = snapshotHeader;
+  {
+    base::RecMutexLock lock(_cacheLock);
+    pruneDroppedObjects();
+
+    for (auto &entry : _topLevelCache) {
+      if (entry.second.empty())
+        continue;
+      snapshot += "T";
+      writeSnapshotString(snapshot, entry.first);
+      writeSnapshotNames(snapshot, entry.second);
+    }
+
+    for (auto &entry : _schemaObjectsCache) {
+      if (entry.second.empty()) // Also skips the schema sentinels.
+        continue;
+      snapshot += "S";
+      writeSnapshotString(snapshot, entry.first.first);
+      writeSnapshotString(snapshot, entry.first.second);
+      writeSnapshotNames(snapshot, entry.second);
+    }
+
+    for (auto &schemaEntry : _tableObjectsCache) {
+      for (auto &tableEntry : schemaEntry.second.element) {
+        for (auto &typeEntry : tableEntry.second.element) {
+          if (typeEntry.second.empty())
+            continue;
+          snapshot += "C";
+          writeSnapshotString(snapshot, schemaEntry.first);
+          writeSnapshotString(snapshot, tableEntry.first);
+          snapshot += std::to_string(typeEntry.first) + ":";
+          writeSnapshotNames(snapshot, typeEntry.second);
+        }
+      }
+    }
+  }
+
+  GError *error = nullptr;
+  if (!g_file_set_contents(path.c_str(), snapshot.data(), (gssize)snapshot.size(), &error)) {
+    logError("Could not write name cache snapshot %s: %s\n", path.c_str(), error ? error->message : "unknown error");
+    if (error)
+      g_error_free(error);
+    return false;
+  }
+
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
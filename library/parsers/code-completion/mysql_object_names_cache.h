@@ -36,6 +36,13 @@ using ObjectQueryCallback = std::function<std::vector<std::pair<std::string, std
 
 class PARSERS_PUBLIC_TYPE MySQLObjectNamesCache {
 public:
+  // Names are ordered case insensitively (ties broken by a case sensitive compare), so all names starting with
+  // a given prefix in any letter case form one contiguous range of a set.
+  struct NameLess {
+    bool operator()(const std::string &left, const std::string &right) const;
+  };
+  using NameSet = std::set<std::string, NameLess>;
+
   // Note: feedback can be called from the worker thread. Make the necessary arrangements.
   //       It comes with parameter true if the cache update is going on, otherwise false.
   MySQLObjectNamesCache(ObjectQueryCallback getValues, std::function<void(bool)> feedback, bool jsonSupport = false);
@@ -88,6 +95,11 @@ public:
 
   void shutdown();
 
+  // Snapshot of the cached names on disk, so completion has data right after connecting. Names loaded from a
+  // snapshot are replaced by the normal (background) refresh as soon as the objects were fetched from the server.
+  bool loadSnapshot(const std::string &path);
+  bool saveSnapshot(const std::string &path);
+
 private:
   struct RefreshTask {
     enum RefreshType {
@@ -151,10 +163,12 @@ private:
   void doRefreshEvents(const std::string &schema);
   void doRefreshCollections(const std::string &schema);
 
-  void updateObjectNames(const std::string &cache, const std::set<std::string> &objects);
+  void updateObjectNames(const std::string &cache, const NameSet &objects);
   void updateObjectNames(const std::string &cache, const std::string &schema, base::StringListPtr objects);
-  void updateObjectNames(const std::string &context, const std::string &schema, const std::set<std::string> &objects,
+  void updateObjectNames(const std::string &context, const std::string &schema, const NameSet &objects,
                          CacheObjectType type);
+  void pruneTableObjects(const std::string &schema);
+  void pruneDroppedObjects();
 
   std::vector<std::string> getMatchingObjects(const std::string &cache, const std::string &schema,
                                               const std::string &table, const std::string &prefix, RetrievalType type);
@@ -184,14 +198,14 @@ private:
 
   // Unbound objects (schemas, udfs, variables, engines, logfile_groups, tablespaces, charsets, collations).
   // Stored as: "object type": object names set.
-  std::map<std::string, std::set<std::string>> _topLevelCache;
+  std::map<std::string, NameSet> _topLevelCache;
 
   // Schema specific objects (views, tables, functions, procedures, events).
   // A schema can be in the top level cache, but not in the objects cache (if not loaded yet).
   //
   // (schema, object type): object names set
   // e.g. (sakila, tables): actor, address, ...
-  std::map<std::pair<std::string, std::string>, std::set<std::string>> _schemaObjectsCache;
+  std::map<std::pair<std::string, std::string>, NameSet> _schemaObjectsCache;
 
   // Table specific objects (columns, triggers).
   // A schema or a table can be in the other caches but not here (if not loaded yet).
@@ -199,7 +213,7 @@ private:
   // e.g. (sakila, (actor, TriggersCacheType)): actor_id, ...
   // Note: did not use a tuple here as it doesn't easily work with a map.
   struct CacheObjectMap {
-    std::map<CacheObjectType, std::set<std::string>> element;
+    std::map<CacheObjectType, NameSet> element;
   };
   struct TableObjectsMap {
     std::map<std::string, CacheObjectMap> element;
@@ -208,5 +222,5 @@ private:
 
 public:
   using TableObjectsCacheType =
-    std::pair<std::string, std::map<std::string, std::map<CacheObjectType, std::set<std::string>>>>;
+    std::pair<std::string, std::map<std::string, std::map<CacheObjectType, NameSet>>>;
 };
@@ -26,9 +26,18 @@ namespace std {
 };
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HAVE_SSE2_SCANNER 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
 #include "base/string_utilities.h"
 #include "base/util_functions.h"
 #include "base/log.h"
+#include "base/threading.h"
 
 #include "grtpp_util.h"
 
@@ -3235,6 +3244,56 @@ size_t MySQLParserServicesImpl::parseTablespace(parser::MySQLParserContext::Ref
   return error_count;
 }
 
+//--------------------------------------------------------------------------------------------------
+
+#define PARALLEL_PARSE_MIN_STATEMENT_COUNT 64
+#define MAX_PARSE_THREAD_COUNT 8
+#define PARSE_BATCH_SIZE_PER_THREAD 16
+
+struct StatementParseJob {
+  const char *sql;
+  const std::pair<size_t, size_t> *ranges; // One statement for each recognizer.
+  MySQLRecognizer *const *recognizers;
+  size_t count;
+
+  static gpointer parse(gpointer data) {
+    StatementParseJob *job = static_cast<StatementParseJob *>(data);
+    for (size_t i = 0; i < job->count; ++i)
+      job->recognizers[i]->parse(job->sql + job->ranges[i].first, job->ranges[i].second, true,
+                                 MySQLParseUnit::PuGeneric);
+    return NULL;
+  }
+};
+
+/**
+ * Parses the statements from the given start index on, one per recognizer, so each recognizer holds the AST
+ * of its statement afterwards. The work is split into consecutive chunks for the given number of threads.
+ */
+static void parseStatementBatch(const char *sql, const std::vector<std::pair<size_t, size_t> > &ranges, size_t start,
+                                const std::vector<MySQLRecognizer *> &recognizers, size_t threadCount) {
+  size_t count = std::min(recognizers.size(), ranges.size() - start);
+  size_t chunkSize = (count + threadCount - 1) / threadCount;
+
+  std::vector<StatementParseJob> jobs;
+  for (size_t offset = 0; offset < count; offset += chunkSize) {
+    StatementParseJob job = {sql, &ranges[start + offset], &recognizers[offset], std::min(chunkSize, count - offset)};
+    jobs.push_back(job);
+  }
+
+  std::vector<GThread *> threads(jobs.size(), (GThread *)NULL);
+  for (size_t n = 1; n < jobs.size(); ++n) {
+    threads[n] = base::create_thread(&StatementParseJob::parse, &jobs[n]);
+    if (threads[n] == NULL)
+      StatementParseJob::parse(&jobs[n]);
+  }
+  StatementParseJob::parse(&jobs[0]);
+  for (size_t n = 1; n < jobs.size(); ++n)
+    if (threads[n] != NULL)
+      g_thread_join(threads[n]);
+}
+
+//--------------------------------------------------------------------------------------------------
+
 size_t MySQLParserServicesImpl::parseSQLIntoCatalogSql(parser_ContextReferenceRef context_ref,
                                                        db_mysql_CatalogRef catalog, const std::string &sql,
                                                        grt::DictRef options) {
@@ -3322,7 +3381,6 @@ size_t MySQLParserServicesImpl::parseSQLIntoCatalog(parser::MySQLParserContext::
   }
 
   size_t errorCount = 0;
-  MySQLRecognizer *recognizer = context->recognizer();
   std::shared_ptr<MySQLQueryIdentifier> queryIdentifier = context->createQueryIdentifier();
 
   std::vector<std::pair<size_t, size_t> > ranges;
@@ -3334,9 +3392,9 @@ size_t MySQLParserServicesImpl::parseSQLIntoCatalog(parser::MySQLParserContext::
     options.set("created_objects", createdObjects);
   }
 
-  // Collect textual FK references into a local cache. At the end this is used
-  // to find actual ref tables + columns, when all tables have been parsed.
-  DbObjectsRefsCache refCache;
+  // Determine first which statements must be parsed at all (the query identifier only runs the lexer).
+  std::vector<std::pair<size_t, size_t> > statementRanges;
+  std::vector<MySQLQueryType> statementTypes;
   for (std::vector<std::pair<size_t, size_t> >::iterator iterator = ranges.begin(); iterator != ranges.end();
        ++iterator) {
     // std::string ddl(sql.c_str() + iterator->first, iterator->second);
@@ -3350,8 +3408,35 @@ size_t MySQLParserServicesImpl::parseSQLIntoCatalog(parser::MySQLParserContext::
     if (relevantQueryTypes.count(queryType) == 0)
       continue; // Something we are not interested in. Don't bother parsing it.
 
-    recognizer->parse(sql.c_str() + iterator->first, iterator->second, true, MySQLParseUnit::PuGeneric);
-    errors = recognizer->error_info().size();
+    statementRanges.push_back(*iterator);
+    statementTypes.push_back(queryType);
+  }
+
+  // Parsing takes most of the time for large scripts (e.g. when reverse engineering a schema with many tables), so
+  // these are parsed in batches by a set of recognizers in worker threads. The parse results are still applied to
+  // the catalog here, in statement order.
+  std::vector<MySQLRecognizer *> recognizers(1, context->recognizer());
+  std::vector<std::shared_ptr<MySQLRecognizer> > batchRecognizers;
+  size_t threadCount = std::min<size_t>(MAX_PARSE_THREAD_COUNT, g_get_num_processors());
+  if (statementRanges.size() >= PARALLEL_PARSE_MIN_STATEMENT_COUNT && threadCount > 1) {
+    for (size_t i = 1; i < threadCount * PARSE_BATCH_SIZE_PER_THREAD; ++i) {
+      batchRecognizers.push_back(context->createRecognizer());
+      recognizers.push_back(batchRecognizers.back().get());
+    }
+  } else
+    threadCount = 1;
+
+  // Collect textual FK references into a local cache. At the end this is used
+  // to find actual ref tables + columns, when all tables have been parsed.
+  DbObjectsRefsCache refCache;
+  for (size_t index = 0; index < statementRanges.size(); ++index) {
+    size_t slot = index % recognizers.size();
+    if (slot == 0)
+      parseStatementBatch(sql.c_str(), statementRanges, index, recognizers, threadCount);
+
+    MySQLRecognizer *recognizer = recognizers[slot];
+    MySQLQueryType queryType = statementTypes[index];
+    size_t errors = recognizer->error_info().size();
     if (errors > 0) {
       errorCount += errors;
       continue;
@@ -4161,6 +4246,140 @@ bool is_line_break(const unsigned char *head, const unsigned char *line_break) {
 
 //--------------------------------------------------------------------------------------------------
 
+// Block scanners for the statement splitter. They only skip bytes the byte-wise state machine would step over
+// without doing anything else, so the splitter produces the same ranges as before, just faster on large scripts.
+// x86 builds use SSE2 (available on every x64 CPU), other platforms use the scalar loops.
+
+#ifdef HAVE_SSE2_SCANNER
+
+static inline unsigned int first_bit(unsigned int mask) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+#endif
+
+/**
+ * Returns the first position in [run, end) which holds either a or b (or end if there is none).
+ */
+static inline const unsigned char *find_either(const unsigned char *run, const unsigned char *end, unsigned char a,
+                                               unsigned char b) {
+#ifdef HAVE_SSE2_SCANNER
+  const __m128i a_block = _mm_set1_epi8((char)a);
+  const __m128i b_block = _mm_set1_epi8((char)b);
+  while (end - run >= 16) {
+    __m128i block = _mm_loadu_si128((const __m128i *)run);
+    unsigned int mask = (unsigned int)_mm_movemask_epi8(
+      _mm_or_si128(_mm_cmpeq_epi8(block, a_block), _mm_cmpeq_epi8(block, b_block)));
+    if (mask != 0)
+      return run + first_bit(mask);
+    run += 16;
+  }
+#endif
+
+  while (run < end && *run != a && *run != b)
+    run++;
+  return run;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Skips over text that contains nothing the splitter has to look at: no comment or quote start, no possible
+ * DELIMITER keyword and no first char of the current delimiter. Sets have_content if any of the skipped bytes
+ * is not white space.
+ */
+static inline const unsigned char *skip_plain_text(const unsigned char *run, const unsigned char *end,
+                                                   unsigned char delimiter_start, bool &have_content) {
+#ifdef HAVE_SSE2_SCANNER
+  const __m128i slash = _mm_set1_epi8('/');
+  const __m128i dash = _mm_set1_epi8('-');
+  const __m128i hash = _mm_set1_epi8('#');
+  const __m128i double_quote = _mm_set1_epi8('"');
+  const __m128i single_quote = _mm_set1_epi8('\'');
+  const __m128i back_tick = _mm_set1_epi8('`');
+  const __m128i lower_d = _mm_set1_epi8('d');
+  const __m128i case_bit = _mm_set1_epi8(0x20);
+  const __m128i delimiter = _mm_set1_epi8((char)delimiter_start);
+  const __m128i space = _mm_set1_epi8(' ');
+
+  while (end - run >= 16) {
+    __m128i block = _mm_loadu_si128((const __m128i *)run);
+    __m128i special = _mm_or_si128(_mm_cmpeq_epi8(block, slash), _mm_cmpeq_epi8(block, dash));
+    special = _mm_or_si128(special, _mm_cmpeq_epi8(block, hash));
+    special = _mm_or_si128(special, _mm_cmpeq_epi8(block, double_quote));
+    special = _mm_or_si128(special, _mm_cmpeq_epi8(block, single_quote));
+    special = _mm_or_si128(special, _mm_cmpeq_epi8(block, back_tick));
+    special = _mm_or_si128(special, _mm_cmpeq_epi8(_mm_or_si128(block, case_bit), lower_d));
+    special = _mm_or_si128(special, _mm_cmpeq_epi8(block, delimiter));
+    unsigned int special_mask = (unsigned int)_mm_movemask_epi8(special);
+
+    // Unsigned byte <= ' ' is white space (or control char) for the splitter.
+    unsigned int blank_mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(block, space), space));
+    unsigned int content_mask = ~blank_mask & 0xFFFF;
+
+    if (special_mask != 0) {
+      unsigned int offset = first_bit(special_mask);
+      if ((content_mask & ((1U << offset) - 1)) != 0)
+        have_content = true;
+      return run + offset;
+    }
+
+    if (content_mask != 0)
+      have_content = true;
+    run += 16;
+  }
+#endif
+
+  while (run < end) {
+    switch (*run) {
+      case '/':
+      case '-':
+      case '#':
+      case '"':
+      case '\'':
+      case '`':
+      case 'd':
+      case 'D':
+        return run;
+
+      default:
+        if (*run == delimiter_start)
+          return run;
+        if (*run > ' ')
+          have_content = true;
+        run++;
+        break;
+    }
+  }
+  return run;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the position of the next line break in [run, end) or end if there is none.
+ */
+static inline const unsigned char *find_line_break(const unsigned char *run, const unsigned char *end,
+                                                   const unsigned char *line_break) {
+  if (*line_break == '\0')
+    return run < end ? end : run;
+
+  while (true) {
+    run = find_either(run, end, *line_break, *line_break);
+    if (run >= end || is_line_break(run, line_break))
+      return run;
+    run++;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
 grt::BaseListRef MySQLParserServicesImpl::getSqlStatementRanges(const std::string &sql) {
   grt::BaseListRef list(true);
   std::vector<std::pair<size_t, size_t> > ranges;
@@ -4205,8 +4424,7 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
           tail += 2;
           bool is_hidden_command = (*tail == '!');
           while (true) {
-            while (tail < end && *tail != '*')
-              tail++;
+            tail = find_either(tail, end, '*', '*');
             if (tail == end) // Unfinished comment.
               break;
             else {
@@ -4229,9 +4447,7 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
         const unsigned char *end_char = tail + 2;
         if (*(tail + 1) == '-' && (*end_char == ' ' || *end_char == '\t' || is_line_break(end_char, new_line))) {
           // Skip everything until the end of the line.
-          tail += 2;
-          while (tail < end && !is_line_break(tail, new_line))
-            tail++;
+          tail = find_line_break(tail + 2, end, new_line);
           if (!have_content)
             head = tail;
         } else
@@ -4241,8 +4457,7 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
       }
 
       case '#': // MySQL single line comment.
-        while (tail < end && !is_line_break(tail, new_line))
-          tail++;
+        tail = find_line_break(tail, end, new_line);
         if (!have_content)
           head = tail;
         break;
@@ -4253,11 +4468,11 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
       {
         have_content = true;
         char quote = *tail++;
-        while (tail < end && *tail != quote) {
-          // Skip any escaped character too.
-          if (*tail == '\\')
-            tail++;
-          tail++;
+        while (true) {
+          tail = find_either(tail, end, quote, '\\');
+          if (tail >= end || *tail == quote)
+            break;
+          tail += 2; // Skip any escaped character too.
         }
         if (*tail == quote)
           tail++; // Skip trailing quote char to if one was there.
@@ -4305,7 +4520,7 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
       default:
         if (*tail > ' ')
           have_content = true;
-        tail++;
+        tail = skip_plain_text(tail + 1, end, *delimiter_head, have_content);
         break;
     }
 
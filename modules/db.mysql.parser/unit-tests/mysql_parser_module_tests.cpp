@@ -45,10 +45,124 @@ TEST_DATA_CONSTRUCTOR(mysql_parser_module_tests) {
   _context = MySQLParserServices::createParserContext(_tester->get_rdbms()->characterSets(), version, true);
 }
 
+// Splits the given script and returns the text of each statement found.
+std::vector<std::string> split(const std::string &sql) {
+  std::vector<std::pair<size_t, size_t> > ranges;
+  _services->determineStatementRanges(sql.c_str(), sql.size(), ";", ranges, "\n");
+
+  std::vector<std::string> result;
+  for (std::vector<std::pair<size_t, size_t> >::const_iterator iterator = ranges.begin(); iterator != ranges.end();
+       ++iterator)
+    result.push_back(sql.substr(iterator->first, iterator->second));
+  return result;
+}
+
 END_TEST_DATA_CLASS
 
 TEST_MODULE(mysql_parser_module_tests, "parser module tests");
 
+// Tests for determineStatementRanges.
+
+// Plain statements and empty input.
+TEST_FUNCTION(1) {
+  std::vector<std::pair<size_t, size_t> > ranges;
+  _services->determineStatementRanges("select 1; select 2;", 19, ";", ranges, "\n");
+  ensure_equals("1.1", ranges.size(), 2UL);
+  ensure_equals("1.2", ranges[0].first, 0UL);
+  ensure_equals("1.3", ranges[0].second, 8UL);
+  ensure_equals("1.4", ranges[1].first, 10UL);
+  ensure_equals("1.5", ranges[1].second, 8UL);
+
+  ranges.clear();
+  _services->determineStatementRanges("", 0, ";", ranges, "\n");
+  ensure("1.6", ranges.empty());
+
+  std::vector<std::string> statements = split("  \n\t ");
+  ensure("1.7", statements.empty());
+
+  // The last statement doesn't need a delimiter.
+  statements = split("select 1;\nselect 2");
+  ensure_equals("1.8", statements.size(), 2UL);
+  ensure_equals("1.9", statements[0], "select 1");
+  ensure_equals("1.10", statements[1], "select 2");
+}
+
+// Comments.
+TEST_FUNCTION(2) {
+  std::vector<std::string> statements =
+    split("-- comment; here\nselect 1;\n# another; one\nselect 2; /* block; comment */ select 3;");
+  ensure_equals("2.1", statements.size(), 3UL);
+  ensure_equals("2.2", statements[0], "select 1");
+  ensure_equals("2.3", statements[1], "select 2");
+  ensure_equals("2.4", statements[2], "select 3");
+
+  // Comments inside a statement are kept, hidden commands are statements of their own.
+  statements = split("select /* inline; */ 1; /*!50003 select 2 */;");
+  ensure_equals("2.5", statements.size(), 2UL);
+  ensure_equals("2.6", statements[0], "select /* inline; */ 1");
+  ensure_equals("2.7", statements[1], "/*!50003 select 2 */");
+
+  // A double dash not followed by white space doesn't start a comment.
+  statements = split("select 1--2; select 3;");
+  ensure_equals("2.8", statements.size(), 2UL);
+  ensure_equals("2.9", statements[0], "select 1--2");
+
+  // An unterminated comment swallows the rest of the text.
+  statements = split("select 1; /* unterminated comment; select 2;");
+  ensure_equals("2.10", statements.size(), 1UL);
+  ensure_equals("2.11", statements[0], "select 1");
+}
+
+// Strings and quoted identifiers with embedded delimiters.
+TEST_FUNCTION(3) {
+  std::vector<std::string> statements = split("select 'a;b'; select \"c;d\"; select `e;f`");
+  ensure_equals("3.1", statements.size(), 3UL);
+  ensure_equals("3.2", statements[0], "select 'a;b'");
+  ensure_equals("3.3", statements[1], "select \"c;d\"");
+  ensure_equals("3.4", statements[2], "select `e;f`");
+
+  statements = split("select 'it\\'s;' ; select 2");
+  ensure_equals("3.5", statements.size(), 2UL);
+  ensure_equals("3.6", statements[0], "select 'it\\'s;' ");
+  ensure_equals("3.7", statements[1], "select 2");
+
+  statements = split("select '-- no comment;', '/* nor this;', \"# nor that;\";");
+  ensure_equals("3.8", statements.size(), 1UL);
+  ensure_equals("3.9", statements[0], "select '-- no comment;', '/* nor this;', \"# nor that;\"");
+
+  // An unterminated string makes the rest of the text the last statement.
+  statements = split("select 1; select 'unterminated; string");
+  ensure_equals("3.10", statements.size(), 2UL);
+  ensure_equals("3.11", statements[1], "select 'unterminated; string");
+}
+
+// DELIMITER changes.
+TEST_FUNCTION(4) {
+  std::vector<std::string> statements =
+    split("delimiter $$\ncreate procedure p() begin select 1; select 2; end$$\ndelimiter ;\nselect 3;");
+  ensure_equals("4.1", statements.size(), 2UL);
+  ensure_equals("4.2", statements[0], "create procedure p() begin select 1; select 2; end");
+  ensure_equals("4.3", statements[1], "select 3");
+
+  statements = split("DELIMITER //\nselect 1//select 2//\nDELIMITER ;\nselect 3;");
+  ensure_equals("4.4", statements.size(), 3UL);
+  ensure_equals("4.5", statements[0], "select 1");
+  ensure_equals("4.6", statements[1], "select 2");
+  ensure_equals("4.7", statements[2], "select 3");
+
+  // Only a delimiter keyword at the start of a word changes the delimiter.
+  statements = split("select 1 into @delimiter; select 2;");
+  ensure_equals("4.8", statements.size(), 2UL);
+  ensure_equals("4.9", statements[0], "select 1 into @delimiter");
+  ensure_equals("4.10", statements[1], "select 2");
+
+  // An unterminated last statement after a delimiter change.
+  statements = split("delimiter $$\nselect 1$$\nselect 2; select 3");
+  ensure_equals("4.11", statements.size(), 2UL);
+  ensure_equals("4.12", statements[0], "select 1");
+  ensure_equals("4.13", statements[1], "select 2; select 3");
+}
+
 // Tests for parseStatement.
 // Each test function tests a group of statements from the grammar, as listed in the top rule.
 // Not all query types are implemented in parseStatement. So most of the functions are empty atm.
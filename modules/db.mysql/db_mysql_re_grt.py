@@ -27,6 +27,10 @@ ModuleInfo = DefineModule(name= "DbMySQLRE", author= "Oracle Corp.", version="1.
 
 ######################### Non exposed functions and variables #################
 
+# Number of tables whose definitions are parsed in one call during reverse engineering. Large enough for the
+# parser to use worker threads, small enough for a steady progress.
+TABLE_PARSE_BATCH_SIZE = 256
+
 def check_interruption():
     if grt.query_status():
         raise grt.UserInterrupt()
@@ -298,23 +302,41 @@ def reverseEngineer(connection, catalog_name, schemata_list, context):
 
         if get_tables or get_views:
             grt.send_info("Reverse engineering tables from %s" % schema_name)
+            tables = []
             for table_name in table_names_per_schema[schema_name]:
                 check_interruption()
                 grt.send_progress(0.1 + 0.9 * (i / total), "Retrieving table %s.%s..." % (schema_name, table_name))
                 result = execute_query(connection, "SHOW CREATE TABLE `%s`.`%s`" % (escape_sql_identifier(schema_name), escape_sql_identifier(table_name)))
                 i += 0.5
-                grt.send_progress(0.1 + 0.9 * (i / total), "Reverse engineering %s.%s..." % (schema_name, table_name))
                 if result and result.nextRow():
-                    sql = result.stringByIndex(2)
-                    grt.push_message_handler(filter_warnings)
-                    grt.begin_progress_step(0.1 + 0.9 * (i / total), 0.1 + 0.9 * ((i+0.5) / total))
-                    grt.modules.MySQLParserServices.parseSQLIntoCatalogSql(context, catalog, wrap_sql(sql, schema_name), options)
-                    grt.end_progress_step()
-                    grt.pop_message_handler()
-                    i += 0.5
+                    tables.append((table_name, result.stringByIndex(2)))
                 else:
                     raise Exception("Could not fetch table information for %s.%s" % (schema_name, table_name))
 
+            # tables are parsed in batches, so the parser can spread the work over several threads
+            for start in range(0, len(tables), TABLE_PARSE_BATCH_SIZE):
+                check_interruption()
+                batch = tables[start:start + TABLE_PARSE_BATCH_SIZE]
+                if len(batch) == 1:
+                    grt.send_progress(0.1 + 0.9 * (i / total), "Reverse engineering %s.%s..." % (schema_name, batch[0][0]))
+                else:
+                    grt.send_progress(0.1 + 0.9 * (i / total), "Reverse engineering %s.%s to %s.%s..." % (schema_name, batch[0][0], schema_name, batch[-1][0]))
+                grt.push_message_handler(filter_warnings)
+                grt.begin_progress_step(0.1 + 0.9 * (i / total), 0.1 + 0.9 * ((i + 0.5 * len(batch)) / total))
+                try:
+                    error_count = grt.modules.MySQLParserServices.parseSQLIntoCatalogSql(context, catalog, wrap_sql(";\n".join(sql for name, sql in batch), schema_name), options)
+                finally:
+                    grt.end_progress_step()
+                    grt.pop_message_handler()
+                i += 0.5 * len(batch)
+
+                # statements with errors are skipped by the parser, so the tables that are missing are the failed ones
+                if error_count:
+                    parsed_names = set(obj.name for obj in list(schema.tables) + list(schema.views))
+                    for table_name, sql in batch:
+                        if table_name not in parsed_names:
+                            grt.send_warning("Could not parse the definition of %s.%s, it was not reverse engineered" % (schema_name, table_name), sql)
+
         if get_triggers:
             grt.send_info("Reverse engineering triggers from %s" % schema_name)
             for trigger_name in trigger_names_per_schema[schema_name]:
@@ -25,16 +25,12 @@
 #include "base/string_utilities.h"
 #include "base/wb_iterators.h"
 #include "base/file_utilities.h"
+#include "base/threading.h"
+#include "base/scope_exit_trigger.h"
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-#ifndef M_PI_2
-#define M_PI_2 1.57079632679489661923
-#endif
-
-#define PI_38 M_PI * 0.375
-#define PI_58 M_PI * 0.625
+#include <float.h>
+#include <random>
+#include <unordered_map>
 
 using namespace grt;
 using namespace std; // In VS min/max are not in the std namespace, so we have to split that.
@@ -265,12 +261,63 @@ int WbModelImpl::autolayout(model_DiagramRef view) {
   return result;
 }
 
+static bool calculate_view_size(const app_PageSettingsRef &page, double &width, double &height) {
+  if (page->paperType().is_valid()) {
+    width = page->paperType()->width();
+    height = page->paperType()->height();
+
+    width -= page->marginLeft() + page->marginRight();
+    height -= page->marginTop() + page->marginBottom();
+
+    width *= page->scale();
+    height *= page->scale();
+
+    if (page->orientation() == "landscape")
+      std::swap(width, height);
+
+    return true;
+  } else {
+    width = 1000;
+    height = 1000;
+    return false;
+  }
+}
+
 //==============================================================================
-//
+// Force directed layout of the table and view figures of a layer. Figures push each other away and
+// connected figures pull each other closer. Pushing is approximated with a quadtree (Barnes-Hut), where
+// groups of figures far enough away act as one, so an iteration takes O(n log n). Overlaps left over at the
+// end are removed in a separate pass. The result only depends on the figures, their connections and the seed.
 //==============================================================================
+
+// Number of iterations of the force directed layout.
+#define AUTOLAYOUT_ITERATIONS 200
+
+// Seed for the initial jitter of the figures, so that the same model is always laid out the same way.
+#define AUTOLAYOUT_SEED 4711
+
+// Pull of all figures towards the center, which keeps unconnected figures together.
+#define AUTOLAYOUT_GRAVITY 0.1
+
+// Quadtree cells smaller than this fraction of their distance to a figure act as a single figure.
+#define AUTOLAYOUT_THETA 0.8
+
+// Figures in the same place are kept in one quadtree cell from this depth on.
+#define AUTOLAYOUT_MAX_TREE_DEPTH 40
+
+// Max. number of passes to push overlapping figures apart.
+#define AUTOLAYOUT_OVERLAP_PASSES 500
+
+// Forces are calculated in worker threads for layouts with at least this many figures.
+#define PARALLEL_AUTOLAYOUT_MIN_COUNT 256
+#define MAX_AUTOLAYOUT_THREAD_COUNT 8
+
+// Space between the laid out figures and the left and top edges of the layer.
+#define AUTOLAYOUT_MARGIN 20
+
 class Layouter {
 public:
-  Layouter(const model_LayerRef &layer);
+  Layouter(const model_LayerRef &layer, unsigned int seed = AUTOLAYOUT_SEED);
 
   void add_figure_to_layout(const model_FigureRef &figure);
   void connect(const model_FigureRef &f1, const model_FigureRef &f2);
@@ -278,392 +325,566 @@ public:
   int do_layout();
 
 private:
-  struct Node;
+  struct Node {
+    Node(const model_FigureRef &figure);
 
-  static bool compare_node_links(const Node &n1, const Node &n2);
+    double w;
+    double h;
+    double x; // Center of the figure.
+    double y;
+    double dx; // Displacement calculated for the current iteration.
+    double dy;
+    model_FigureRef fig;
+    std::vector<size_t> linked;
+  };
 
-  bool shuffle();
-  double calc_energy();
-  double calc_node_energy(const std::size_t i, const Node &n);
-  long distance_to_node(const std::size_t n1, const std::size_t n2, bool *is_horiz = NULL);
-  double calc_node_pair(const std::size_t i1, const std::size_t i2);
-  void prepare_layout_stages();
+  struct QuadCell {
+    double x; // Center of the square.
+    double y;
+    double half_size;
+    double mass; // Number of figures in the cell.
+    double mass_x; // Center of mass.
+    double mass_y;
+    int children[4];
+    int figure; // The figure in a cell with only one.
+  };
 
-  const double _w;
-  const double _h;
+  // A range of figures whose forces are calculated by one thread. Ranges without a thread (the first one
+  // or when the thread could not be created) are calculated by the thread running the layout.
+  struct ForceWorker {
+    Layouter *layouter;
+    size_t begin;
+    size_t end;
+    GThread *thread;
 
-  struct Node {
-    Node(const model_FigureRef &figure);
-    void move_by(const long dx, const long dy);
-    void move(const long x, const long y);
-    bool is_linked_to(const ssize_t node) const;
-
-    long w;
-    long h;
-    long x1;
-    long y1;
-    long x2;
-    long y2;
-    model_FigureRef fig;
-    std::vector<ssize_t> linked;
+    static gpointer run(gpointer data);
   };
-  typedef std::vector<Node> NodesList;
-  NodesList _all_figures;
-  NodesList _figures;
-  long _min_dist; // desired dist between nodes
-  double _min_energy;
-  int _cell_w;
-  int _cell_h;
+
+  static int64_t cell_key(int x, int y) {
+    return ((int64_t)x << 32) | (uint32_t)y;
+  }
+
+  void place_initially();
+  void build_tree();
+  int tree_child(int cell, double x, double y);
+  void add_repulsion(int cell, size_t i, double &fx, double &fy) const;
+  void build_grid(double cell_size);
+  void calculate_forces(size_t begin, size_t end);
+  void start_workers();
+  void calculate_all_forces();
+  void stop_workers();
+  void remove_overlaps();
+  void fit_into_layer();
+
   model_LayerRef _layer;
+
+  std::set<std::string> _layer_figures;
+  std::map<std::string, size_t> _figure_index; // Figure id -> index in _figures.
+  std::vector<Node> _figures;
+  std::vector<QuadCell> _tree;
+  std::unordered_map<int64_t, std::vector<size_t> > _grid;
+  double _cell_size;
+  double _ideal_dist; // Desired distance between the centers of connected figures.
+  double _min_dist;   // Desired space between figures.
+  unsigned int _seed;
+
+  std::vector<ForceWorker> _workers;
+  base::Mutex _work_mutex;
+  base::Cond _work_cond; // Signals the workers a new iteration or the end of the layout.
+  base::Cond _done_cond; // Signals the end of the last running worker.
+  int _iteration;        // Incremented for every iteration the workers have to calculate.
+  size_t _running_workers;
+  bool _stop_workers;
 };
 
 //------------------------------------------------------------------------------
 Layouter::Node::Node(const model_FigureRef &figure)
-  : w((long)figure->width()),
-    h((long)figure->height()),
-    x1((long)figure->left()),
-    y1((long)figure->top()),
-    x2(x1 + w),
-    y2(y1 + h),
+  : w(figure->width()),
+    h(figure->height()),
+    x(figure->left() + w / 2),
+    y(figure->top() + h / 2),
+    dx(0),
+    dy(0),
     fig(figure) {
 }
 
 //------------------------------------------------------------------------------
-void Layouter::Node::move(const long x, const long y) {
-  x1 = x;
-  y1 = y;
-  x2 = x1 + w;
-  y2 = y1 + h;
-}
+Layouter::Layouter(const model_LayerRef &layer, unsigned int seed)
+  : _layer(layer),
+    _cell_size(1),
+    _ideal_dist(1),
+    _min_dist(40),
+    _seed(seed),
+    _iteration(0),
+    _running_workers(0),
+    _stop_workers(false) {
+  const ListRef<model_Figure> figures = layer->figures();
 
-//------------------------------------------------------------------------------
-void Layouter::Node::move_by(const long dx, const long dy) {
-  x1 += dx;
-  y1 += dy;
-  x2 += dx;
-  y2 += dy;
+  for (std::size_t i = 0; i < figures->count(); ++i)
+    _layer_figures.insert(figures[i]->id());
 }
 
 //------------------------------------------------------------------------------
-bool Layouter::Node::is_linked_to(const ssize_t node) const {
-  bool found = false;
-
-  for (ssize_t i = linked.size() - 1; i >= 0; --i) {
-    if (linked[i] == node) {
-      found = true;
-      break;
-    }
+void Layouter::add_figure_to_layout(const model_FigureRef &figure) {
+  if (_layer_figures.find(figure->id()) != _layer_figures.end() &&
+      _figure_index.find(figure->id()) == _figure_index.end()) {
+    _figure_index[figure->id()] = _figures.size();
+    _figures.push_back(figure);
   }
-
-  return found;
 }
 
 //------------------------------------------------------------------------------
-Layouter::Layouter(const model_LayerRef &layer)
-  : _w(layer->width()), _h(layer->height()), _min_dist(80), _min_energy(0), _cell_w(0), _cell_h(0), _layer(layer) {
-  const ListRef<model_Figure> figures = layer->figures();
+void Layouter::connect(const model_FigureRef &f1, const model_FigureRef &f2) {
+  if (!f1.is_valid() || !f2.is_valid())
+    return;
 
-  for (std::size_t i = 0; i < figures->count(); ++i)
-    _all_figures.push_back(figures[i]);
-}
+  std::map<std::string, size_t>::const_iterator n1 = _figure_index.find(f1->id());
+  std::map<std::string, size_t>::const_iterator n2 = _figure_index.find(f2->id());
 
-//------------------------------------------------------------------------------
-void Layouter::add_figure_to_layout(const model_FigureRef &figure) {
-  for (std::size_t i = 0; i < _all_figures.size(); ++i) {
-    if (_all_figures[i].fig == figure) {
-      _figures.push_back(figure);
+  if (n1 != _figure_index.end() && n2 != _figure_index.end() && n1->second != n2->second) {
+    std::vector<size_t> &linked = _figures[n1->second].linked;
+    if (std::find(linked.begin(), linked.end(), n2->second) == linked.end()) {
+      linked.push_back(n2->second);
+      _figures[n2->second].linked.push_back(n1->second);
     }
   }
 }
 
 //------------------------------------------------------------------------------
-void Layouter::connect(const model_FigureRef &f1, const model_FigureRef &f2) {
-  ssize_t n1 = -1;
-  ssize_t n2 = -1;
+/**
+ * Places the figures on a square grid, in breadth first order over their connections (starting with the
+ * most connected figures), so that connected figures start out close to each other.
+ */
+void Layouter::place_initially() {
+  std::vector<size_t> order;
+  std::vector<size_t> by_links;
+  std::vector<bool> placed(_figures.size(), false);
+  double total_size = 0;
 
-  for (std::size_t i = 0; i < _figures.size(); ++i) {
-    Node &n = _figures[i];
-    if (n1 == -1 && n.fig == f1)
-      n1 = i;
-    if (n2 == -1 && n.fig == f2)
-      n2 = i;
-    if (n1 >= 0 && n2 >= 0)
-      break;
+  for (size_t i = 0; i < _figures.size(); ++i) {
+    by_links.push_back(i);
+    total_size += std::max(_figures[i].w, _figures[i].h);
   }
+  std::stable_sort(by_links.begin(), by_links.end(), [this](size_t a, size_t b) {
+    return _figures[a].linked.size() > _figures[b].linked.size();
+  });
 
-  if (n1 >= 0 && n2 >= 0) {
-    Node &node1 = _figures[n1];
-    Node &node2 = _figures[n2];
-    node1.linked.push_back(n2);
-    node2.linked.push_back(n1);
-  }
-}
+  for (size_t n = 0; n < by_links.size(); ++n) {
+    if (placed[by_links[n]])
+      continue;
 
-//------------------------------------------------------------------------------
-long Layouter::distance_to_node(const std::size_t i1, const std::size_t i2, bool *is_horiz) {
-  const Node &n1 = _figures[i1];
-  const Node &n2 = _figures[i2];
-  const long x11 = n1.x1;
-  const long y11 = n1.y1;
-  const long x12 = n1.x2;
-  const long y12 = n1.y2;
-
-  const long x21 = n2.x1;
-  const long y21 = n2.y1;
-  const long x22 = n2.x2;
-  const long y22 = n2.y2;
-
-  const long cx1 = x11 + (x12 - x11) / 2;
-  const long cy1 = y11 + (y12 - y11) / 2;
-  const long cx2 = x21 + (x22 - x21) / 2;
-  const long cy2 = y21 + (y22 - y21) / 2;
-  const long dcx = cx2 - cx1;
-  const double qr = atan2((double)dcx, (double)(cy2 - cy1));
-
-  double dx = 0;
-  double dy = 0;
-  double l1 = 0;
-  double l2 = 0;
-  if (qr > M_PI_2) {
-    dy = y11 - y22;
-    dx = x21 - x12;
-    l1 = dy ? ::fabs(dy / cos(qr)) : ::fabs(dx);
-    l2 = dx ? ::fabs(dx / sin(qr)) : ::fabs(dy);
-  } else if (0.0 < qr && qr <= M_PI_2) {
-    dy = y21 - y12;
-    dx = x21 - x12;
-    if (dy > dx)
-      l1 = l2 = dy ? ::fabs(dy / cos(qr)) : ::fabs(dx);
-    else
-      l1 = l2 = dx ? ::fabs(dx / sin(qr)) : ::fabs(dy);
-  } else if (qr < -M_PI_2) {
-    dy = y11 - y22;
-    dx = -(x22 - x11);
-    if (dy > dx)
-      l1 = l2 = dy ? ::fabs(dy / cos(qr)) : ::fabs(dx);
-    else
-      l1 = l2 = dx ? ::fabs(dx / sin(qr)) : ::fabs(dy);
-  } else {
-    dy = y21 - y12;
-    if (abs(dcx) > (x12 - x11) / 2)
-      dx = x11 - x22;
-    else
-      dx = dcx;
-    if (dy > dx)
-      l1 = l2 = dy ? ::fabs(dy / cos(qr)) : ::fabs(dx);
-    else
-      l1 = l2 = (dx && qr != 0.0) ? ::fabs(dx / sin(qr)) : ::fabs(dy);
+    size_t first = order.size();
+    order.push_back(by_links[n]);
+    placed[by_links[n]] = true;
+    for (size_t i = first; i < order.size(); ++i) {
+      const std::vector<size_t> &linked = _figures[order[i]].linked;
+      for (size_t j = 0; j < linked.size(); ++j) {
+        if (!placed[linked[j]]) {
+          placed[linked[j]] = true;
+          order.push_back(linked[j]);
+        }
+      }
+    }
   }
 
-  // printf("qr %f (cos(qr) = %f, sin(rq) = %f), l1 %li, l2 %li, dy %li, dx %li\n", qr, cos(qr), sin(qr), l1, l2, dy,
-  // dx);
+  _ideal_dist = total_size / _figures.size() + _min_dist;
 
-  const double aqr = ::fabs(qr);
-  if (is_horiz)
-    *is_horiz = PI_38 < aqr && aqr < PI_58;
-  return l1 < l2 ? (long)l1 : (long)l2;
-}
+  std::mt19937 generator(_seed);
+  size_t columns = (size_t)ceil(sqrt((double)order.size()));
+  for (size_t i = 0; i < order.size(); ++i) {
+    Node &node = _figures[order[i]];
+    double jitter_x = (double)generator() / generator.max() - 0.5;
+    double jitter_y = (double)generator() / generator.max() - 0.5;
 
-//------------------------------------------------------------------------------
-inline double line_len2(long x1, long y1, long x2, long y2) {
-  return sqrt(pow((double)(x2 - x1), 2) + pow((double)(y2 - y1), 2));
+    node.x = ((double)(i % columns) - columns / 2.0 + jitter_x / 2) * _ideal_dist;
+    node.y = ((double)(i / columns) - columns / 2.0 + jitter_y / 2) * _ideal_dist;
+  }
 }
 
 //------------------------------------------------------------------------------
-double Layouter::calc_node_pair(const std::size_t i1, const std::size_t i2) {
-  const Node *n1 = &(_figures[i1]);
-  const Node *n2 = &(_figures[i2]);
-  const bool is_linked = n1->is_linked_to(i2) || n2->is_linked_to(i1);
-
-  long S1 = n1->w * n1->h;
-  long S2 = n2->w * n2->h;
-  if (S1 > S2) {
-    std::swap(n1, n2);
-    std::swap(S1, S2);
+void Layouter::build_tree() {
+  double left = DBL_MAX, top = DBL_MAX, right = -DBL_MAX, bottom = -DBL_MAX;
+  for (size_t i = 0; i < _figures.size(); ++i) {
+    left = std::min(left, _figures[i].x);
+    top = std::min(top, _figures[i].y);
+    right = std::max(right, _figures[i].x);
+    bottom = std::max(bottom, _figures[i].y);
   }
 
-  const long x11 = n1->x1;
-  const long y11 = n1->y1;
-  const long x12 = n1->x2;
-  const long y12 = n1->y2;
+  QuadCell root = {(left + right) / 2, (top + bottom) / 2, std::max(right - left, bottom - top) / 2 + 1, 0, 0, 0,
+                   {-1, -1, -1, -1}, -1};
+  _tree.clear();
+  _tree.push_back(root);
 
-  const long x21 = n2->x1;
-  const long y21 = n2->y1;
-  const long x22 = n2->x2;
-  const long y22 = n2->y2;
+  for (size_t i = 0; i < _figures.size(); ++i) {
+    const Node &node = _figures[i];
+    int cell = 0;
 
-  const long cx1 = x11 + (x12 - x11) / 2;
-  const long cy1 = y11 + (y12 - y11) / 2;
-  const long cx2 = x21 + (x22 - x21) / 2;
-  const long cy2 = y21 + (y22 - y21) / 2;
+    for (int depth = 0;; ++depth) {
+      _tree[cell].mass += 1;
+      _tree[cell].mass_x += node.x;
+      _tree[cell].mass_y += node.y;
 
-  // Detect if nodes overlap
-  const bool is_overlap = ((x12 >= x21) && (x22 >= x11) && (y12 >= y21) && (y22 >= y11));
+      bool is_leaf = _tree[cell].children[0] < 0 && _tree[cell].children[1] < 0 && _tree[cell].children[2] < 0 &&
+                     _tree[cell].children[3] < 0;
+      if (is_leaf && _tree[cell].mass == 1) {
+        _tree[cell].figure = (int)i;
+        break;
+      }
+      if (depth >= AUTOLAYOUT_MAX_TREE_DEPTH)
+        break;
 
-  static const double overlap_quot = 1000.0;
+      if (_tree[cell].figure >= 0) {
+        // Move the figure that was alone in this cell one level down.
+        const Node &other = _figures[_tree[cell].figure];
+        int child = tree_child(cell, other.x, other.y);
 
-  double e = 0.0;
-  double distance = 0;
-  if (is_overlap) {
-    distance = line_len2(cx1, cy1, cx2, cy2);
+        _tree[child].mass = 1;
+        _tree[child].mass_x = other.x;
+        _tree[child].mass_y = other.y;
+        _tree[child].figure = _tree[cell].figure;
+        _tree[cell].figure = -1;
+      }
+      cell = tree_child(cell, node.x, node.y);
+    }
+  }
 
-    // calc area of overlap
-    const long sx1 = x11 > x21 ? x11 : x21;
-    const long sy1 = y11 > y21 ? y11 : y21;
-    const long sx2 = x12 < x22 ? x12 : x22;
-    const long sy2 = y12 < y22 ? y12 : y22;
-    const long dsx = sx2 - sx1;
-    const long dsy = sy2 - sy1;
+  for (std::vector<QuadCell>::iterator cell = _tree.begin(); cell != _tree.end(); ++cell) {
+    cell->mass_x /= cell->mass;
+    cell->mass_y /= cell->mass;
+  }
+}
 
-    const long Sov = dsx * dsy;
+//------------------------------------------------------------------------------
+/**
+ * Returns the child of the given quadtree cell containing the given point, creating it if needed.
+ */
+int Layouter::tree_child(int cell, double x, double y) {
+  int quadrant = (x >= _tree[cell].x ? 1 : 0) + (y >= _tree[cell].y ? 2 : 0);
+
+  if (_tree[cell].children[quadrant] < 0) {
+    double half_size = _tree[cell].half_size / 2;
+    QuadCell child = {_tree[cell].x + (quadrant & 1 ? half_size : -half_size),
+                      _tree[cell].y + (quadrant & 2 ? half_size : -half_size),
+                      half_size,
+                      0,
+                      0,
+                      0,
+                      {-1, -1, -1, -1},
+                      -1};
+    _tree[cell].children[quadrant] = (int)_tree.size();
+    _tree.push_back(child);
+  }
+  return _tree[cell].children[quadrant];
+}
 
-    if (distance == 0.0)
-      distance = 0.0000001;
+//------------------------------------------------------------------------------
+void Layouter::add_repulsion(int cell_index, size_t i, double &fx, double &fy) const {
+  const QuadCell &cell = _tree[cell_index];
+  const Node &node = _figures[i];
 
-    e = _min_dist * 1 / distance * 100 + Sov;
-    e *= overlap_quot;
-  } else {
-    bool is_horiz = false;
-    distance = distance_to_node(i1, i2, &is_horiz);
-
-    if (distance <= _min_dist) {
-      if (distance != 0) {
-        if (is_linked)
-          e += _min_dist + overlap_quot * 1 / distance;
-        else
-          e += _min_dist + overlap_quot * _min_dist / distance;
-      } else {
-        e += overlap_quot;
-      }
-    } else {
-      e += distance;
-      if (is_linked)
-        e += distance * distance;
+  if (cell.figure == (int)i)
+    return;
+
+  bool is_leaf = cell.children[0] < 0 && cell.children[1] < 0 && cell.children[2] < 0 && cell.children[3] < 0;
+  double ddx = node.x - cell.mass_x;
+  double ddy = node.y - cell.mass_y;
+  double dist = sqrt(ddx * ddx + ddy * ddy);
+
+  if (is_leaf || 2 * cell.half_size < AUTOLAYOUT_THETA * dist) {
+    if (dist < 0.01) {
+      // Figures on top of each other, move each in its own direction.
+      ddx = cos((double)i) * 0.01;
+      ddy = sin((double)i) * 0.01;
+      dist = 0.01;
     }
+    double force = cell.mass * _ideal_dist * _ideal_dist / dist;
+    fx += ddx / dist * force;
+    fy += ddy / dist * force;
+  } else {
+    for (int n = 0; n < 4; ++n)
+      if (cell.children[n] >= 0)
+        add_repulsion(cell.children[n], i, fx, fy);
   }
+}
 
-  return e;
+//------------------------------------------------------------------------------
+void Layouter::build_grid(double cell_size) {
+  _cell_size = cell_size;
+  _grid.clear();
+  for (size_t i = 0; i < _figures.size(); ++i)
+    _grid[cell_key((int)floor(_figures[i].x / _cell_size), (int)floor(_figures[i].y / _cell_size))].push_back(i);
 }
 
 //------------------------------------------------------------------------------
-double Layouter::calc_energy() {
-  double e = 0.0;
+/**
+ * Calculates the displacement of the given range of figures. Only the displacement of these figures is
+ * written, so ranges can be calculated in parallel.
+ */
+void Layouter::calculate_forces(size_t begin, size_t end) {
+  for (size_t i = begin; i < end; ++i) {
+    Node &node = _figures[i];
+    double fx = 0, fy = 0;
 
-  std::size_t size = _figures.size();
-  for (std::size_t i = 0; i < size; ++i) {
-    const Node &node = _figures[i];
-    if ((node.x1 < 0) || (node.y1 < 0) || (node.x2 + 20 > _w) || (node.y2 + 20 > _h))
-      e += 1000000000000.0;
+    add_repulsion(0, i, fx, fy);
 
-    for (std::size_t j = i + 1; j < size; ++j) {
-      if (j >= size)
-        break;
-      e += calc_node_pair(i, j);
+    // Attraction to the connected figures.
+    for (std::vector<size_t>::const_iterator j = node.linked.begin(); j != node.linked.end(); ++j) {
+      double ddx = _figures[*j].x - node.x;
+      double ddy = _figures[*j].y - node.y;
+      double dist = sqrt(ddx * ddx + ddy * ddy);
+
+      fx += ddx * dist / _ideal_dist;
+      fy += ddy * dist / _ideal_dist;
     }
-  }
 
-  return e;
+    node.dx = fx - AUTOLAYOUT_GRAVITY * node.x;
+    node.dy = fy - AUTOLAYOUT_GRAVITY * node.y;
+  }
 }
 
 //------------------------------------------------------------------------------
-double Layouter::calc_node_energy(const std::size_t node_i, const Node &node) {
-  double e = 0.0;
+gpointer Layouter::ForceWorker::run(gpointer data) {
+  ForceWorker *worker = static_cast<ForceWorker *>(data);
+  Layouter *layouter = worker->layouter;
+  int iteration = 0;
+
+  base::MutexLock lock(layouter->_work_mutex);
+  for (;;) {
+    while (layouter->_iteration == iteration && !layouter->_stop_workers)
+      layouter->_work_cond.wait(layouter->_work_mutex);
+    if (layouter->_stop_workers)
+      break;
+    iteration = layouter->_iteration;
 
-  if ((node.x1 < 0) || (node.y1 < 0) || (node.x2 + 20 > _w) || (node.y2 + 20 > _h))
-    e += 1000000000000.0;
+    layouter->_work_mutex.unlock();
+    layouter->calculate_forces(worker->begin, worker->end);
+    layouter->_work_mutex.lock();
 
-  for (std::size_t i = 0; i < _figures.size(); ++i) {
-    if (node_i != i)
-      e += calc_node_pair(node_i, i);
+    if (--layouter->_running_workers == 0)
+      layouter->_done_cond.signal();
   }
-
-  return e;
+  return NULL;
 }
 
 //------------------------------------------------------------------------------
-bool Layouter::shuffle() {
-  bool found_smaller_energy = false;
-  const int step = (rand() % 5) + 1;
+/**
+ * Splits the figures into ranges for the force calculation and starts one thread per range (except the
+ * first). The threads are kept for all iterations of the layout and ended by stop_workers().
+ */
+void Layouter::start_workers() {
+  size_t count = _figures.size();
+  size_t thread_count = std::min<size_t>(MAX_AUTOLAYOUT_THREAD_COUNT, g_get_num_processors());
+  if (count < PARALLEL_AUTOLAYOUT_MIN_COUNT)
+    thread_count = 1;
+
+  size_t chunk_size = (count + thread_count - 1) / thread_count;
+  _workers.clear();
+  for (size_t n = 0; n < thread_count; ++n) {
+    ForceWorker worker = {this, std::min(n * chunk_size, count), std::min((n + 1) * chunk_size, count), NULL};
+    _workers.push_back(worker);
+  }
 
-  for (std::size_t i = 0; i < _figures.size(); ++i) {
-    Node &n = _figures[i];
-    const int wstep = _cell_w * step;
-    const int hstep = _cell_w * step;
-    double node_energy = calc_node_energy(i, n);
-
-    const int wsteps[] = {wstep, -wstep, 0, 0};
-    const int hsteps[] = {0, 0, hstep, -hstep};
-    for (int ns = sizeof(wsteps) / sizeof(int) - 1; ns >= 0; --ns) {
-      n.move_by(wsteps[ns], hsteps[ns]);
-      const double energy = calc_node_energy(i, n);
-      if (energy < node_energy) {
-        node_energy = energy;
-        found_smaller_energy = true;
-      } else
-        n.move_by(-wsteps[ns], -hsteps[ns]);
-    }
+  _iteration = 0;
+  _running_workers = 0;
+  _stop_workers = false;
+  for (size_t n = 1; n < _workers.size(); ++n)
+    _workers[n].thread = base::create_thread(&ForceWorker::run, &_workers[n]);
+}
+
+//------------------------------------------------------------------------------
+void Layouter::calculate_all_forces() {
+  size_t thread_count = 0;
+  for (size_t n = 0; n < _workers.size(); ++n)
+    if (_workers[n].thread != NULL)
+      ++thread_count;
+
+  if (thread_count > 0) {
+    base::MutexLock lock(_work_mutex);
+    _running_workers = thread_count;
+    ++_iteration;
+    _work_cond.broadcast();
   }
 
-  if (found_smaller_energy)
-    _min_energy = calc_energy();
+  for (size_t n = 0; n < _workers.size(); ++n)
+    if (_workers[n].thread == NULL)
+      calculate_forces(_workers[n].begin, _workers[n].end);
 
-  return found_smaller_energy;
+  if (thread_count > 0) {
+    base::MutexLock lock(_work_mutex);
+    while (_running_workers > 0)
+      _done_cond.wait(_work_mutex);
+  }
 }
 
 //------------------------------------------------------------------------------
-bool Layouter::compare_node_links(const Node &n1, const Node &n2) {
-  return n1.linked.size() > n2.linked.size();
+void Layouter::stop_workers() {
+  {
+    base::MutexLock lock(_work_mutex);
+    _stop_workers = true;
+    _work_cond.broadcast();
+  }
+
+  for (size_t n = 0; n < _workers.size(); ++n)
+    if (_workers[n].thread != NULL)
+      g_thread_join(_workers[n].thread);
+  _workers.clear();
 }
 
 //------------------------------------------------------------------------------
-void Layouter::prepare_layout_stages() {
-  double total_w = 0;
-  double total_h = 0;
-  std::sort(_figures.begin(), _figures.end(), compare_node_links);
-
-  // reset layout
-  for (size_t i = 0; i < _figures.size(); ++i) {
-    Node &n = _figures[i];
-    // place all tables in some initial position
-    n.move((long)_w / 4, (long)_h / 4);
-
-    // Calculate total dimensions and find max cell size.
-    total_w += n.w;
-    total_h += n.h;
-    if (_cell_w < n.w)
-      _cell_w = (int)n.w;
-    if (_cell_h < n.h)
-      _cell_h = (int)n.h;
+/**
+ * Pushes figures that overlap (or are closer than _min_dist) apart, along the axis where that takes
+ * the shorter distance.
+ */
+void Layouter::remove_overlaps() {
+  double max_extent = 0;
+  for (size_t i = 0; i < _figures.size(); ++i)
+    max_extent = std::max(max_extent, std::max(_figures[i].w, _figures[i].h));
+
+  for (int pass = 0; pass < AUTOLAYOUT_OVERLAP_PASSES; ++pass) {
+    bool moved = false;
+
+    // Figures that are too close are always in the same or neighbouring cells.
+    build_grid(max_extent + _min_dist);
+    for (size_t i = 0; i < _figures.size(); ++i) {
+      Node &node = _figures[i];
+      int cx = (int)floor(node.x / _cell_size);
+      int cy = (int)floor(node.y / _cell_size);
+
+      for (int x = cx - 1; x <= cx + 1; ++x) {
+        for (int y = cy - 1; y <= cy + 1; ++y) {
+          std::unordered_map<int64_t, std::vector<size_t> >::const_iterator cell = _grid.find(cell_key(x, y));
+          if (cell == _grid.end())
+            continue;
+
+          for (std::vector<size_t>::const_iterator j = cell->second.begin(); j != cell->second.end(); ++j) {
+            if (*j <= i)
+              continue;
+
+            Node &other = _figures[*j];
+            double overlap_x = (node.w + other.w) / 2 + _min_dist - fabs(node.x - other.x);
+            double overlap_y = (node.h + other.h) / 2 + _min_dist - fabs(node.y - other.y);
+            if (overlap_x <= 0 || overlap_y <= 0)
+              continue;
+
+            if (overlap_x < overlap_y) {
+              double direction = node.x < other.x ? -1 : 1;
+              node.x += direction * overlap_x / 2;
+              other.x -= direction * overlap_x / 2;
+            } else {
+              double direction = node.y < other.y ? -1 : 1;
+              node.y += direction * overlap_y / 2;
+              other.y -= direction * overlap_y / 2;
+            }
+            moved = true;
+          }
+        }
+      }
+    }
+    if (!moved)
+      break;
   }
-  _cell_w = (int)(1.1 * _cell_w);
 }
 
 //------------------------------------------------------------------------------
-int Layouter::do_layout() {
-  prepare_layout_stages();
-
-  _min_energy = calc_energy();
-  int de0_count = 10; // de=0 count
-  double de = 1;      // energy delta
-  double prev_energy = 0;
-  while (de0_count > 0) {
-    shuffle();
-    de = prev_energy - _min_energy;
-    prev_energy = _min_energy;
-    if (de == 0)
-      --de0_count;
-    else
-      de0_count = 10;
+/**
+ * Moves the layout to the top left corner of the layer and updates the figures. The root layer grows with
+ * the diagram if the layout does not fit, other layers keep their size and the layout is squeezed into them.
+ */
+void Layouter::fit_into_layer() {
+  double left = DBL_MAX, top = DBL_MAX, right = -DBL_MAX, bottom = -DBL_MAX;
+  for (size_t i = 0; i < _figures.size(); ++i) {
+    left = std::min(left, _figures[i].x - _figures[i].w / 2);
+    top = std::min(top, _figures[i].y - _figures[i].h / 2);
+    right = std::max(right, _figures[i].x + _figures[i].w / 2);
+    bottom = std::max(bottom, _figures[i].y + _figures[i].h / 2);
   }
 
+  double width = right - left + 2 * AUTOLAYOUT_MARGIN;
+  double height = bottom - top + 2 * AUTOLAYOUT_MARGIN;
+  model_DiagramRef diagram(_layer->owner());
+  if (diagram.is_valid() && diagram->rootLayer() == _layer &&
+      (width > *_layer->width() || height > *_layer->height())) {
+    app_PageSettingsRef page(app_PageSettingsRef::cast_from(grt::GRT::get()->get("/wb/doc/pageSettings")));
+    double page_width, page_height;
+
+    calculate_view_size(page, page_width, page_height);
+    diagram->setPageCounts((ssize_t)ceil(std::max(width, *_layer->width()) / page_width),
+                           (ssize_t)ceil(std::max(height, *_layer->height()) / page_height));
+  }
+
+  // Offsets of the figures from the top left corner are scaled down until the widest and highest figures
+  // still fit, the clamping below keeps everything inside if that is not possible.
+  double scale_x = 1, scale_y = 1;
+  for (size_t i = 0; i < _figures.size(); ++i) {
+    const Node &n = _figures[i];
+    double offset_x = n.x - n.w / 2 - left;
+    double offset_y = n.y - n.h / 2 - top;
+
+    if (offset_x > 0)
+      scale_x = std::min(scale_x, (*_layer->width() - 2 * AUTOLAYOUT_MARGIN - n.w) / offset_x);
+    if (offset_y > 0)
+      scale_y = std::min(scale_y, (*_layer->height() - 2 * AUTOLAYOUT_MARGIN - n.h) / offset_y);
+  }
+  scale_x = std::max(scale_x, 0.0);
+  scale_y = std::max(scale_y, 0.0);
+
   // update actual figures with new coords
   for (std::size_t i = 0; i < _figures.size(); ++i) {
     Node &n = _figures[i];
     model_FigureRef &f = n.fig;
+    double x = AUTOLAYOUT_MARGIN + (n.x - n.w / 2 - left) * scale_x;
+    double y = AUTOLAYOUT_MARGIN + (n.y - n.h / 2 - top) * scale_y;
+
+    f->left(floor(std::max(0.0, std::min(x, *_layer->width() - n.w))));
+    f->top(floor(std::max(0.0, std::min(y, *_layer->height() - n.h))));
+  }
+}
 
-    f->left(n.x1);
-    f->top(n.y1);
+//------------------------------------------------------------------------------
+int Layouter::do_layout() {
+  if (_figures.empty())
+    return 0;
+
+  place_initially();
+
+  // The max. distance a figure can move per iteration goes down linearly.
+  double start_temperature = _ideal_dist * sqrt((double)_figures.size()) / 2;
+  double end_temperature = _ideal_dist / 20;
+
+  {
+    // The workers wait on members of the layouter, so they must be ended however the iterations end.
+    base::ScopeExitTrigger join_workers(std::bind(&Layouter::stop_workers, this));
+    start_workers();
+    for (int iteration = 0; iteration < AUTOLAYOUT_ITERATIONS; ++iteration) {
+      if (iteration % 10 == 0)
+        grt::GRT::get()->send_progress(0.9f * iteration / AUTOLAYOUT_ITERATIONS, _("Laying out figures..."),
+                                       base::strfmt("%i figures", (int)_figures.size()));
+
+      double temperature =
+        start_temperature + (end_temperature - start_temperature) * iteration / (AUTOLAYOUT_ITERATIONS - 1);
+
+      build_tree();
+      calculate_all_forces();
+
+      for (size_t i = 0; i < _figures.size(); ++i) {
+        Node &node = _figures[i];
+        double length = sqrt(node.dx * node.dx + node.dy * node.dy);
+        if (length > 0) {
+          double step = std::min(length, temperature);
+          node.x += node.dx / length * step;
+          node.y += node.dy / length * step;
+        }
+      }
+    }
   }
+
+  grt::GRT::get()->send_progress(0.9f, _("Removing overlaps..."), "");
+  remove_overlaps();
+
+  fit_into_layer();
+  grt::GRT::get()->send_progress(1.0f, _("Autolayout finished"), "");
+
   return 0;
 }
 
@@ -694,28 +915,6 @@ int WbModelImpl::do_autolayout(const model_LayerRef &layer, ListRef<model_Object
   return layout.do_layout();
 }
 
-static bool calculate_view_size(const app_PageSettingsRef &page, double &width, double &height) {
-  if (page->paperType().is_valid()) {
-    width = page->paperType()->width();
-    height = page->paperType()->height();
-
-    width -= page->marginLeft() + page->marginRight();
-    height -= page->marginTop() + page->marginBottom();
-
-    width *= page->scale();
-    height *= page->scale();
-
-    if (page->orientation() == "landscape")
-      std::swap(width, height);
-
-    return true;
-  } else {
-    width = 1000;
-    height = 1000;
-    return false;
-  }
-}
-
 workbench_physical_DiagramRef WbModelImpl::add_model_view(
   const db_CatalogRef &catalog, int xpages,
   int ypages) { // XXX TODO move this to Workbench module so we can reuse the same code as from wb_component
@@ -21,6 +21,7 @@
 #include "grt_test_utility.h"
 #include "grt/grt_manager.h"
 #include "grt.h"
+#include "base/string_utilities.h"
 
 #include "grts/structs.h"
 #include "grts/structs.workbench.h"
@@ -776,6 +777,66 @@ TEST_FUNCTION(65) {
   tester->wb->close_document_finish();
 }
 
+// Scripts with many statements are parsed in worker threads, the catalog must be the same as when the statements
+// are parsed one by one.
+TEST_FUNCTION(70) {
+  std::vector<std::string> statements;
+  statements.push_back("CREATE SCHEMA `parallel_parse`");
+  for (int i = 0; i < 150; ++i) {
+    std::string sql = base::strfmt(
+      "CREATE TABLE `parallel_parse`.`table%i` (\n"
+      "  `id` INT NOT NULL AUTO_INCREMENT,\n"
+      "  `name` VARCHAR(%i) NULL COMMENT 'table %i',\n"
+      "  `parent_id` INT NULL,\n"
+      "  PRIMARY KEY (`id`),\n"
+      "  INDEX `name_idx` (`name`)",
+      i, 10 + i, i);
+    // References to tables created before, which are resolved after all statements were applied.
+    if (i > 0)
+      sql += base::strfmt(",\n  CONSTRAINT `fk_table%i` FOREIGN KEY (`parent_id`)"
+                          " REFERENCES `parallel_parse`.`table%i` (`id`)",
+                          i, i / 2);
+    sql += ") ENGINE = InnoDB";
+    statements.push_back(sql);
+
+    if (i % 10 == 9)
+      statements.push_back(
+        base::strfmt("CREATE VIEW `parallel_parse`.`view%i` AS SELECT * FROM `parallel_parse`.`table%i`", i, i));
+  }
+  // Statements changing tables created before (which are not referenced, foreign keys are only resolved at the end).
+  statements.push_back("DROP TABLE `parallel_parse`.`table148`");
+  statements.push_back("RENAME TABLE `parallel_parse`.`table149` TO `parallel_parse`.`renamed149`");
+
+  db_mysql_CatalogRef catalog = create_catalog_from_script(base::join(statements, ";\n") + ";");
+
+  db_mysql_CatalogRef sequential_catalog = create_empty_catalog_for_import();
+  MySQLParserServices::Ref services = MySQLParserServices::get();
+  MySQLParserContext::Ref context =
+    services->createParserContext(tester->get_rdbms()->characterSets(), tester->get_rdbms()->version(), false);
+  for (std::vector<std::string>::const_iterator statement = statements.begin(); statement != statements.end();
+       ++statement) {
+    grt::DictRef options(true);
+    ensure_equals("sequential parse of " + *statement,
+                  services->parseSQLIntoCatalog(context, sequential_catalog, *statement, options), 0U);
+  }
+
+  db_mysql_SchemaRef schema = find_named_object_in_list(catalog->schemata(), "parallel_parse");
+  ensure("schema created", schema.is_valid());
+  ensure_equals("table count", schema->tables().count(), 149U);
+  ensure_equals("view count", schema->views().count(), 15U);
+  ensure("dropped table", !find_named_object_in_list(schema->tables(), "table148").is_valid());
+  ensure("renamed table", find_named_object_in_list(schema->tables(), "renamed149").is_valid());
+
+  db_TableRef table = find_named_object_in_list(schema->tables(), "table147");
+  ensure_equals("foreign key", table->foreignKeys().count(), 1U);
+  ensure_equals("referenced table", *table->foreignKeys()[0]->referencedTable()->name(), "table73");
+
+  std::shared_ptr<DiffChange> change = diff_make(catalog, sequential_catalog, &omf);
+  if (change)
+    change->dump_log(0);
+  ensure("same catalog as the sequential parse", change == NULL);
+}
+
 // Due to the tut nature, this must be executed as a last test always,
 // we can't have this inside of the d-tor.
 TEST_FUNCTION(99) {
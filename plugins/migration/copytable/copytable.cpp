@@ -22,6 +22,7 @@
 #include <stdint.h>
 #include <cstdlib>
 #include <cstdio>
+#include <algorithm>
 
 #include <my_config.h>
 
@@ -45,6 +46,17 @@ DEFAULT_LOG_DOMAIN("copytable");
 
 #define TMP_TRIGGER_TABLE "wb_tmp_triggers"
 
+// Minimum amount of data sent to the server with each LOAD DATA LOCAL INFILE statement
+#define LOAD_DATA_BUFFER_SIZE (16 * 1024 * 1024)
+
+// Character set number reported in the field metadata for binary strings
+#ifndef BINARY_CHARSET_NUMBER
+#define BINARY_CHARSET_NUMBER 63
+#endif
+
+// Upper limit for the memory used by the row buffers of a pipelined copy task
+#define MAX_PIPELINE_MEMORY (256 * 1024 * 1024)
+
 #if defined(MYSQL_VERSION_MAJOR) && defined(MYSQL_VERSION_MINOR) && defined(MYSQL_VERSION_PATCH)
 #define MYSQL_CHECK_VERSION(major, minor, micro)                                                         \
   (MYSQL_VERSION_MAJOR > (major) || (MYSQL_VERSION_MAJOR == (major) && MYSQL_VERSION_MINOR > (minor)) || \
@@ -197,6 +209,16 @@ static const char *odbc_type_to_name(SQLSMALLINT type) {
   }
 }
 
+static bool parse_key_value(const char *value, long long &result) {
+  if (!value || !*value)
+    return false;
+
+  char *end = NULL;
+  errno = 0;
+  result = strtoll(value, &end, 10);
+  return errno == 0 && end && *end == 0;
+}
+
 std::string QueryBuilder::build_query() {
   std::string q;
   std::string where_cond;
@@ -373,6 +395,13 @@ void RowBuffer::clear() {
   _current_field = 0;
 }
 
+size_t RowBuffer::buffer_size() const {
+  size_t size = 0;
+  for (std::vector<MYSQL_BIND>::const_iterator field = begin(); field != end(); ++field)
+    size += field->buffer_length;
+  return size;
+}
+
 void RowBuffer::prepare_add_string(char *&buffer, size_t &buffer_len, unsigned long *&length) {
   MYSQL_BIND &bind(at(_current_field));
   if (bind.buffer_type != MYSQL_TYPE_STRING)
@@ -791,6 +820,43 @@ SQLRETURN ODBCCopyDataSource::get_geometry_buffer_data(RowBuffer &rowbuffer, int
   return ret;
 }
 
+bool ODBCCopyDataSource::get_key_range(const std::string &schema, const std::string &table,
+                                       const std::string &key_column, long long &min_value, long long &max_value) {
+  SQLHSTMT stmt;
+  SQLRETURN ret;
+  if (!SQL_SUCCEEDED(ret = SQLAllocHandle(SQL_HANDLE_STMT, _dbc, &stmt)))
+    throw ConnectionError("SQLAllocHandle", ret, SQL_HANDLE_DBC, _dbc);
+
+  QueryBuilder q;
+  q.select_columns(base::strfmt("min(%s), max(%s)", key_column.c_str(), key_column.c_str()));
+  q.select_from_table(table, schema);
+
+  logDebug("Executing query: %s\n", q.build_query().c_str());
+  if (!SQL_SUCCEEDED(ret = SQLExecDirect(stmt, (SQLCHAR *)q.build_query().c_str(), SQL_NTS))) {
+    // Not being able to get the range only means the table will be copied in one go
+    logWarning("Could not get the key range of %s.%s: %s\n", schema.c_str(), table.c_str(),
+               ConnectionError("SQLExecDirect", ret, SQL_HANDLE_STMT, stmt).what());
+    SQLFreeHandle(SQL_HANDLE_STMT, stmt);
+    return false;
+  }
+
+  // Values are fetched as text so non integer keys can be detected and rejected
+  bool ret_val = false;
+  if (SQL_SUCCEEDED(SQLFetch(stmt))) {
+    char min_buffer[64], max_buffer[64];
+    SQLLEN min_ind = SQL_NULL_DATA, max_ind = SQL_NULL_DATA;
+
+    if (SQL_SUCCEEDED(SQLGetData(stmt, 1, SQL_C_CHAR, min_buffer, sizeof(min_buffer), &min_ind)) &&
+        SQL_SUCCEEDED(SQLGetData(stmt, 2, SQL_C_CHAR, max_buffer, sizeof(max_buffer), &max_ind)) &&
+        min_ind != SQL_NULL_DATA && max_ind != SQL_NULL_DATA)
+      ret_val = parse_key_value(min_buffer, min_value) && parse_key_value(max_buffer, max_value);
+  }
+
+  SQLFreeHandle(SQL_HANDLE_STMT, stmt);
+
+  return ret_val;
+}
+
 size_t ODBCCopyDataSource::count_rows(const std::string &schema, const std::string &table,
                                       const std::vector<std::string> &pk_columns, const CopySpec &spec,
                                       const std::vector<std::string> &last_pkeys) {
@@ -810,7 +876,7 @@ size_t ODBCCopyDataSource::count_rows(const std::string &schema, const std::stri
       break;
     case CopyRange: {
       std::string start_expr, end_expr;
-      if (spec.range_end < 0)
+      if (!spec.has_range_end)
         end_expr = "";
       else
         end_expr = base::strfmt("%s <= %lli", spec.range_key.c_str(), spec.range_end);
@@ -819,6 +885,8 @@ size_t ODBCCopyDataSource::count_rows(const std::string &schema, const std::stri
         q.add_where(base::strfmt("%s AND %s", start_expr.c_str(), end_expr.c_str()));
       else
         q.add_where(start_expr);
+      if (spec.resume && last_pkeys.size())
+        q.add_where(get_where_condition(pk_columns, last_pkeys));
       break;
     }
     case CopyCount: {
@@ -872,7 +940,7 @@ std::shared_ptr<std::vector<ColumnInfo> > ODBCCopyDataSource::begin_select_table
     select_query.add_where(get_where_condition(pk_columns, last_pkeys));
   if (spec.type == CopyRange) {
     select_query.add_where(base::strfmt("%s >= %lli", spec.range_key.c_str(), spec.range_start));
-    if (spec.range_end >= 0)
+    if (spec.has_range_end)
       select_query.add_where(base::strfmt("%s <= %lli", spec.range_key.c_str(), spec.range_end));
   }
   if (spec.type == CopyWhere)
@@ -901,6 +969,7 @@ std::shared_ptr<std::vector<ColumnInfo> > ODBCCopyDataSource::begin_select_table
 
     info.is_long_data = false;
     info.is_unsigned = false;
+    info.is_binary = false;
 
     if (SQL_SUCCEEDED(SQLDescribeCol(_stmt, i, columnName, sizeof(columnName), &nameLength, &dataType, &columnSize,
                                      &decimalDigits, &nullablePtr))) {
@@ -1219,6 +1288,29 @@ MySQLCopyDataSource::MySQLCopyDataSource(const std::string &hostname, int port,
     throw ConnectionError(q, &_mysql);
 }
 
+bool MySQLCopyDataSource::get_key_range(const std::string &schema, const std::string &table,
+                                        const std::string &key_column, long long &min_value, long long &max_value) {
+  std::string q = base::strfmt("SELECT min(%s), max(%s) FROM %s.%s", key_column.c_str(), key_column.c_str(),
+                               schema.c_str(), table.c_str());
+
+  logDebug("Executing query: %s\n", q.c_str());
+  if (mysql_query(&_mysql, q.data()) != 0)
+    throw ConnectionError("mysql_query(" + q + ")", &_mysql);
+
+  MYSQL_RES *result;
+  if ((result = mysql_store_result(&_mysql)) == NULL)
+    throw ConnectionError("MySQL query", &_mysql);
+
+  bool ret_val = false;
+  MYSQL_ROW row = mysql_fetch_row(result);
+  if (row)
+    ret_val = parse_key_value(row[0], min_value) && parse_key_value(row[1], max_value);
+
+  mysql_free_result(result);
+
+  return ret_val;
+}
+
 size_t MySQLCopyDataSource::count_rows(const std::string &schema, const std::string &table,
                                        const std::vector<std::string> &pk_columns, const CopySpec &spec,
                                        const std::vector<std::string> &last_pkeys) {
@@ -1237,11 +1329,13 @@ size_t MySQLCopyDataSource::count_rows(const std::string &schema, const std::str
       break;
     case CopyRange: {
       std::string start_expr, end_expr;
-      if (spec.range_end < 0)
+      if (!spec.has_range_end)
         end_expr = "";
       else
         end_expr = base::strfmt("%s <= %lli", spec.range_key.c_str(), spec.range_end);
       start_expr = base::strfmt("%s >= %lli", spec.range_key.c_str(), spec.range_start);
+      if (spec.resume && last_pkeys.size())
+        start_expr += base::strfmt(" AND (%s)", get_where_condition(pk_columns, last_pkeys).c_str());
       if (!end_expr.empty())
         q =
           base::strfmt("SELECT count(*) FROM %s WHERE %s AND %s", table.c_str(), start_expr.c_str(), end_expr.c_str());
@@ -1309,7 +1403,7 @@ std::shared_ptr<std::vector<ColumnInfo> > MySQLCopyDataSource::begin_select_tabl
     select_query.add_where(get_where_condition(pk_columns, last_pkeys));
   if (spec.type == CopyRange) {
     select_query.add_where(base::strfmt("%s >= %lli", spec.range_key.c_str(), spec.range_start));
-    if (spec.range_end >= 0)
+    if (spec.has_range_end)
       select_query.add_where(base::strfmt("%s <= %lli", spec.range_key.c_str(), spec.range_end));
   }
   if (spec.type == CopyWhere)
@@ -1340,6 +1434,7 @@ std::shared_ptr<std::vector<ColumnInfo> > MySQLCopyDataSource::begin_select_tabl
           info.source_length = fields[i].length;
           info.is_unsigned = false;
           info.is_long_data = false;
+          info.is_binary = false;
 
           info.is_long_data = fields[i].type == MYSQL_TYPE_TINY_BLOB || fields[i].type == MYSQL_TYPE_MEDIUM_BLOB ||
                               fields[i].type == MYSQL_TYPE_BLOB;
@@ -1467,6 +1562,19 @@ void MySQLCopyDataTarget::init() {
   } else
     _max_long_data_size = _max_allowed_packet;
 
+  // LOAD DATA LOCAL is disabled by default since MySQL 8.0, in that case regular inserts are used
+  if (_use_load_data) {
+    std::string local_infile;
+    get_server_value("local_infile", local_infile);
+    if (base::tolower(local_infile) != "on") {
+      logWarning("local_infile is disabled in the target server, falling back to INSERT statements\n");
+      _use_load_data = false;
+    } else
+      mysql_set_local_infile_handler(&_mysql, &MySQLCopyDataTarget::local_infile_init,
+                                     &MySQLCopyDataTarget::local_infile_read, &MySQLCopyDataTarget::local_infile_end,
+                                     &MySQLCopyDataTarget::local_infile_error, this);
+  }
+
   std::string q = "SET NAMES 'utf8'";
   if (mysql_real_query(&_mysql, q.data(), (unsigned long)q.length()) != 0)
     throw ConnectionError(q, &_mysql);
@@ -1491,7 +1599,8 @@ void MySQLCopyDataTarget::init() {
 }
 
 std::vector<std::string> MySQLCopyDataTarget::get_last_pkeys(const std::vector<std::string> &pk_columns,
-                                                             const std::string &schema, const std::string &table) {
+                                                             const std::string &schema, const std::string &table,
+                                                             const std::string &where_condition) {
   std::vector<std::string> ret;
   std::string order_by_cond;
   if (pk_columns.empty())
@@ -1503,9 +1612,14 @@ std::vector<std::string> MySQLCopyDataTarget::get_last_pkeys(const std::vector<s
       order_by_cond += ",";
   }
 
-  const std::string q =
-    base::strfmt("SELECT %s FROM %s.%s ORDER BY %s LIMIT 0,1", boost::algorithm::join(pk_columns, ", ").c_str(),
-                 schema.c_str(), table.c_str(), order_by_cond.c_str());
+  QueryBuilder last_query;
+  last_query.select_columns(boost::algorithm::join(pk_columns, ", "));
+  last_query.select_from_table(table, schema);
+  last_query.add_orderby(order_by_cond);
+  last_query.add_limit("0,1");
+  if (!where_condition.empty())
+    last_query.add_where(where_condition);
+  const std::string q = last_query.build_query();
   if (mysql_query(&_mysql, q.data()) != 0)
     throw ConnectionError("mysql_query(" + q + ")", &_mysql);
 
@@ -1727,7 +1841,7 @@ MySQLCopyDataTarget::MySQLCopyDataTarget(const std::string &hostname, int port,
                                          const std::string &password, const std::string &socket,
                                          bool use_cleartext_plugin, const std::string &app_name,
                                          const std::string &incoming_charset, const std::string &source_rdbms_type,
-                                         const unsigned int connection_timeout)
+                                         const unsigned int connection_timeout, bool use_load_data)
   : _insert_stmt(NULL),
     _max_allowed_packet(1000000),
     _max_long_data_size(1000000), // 1M default
@@ -1740,7 +1854,10 @@ MySQLCopyDataTarget::MySQLCopyDataTarget(const std::string &hostname, int port,
     _bulk_insert_record(this),
     _bulk_insert_batch(0),
     _source_rdbms_type(source_rdbms_type),
-    _connection_timeout(connection_timeout) {
+    _connection_timeout(connection_timeout),
+    _use_load_data(use_load_data),
+    _load_data_buffer(this),
+    _load_data_offset(0) {
   std::string host = hostname;
   _truncate = false;
 
@@ -1748,6 +1865,12 @@ MySQLCopyDataTarget::MySQLCopyDataTarget(const std::string &hostname, int port,
   if (base::tolower(_incoming_data_charset) == "cp1252" || base::tolower(_incoming_data_charset) == "windows-1252")
     _incoming_data_charset = "latin1";
 
+  if (_use_load_data && !load_data_charset_supported(_incoming_data_charset)) {
+    logWarning("LOAD DATA can't be used with source data in %s, falling back to INSERT statements\n",
+               _incoming_data_charset.c_str());
+    _use_load_data = false;
+  }
+
   mysql_init(&_mysql);
 #if MYSQL_CHECK_VERSION(5, 6, 6)
   if (is_mysql_version_at_least(5, 6, 6))
@@ -1788,6 +1911,12 @@ MySQLCopyDataTarget::MySQLCopyDataTarget(const std::string &hostname, int port,
     logWarning("Trying to use the ClearText plugin, but it's not supported by libmysqlclient\n");
 #endif
 
+  // The data is served by our own local infile handler, so no files can be read through this
+  if (_use_load_data) {
+    unsigned int local_infile = 1;
+    mysql_options(&_mysql, MYSQL_OPT_LOCAL_INFILE, &local_infile);
+  }
+
   if (!mysql_real_connect(&_mysql, hostname.c_str(), username.c_str(), password.c_str(), NULL, port, socket.c_str(),
                           CLIENT_COMPRESS)) {
     logError("Failed opening connection to MySQL: %s\n", mysql_error(&_mysql));
@@ -1831,8 +1960,14 @@ void MySQLCopyDataTarget::get_generated_columns(const std::string &schema, const
   mysql_free_result(result);
 }
 
+void MySQLCopyDataTarget::truncate_table(const std::string &schema, const std::string &table) {
+  logInfo("Truncating table %s.%s\n", schema.c_str(), table.c_str());
+  if (mysql_query(&_mysql, base::strfmt("TRUNCATE %s.%s", schema.c_str(), table.c_str()).c_str()) != 0)
+    logWarning("Error executing TRUNCATE %s.%s: %s\n", schema.c_str(), table.c_str(), mysql_error(&_mysql));
+}
+
 void MySQLCopyDataTarget::set_target_table(const std::string &schema, const std::string &table,
-                                           std::shared_ptr<std::vector<ColumnInfo> > columns) {
+                                           std::shared_ptr<std::vector<ColumnInfo> > columns, bool truncate) {
   _schema = schema;
   _table = table;
   _columns = columns;
@@ -1872,6 +2007,11 @@ void MySQLCopyDataTarget::set_target_table(const std::string &schema, const std:
             // We can't trust source drivers to report signed/unsigned values, so we take that from the target MySQL
             // table:
             (*columns)[i - idx_mod].is_unsigned = (fields[i].flags & UNSIGNED_FLAG) != 0;
+            // BINARY, VARBINARY and BLOB columns, numbers also report the binary charset
+            (*columns)[i - idx_mod].is_binary =
+              fields[i].charsetnr == BINARY_CHARSET_NUMBER && fields[i].type != MYSQL_TYPE_DECIMAL &&
+              fields[i].type != MYSQL_TYPE_NEWDECIMAL && ((*columns)[i - idx_mod].target_type == MYSQL_TYPE_STRING ||
+                                                          (*columns)[i - idx_mod].target_type == MYSQL_TYPE_BLOB);
             if (_get_field_lengths_from_target)
               (*columns)[i - idx_mod].source_length = fields[i].length;
             logDebug2("%i - %s: %s\n", i + 1, (*columns)[i - idx_mod].target_name.c_str(),
@@ -1899,11 +2039,8 @@ void MySQLCopyDataTarget::set_target_table(const std::string &schema, const std:
   } else
     throw ConnectionError("mysql_stmt_init", &_mysql);
 
-  if (_truncate) {
-    logInfo("Truncating table %s.%s\n", schema.c_str(), table.c_str());
-    if (mysql_query(&_mysql, base::strfmt("TRUNCATE %s.%s", schema.c_str(), table.c_str()).c_str()) != 0)
-      logWarning("Error executing TRUNCATE %s.%s: %s\n", schema.c_str(), table.c_str(), mysql_error(&_mysql));
-  }
+  if (_truncate && truncate)
+    truncate_table(schema, table);
 
   // TODO: Bulk inserts should be disabled when a single record can be bigger than the max_packet_size
   _use_bulk_inserts = true;
@@ -1928,6 +2065,11 @@ void MySQLCopyDataTarget::begin_inserts() {
   _init_bulk_insert = true;
   _bulk_record_count = 0;
 
+  if (_use_load_data) {
+    _load_data_query = load_data_query();
+    _load_data_buffer.reset(std::max<size_t>(LOAD_DATA_BUFFER_SIZE, _max_allowed_packet));
+  }
+
   // The RowBuffer is used by the CopyDataSources to store in it the data read from the
   // database, once the data is loaded in it, it is used for both bulk inserts
   // and prepared statements
@@ -1964,7 +2106,13 @@ int MySQLCopyDataTarget::end_inserts(bool flush) {
 
   // When doing bulk inserts it is possible that some records are still pending on the
   // _bulk_insert_buffer or _bulk_insert_record so they need to be inserted
-  if (_use_bulk_inserts) {
+  if (_use_load_data) {
+    if (flush && _load_data_buffer.length)
+      ret_val = do_load_data(true);
+    else
+      _load_data_buffer.reset(_load_data_buffer.size);
+    _bulk_record_count = 0;
+  } else if (_use_bulk_inserts) {
     if (flush) {
       if (_bulk_insert_buffer.length)
         ret_val = do_insert(true);
@@ -1985,7 +2133,9 @@ int MySQLCopyDataTarget::end_inserts(bool flush) {
 int MySQLCopyDataTarget::do_insert(bool final) {
   int ret_val = 0;
 
-  if (_use_bulk_inserts) {
+  if (_use_load_data)
+    ret_val = do_load_data(final);
+  else if (_use_bulk_inserts) {
     bool add_comma = true;
 
     if (_init_bulk_insert) {
@@ -2230,10 +2380,379 @@ bool MySQLCopyDataTarget::append_bulk_column(size_t col_index) {
   return ret_val;
 }
 
+/*
+ * load_data_charset_supported : tells whether rows in the given source character set can be sent
+ *                               with LOAD DATA LOCAL INFILE.
+ *
+ * Remarks : Rows are escaped one byte at a time, which only works when no multibyte character can
+ *           contain a byte in the ASCII range. That is not the case for sjis, cp932, big5, gbk and
+ *           gb18030, where 0x5C (the escape character) is a valid trailing byte, and the server can't
+ *           load files in the UCS-2/UTF-16/UTF-32 encodings at all. Those use INSERT statements,
+ *           for which the client library does the escaping for the connection character set.
+ */
+bool MySQLCopyDataTarget::load_data_charset_supported(const std::string &charset) {
+  static const char *unsupported_charsets[] = {"sjis",  "cp932", "big5",    "gbk",   "gb18030",
+                                               "ucs2",  "utf16", "utf16le", "utf32", NULL};
+  std::string name = base::tolower(charset);
+
+  for (const char **unsupported = unsupported_charsets; *unsupported; ++unsupported) {
+    if (name == *unsupported)
+      return false;
+  }
+  return true;
+}
+
+// Escapes the data as expected by LOAD DATA with ESCAPED BY '\\'. out must have room for twice the
+// length of data, returns the number of bytes written.
+size_t MySQLCopyDataTarget::load_data_escape(char *out, const char *data, size_t length) {
+  char *start = out;
+
+  for (const char *end = data + length; data < end; ++data) {
+    switch (*data) {
+      case '\\':
+        *out++ = '\\';
+        *out++ = '\\';
+        break;
+      case '\t':
+        *out++ = '\\';
+        *out++ = 't';
+        break;
+      case '\n':
+        *out++ = '\\';
+        *out++ = 'n';
+        break;
+      case '\r':
+        *out++ = '\\';
+        *out++ = 'r';
+        break;
+      case '\0':
+        *out++ = '\\';
+        *out++ = '0';
+        break;
+      default:
+        *out++ = *data;
+        break;
+    }
+  }
+  return out - start;
+}
+
+// Hex encodes the data for binary columns, which are decoded with UNHEX() by the LOAD DATA statement.
+size_t MySQLCopyDataTarget::load_data_hex(char *out, const char *data, size_t length) {
+  static const char digits[] = "0123456789ABCDEF";
+
+  for (size_t index = 0; index < length; index++) {
+    unsigned char c = (unsigned char)data[index];
+    *out++ = digits[c >> 4];
+    *out++ = digits[c & 0x0F];
+  }
+  return length * 2;
+}
+
+/*
+ * load_data_query : creates the LOAD DATA LOCAL INFILE statement used to insert the rows.
+ *
+ * Remarks : The data is declared in the character set of the source data, the same one set as
+ *           character_set_client for the INSERT statements, so the server converts it the same way.
+ *           Without a known source character set the data is utf8, the connection character set
+ *           set with SET NAMES.
+ *           Columns that need a conversion from their text representation (BIT and geometries) are
+ *           loaded into user variables and converted in the SET clause. Binary strings are sent hex
+ *           encoded the same way, so their bytes don't go through the character set conversion.
+ */
+std::string MySQLCopyDataTarget::load_data_query() {
+  std::string columns, conversions;
+
+  for (size_t index = 0; index < _columns->size(); index++) {
+    const ColumnInfo &column((*_columns)[index]);
+    std::string name = base::sqlstring("!", 0) << column.target_name;
+    std::string variable = base::strfmt("@wb_col%li", (long)index);
+
+    if (!columns.empty())
+      columns.append(", ");
+
+    if (column.is_binary) {
+      columns.append(variable);
+      conversions.append(conversions.empty() ? " SET " : ", ");
+      conversions.append(base::strfmt("%s = UNHEX(%s)", name.c_str(), variable.c_str()));
+      continue;
+    }
+
+    switch (column.target_type) {
+      case MYSQL_TYPE_BIT:
+        columns.append(variable);
+        conversions.append(conversions.empty() ? " SET " : ", ");
+        conversions.append(base::strfmt("%s = CAST(%s AS UNSIGNED)", name.c_str(), variable.c_str()));
+        break;
+      case MYSQL_TYPE_GEOMETRY:
+        columns.append(variable);
+        conversions.append(conversions.empty() ? " SET " : ", ");
+        conversions.append(base::strfmt("%s = GeomFromText(%s)", name.c_str(), variable.c_str()));
+        break;
+      default:
+        columns.append(name);
+        break;
+    }
+  }
+
+  return base::strfmt(
+    "LOAD DATA LOCAL INFILE 'wbcopytables' INTO TABLE %s.%s CHARACTER SET %s FIELDS TERMINATED BY '\\t' "
+    "ESCAPED BY '\\\\' LINES TERMINATED BY '\\n' (%s)%s",
+    _schema.c_str(), _table.c_str(), _incoming_data_charset.empty() ? "utf8" : _incoming_data_charset.c_str(),
+    columns.c_str(), conversions.c_str());
+}
+
+bool MySQLCopyDataTarget::format_load_data_record() {
+  bool ret_val = true;
+
+  for (size_t index = 0; ret_val && index < _row_buffer->size(); index++) {
+    if (index > 0)
+      ret_val = _bulk_insert_record.append("\t", 1);
+    if (ret_val)
+      ret_val = append_load_data_column(index);
+  }
+
+  if (ret_val)
+    ret_val = _bulk_insert_record.append("\n", 1);
+
+  return ret_val;
+}
+
+bool MySQLCopyDataTarget::append_load_data_column(size_t col_index) {
+  MYSQL_BIND &field((*_row_buffer)[col_index]);
+  std::string data;
+
+  if (field.buffer_type == MYSQL_TYPE_NULL || *field.is_null)
+    return _bulk_insert_record.append("\\N", 2);
+
+  switch (field.buffer_type) {
+    case MYSQL_TYPE_TINY:
+      if (field.is_unsigned)
+        data = base::strfmt("%u", *(unsigned char *)field.buffer);
+      else
+        data = base::strfmt("%d", *(char *)field.buffer);
+      break;
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_YEAR:
+      if (field.is_unsigned)
+        data = base::strfmt("%u", *(unsigned short *)field.buffer);
+      else
+        data = base::strfmt("%d", *(short *)field.buffer);
+      break;
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONG:
+      if (field.is_unsigned)
+        data = base::strfmt("%u", *(unsigned int *)field.buffer);
+      else
+        data = base::strfmt("%i", *(int *)field.buffer);
+      break;
+    case MYSQL_TYPE_LONGLONG:
+      if (field.is_unsigned)
+        data = base::strfmt("%llu", *(unsigned long long int *)field.buffer);
+      else
+        data = base::strfmt("%lli", *(long long int *)field.buffer);
+      break;
+    case MYSQL_TYPE_FLOAT:
+      data = base::strfmt("%f", *(float *)field.buffer);
+      break;
+    case MYSQL_TYPE_DOUBLE:
+      data = base::strfmt("%f", *(double *)field.buffer);
+      break;
+    case MYSQL_TYPE_BIT: {
+      // Same conversion as for bulk inserts, the value is sent as a number
+      std::div_t length = std::div((int)field.buffer_length - 1, 8);
+
+      if (length.rem)
+        ++length.quot;
+
+      unsigned long long uval = 0;
+      unsigned int shift = 0;
+
+      for (int index = 1; index <= length.quot; index++) {
+        uval += (((unsigned char *)field.buffer)[length.quot - index]) << shift;
+        shift += 8;
+      }
+      data = base::strfmt("%llu", uval);
+      break;
+    }
+    case MYSQL_TYPE_TIME:
+    case MYSQL_TYPE_DATE:
+    case MYSQL_TYPE_NEWDATE:
+    case MYSQL_TYPE_DATETIME:
+    case MYSQL_TYPE_TIMESTAMP: {
+      MYSQL_TIME *ts = (MYSQL_TIME *)field.buffer;
+      bool fractional = is_mysql_version_at_least(5, 6, 4);
+      switch (ts->time_type) {
+        case MYSQL_TIMESTAMP_DATETIME:
+          if (fractional)
+            data = base::strfmt("%04d-%02d-%02d %02d:%02d:%02d.%06lu", ts->year, ts->month, ts->day, ts->hour,
+                                ts->minute, ts->second, ts->second_part);
+          else
+            data = base::strfmt("%04d-%02d-%02d %02d:%02d:%02d", ts->year, ts->month, ts->day, ts->hour, ts->minute,
+                                ts->second);
+          break;
+        case MYSQL_TIMESTAMP_DATE:
+          data = base::strfmt("%04d-%02d-%02d", ts->year, ts->month, ts->day);
+          break;
+        case MYSQL_TIMESTAMP_TIME:
+          if (fractional)
+            data = base::strfmt("%02d:%02d:%02d.%06lu", ts->hour, ts->minute, ts->second, ts->second_part);
+          else
+            data = base::strfmt("%02d:%02d:%02d", ts->hour, ts->minute, ts->second);
+          break;
+        default:
+          break;
+      }
+      break;
+    }
+    case MYSQL_TYPE_DECIMAL:
+    case MYSQL_TYPE_NEWDECIMAL:
+    case MYSQL_TYPE_VAR_STRING:
+    case MYSQL_TYPE_VARCHAR:
+    case MYSQL_TYPE_STRING:
+    case MYSQL_TYPE_ENUM:
+    case MYSQL_TYPE_SET:
+    case MYSQL_TYPE_JSON:
+    case MYSQL_TYPE_BLOB:
+    case MYSQL_TYPE_TINY_BLOB:
+    case MYSQL_TYPE_MEDIUM_BLOB:
+    case MYSQL_TYPE_LONG_BLOB:
+    case MYSQL_TYPE_GEOMETRY:
+      if ((*_columns)[col_index].is_binary)
+        return _bulk_insert_record.append_load_data_hex((char *)field.buffer, *field.length);
+      return _bulk_insert_record.append_load_data_escaped((char *)field.buffer, *field.length);
+    default:
+      // Same as for bulk inserts, values of unhandled types are left empty
+      return true;
+  }
+
+  return _bulk_insert_record.append(data.data(), data.length());
+}
+
+/*
+ * do_load_data : adds the current row to the LOAD DATA buffer, sending the buffer to the
+ *                server when it is full or when final is set.
+ *
+ * Remarks : Returns the number of rows the server loaded. Errors in LOAD DATA LOCAL are
+ *           reported as warnings by the server and the offending rows skipped, so those are
+ *           logged and show up as rows that failed to be copied.
+ */
+int MySQLCopyDataTarget::do_load_data(bool final) {
+  int ret_val = 0;
+  bool pending_record = false;
+
+  if (!final) {
+    _bulk_insert_record.reset(_max_allowed_packet);
+    if (!format_load_data_record())
+      throw std::runtime_error("Found record bigger than max_allowed_packet");
+
+    if (_load_data_buffer.append(_bulk_insert_record.buffer, _bulk_insert_record.length)) {
+      _bulk_record_count++;
+      return 0;
+    }
+    pending_record = true;
+  }
+
+  if (_load_data_buffer.length) {
+    _load_data_offset = 0;
+    if (mysql_real_query(&_mysql, _load_data_query.data(), (unsigned long)_load_data_query.length()) != 0) {
+      logInfo("Statement execution failed: %s:\n%s\n", mysql_error(&_mysql), _load_data_query.c_str());
+      throw ConnectionError("Loading Data", &_mysql);
+    }
+
+    ret_val = (int)mysql_affected_rows(&_mysql);
+    if (mysql_warning_count(&_mysql) > 0 || ret_val != _bulk_record_count)
+      log_load_data_warnings();
+
+    _load_data_buffer.reset(_load_data_buffer.size);
+    _bulk_record_count = 0;
+  }
+
+  // The record that didn't fit starts the next batch
+  if (pending_record) {
+    if (!_load_data_buffer.append(_bulk_insert_record.buffer, _bulk_insert_record.length))
+      throw std::runtime_error("Found record bigger than the LOAD DATA buffer");
+    _bulk_record_count++;
+  }
+
+  return ret_val;
+}
+
+void MySQLCopyDataTarget::log_load_data_warnings() {
+  logWarning("LOAD DATA into %s.%s loaded %llu of %i rows with %u warnings\n", _schema.c_str(), _table.c_str(),
+             (unsigned long long)mysql_affected_rows(&_mysql), _bulk_record_count, mysql_warning_count(&_mysql));
+
+  if (mysql_query(&_mysql, "SHOW WARNINGS LIMIT 10") != 0)
+    return;
+
+  MYSQL_RES *result = mysql_store_result(&_mysql);
+  if (result) {
+    MYSQL_ROW row;
+    while ((row = mysql_fetch_row(result)) != NULL)
+      logWarning("%s %s: %s\n", row[0] ? row[0] : "", row[1] ? row[1] : "", row[2] ? row[2] : "");
+    mysql_free_result(result);
+  }
+}
+
+// The local infile handler serves the contents of _load_data_buffer, whatever file name the server asks for.
+int MySQLCopyDataTarget::local_infile_init(void **ptr, const char *filename, void *userdata) {
+  *ptr = userdata;
+  return 0;
+}
+
+int MySQLCopyDataTarget::local_infile_read(void *ptr, char *buf, unsigned int buf_len) {
+  MySQLCopyDataTarget *self = (MySQLCopyDataTarget *)ptr;
+
+  size_t length = std::min((size_t)buf_len, self->_load_data_buffer.length - self->_load_data_offset);
+  memcpy(buf, self->_load_data_buffer.buffer + self->_load_data_offset, length);
+  self->_load_data_offset += length;
+
+  return (int)length;
+}
+
+void MySQLCopyDataTarget::local_infile_end(void *ptr) {
+}
+
+int MySQLCopyDataTarget::local_infile_error(void *ptr, char *error_msg, unsigned int error_msg_len) {
+  return 0;
+}
+
 RowBuffer &MySQLCopyDataTarget::row_buffer() {
   return *_row_buffer;
 }
 
+RowBuffer *MySQLCopyDataTarget::create_row_buffer() {
+  return new RowBuffer(_columns, std::bind(&MySQLCopyDataTarget::send_long_data, this, std::placeholders::_1,
+                                           std::placeholders::_2, std::placeholders::_3),
+                       _max_allowed_packet);
+}
+
+/*
+ * do_insert : inserts the data contained in a row buffer other than the one owned by the target.
+ *
+ * Remarks : Only valid for bulk inserts, the row is formatted into the insert statement before
+ *           returning so the buffer can be reused right away. Prepared statements are bound
+ *           to the target's own row buffer.
+ */
+int MySQLCopyDataTarget::do_insert(RowBuffer *row) {
+  if (!_use_bulk_inserts)
+    throw std::logic_error("Inserting from external row buffers requires bulk inserts");
+
+  RowBuffer *own_buffer = _row_buffer;
+  _row_buffer = row;
+
+  int ret_val = 0;
+  try {
+    ret_val = do_insert();
+  } catch (...) {
+    _row_buffer = own_buffer;
+    throw;
+  }
+  _row_buffer = own_buffer;
+
+  return ret_val;
+}
+
 long long MySQLCopyDataTarget::get_max_value(const std::string &key) {
   std::string q = base::sqlstring("SELECT max(!) FROM !.!", 0) << key << _schema << _table;
   mysql_query(&_mysql, q.c_str());
@@ -2451,6 +2970,149 @@ void MySQLCopyDataTarget::restore_triggers(std::set<std::string> &schemas) {
   }
 }
 
+RowBufferQueue::RowBufferQueue(std::function<RowBuffer *()> create_buffer, size_t capacity)
+  : _create_buffer(create_buffer),
+    _capacity(capacity),
+    _allocating(0),
+    _finished(false),
+    _aborted(false),
+    _batches(0),
+    _rows(0),
+    _occupancy_total(0),
+    _max_occupancy(0),
+    _reader_waits(0),
+    _writer_waits(0) {
+}
+
+RowBufferQueue::~RowBufferQueue() {
+  for (std::vector<RowBuffer *>::iterator buffer = _buffers.begin(); buffer != _buffers.end(); ++buffer)
+    delete *buffer;
+}
+
+RowBuffer *RowBufferQueue::get_free_buffer() {
+  {
+    base::MutexLock lock(_mutex);
+
+    // Buffers are only allocated when needed, small tables never fill the whole ring
+    while (!_aborted && _free.empty() && _buffers.size() + _allocating >= _capacity) {
+      _reader_waits++;
+      _free_cond.wait(_mutex);
+    }
+
+    if (_aborted)
+      return NULL;
+
+    if (!_free.empty()) {
+      RowBuffer *buffer = _free.back();
+      _free.pop_back();
+      return buffer;
+    }
+
+    // The slot is reserved and the buffer allocated without the lock, so the writer isn't held up
+    // releasing buffers meanwhile
+    _allocating++;
+  }
+
+  RowBuffer *buffer;
+  try {
+    buffer = _create_buffer();
+  } catch (...) {
+    base::MutexLock lock(_mutex);
+    _allocating--;
+    _free_cond.signal();
+    throw;
+  }
+
+  base::MutexLock lock(_mutex);
+  _allocating--;
+  _buffers.push_back(buffer);
+  return buffer;
+}
+
+void RowBufferQueue::push_filled_buffer(RowBuffer *buffer) {
+  base::MutexLock lock(_mutex);
+
+  _filled.push_back(buffer);
+  _filled_cond.signal();
+}
+
+void RowBufferQueue::finish() {
+  base::MutexLock lock(_mutex);
+
+  _finished = true;
+  _filled_cond.signal();
+}
+
+bool RowBufferQueue::get_filled_buffers(std::vector<RowBuffer *> &batch) {
+  base::MutexLock lock(_mutex);
+
+  while (!_aborted && !_finished && _filled.empty()) {
+    _writer_waits++;
+    _filled_cond.wait(_mutex);
+  }
+
+  if (_aborted || _filled.empty())
+    return false;
+
+  _batches++;
+  _rows += _filled.size();
+  _occupancy_total += _filled.size();
+  _max_occupancy = std::max(_max_occupancy, _filled.size());
+
+  batch.swap(_filled);
+  return true;
+}
+
+void RowBufferQueue::release_buffer(RowBuffer *buffer) {
+  base::MutexLock lock(_mutex);
+
+  _free.push_back(buffer);
+  _free_cond.signal();
+}
+
+void RowBufferQueue::release_buffers(std::vector<RowBuffer *> &batch) {
+  base::MutexLock lock(_mutex);
+
+  _free.insert(_free.end(), batch.begin(), batch.end());
+  batch.clear();
+  _free_cond.signal();
+}
+
+void RowBufferQueue::reset() {
+  base::MutexLock lock(_mutex);
+
+  _free = _buffers;
+  _filled.clear();
+  _finished = false;
+  _aborted = false;
+
+  _batches = 0;
+  _rows = 0;
+  _occupancy_total = 0;
+  _max_occupancy = 0;
+  _reader_waits = 0;
+  _writer_waits = 0;
+}
+
+void RowBufferQueue::abort() {
+  base::MutexLock lock(_mutex);
+
+  _aborted = true;
+  _free_cond.broadcast();
+  _filled_cond.broadcast();
+}
+
+void RowBufferQueue::log_statistics(const std::string &name) {
+  base::MutexLock lock(_mutex);
+
+  // Reader waits mean the target is the bottleneck, writer waits mean it's the source
+  logDebug("%s: %lli rows in %lli batches, %li buffers allocated, average/max occupancy %.1f/%li, "
+           "reader waited %lli times, writer waited %lli times\n",
+           name.c_str(), _rows, _batches, (long)_buffers.size(),
+           _batches > 0 ? (double)_occupancy_total / _batches : 0.0, (long)_max_occupancy, _reader_waits,
+           _writer_waits);
+}
+
 TaskQueue::TaskQueue() {
 }
 
@@ -2473,12 +3135,166 @@ bool TaskQueue::get_task(TableParam &task) {
   return ret_val;
 }
 
+/*
+ * chunk_ranges : divides the key range [min_key, max_key] in at most chunk_count consecutive ranges
+ *                of the same number of keys (except for the last one, which may be shorter).
+ *
+ * Remarks : The ranges cover [min_key, max_key] exactly and none of them is empty or inverted.
+ *           Less than chunk_count ranges are returned when the keys don't divide evenly among them.
+ */
+std::vector<std::pair<long long, long long> > TaskQueue::chunk_ranges(long long min_key, long long max_key,
+                                                                      unsigned long long chunk_count) {
+  std::vector<std::pair<long long, long long> > ranges;
+
+  // Unsigned, as the difference of two signed 64 bit keys can overflow
+  unsigned long long key_span = (unsigned long long)max_key - (unsigned long long)min_key;
+  if (chunk_count <= 1) {
+    ranges.push_back(std::make_pair(min_key, max_key));
+    return ranges;
+  }
+  if (key_span < chunk_count - 1)
+    chunk_count = key_span + 1;
+
+  // The range has key_span + 1 keys, the span is that divided by chunk_count rounded up (which can't overflow
+  // written this way). Rounding up can leave the last chunks without keys, so the ranges actually needed are
+  // counted again.
+  unsigned long long span = key_span / chunk_count + 1;
+  chunk_count = key_span / span + 1;
+
+  for (unsigned long long index = 0; index < chunk_count; index++) {
+    unsigned long long range_start = (unsigned long long)min_key + index * span;
+    ranges.push_back(std::make_pair((long long)range_start,
+                                    index == chunk_count - 1 ? max_key : (long long)(range_start + span - 1)));
+  }
+  return ranges;
+}
+
+/*
+ * split_tasks : replaces the tasks copying a whole table by several tasks each copying a range of
+ *               the table's primary key, so a big table can be copied by several threads at once.
+ * Parameters:
+ * - source : connection used to get the row count and key range of the tables
+ * - truncate_target : when given, split tables are truncated through it before their chunks are
+ *                     queued, as the chunk tasks share the table and must not truncate it themselves
+ * - chunk_size : approximate number of rows to be copied by each chunk
+ *
+ * Remarks : Only tables with a single integer PK column copied with CopyAll and no --max-count
+ *           are split. The key range is divided evenly so the chunk sizes are only accurate for
+ *           dense keys. Rows outside the [min, max] range at the time of the split (i.e. inserted
+ *           later) are not copied, same as with --table-range.
+ */
+void TaskQueue::split_tasks(CopyDataSource *source, MySQLCopyDataTarget *truncate_target, long long chunk_size) {
+  std::vector<TableParam> tasks;
+
+  {
+    base::MutexLock lock(_task_mutex);
+    tasks.swap(_tasks);
+  }
+
+  for (std::vector<TableParam>::iterator task = tasks.begin(); task != tasks.end(); ++task) {
+    long long min_key = 0, max_key = 0, row_count = 0;
+
+    if (task->copy_spec.type == CopyAll && task->copy_spec.max_count <= 0 && task->source_pk_columns.size() == 1 &&
+        task->target_pk_columns.size() == 1 && !task->chunk_progress) {
+      std::vector<std::string> no_pkeys;
+      row_count = (long long)source->count_rows(task->source_schema, task->source_table, task->source_pk_columns,
+                                                task->copy_spec, no_pkeys);
+
+      if (row_count > chunk_size &&
+          source->get_key_range(task->source_schema, task->source_table, task->source_pk_columns[0], min_key,
+                                max_key)) {
+        std::vector<std::pair<long long, long long> > ranges =
+          chunk_ranges(min_key, max_key, (row_count + chunk_size - 1) / chunk_size);
+
+        logInfo("Splitting table %s.%s in %i chunks\n", task->source_schema.c_str(), task->source_table.c_str(),
+                (int)ranges.size());
+
+        if (truncate_target)
+          truncate_target->truncate_table(task->target_schema, task->target_table);
+
+        std::shared_ptr<TableChunkProgress> progress(new TableChunkProgress(row_count, (int)ranges.size()));
+        for (int index = 0; index < (int)ranges.size(); index++) {
+          TableParam chunk = *task;
+
+          chunk.copy_spec.type = CopyRange;
+          chunk.copy_spec.range_key = task->source_pk_columns[0];
+          chunk.copy_spec.range_start = ranges[index].first;
+          chunk.copy_spec.range_end = ranges[index].second;
+          chunk.copy_spec.has_range_end = true;
+          chunk.chunk_progress = progress;
+          chunk.chunk_index = index;
+
+          add_task(chunk);
+        }
+        continue;
+      }
+    }
+
+    add_task(*task);
+  }
+}
+
+TableChunkProgress::TableChunkProgress(long long total_rows, int chunk_count)
+  : _total_rows(total_rows),
+    _copied_rows(0),
+    _chunk_count(chunk_count),
+    _started_chunks(0),
+    _finished_chunks(0),
+    _failed_chunks(0),
+    _missing_rows(0),
+    _start_time(time(NULL)) {
+}
+
+bool TableChunkProgress::begin_chunk() {
+  base::MutexLock lock(_mutex);
+
+  if (_started_chunks++ == 0) {
+    _start_time = time(NULL);
+    return true;
+  }
+  return false;
+}
+
+long long TableChunkProgress::add_copied_rows(long long count) {
+  base::MutexLock lock(_mutex);
+
+  _copied_rows += count;
+  return _copied_rows;
+}
+
+bool TableChunkProgress::end_chunk(bool succeeded, long long expected_rows, long long chunk_rows) {
+  base::MutexLock lock(_mutex);
+
+  if (!succeeded || chunk_rows != expected_rows) {
+    _failed_chunks++;
+    _missing_rows += expected_rows - chunk_rows;
+  }
+
+  return ++_finished_chunks == _chunk_count;
+}
+
+long long TableChunkProgress::copied_rows() {
+  base::MutexLock lock(_mutex);
+  return _copied_rows;
+}
+
+long long TableChunkProgress::missing_rows() {
+  base::MutexLock lock(_mutex);
+  return _missing_rows;
+}
+
+int TableChunkProgress::failed_chunks() {
+  base::MutexLock lock(_mutex);
+  return _failed_chunks;
+}
+
 CopyDataTask::CopyDataTask(const std::string name, CopyDataSource *psource, MySQLCopyDataTarget *ptarget,
-                           TaskQueue *ptasks, bool show_progress)
-  : _source(psource), _target(ptarget) {
+                           TaskQueue *ptasks, bool show_progress, size_t pipeline_depth)
+  : _source(psource), _target(ptarget), _queue(NULL), _row_limit(0) {
   _name = name;
   _tasks = ptasks;
   _show_progress = show_progress;
+  _pipeline_depth = pipeline_depth == 1 ? 2 : pipeline_depth;
 
   _thread = base::create_thread(&CopyDataTask::thread_func, this);
 }
@@ -2497,54 +3313,73 @@ gpointer CopyDataTask::thread_func(gpointer data) {
 
 void CopyDataTask::copy_table(const TableParam &task) {
   std::shared_ptr<std::vector<ColumnInfo> > columns;
+  TableChunkProgress *chunk_progress = task.chunk_progress.get();
 
   long long i = 0, total = 0;
   int inserted_records;
+  bool succeeded = false;
 
   time_t start = time(NULL);
   try {
     std::vector<std::string> last_pkeys;
-    if (task.copy_spec.resume)
-      last_pkeys = _target->get_last_pkeys(task.target_pk_columns, task.target_schema, task.target_table);
+    if (task.copy_spec.resume) {
+      // Chunks resume from the last row copied inside of their own key range
+      std::string range_condition;
+      if (chunk_progress)
+        range_condition =
+          base::strfmt("%s BETWEEN %lli AND %lli", task.target_pk_columns[0].c_str(), task.copy_spec.range_start,
+                       task.copy_spec.range_end);
+      last_pkeys =
+        _target->get_last_pkeys(task.target_pk_columns, task.target_schema, task.target_table, range_condition);
+    }
     total =
       _source->count_rows(task.source_schema, task.source_table, task.source_pk_columns, task.copy_spec, last_pkeys);
+
+    // The table total counts all rows of the table, so the rows of this chunk copied by an earlier
+    // run are counted as copied already
+    if (chunk_progress && !last_pkeys.empty()) {
+      std::vector<std::string> no_pkeys;
+      long long chunk_rows = (long long)_source->count_rows(task.source_schema, task.source_table,
+                                                            task.source_pk_columns, task.copy_spec, no_pkeys);
+      if (chunk_rows > total)
+        chunk_progress->add_copied_rows(chunk_rows - total);
+    }
+
     columns = _source->begin_select_table(task.source_schema, task.source_table, task.source_pk_columns,
                                           task.select_expression, task.copy_spec, last_pkeys);
 
-    printf("BEGIN:%s.%s:Copying %li columns of %lli rows from table %s.%s\n", task.target_schema.c_str(),
-           task.target_table.c_str(), (long)columns->size(), total, task.source_schema.c_str(),
-           task.source_table.c_str());
-    fflush(stdout);
+    if (chunk_progress) {
+      logDebug("%s copying chunk %i of %s.%s (%s %lli to %lli)\n", _name.c_str(), task.chunk_index + 1,
+               task.source_schema.c_str(), task.source_table.c_str(), task.copy_spec.range_key.c_str(),
+               task.copy_spec.range_start, task.copy_spec.range_end);
+
+      if (chunk_progress->begin_chunk())
+        report_begin(task, columns->size(), chunk_progress->total_rows());
+    } else
+      report_begin(task, columns->size(), total);
 
     _target->set_get_field_lengths_from_target(_source->get_get_field_lengths_from_target());
 
-    _target->set_target_table(task.target_schema, task.target_table, columns);
+    // Chunked tables were truncated once before their chunks were queued
+    _target->set_target_table(task.target_schema, task.target_table, columns, chunk_progress == NULL);
 
     _source->set_bulk_inserts(_target->bulk_inserts());
 
     _target->begin_inserts();
-    while (_source->fetch_row(_target->row_buffer())) {
-      inserted_records = _target->do_insert();
-      i += inserted_records;
 
-      if (_show_progress && inserted_records)
-        report_progress(task.target_schema, task.target_table, i, total);
-
-      _target->row_buffer().clear();
-
-      if ((task.copy_spec.type == CopyCount && i >= task.copy_spec.row_count) ||
-          (task.copy_spec.max_count > 0 && i >= task.copy_spec.max_count))
-        break;
-    }
+    // Pipelining needs the rows to be fully contained in the row buffers, which is not the case
+    // when blobs are streamed to the prepared statement with send_long_data
+    if (_pipeline_depth > 0 && _target->bulk_inserts())
+      copy_rows_pipelined(task, total, i);
+    else
+      copy_rows(task, total, i);
 
     inserted_records = _target->end_inserts();
     i += inserted_records;
-
-    if (_show_progress && inserted_records) {
-      report_progress(task.target_schema, task.target_table, i, total);
-    }
+    report_inserted(task, inserted_records, i, total);
 
     _source->end_select_table();
+    succeeded = true;
   } catch (std::exception &e) {
     printf("ERROR:%s.%s:%s\n", task.target_schema.c_str(), task.target_table.c_str(), e.what());
     fflush(stdout);
@@ -2552,12 +3387,173 @@ void CopyDataTask::copy_table(const TableParam &task) {
     _source->end_select_table();
   }
 
+  if (chunk_progress) {
+    logDebug("%s finished chunk %i of %s.%s with %lli of %lli rows\n", _name.c_str(), task.chunk_index + 1,
+             task.source_schema.c_str(), task.source_table.c_str(), i, total);
+
+    // The table is reported as finished once, by the thread completing its last pending chunk
+    if (chunk_progress->end_chunk(succeeded, total, i)) {
+      long long copied = chunk_progress->copied_rows();
+      int failed_chunks = chunk_progress->failed_chunks();
+
+      if (failed_chunks > 0)
+        logError("%i of %i chunks of table %s.%s failed, they can be completed with --resume\n", failed_chunks,
+                 chunk_progress->chunk_count(), task.source_schema.c_str(), task.source_table.c_str());
+      report_end(task, copied, copied + chunk_progress->missing_rows(), chunk_progress->start_time(),
+                 failed_chunks > 0);
+    }
+  } else
+    report_end(task, i, total, start, false);
+}
+
+void CopyDataTask::copy_rows(const TableParam &task, long long total, long long &copied) {
+  while (_source->fetch_row(_target->row_buffer())) {
+    int inserted_records = _target->do_insert();
+    copied += inserted_records;
+    report_inserted(task, inserted_records, copied, total);
+
+    _target->row_buffer().clear();
+
+    if ((task.copy_spec.type == CopyCount && copied >= task.copy_spec.row_count) ||
+        (task.copy_spec.max_count > 0 && copied >= task.copy_spec.max_count))
+      break;
+  }
+}
+
+/*
+ * copy_rows_pipelined : same as copy_rows, but rows are fetched from the source by a separate
+ *                       reader thread while this thread formats and sends them to the target.
+ *
+ * Remarks : The source is only used by the reader thread and the target only by this thread
+ *           until the reader is joined, so neither connection is shared between threads.
+ */
+void CopyDataTask::copy_rows_pipelined(const TableParam &task, long long total, long long &copied) {
+  // Row buffers reserve space for the largest possible value of each column, so the number of them
+  // in flight is limited by memory rather than only by the requested depth
+  size_t depth = _pipeline_depth;
+  size_t row_size = std::max<size_t>(_target->row_buffer().buffer_size(), 1);
+  if (depth * row_size > MAX_PIPELINE_MEMORY) {
+    depth = std::max<size_t>(MAX_PIPELINE_MEMORY / row_size, 2);
+    logDebug("%s: limiting pipeline depth for %s.%s to %li rows of %li bytes\n", _name.c_str(),
+             task.source_schema.c_str(), task.source_table.c_str(), (long)depth, (long)row_size);
+  }
+
+  // Chunks of the same table reuse the buffers allocated by the previous run instead of
+  // allocating a new set each time
+  std::string pool_table = base::strfmt("%s.%s:%li", task.target_schema.c_str(), task.target_table.c_str(), (long)depth);
+  if (!_row_pool || _row_pool_table != pool_table) {
+    _row_pool.reset(new RowBufferQueue(std::bind(&MySQLCopyDataTarget::create_row_buffer, _target.get()), depth));
+    _row_pool_table = pool_table;
+  } else
+    _row_pool->reset();
+  RowBufferQueue &queue = *_row_pool;
+
+  _queue = &queue;
+  _reader_error.clear();
+  _row_limit = 0;
+  if (task.copy_spec.type == CopyCount)
+    _row_limit = task.copy_spec.row_count;
+  if (task.copy_spec.max_count > 0 && (_row_limit == 0 || task.copy_spec.max_count < _row_limit))
+    _row_limit = task.copy_spec.max_count;
+
+  GError *error = NULL;
+  GThread *reader = base::create_thread(&CopyDataTask::reader_thread_func, this, &error);
+  if (!reader) {
+    std::string msg = base::strfmt("Error creating reader thread: %s", error ? error->message : "unknown error");
+    if (error)
+      g_error_free(error);
+    _queue = NULL;
+    throw std::runtime_error(msg);
+  }
+
+  try {
+    std::vector<RowBuffer *> batch;
+    while (queue.get_filled_buffers(batch)) {
+      // do_insert copies the row into the insert statement, so the buffer goes back right away and the
+      // reader can keep fetching while the rest of the batch is sent
+      for (std::vector<RowBuffer *>::iterator row = batch.begin(); row != batch.end(); ++row) {
+        int inserted_records = _target->do_insert(*row);
+        queue.release_buffer(*row);
+        copied += inserted_records;
+        report_inserted(task, inserted_records, copied, total);
+      }
+      batch.clear();
+    }
+  } catch (...) {
+    queue.abort();
+    g_thread_join(reader);
+    _queue = NULL;
+    throw;
+  }
+
+  g_thread_join(reader);
+  _queue = NULL;
+
+  queue.log_statistics(base::strfmt("%s %s.%s", _name.c_str(), task.source_schema.c_str(),
+                                    task.source_table.c_str()));
+
+  if (!_reader_error.empty())
+    throw std::runtime_error(_reader_error);
+}
+
+gpointer CopyDataTask::reader_thread_func(gpointer data) {
+  CopyDataTask *self = (CopyDataTask *)data;
+
+  self->read_rows();
+
+  return NULL;
+}
+
+void CopyDataTask::read_rows() {
+  long long fetched = 0;
+
+  try {
+    RowBuffer *row;
+    while ((_row_limit == 0 || fetched < _row_limit) && (row = _queue->get_free_buffer()) != NULL) {
+      row->clear();
+      if (!_source->fetch_row(*row)) {
+        std::vector<RowBuffer *> unused(1, row);
+        _queue->release_buffers(unused);
+        break;
+      }
+      _queue->push_filled_buffer(row);
+      fetched++;
+    }
+  } catch (std::exception &e) {
+    _reader_error = e.what();
+  }
+
+  // Lets the writer drain what was already read, an error is reported once it's done
+  _queue->finish();
+}
+
+void CopyDataTask::report_inserted(const TableParam &task, int inserted_records, long long copied, long long total) {
+  if (!inserted_records)
+    return;
+
+  if (task.chunk_progress) {
+    long long table_copied = task.chunk_progress->add_copied_rows(inserted_records);
+    if (_show_progress)
+      report_progress(task.target_schema, task.target_table, table_copied, task.chunk_progress->total_rows());
+  } else if (_show_progress)
+    report_progress(task.target_schema, task.target_table, copied, total);
+}
+
+void CopyDataTask::report_begin(const TableParam &task, size_t column_count, long long total) {
+  printf("BEGIN:%s.%s:Copying %li columns of %lli rows from table %s.%s\n", task.target_schema.c_str(),
+         task.target_table.c_str(), (long)column_count, total, task.source_schema.c_str(), task.source_table.c_str());
+  fflush(stdout);
+}
+
+void CopyDataTask::report_end(const TableParam &task, long long copied, long long total, time_t start,
+                              bool failed) {
   time_t end = time(NULL);
-  if (i != total)
-    printf("ERROR:%s.%s:Failed copying %lli rows\n", task.target_schema.c_str(), task.target_table.c_str(), total - i);
+  if (failed || copied != total)
+    printf("ERROR:%s.%s:Failed copying %lli rows\n", task.target_schema.c_str(), task.target_table.c_str(),
+           total - copied);
   else
     printf("END:%s.%s:Finished copying %lli rows in %im%02is\n", task.target_schema.c_str(), task.target_table.c_str(),
-           i, (int)((end - start) / 60), (int)((end - start) % 60));
+           copied, (int)((end - start) / 60), (int)((end - start) % 60));
   fflush(stdout);
 }
 
@@ -2628,6 +3624,23 @@ bool MySQLCopyDataTarget::InsertBuffer::append_escaped(const char *data, size_t
   return true;
 }
 
+bool MySQLCopyDataTarget::InsertBuffer::append_load_data_escaped(const char *data, size_t dlength) {
+  // Worst case scenario is all the characters being escaped
+  if ((dlength * 2) > space_left())
+    return false;
+
+  length += MySQLCopyDataTarget::load_data_escape(buffer + length, data, dlength);
+  return true;
+}
+
+bool MySQLCopyDataTarget::InsertBuffer::append_load_data_hex(const char *data, size_t dlength) {
+  if ((dlength * 2) > space_left())
+    return false;
+
+  length += MySQLCopyDataTarget::load_data_hex(buffer + length, data, dlength);
+  return true;
+}
+
 size_t MySQLCopyDataTarget::InsertBuffer::space_left() {
   return size - length;
 }
@@ -41,6 +41,8 @@
 
 #endif
 
+#include <ctime>
+
 #include "converter.h"
 #include "glib.h"
 #include "base/threading.h"
@@ -104,6 +106,7 @@ struct ColumnInfo {
   enum enum_field_types target_type;
   bool is_unsigned;
   bool is_long_data;
+  bool is_binary;
 };
 
 class RowBuffer : public std::vector<MYSQL_BIND> {
@@ -135,6 +138,57 @@ public:
 
   bool check_if_blob();
   void send_blob_data(const char *data, size_t length);
+
+  size_t buffer_size() const;
+};
+
+// Bounded ring of row buffers used to decouple reading rows from the source and inserting
+// them in the target, each side running in its own thread (see --pipeline-depth).
+// The reader takes free buffers and hands them back filled, the writer drains all filled buffers
+// at once and returns each one to the free list as soon as its row was inserted, blocking on either
+// side provides the back-pressure.
+class RowBufferQueue {
+  base::Mutex _mutex;
+  base::Cond _free_cond;
+  base::Cond _filled_cond;
+
+  std::function<RowBuffer *()> _create_buffer;
+  size_t _capacity;
+  size_t _allocating;
+  std::vector<RowBuffer *> _buffers;
+  std::vector<RowBuffer *> _free;
+  std::vector<RowBuffer *> _filled;
+  bool _finished;
+  bool _aborted;
+
+  // Statistics
+  long long _batches;
+  long long _rows;
+  long long _occupancy_total;
+  size_t _max_occupancy;
+  long long _reader_waits;
+  long long _writer_waits;
+
+public:
+  RowBufferQueue(std::function<RowBuffer *()> create_buffer, size_t capacity);
+  ~RowBufferQueue();
+
+  // Reader side: returns NULL if the writer aborted.
+  RowBuffer *get_free_buffer();
+  void push_filled_buffer(RowBuffer *buffer);
+  void finish();
+
+  // Writer side: returns false once the reader finished and all rows were consumed, or on abort.
+  bool get_filled_buffers(std::vector<RowBuffer *> &batch);
+  void release_buffer(RowBuffer *buffer);
+  void release_buffers(std::vector<RowBuffer *> &batch);
+  void abort();
+
+  // Makes every allocated buffer free again so the queue can be used for another run,
+  // only valid once the reader thread was joined.
+  void reset();
+
+  void log_statistics(const std::string &name);
 };
 
 enum CopyType { CopyAll, CopyRange, CopyCount, CopyWhere };
@@ -146,11 +200,52 @@ struct CopySpec {
   std::string where_expression;
   long long range_start;
   long long range_end;
+  bool has_range_end; // false copies everything from range_start on, range_end is ignored then
   long long row_count;
   long long max_count;
   bool resume;
 };
 
+// Shared state for a table whose rows are copied as several primary key range chunks
+// (see --chunk-size). Chunks of the same table may be processed concurrently by different
+// CopyDataTask threads, so progress and completion are aggregated here and reported once per table.
+class TableChunkProgress {
+  base::Mutex _mutex;
+  long long _total_rows;
+  long long _copied_rows;
+  int _chunk_count;
+  int _started_chunks;
+  int _finished_chunks;
+  int _failed_chunks;
+  long long _missing_rows;
+  time_t _start_time;
+
+public:
+  TableChunkProgress(long long total_rows, int chunk_count);
+
+  long long total_rows() const {
+    return _total_rows;
+  }
+  int chunk_count() const {
+    return _chunk_count;
+  }
+  time_t start_time() const {
+    return _start_time;
+  }
+
+  // Returns true for the first chunk of the table to be started.
+  bool begin_chunk();
+  // Adds count rows to the copied row total and returns the new total.
+  long long add_copied_rows(long long count);
+  // Records the completion of a chunk that was expected to copy expected_rows and copied
+  // chunk_rows of them. Returns true when it was the last chunk pending.
+  bool end_chunk(bool succeeded, long long expected_rows, long long chunk_rows);
+
+  long long copied_rows();
+  long long missing_rows();
+  int failed_chunks();
+};
+
 struct TableParam {
   std::string source_schema;
   std::string source_table;
@@ -160,6 +255,13 @@ struct TableParam {
   std::vector<std::string> source_pk_columns;
   std::vector<std::string> target_pk_columns;
   CopySpec copy_spec;
+
+  // Only set for tasks that copy a single chunk of a table split by primary key ranges.
+  std::shared_ptr<TableChunkProgress> chunk_progress;
+  int chunk_index;
+
+  TableParam() : chunk_index(0) {
+  }
 };
 
 class CopyDataSource {
@@ -199,6 +301,13 @@ public:
   std::string get_where_condition(const std::vector<std::string> &pk_columns,
                                   const std::vector<std::string> &last_pkeys);
 
+  // Retrieves the lowest and highest value of an integer key column, used to split a table in
+  // ranges that can be copied in parallel. Returns false if the source can't provide them.
+  virtual bool get_key_range(const std::string &schema, const std::string &table, const std::string &key_column,
+                             long long &min_value, long long &max_value) {
+    return false;
+  }
+
   virtual size_t count_rows(const std::string &schema, const std::string &table,
                             const std::vector<std::string> &pk_columns, const CopySpec &spec,
                             const std::vector<std::string> &last_pkeys) = 0;
@@ -238,6 +347,8 @@ public:
   SQLRETURN get_geometry_buffer_data(RowBuffer &rowbuffer, int column);
 
 public:
+  virtual bool get_key_range(const std::string &schema, const std::string &table, const std::string &key_column,
+                             long long &min_value, long long &max_value);
   virtual size_t count_rows(const std::string &schema, const std::string &table,
                             const std::vector<std::string> &pk_columns, const CopySpec &spec,
                             const std::vector<std::string> &last_pkeys);
@@ -259,6 +370,8 @@ public:
                       const std::string &socket, bool use_cleartext_plugin, const unsigned int connection_timeout);
   virtual ~MySQLCopyDataSource();
 
+  virtual bool get_key_range(const std::string &schema, const std::string &table, const std::string &key_column,
+                             long long &min_value, long long &max_value);
   virtual size_t count_rows(const std::string &schema, const std::string &table,
                             const std::vector<std::string> &pk_columns, const CopySpec &spec,
                             const std::vector<std::string> &last_pkeys);
@@ -291,6 +404,8 @@ class MySQLCopyDataTarget {
     bool append(const char *data, size_t length);
     bool append(const char *data);
     bool append_escaped(const char *data, size_t length);
+    bool append_load_data_escaped(const char *data, size_t length);
+    bool append_load_data_hex(const char *data, size_t length);
     void set_connection(MYSQL *mysql) {
       _mysql = mysql;
     }
@@ -323,12 +438,30 @@ class MySQLCopyDataTarget {
   std::string _source_rdbms_type;
   unsigned int _connection_timeout;
 
+  // Variables used for LOAD DATA LOCAL INFILE, records are formatted into _bulk_insert_record
+  // and then accumulated in _load_data_buffer, which is streamed by the local infile handler
+  bool _use_load_data;
+  std::string _load_data_query;
+  InsertBuffer _load_data_buffer;
+  size_t _load_data_offset;
+
   MYSQL_RES *get_server_value(const std::string &variable);
   void get_server_value(const std::string &variable, std::string &value);
   void get_server_value(const std::string &variable, unsigned long &value);
   bool format_bulk_record();
   bool append_bulk_column(size_t col_index);
 
+  std::string load_data_query();
+  bool format_load_data_record();
+  bool append_load_data_column(size_t col_index);
+  int do_load_data(bool final);
+  void log_load_data_warnings();
+
+  static int local_infile_init(void **ptr, const char *filename, void *userdata);
+  static int local_infile_read(void *ptr, char *buf, unsigned int buf_len);
+  static void local_infile_end(void *ptr);
+  static int local_infile_error(void *ptr, char *error_msg, unsigned int error_msg_len);
+
   void get_server_version();
   bool is_mysql_version_at_least(const int _major, const int _minor, const int _build);
   void send_long_data(int column, const char *data, size_t length);
@@ -343,7 +476,7 @@ public:
   MySQLCopyDataTarget(const std::string &hostname, int port, const std::string &username, const std::string &password,
                       const std::string &socket, bool use_cleartext_plugin, const std::string &app_name,
                       const std::string &incoming_charset, const std::string &source_rdbms_type,
-                      const unsigned int connection_timeout);
+                      const unsigned int connection_timeout, bool use_load_data = false);
 
   ~MySQLCopyDataTarget();
 
@@ -355,14 +488,19 @@ public:
   }
 
   void set_truncate(bool flag);
+  void truncate_table(const std::string &schema, const std::string &table);
 
+  // The table is truncated when truncation was enabled with set_truncate and truncate is true.
   void set_target_table(const std::string &schema, const std::string &table,
-                        std::shared_ptr<std::vector<ColumnInfo> > columns);
+                        std::shared_ptr<std::vector<ColumnInfo> > columns, bool truncate = true);
   long long get_max_value(const std::string &key);
 
   bool bulk_inserts() {
     return _use_bulk_inserts;
   }
+  bool load_data() {
+    return _use_load_data;
+  }
   void set_bulk_insert_batch_size(int value) {
     _bulk_insert_batch = value;
   }
@@ -377,6 +515,7 @@ public:
   void begin_inserts();
   int end_inserts(bool flush = true);
   int do_insert(bool final = false);
+  int do_insert(RowBuffer *row);
 
   void restore_triggers(std::set<std::string> &schemas);
   void backup_triggers(std::set<std::string> &schemas);
@@ -385,9 +524,14 @@ public:
   bool get_trigger_definitions_for_schema(const std::string &schema, std::map<std::string, std::string> &triggers);
   void drop_trigger_backups(const std::string &schema);
   std::vector<std::string> get_last_pkeys(const std::vector<std::string> &pk_columns, const std::string &schema,
-                                          const std::string &table);
+                                          const std::string &table, const std::string &where_condition = "");
 
   RowBuffer &row_buffer();
+  RowBuffer *create_row_buffer();
+
+  static bool load_data_charset_supported(const std::string &charset);
+  static size_t load_data_escape(char *out, const char *data, size_t length);
+  static size_t load_data_hex(char *out, const char *data, size_t length);
 };
 
 class TaskQueue {
@@ -399,6 +543,10 @@ public:
   TaskQueue();
   void add_task(const TableParam &task);
   bool get_task(TableParam &task);
+  void split_tasks(CopyDataSource *source, MySQLCopyDataTarget *truncate_target, long long chunk_size);
+
+  static std::vector<std::pair<long long, long long> > chunk_ranges(long long min_key, long long max_key,
+                                                                    unsigned long long chunk_count);
 
   size_t size() {
     return _tasks.size();
@@ -415,18 +563,38 @@ private:
   std::unique_ptr<MySQLCopyDataTarget> _target;
   TaskQueue *_tasks;
   bool _show_progress;
+  size_t _pipeline_depth;
 
   GThread *_thread;
 
+  // Row buffers are kept between runs on the same target table (e.g. its chunks), they're
+  // laid out for the table columns so they're dropped when switching to another table
+  std::unique_ptr<RowBufferQueue> _row_pool;
+  std::string _row_pool_table;
+
+  // State shared with the reader thread while copying in pipelined mode
+  RowBufferQueue *_queue;
+  long long _row_limit;
+  std::string _reader_error;
+
   static gpointer thread_func(gpointer data);
+  static gpointer reader_thread_func(gpointer data);
 
   void copy_table(const TableParam &task);
+  void copy_rows(const TableParam &task, long long total, long long &copied);
+  void copy_rows_pipelined(const TableParam &task, long long total, long long &copied);
+  void read_rows();
+  void report_inserted(const TableParam &task, int inserted_records, long long copied, long long total);
 
   void report_progress(const std::string &schema, const std::string &table, long long current, long long total);
+  void report_begin(const TableParam &task, size_t column_count, long long total);
+  void report_end(const TableParam &task, long long copied, long long total, time_t start, bool failed);
 
 public:
+  // pipeline_depth is the number of rows read ahead of the inserts, 0 disables pipelining
+  // and 1 is raised to 2 as a single buffer can't overlap reading and writing.
   CopyDataTask(const std::string name, CopyDataSource *psource, MySQLCopyDataTarget *ptarget, TaskQueue *ptasks,
-               bool show_progress);
+               bool show_progress, size_t pipeline_depth = 0);
   ~CopyDataTask();
   void wait() {
     g_thread_join(_thread);
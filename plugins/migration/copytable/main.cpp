@@ -160,7 +160,10 @@ static void show_help() {
   printf("--log-file=<file_path>\n");
   printf("--log-level=<level>\n");
   printf("--thread-count=<count>\n");
+  printf("--chunk-size=<rows>\n");
+  printf("--pipeline-depth=<rows> (0 disables, minimum 2)\n");
   printf("--bulk-insert-batch-size=<size>\n");
+  printf("--load-data\n");
   printf("--disable-triggers-on=<schema>\n");
   printf("--reenable-triggers-on=<schema>\n");
   printf("--dont-disable-triggers");
@@ -264,7 +267,10 @@ int main(int argc, char **argv) {
   bool reenable_triggers = false;
   bool disable_triggers_on_copy = true;
   bool resume = false;
+  bool use_load_data = false;
   int thread_count = 1;
+  long long chunk_size = 0;
+  int pipeline_depth = 0;
   long long bulk_insert_batch = 100;
   long long max_count = 0;
 
@@ -320,6 +326,8 @@ int main(int argc, char **argv) {
       disable_triggers_on_copy = false;
     else if (strcmp(argv[i], "--resume") == 0)
       resume = true;
+    else if (strcmp(argv[i], "--load-data") == 0)
+      use_load_data = true;
     else if (check_arg_with_value(argv, i, "--disable-triggers-on", argval, true)) {
       // disabling/enabling triggers are standalone operations and mutually exclusive
       // so here it ensures a request for trigger enabling was not found first
@@ -338,6 +346,20 @@ int main(int argc, char **argv) {
       thread_count = base::atoi<int>(argval, 0);
       if (thread_count < 1)
         thread_count = 1;
+    } else if (check_arg_with_value(argv, i, "--chunk-size", argval, true)) {
+      chunk_size = base::atoi<long long>(argval, 0ll);
+      if (chunk_size < 0)
+        chunk_size = 0;
+    } else if (check_arg_with_value(argv, i, "--pipeline-depth", argval, true)) {
+      // 0 disables pipelining, a single buffer can't overlap reading and writing so the
+      // smallest usable depth is 2
+      pipeline_depth = base::atoi<int>(argval, 0);
+      if (pipeline_depth < 0)
+        pipeline_depth = 0;
+      else if (pipeline_depth == 1) {
+        fprintf(stderr, "--pipeline-depth=1 can't overlap reads and inserts, using a depth of 2\n");
+        pipeline_depth = 2;
+      }
     } else if (check_arg_with_value(argv, i, "--bulk-insert-batch-size", argval, true)) {
       bulk_insert_batch = base::atoi<int>(argval, 0);
       if (bulk_insert_batch < 1)
@@ -408,6 +430,8 @@ int main(int argc, char **argv) {
       param.copy_spec.range_key = argv[++i];
       param.copy_spec.range_start = base::atoi<long long>(argv[++i], 0ll);
       param.copy_spec.range_end = base::atoi<long long>(argv[++i], 0ll);
+      // A negative end on the command line means the range has no upper bound
+      param.copy_spec.has_range_end = param.copy_spec.range_end >= 0;
       param.copy_spec.type = CopyRange;
 
       tables.add_task(param);
@@ -654,6 +678,31 @@ int main(int argc, char **argv) {
         ptarget_conn->backup_triggers(trigger_schemas);
       }
 
+      // Big tables are split in primary key ranges so all the threads can work on them
+      if (chunk_size > 0 && thread_count > 1) {
+        std::unique_ptr<CopyDataSource> psplitter;
+
+        if (source_type == ST_ODBC) {
+          SQLAllocHandle(SQL_HANDLE_ENV, SQL_NULL_HANDLE, &odbc_env);
+          SQLSetEnvAttr(odbc_env, SQL_ATTR_ODBC_VERSION, (void *)SQL_OV_ODBC3, 0);
+
+          psplitter.reset(
+            new ODBCCopyDataSource(odbc_env, source_connstring, source_password, source_is_utf8, source_rdbms_type));
+        } else if (source_type == ST_MYSQL)
+          psplitter.reset(new MySQLCopyDataSource(source_host, source_port, source_user, source_password,
+                                                  source_socket, source_use_cleartext_plugin,
+                                                  source_connection_timeout));
+        else
+          psplitter.reset(new PythonCopyDataSource(source_connstring, source_password));
+
+        std::unique_ptr<MySQLCopyDataTarget> ptruncater;
+        if (truncate_target)
+          ptruncater.reset(new MySQLCopyDataTarget(target_host, target_port, target_user, target_password,
+                                                   target_socket, target_use_cleartext_plugin, app_name,
+                                                   source_charset, source_rdbms_type, target_connection_timeout));
+        tables.split_tasks(psplitter.get(), ptruncater.get(), chunk_size);
+      }
+
       for (int index = 0; index < thread_count; index++) {
         if (source_type == ST_ODBC) {
           SQLAllocHandle(SQL_HANDLE_ENV, SQL_NULL_HANDLE, &odbc_env);
@@ -669,7 +718,7 @@ int main(int argc, char **argv) {
 
         ptarget = new MySQLCopyDataTarget(target_host, target_port, target_user, target_password, target_socket,
                                           target_use_cleartext_plugin, app_name, source_charset, source_rdbms_type,
-                                          target_connection_timeout);
+                                          target_connection_timeout, use_load_data);
 
         psource->set_max_blob_chunk_size(ptarget->get_max_allowed_packet());
         psource->set_max_parameter_size((unsigned long)ptarget->get_max_long_data_size());
@@ -684,7 +733,8 @@ int main(int argc, char **argv) {
           delete psource;
         } else {
           threads.push_back(
-            new CopyDataTask(base::strfmt("Task %d", index + 1), psource, ptarget, &tables, show_progress));
+            new CopyDataTask(base::strfmt("Task %d", index + 1), psource, ptarget, &tables, show_progress,
+                             (size_t)pipeline_depth));
         }
       }
 
@@ -190,6 +190,62 @@ void PythonCopyDataSource::_init() // This has to be executed from the same thre
   PyGILState_Release(state);
 }
 
+bool PythonCopyDataSource::get_key_range(const std::string &schema, const std::string &table,
+                                         const std::string &key_column, long long &min_value, long long &max_value) {
+  _init();
+
+  PyGILState_STATE state = PyGILState_Ensure();
+
+  if (!schema.empty() && base::trim(schema, "`\"'") != "def") {
+    std::string use_query = base::strfmt("USE %s", schema.c_str());
+    PyObject_CallMethod(_cursor, (char *)"execute", (char *)"(s)", use_query.c_str());
+    if (PyErr_Occurred()) {
+      PyErr_Print();
+      logWarning("The query \"USE %s\" failed\n", schema.c_str());
+    }
+  }
+
+  std::string q =
+    base::strfmt("SELECT min(%s), max(%s) FROM %s", key_column.c_str(), key_column.c_str(), table.c_str());
+
+  logDebug("Executing query: %s\n", q.c_str());
+  PyObject *result = PyObject_CallMethod(_cursor, (char *)"execute", (char *)"(s)", q.c_str());
+  if (result == NULL) {
+    // Not being able to get the range only means the table will be copied in one go
+    if (PyErr_Occurred())
+      PyErr_Print();
+    logWarning("Could not get the key range of %s.%s\n", schema.c_str(), table.c_str());
+    PyGILState_Release(state);
+    return false;
+  }
+  Py_DECREF(result);
+
+  bool ret_val = false;
+  PyObject *row = PyObject_CallMethod(_cursor, (char *)"fetchone", NULL);
+  if (row && PySequence_Check(row) && PySequence_Size(row) == 2) {
+    PyObject *min_item = PySequence_GetItem(row, 0);
+    PyObject *max_item = PySequence_GetItem(row, 1);
+
+    // Only integer keys can be split in ranges
+    if ((PyInt_Check(min_item) || PyLong_Check(min_item)) && (PyInt_Check(max_item) || PyLong_Check(max_item))) {
+      min_value = PyLong_AsLongLong(min_item);
+      max_value = PyLong_AsLongLong(max_item);
+      ret_val = !PyErr_Occurred();
+    }
+    Py_DECREF(min_item);
+    Py_DECREF(max_item);
+  }
+  if (PyErr_Occurred()) {
+    PyErr_Print();
+    PyErr_Clear();
+  }
+  Py_XDECREF(row);
+
+  PyGILState_Release(state);
+
+  return ret_val;
+}
+
 size_t PythonCopyDataSource::count_rows(const std::string &schema, const std::string &table,
                                         const std::vector<std::string> &pk_columns, const CopySpec &spec,
                                         const std::vector<std::string> &last_pkeys) {
@@ -217,7 +273,7 @@ size_t PythonCopyDataSource::count_rows(const std::string &schema, const std::st
       break;
     case CopyRange: {
       std::string start_expr, end_expr;
-      if (spec.range_end < 0)
+      if (!spec.has_range_end)
         end_expr = "";
       else
         end_expr = base::strfmt("%s <= %lli", spec.range_key.c_str(), spec.range_end);
@@ -308,7 +364,7 @@ std::shared_ptr<std::vector<ColumnInfo> > PythonCopyDataSource::begin_select_tab
     select_query.add_where(get_where_condition(pk_columns, last_pkeys));
   if (spec.type == CopyRange) {
     select_query.add_where(base::strfmt("%s >= %lli", spec.range_key.c_str(), spec.range_start));
-    if (spec.range_end >= 0)
+    if (spec.has_range_end)
       select_query.add_where(base::strfmt("%s <= %lli", spec.range_key.c_str(), spec.range_end));
   }
   if (spec.type == CopyWhere)
@@ -353,6 +409,7 @@ std::shared_ptr<std::vector<ColumnInfo> > PythonCopyDataSource::begin_select_tab
     info.source_length = 0;   // The actual value will be taken from the target
     info.is_unsigned = false; // The actual value will be taken from the target
     info.is_long_data = false;
+    info.is_binary = false;   // The actual value will be taken from the target
 
     info.is_long_data = false;
 
@@ -47,6 +47,8 @@ public:
   virtual ~PythonCopyDataSource();
 
 public:
+  virtual bool get_key_range(const std::string &schema, const std::string &table, const std::string &key_column,
+                             long long &min_value, long long &max_value);
   virtual size_t count_rows(const std::string &schema, const std::string &table,
                             const std::vector<std::string> &pk_columns, const CopySpec &spec,
                             const std::vector<std::string> &last_pkeys);
@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2017, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include <algorithm>
+#include <climits>
+
+#include "base/string_utilities.h"
+#include "copytable.h"
+#include "wb_helpers.h"
+
+static std::string load_data_escape(const std::string &value) {
+  std::string result(value.size() * 2, '\0');
+  result.resize(MySQLCopyDataTarget::load_data_escape(&result[0], value.data(), value.size()));
+  return result;
+}
+
+static std::string load_data_hex(const std::string &value) {
+  std::string result(value.size() * 2, '\0');
+  result.resize(MySQLCopyDataTarget::load_data_hex(&result[0], value.data(), value.size()));
+  return result;
+}
+
+// Checks that the chunk ranges cover [min_key, max_key] exactly, without empty or inverted ranges.
+static void check_chunk_ranges(long long min_key, long long max_key, unsigned long long chunk_count) {
+  std::string name = base::strfmt("[%lli, %lli] in %llu chunks", min_key, max_key, chunk_count);
+  std::vector<std::pair<long long, long long> > ranges = TaskQueue::chunk_ranges(min_key, max_key, chunk_count);
+
+  tut::ensure(name + ": ranges", !ranges.empty());
+  tut::ensure(name + ": not more than requested", ranges.size() <= std::max(chunk_count, 1ULL));
+  tut::ensure_equals(name + ": first key", ranges.front().first, min_key);
+  tut::ensure_equals(name + ": last key", ranges.back().second, max_key);
+  for (size_t index = 0; index < ranges.size(); index++) {
+    tut::ensure(name + ": range not inverted", ranges[index].first <= ranges[index].second);
+    if (index > 0)
+      tut::ensure_equals(name + ": ranges contiguous", ranges[index].first, ranges[index - 1].second + 1);
+  }
+}
+
+// A single int column, the row buffers of the queue tests hold the number of their row in it.
+static std::shared_ptr<std::vector<ColumnInfo> > int_columns() {
+  ColumnInfo column;
+  column.source_name = column.target_name = "id";
+  column.source_type = "INT";
+  column.mapped_source_type = column.target_type = MYSQL_TYPE_LONG;
+  column.source_length = 11;
+  column.is_unsigned = false;
+  column.is_long_data = false;
+  column.is_binary = false;
+  return std::shared_ptr<std::vector<ColumnInfo> >(new std::vector<ColumnInfo>(1, column));
+}
+
+static int &row_number(RowBuffer *row) {
+  return *(int *)(*row)[0].buffer;
+}
+
+// Reader side of a RowBufferQueue, pushing row_count rows the way CopyDataTask::read_rows does.
+struct QueueReader {
+  RowBufferQueue *queue;
+  int row_count;
+  int pushed;
+  bool aborted;
+  std::string error;
+
+  static gpointer run(gpointer data) {
+    QueueReader *self = (QueueReader *)data;
+    try {
+      for (; self->pushed < self->row_count; self->pushed++) {
+        RowBuffer *row = self->queue->get_free_buffer();
+        if (!row) {
+          self->aborted = true;
+          break;
+        }
+        row_number(row) = self->pushed;
+        self->queue->push_filled_buffer(row);
+      }
+    } catch (std::exception &e) {
+      self->error = e.what();
+    }
+    self->queue->finish();
+    return NULL;
+  }
+};
+
+BEGIN_TEST_DATA_CLASS(copytable_test)
+protected:
+std::shared_ptr<std::vector<ColumnInfo> > columns;
+int allocated;
+int fail_allocation; // The allocation that fails, 0 for none.
+
+TEST_DATA_CONSTRUCTOR(copytable_test) {
+  columns = int_columns();
+  allocated = 0;
+  fail_allocation = 0;
+}
+
+RowBuffer *create_buffer() {
+  if (++allocated == fail_allocation)
+    throw std::runtime_error("Could not allocate row buffer");
+  return new RowBuffer(columns, std::function<void(int, const char *, size_t)>(), 0);
+}
+
+std::function<RowBuffer *()> buffer_factory() {
+  return std::bind(&Test_object_base<copytable_test>::create_buffer, this);
+}
+
+GThread *start_reader(QueueReader &reader, RowBufferQueue &queue, int row_count) {
+  reader.queue = &queue;
+  reader.row_count = row_count;
+  reader.pushed = 0;
+  reader.aborted = false;
+  reader.error.clear();
+  return base::create_thread(&QueueReader::run, &reader);
+}
+
+END_TEST_DATA_CLASS;
+
+TEST_MODULE(copytable_test, "wbcopytables");
+
+// LOAD DATA escaping of field values.
+TEST_FUNCTION(5) {
+  ensure_equals("plain text", load_data_escape("abc def"), "abc def");
+  ensure_equals("empty", load_data_escape(""), "");
+  ensure_equals("field and line separators", load_data_escape("a\tb\nc\rd"), "a\\tb\\nc\\rd");
+  ensure_equals("escape character", load_data_escape("C:\\dir\\"), "C:\\\\dir\\\\");
+  ensure_equals("null byte", load_data_escape(std::string("a\0b", 3)), "a\\0b");
+  ensure_equals("quotes are left alone", load_data_escape("'\""), "'\"");
+
+  // utf8 multibyte characters never contain ASCII bytes, so they pass through unchanged.
+  ensure_equals("utf8", load_data_escape("\xE3\x8A\xA8\xC3\xA9"), "\xE3\x8A\xA8\xC3\xA9");
+  ensure_equals("worst case size", load_data_escape("\\\\\\").size(), 6U);
+}
+
+// Binary values are hex encoded so they are loaded with UNHEX() without a charset conversion.
+TEST_FUNCTION(10) {
+  ensure_equals("empty", load_data_hex(""), "");
+  ensure_equals("text", load_data_hex("AZ"), "415A");
+  ensure_equals("binary", load_data_hex(std::string("\x00\x5C\x09\x0A\xFF", 5)), "005C090AFF");
+}
+
+// Character sets of the source data for which LOAD DATA can be used.
+TEST_FUNCTION(15) {
+  // ASCII safe character sets.
+  ensure("no charset", MySQLCopyDataTarget::load_data_charset_supported(""));
+  ensure("utf8", MySQLCopyDataTarget::load_data_charset_supported("utf8"));
+  ensure("utf8mb4", MySQLCopyDataTarget::load_data_charset_supported("utf8mb4"));
+  ensure("latin1", MySQLCopyDataTarget::load_data_charset_supported("latin1"));
+  ensure("ujis", MySQLCopyDataTarget::load_data_charset_supported("ujis"));
+  ensure("euckr", MySQLCopyDataTarget::load_data_charset_supported("euckr"));
+
+  // 0x5C can be the second byte of a multibyte character.
+  ensure("sjis", !MySQLCopyDataTarget::load_data_charset_supported("sjis"));
+  ensure("cp932", !MySQLCopyDataTarget::load_data_charset_supported("cp932"));
+  ensure("big5", !MySQLCopyDataTarget::load_data_charset_supported("big5"));
+  ensure("gbk", !MySQLCopyDataTarget::load_data_charset_supported("gbk"));
+  ensure("gb18030", !MySQLCopyDataTarget::load_data_charset_supported("gb18030"));
+  ensure("upper case", !MySQLCopyDataTarget::load_data_charset_supported("SJIS"));
+
+  // Not ASCII compatible at all.
+  ensure("ucs2", !MySQLCopyDataTarget::load_data_charset_supported("ucs2"));
+  ensure("utf16", !MySQLCopyDataTarget::load_data_charset_supported("utf16"));
+  ensure("utf32", !MySQLCopyDataTarget::load_data_charset_supported("utf32"));
+}
+
+// Key ranges of the chunks a table is split in.
+TEST_FUNCTION(20) {
+  check_chunk_ranges(0, 9, 10);
+  check_chunk_ranges(1, 10, 10);
+  check_chunk_ranges(0, 10, 10); // Doesn't divide evenly.
+  check_chunk_ranges(1, 1000000, 7);
+  check_chunk_ranges(-50, 49, 7); // Negative keys.
+  check_chunk_ranges(-1, 1, 100); // Less keys than chunks.
+  check_chunk_ranges(5, 5, 3);
+  check_chunk_ranges(0, 999, 1);
+  check_chunk_ranges(0, 999, 0);
+  check_chunk_ranges(LLONG_MIN, LLONG_MAX, 1); // The key span overflows a signed 64 bit value.
+  check_chunk_ranges(LLONG_MIN, LLONG_MAX, 2);
+  check_chunk_ranges(LLONG_MIN, LLONG_MAX, 7);
+  check_chunk_ranges(LLONG_MAX - 10, LLONG_MAX, 4);
+
+  // The keys are distributed evenly, only the last range can be shorter.
+  std::vector<std::pair<long long, long long> > ranges = TaskQueue::chunk_ranges(0, 99, 4);
+  ensure_equals("chunk count", ranges.size(), 4U);
+  for (size_t index = 0; index < ranges.size(); index++)
+    ensure_equals("chunk size", ranges[index].second - ranges[index].first + 1, 25);
+
+  ranges = TaskQueue::chunk_ranges(0, 10, 10);
+  ensure_equals("chunk count", ranges.size(), 6U);
+  ensure_equals("last chunk start", ranges.back().first, 10);
+  ensure_equals("last chunk end", ranges.back().second, 10);
+}
+
+// Rows pushed through the queue arrive in order, without allocating more buffers than its capacity.
+TEST_FUNCTION(25) {
+  RowBufferQueue queue(buffer_factory(), 4);
+  QueueReader reader;
+
+  for (int run = 0; run < 2; run++) {
+    GThread *thread = start_reader(reader, queue, 1000);
+    std::vector<RowBuffer *> batch;
+    int received = 0;
+    while (queue.get_filled_buffers(batch)) {
+      ensure("batch not empty", !batch.empty());
+      ensure("batch within capacity", batch.size() <= 4U);
+      for (std::vector<RowBuffer *>::iterator row = batch.begin(); row != batch.end(); ++row)
+        ensure_equals("row order", row_number(*row), received++);
+
+      // Both ways of giving the buffers back.
+      if (received % 2)
+        queue.release_buffers(batch);
+      else {
+        for (std::vector<RowBuffer *>::iterator row = batch.begin(); row != batch.end(); ++row)
+          queue.release_buffer(*row);
+        batch.clear();
+      }
+    }
+    g_thread_join(thread);
+
+    ensure_equals("all rows received", received, 1000);
+    ensure("no reader error", reader.error.empty());
+    ensure("not aborted", !reader.aborted);
+    ensure("buffers allocated", allocated > 0);
+    ensure("not more buffers than the capacity", allocated <= 4);
+
+    // The next run reuses the buffers of the previous one.
+    queue.reset();
+  }
+
+  // A reader without rows finishes the writer right away.
+  GThread *thread = start_reader(reader, queue, 0);
+  std::vector<RowBuffer *> batch;
+  ensure("nothing to write", !queue.get_filled_buffers(batch));
+  g_thread_join(thread);
+  ensure("no rows", batch.empty());
+}
+
+// Aborting the writer unblocks the reader waiting for a free buffer.
+TEST_FUNCTION(30) {
+  RowBufferQueue queue(buffer_factory(), 2);
+  QueueReader reader;
+  GThread *thread = start_reader(reader, queue, 1000);
+
+  // The buffers aren't given back, so the reader blocks once both were filled.
+  std::vector<RowBuffer *> batch;
+  std::vector<RowBuffer *> held;
+  while (held.size() < 2 && queue.get_filled_buffers(batch)) {
+    held.insert(held.end(), batch.begin(), batch.end());
+    batch.clear();
+  }
+  ensure_equals("rows received", held.size(), 2U);
+
+  g_usleep(100000);
+  queue.abort();
+  g_thread_join(thread);
+
+  ensure("reader aborted", reader.aborted);
+  ensure_equals("rows pushed", reader.pushed, 2);
+  ensure_equals("buffers allocated", allocated, 2);
+  ensure("writer aborted", !queue.get_filled_buffers(batch));
+  ensure("aborted reader gets no buffer", queue.get_free_buffer() == NULL);
+
+  // Resetting after the abort makes the queue usable again.
+  queue.reset();
+  thread = start_reader(reader, queue, 10);
+  int received = 0;
+  while (queue.get_filled_buffers(batch)) {
+    received += (int)batch.size();
+    queue.release_buffers(batch);
+  }
+  g_thread_join(thread);
+  ensure_equals("rows after reset", received, 10);
+  ensure("not aborted after reset", !reader.aborted);
+}
+
+// A buffer that can't be allocated ends the reader with an error, the rows read before are still written.
+TEST_FUNCTION(35) {
+  fail_allocation = 3;
+  RowBufferQueue queue(buffer_factory(), 4);
+  QueueReader reader;
+  GThread *thread = start_reader(reader, queue, 1000);
+
+  // Holding on to the buffers makes the reader allocate a new one for each row.
+  std::vector<RowBuffer *> batch;
+  std::vector<RowBuffer *> held;
+  while (queue.get_filled_buffers(batch)) {
+    held.insert(held.end(), batch.begin(), batch.end());
+    batch.clear();
+  }
+  g_thread_join(thread);
+
+  ensure_equals("reader error", reader.error, "Could not allocate row buffer");
+  ensure_equals("rows pushed", reader.pushed, 2);
+  ensure_equals("rows received", held.size(), 2U);
+  ensure_equals("first row", row_number(held[0]), 0);
+  ensure_equals("second row", row_number(held[1]), 1);
+
+  // The failed allocation doesn't take up a slot of the queue.
+  fail_allocation = 0;
+  queue.reset();
+  thread = start_reader(reader, queue, 4);
+  held.clear();
+  while (queue.get_filled_buffers(batch)) {
+    held.insert(held.end(), batch.begin(), batch.end());
+    batch.clear();
+  }
+  g_thread_join(thread);
+  ensure("no reader error", reader.error.empty());
+  ensure_equals("whole capacity used", held.size(), 4U);
+}
+
+END_TESTS
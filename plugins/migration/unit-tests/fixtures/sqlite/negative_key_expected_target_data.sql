@@ -0,0 +1,9 @@
+/*!40101 SET @saved_cs_client     = @@character_set_client */;
+/*!40101 SET character_set_client = utf8 */;
+CREATE TABLE `NegativeKeyContainer` (
+  `id` int(11) NOT NULL,
+  `str_data` longtext,
+  PRIMARY KEY (`id`)
+) ENGINE=InnoDB DEFAULT CHARSET=latin1;
+/*!40101 SET character_set_client = @saved_cs_client */;
+INSERT INTO `NegativeKeyContainer` VALUES (-9,'minus nine'),(-6,'minus six'),(-5,'minus five'),(-3,'minus three'),(-1,'minus one'),(0,'zero'),(2,'two'),(5,'five');
@@ -0,0 +1,19 @@
+BEGIN TRANSACTION;
+
+DROP TABLE IF EXISTS NegativeKeyContainer;
+
+CREATE TABLE NegativeKeyContainer (
+  id INTEGER PRIMARY KEY,
+  str_data TEXT
+);
+
+INSERT INTO NegativeKeyContainer (id, str_data) VALUES (-9, 'minus nine');
+INSERT INTO NegativeKeyContainer (id, str_data) VALUES (-6, 'minus six');
+INSERT INTO NegativeKeyContainer (id, str_data) VALUES (-5, 'minus five');
+INSERT INTO NegativeKeyContainer (id, str_data) VALUES (-3, 'minus three');
+INSERT INTO NegativeKeyContainer (id, str_data) VALUES (-1, 'minus one');
+INSERT INTO NegativeKeyContainer (id, str_data) VALUES (0, 'zero');
+INSERT INTO NegativeKeyContainer (id, str_data) VALUES (2, 'two');
+INSERT INTO NegativeKeyContainer (id, str_data) VALUES (5, 'five');
+
+COMMIT TRANSACTION;
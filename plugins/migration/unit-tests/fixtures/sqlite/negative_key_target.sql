@@ -0,0 +1,4 @@
+CREATE  TABLE IF NOT EXISTS `NegativeKeyContainer` (
+  `id` INT NOT NULL ,
+  `str_data` LONGTEXT NULL DEFAULT NULL ,
+  PRIMARY KEY (`id`) );
@@ -167,6 +167,8 @@ class CopyTablesTestCase(unittest.TestCase):
                              ' --table-file="%(table_file)s"' % test_info +
                              ' --thread-count=%u' % self.thread_count
                             )
+        if test_info['params']:
+            copytables_params += ' ' + open(test_info['params'], 'rb').read().strip()
         logging.debug('Calling copytables with command: %s' % settings.copytables_path + scramble_pwd(copytables_params))
         subprocess.Popen(settings.copytables_path + copytables_params, shell=True).wait()
 
@@ -216,7 +218,8 @@ def available_tests(path):
     A test is identified by the presence of the files <test_name>_source.sql,
     <test_name>_target.sql and either a <test_name>_expected_target_data.sql or a
     subset of <test_name>_<mysql_server_name>_expected_target_data.sql files for each
-    defined mysql server in settings.py.
+    defined mysql server in settings.py. An optional <test_name>_params.txt file holds
+    additional wbcopytables parameters for the test.
 
     Args:
         path: A string containing the path to the directory where the tests are stored.
@@ -232,6 +235,7 @@ def available_tests(path):
             'target' : The .sql file to be run in each target MySQL server. This file
                 usually sets up the table(s) that will contain the migrated data.
             'table_file' : The table file that wbcopytables will use.
+            'params' : The file with additional wbcopytables parameters, or None.
             'expected' : A dictionary mapping a MySQL server name (obtained from iterating
                 over the MySQL servers defined in settings.py) to the expected result
                 file, obtained from dumping the target table that contains the expected
@@ -262,6 +266,8 @@ def available_tests(path):
                              'source'    : os.path.join(root, candidate_test),
                              'target'    : os.path.join(root, test_name + '_target.sql'),
                              'table_file': os.path.join(root, test_name + '_table_file.txt'),
+                             'params'    : (os.path.join(root, test_name + '_params.txt')
+                                            if test_name + '_params.txt' in files else None),
                              'expected'  : expected
                            }
                          )
@@ -1,3 +1,3 @@
 {{#ROW}}{{INDENT}}{{{#FIELD}}
-{{INDENT}}{{INDENT}}"{{FIELD_NAME:xml_escape}}" : {{FIELD_VALUE}}{{#FIELD_separator}},{{/FIELD_separator}}{{/FIELD}}
+{{INDENT}}{{INDENT}}"{{FIELD_NAME:x-json_escape}}" : {{FIELD_VALUE}}{{#FIELD_separator}},{{/FIELD_separator}}{{/FIELD}}
 {{INDENT}}}{{ROW_SEPARATOR}}{{/ROW}}